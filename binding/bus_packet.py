@@ -1,16 +1,35 @@
 import ctypes
+import os
+import sys
 
 try:
-    lib = ctypes.WinDLL('./bus_packet.dll')
-except:
-    print("ERROR: No se ha encontrado la librería 'bus_packet.dll' en el directorio actual.")
-    print("¿Tienes el archivo bus_packet.dll en la misma carpeta que este archivo?")
-    
+    import numpy as np
+except ImportError:
+    np = None       # Las funciones *_batch necesitan NumPy
+
+
+_dir = os.path.dirname(os.path.abspath(__file__))
+
+try:
+    if sys.platform == "win32":
+        lib = ctypes.WinDLL(os.path.join(_dir, 'bus_packet.dll'))
+    else:
+        # Compilar con:
+        #   gcc -O2 -shared -fPIC -Icrc -Ibus_packet -Itf_packet crc/crc16_ccsds.c crc/crc32_ccsds.c
+        #       bus_packet/bus_packet.c tf_packet/tf_packet.c -o binding/libbus_packet.so
+        lib = ctypes.CDLL(os.path.join(_dir, 'libbus_packet.so'))
+except OSError:
+    print("ERROR: No se ha encontrado la librería 'bus_packet.dll' / 'libbus_packet.so' en el directorio de este archivo.")
+    print("¿Tienes el archivo bus_packet.dll (Windows) o libbus_packet.so (Linux) en la misma carpeta que este archivo?")
+    raise
+
 BUS_PACKET_BUS_SIZE		        =	127
 BUS_PACKET_ECF_SIZE		        =	2
 BUS_PACKET_HEADER_SIZE	        =	2
 BUS_PACKET_DATA_SIZE	        =	(BUS_PACKET_BUS_SIZE-BUS_PACKET_ECF_SIZE-BUS_PACKET_HEADER_SIZE)
 BUS_PACKET_FRAME_SYNC_SIZE      =	4
+BUS_PACKET_JUMBO_HEADER_SIZE    =	4
+BUS_PACKET_JUMBO_MARKER         =	0x80    # Segundo byte de la cabecera de un jumbo bus packet
 
 BUS_PACKET_TYPE_TM		        =	0       # Para Telemetrías
 BUS_PACKET_TYPE_TC		        =	1       # Para Telecomandos
@@ -21,56 +40,242 @@ BUS_PACKET_ECF_EXIST	        =	1       # RECOMENDADO: Poner siempre este
 
 class bus_packet_t(ctypes.Structure):
     _fields_ = [
-        ("packet_type", ctypes.c_uint8), 
-        ("apid", ctypes.c_uint8), 
-        ("ecf_flag", ctypes.c_uint8), 
-        ("length", ctypes.c_uint8), 
-        ("data", ctypes.c_uint8 * BUS_PACKET_DATA_SIZE), 
-        ("ecf", ctypes.c_uint16), 
+        ("packet_type", ctypes.c_uint8),
+        ("apid", ctypes.c_uint8),
+        ("ecf_flag", ctypes.c_uint8),
+        ("length", ctypes.c_uint8),
+        ("data", ctypes.c_uint8 * BUS_PACKET_DATA_SIZE),
+        ("ecf", ctypes.c_uint16),
         ]
-    
+
+
+class bus_packet_batch_t(ctypes.Structure):
+    _fields_ = [
+        ("capacity", ctypes.c_uint32),
+        ("count", ctypes.c_uint32),
+        ("packet_type", ctypes.POINTER(ctypes.c_uint8)),
+        ("apid", ctypes.POINTER(ctypes.c_uint8)),
+        ("ecf_flag", ctypes.POINTER(ctypes.c_uint8)),
+        ("length", ctypes.POINTER(ctypes.c_uint16)),
+        ("ecf", ctypes.POINTER(ctypes.c_uint16)),
+        ("offset", ctypes.POINTER(ctypes.c_uint32)),
+        ("status", ctypes.POINTER(ctypes.c_uint8)),
+        ]
+
+
+class bus_packet_record_t(ctypes.Structure):
+    _fields_ = [
+        ("packet_type", ctypes.c_uint8),
+        ("apid", ctypes.c_uint8),
+        ("ecf_flag", ctypes.c_uint8),
+        ("crc_ok", ctypes.c_uint8),
+        ("length", ctypes.c_uint16),
+        ("header_size", ctypes.c_uint8),
+        ("reserved", ctypes.c_uint8),
+        ("offset", ctypes.c_uint64),
+        ]
+
+# Mismo formato que bus_packet_record_t
+BUS_PACKET_RECORD_DTYPE = None if np is None else np.dtype({
+    "names": ["packet_type", "apid", "ecf_flag", "crc_ok", "length", "header_size", "offset"],
+    "formats": [np.uint8, np.uint8, np.uint8, np.bool_, np.uint16, np.uint8, np.uint64],
+    "offsets": [0, 1, 2, 3, 4, 6, 8],
+    "itemsize": ctypes.sizeof(bus_packet_record_t),
+    })
+
 packet = bus_packet_t()
 HAL_StatusTypeDef = ctypes.c_int8
 
+_p_uint8 = ctypes.POINTER(ctypes.c_uint8)
+_p_uint32 = ctypes.POINTER(ctypes.c_uint32)
+
 
 fun_bus_packet_Decode = lib.bus_packet_Decode
 fun_bus_packet_Decode.argtypes = [ctypes.POINTER(ctypes.c_uint8), ctypes.POINTER(bus_packet_t)]
 
 fun_bus_packet_EncodePacketize = lib.bus_packet_EncodePacketize
-fun_bus_packet_EncodePacketize.argtypes = [ctypes.c_uint8, ctypes.c_uint8, ctypes.c_uint8, 
-                                      ctypes.POINTER(ctypes.c_uint8), ctypes.c_uint8, 
+fun_bus_packet_EncodePacketize.argtypes = [ctypes.c_uint8, ctypes.c_uint8, ctypes.c_uint8,
+                                      ctypes.POINTER(ctypes.c_uint8), ctypes.c_uint32,
                                       ctypes.POINTER(ctypes.c_uint8)]
 
+# Funciones por lotes (no existen en bus_packet.dll antiguas)
+if hasattr(lib, "bus_packet_DecodeBatch"):
+    fun_bus_packet_DecodeBatch = lib.bus_packet_DecodeBatch
+    fun_bus_packet_DecodeBatch.argtypes = [_p_uint8, ctypes.c_uint32, _p_uint32, ctypes.c_uint32, ctypes.POINTER(bus_packet_batch_t)]
+    fun_bus_packet_DecodeBatch.restype = ctypes.c_uint32
+
+    fun_bus_packet_EncodePacketizeBatch = lib.bus_packet_EncodePacketizeBatch
+    fun_bus_packet_EncodePacketizeBatch.argtypes = [_p_uint8, _p_uint8, _p_uint8, _p_uint8, _p_uint32, _p_uint32,
+                                                    ctypes.c_uint32, _p_uint8, _p_uint32]
+    fun_bus_packet_EncodePacketizeBatch.restype = ctypes.c_uint32
+
+    fun_bus_packet_ScanCapture = lib.bus_packet_ScanCapture
+    fun_bus_packet_ScanCapture.argtypes = [_p_uint8, ctypes.c_uint64, ctypes.c_uint64, ctypes.POINTER(bus_packet_record_t),
+                                           ctypes.c_uint32, ctypes.POINTER(ctypes.c_uint64)]
+    fun_bus_packet_ScanCapture.restype = ctypes.c_uint32
+
 
 
 def bus_packet_EncodePacketize(packet_type, apid, ecf_flag, data, data_length):
     buffer_out = (ctypes.c_uint8 * BUS_PACKET_BUS_SIZE)()
-    
-    status = fun_bus_packet_EncodePacketize(packet_type, apid, ecf_flag, 
-                                    (ctypes.c_uint8 * len(data))(*data), 
+
+    status = fun_bus_packet_EncodePacketize(packet_type, apid, ecf_flag,
+                                    (ctypes.c_uint8 * len(data))(*data),
                                     data_length, buffer_out)
-    
-    return status, list(buffer_out[:data_length+4])  
-    
-    
+
+    return status, list(buffer_out[:data_length+4])
+
+
 def bus_packet_Decode(buffer):
     packet = bus_packet_t()
     status = fun_bus_packet_Decode((ctypes.c_uint8 * len(buffer))(*buffer), ctypes.byref(packet))
     return status, packet
 
 
-    
-    
+
+def as_array(buffer, dtype=None):
+    """Vista NumPy sin copia de bytes, bytearray, memoryview, mmap o ndarray.
+
+    Las secuencias que no son buffers (listas, tuplas...) se convierten con
+    copia al dtype pedido.
+    """
+    if isinstance(buffer, np.ndarray):
+        return np.ascontiguousarray(buffer, dtype=dtype or buffer.dtype)
+    try:
+        memoryview(buffer)
+    except TypeError:
+        return np.ascontiguousarray(np.asarray(buffer, dtype=dtype or np.uint8))
+    return np.frombuffer(buffer, dtype=dtype or np.uint8)
+
+
+def _check_offsets(data, offsets, size):
+    """Comprueba que se pueden leer size bytes desde cada offset de data."""
+    if len(offsets) and int(offsets.max()) + size > len(data):
+        raise ValueError(f"Offset {int(offsets.max())} fuera del buffer de {len(data)} bytes")
+
+
+def _ptr(array, ctype):
+    return array.ctypes.data_as(ctypes.POINTER(ctype))
+
+
+def bus_packet_encode_batch(packet_types, apids, ecf_flags, data, data_lengths):
+    """Codifica N bus packets seguidos en un único buffer.
+
+    data contiene los datos de todos los paquetes uno detrás de otro y
+    data_lengths la longitud de cada uno. Devuelve (buffer, offsets), con
+    offsets de N+1 elementos (el último es la longitud total).
+    El GIL se libera durante la llamada a C.
+    """
+    data_lengths = as_array(data_lengths, np.uint32)
+    n = len(data_lengths)
+    packet_types = np.broadcast_to(np.asarray(packet_types, np.uint8), (n,)).copy()
+    apids = np.broadcast_to(np.asarray(apids, np.uint8), (n,)).copy()
+    ecf_flags = np.broadcast_to(np.asarray(ecf_flags, np.uint8), (n,)).copy()
+    data = as_array(data, np.uint8)
+
+    data_offsets = np.zeros(n, np.uint32)
+    np.cumsum(data_lengths[:-1], out=data_offsets[1:])
+    buffer_out = np.zeros(int(data_lengths.sum()) + n * (BUS_PACKET_HEADER_SIZE + BUS_PACKET_ECF_SIZE), np.uint8)
+    out_offsets = np.zeros(n + 1, np.uint32)
+
+    encoded = fun_bus_packet_EncodePacketizeBatch(_ptr(packet_types, ctypes.c_uint8), _ptr(apids, ctypes.c_uint8),
+                                                  _ptr(ecf_flags, ctypes.c_uint8), _ptr(data, ctypes.c_uint8),
+                                                  _ptr(data_offsets, ctypes.c_uint32), _ptr(data_lengths, ctypes.c_uint32),
+                                                  n, _ptr(buffer_out, ctypes.c_uint8), _ptr(out_offsets, ctypes.c_uint32))
+    if encoded != n:
+        raise ValueError(f"Error al codificar el paquete {encoded}")
+
+    return buffer_out, out_offsets
+
+
+def bus_packet_decode_batch(buffer, offsets):
+    """Decodifica las cabeceras de los bus packets de buffer en offsets.
+
+    buffer puede ser bytes, memoryview, mmap o ndarray (no se copia).
+    Lanza ValueError si algún offset no deja leer la cabecera dentro de
+    buffer. Devuelve un diccionario de columnas NumPy: packet_type, apid, ecf_flag,
+    length, ecf, offset y status (0 = HAL_OK). El GIL se libera durante la
+    llamada a C.
+    """
+    data = as_array(buffer, np.uint8)
+    offsets = as_array(offsets, np.uint32)
+    _check_offsets(data, offsets, BUS_PACKET_HEADER_SIZE)
+    n = len(offsets)
+
+    columns = {
+        "packet_type": np.empty(n, np.uint8),
+        "apid": np.empty(n, np.uint8),
+        "ecf_flag": np.empty(n, np.uint8),
+        "length": np.empty(n, np.uint16),
+        "ecf": np.empty(n, np.uint16),
+        "offset": np.empty(n, np.uint32),
+        "status": np.empty(n, np.uint8),
+    }
+    batch = bus_packet_batch_t(n, 0, *(_ptr(columns[name], ctype) for name, ctype in
+                                       (("packet_type", ctypes.c_uint8), ("apid", ctypes.c_uint8),
+                                        ("ecf_flag", ctypes.c_uint8), ("length", ctypes.c_uint16),
+                                        ("ecf", ctypes.c_uint16), ("offset", ctypes.c_uint32),
+                                        ("status", ctypes.c_uint8))))
+
+    fun_bus_packet_DecodeBatch(_ptr(data, ctypes.c_uint8), len(data), _ptr(offsets, ctypes.c_uint32), n, ctypes.byref(batch))
+    return columns
+
+
+def bus_packet_payload(buffer, offset, length):
+    """Vista sin copia de los datos de un bus packet o jumbo bus packet."""
+    data = as_array(buffer, np.uint8)
+    header_size = BUS_PACKET_JUMBO_HEADER_SIZE if data[offset + 1] == BUS_PACKET_JUMBO_MARKER else BUS_PACKET_HEADER_SIZE
+    return data[offset + header_size: offset + length - BUS_PACKET_ECF_SIZE]
+
+
+def bus_packet_load_capture(buffer, chunk_records=1 << 20):
+    """Busca los sync markers de una captura y decodifica todos los bus packets.
+
+    buffer puede ser bytes, memoryview, mmap o ndarray (no se copia). La
+    búsqueda y la decodificación se hacen en C sin el GIL. Devuelve un array
+    estructurado con los campos packet_type, apid, ecf_flag, crc_ok, length,
+    header_size (4 en los jumbo bus packets) y offset (posición del bus packet
+    tras el sync marker).
+    Los datos de cada paquete se obtienen sin copia con bus_packet_payloads().
+    """
+    data = as_array(buffer, np.uint8)
+    chunks = []
+    start = 0
+    next_offset = ctypes.c_uint64(0)
+
+    while start < len(data):
+        records = np.empty(chunk_records, BUS_PACKET_RECORD_DTYPE)
+        count = fun_bus_packet_ScanCapture(_ptr(data, ctypes.c_uint8), len(data), start,
+                                           records.ctypes.data_as(ctypes.POINTER(bus_packet_record_t)),
+                                           chunk_records, ctypes.byref(next_offset))
+        chunks.append(records[:count])
+        if next_offset.value <= start:
+            break
+        start = next_offset.value
+
+    return np.concatenate(chunks) if chunks else np.empty(0, BUS_PACKET_RECORD_DTYPE)
+
+
+def bus_packet_payloads(buffer, records):
+    """Lista de vistas sin copia con los datos de cada bus packet de records."""
+    data = as_array(buffer, np.uint8)
+    starts = records["offset"] + records["header_size"]
+    ends = records["offset"] + records["length"] - BUS_PACKET_ECF_SIZE
+    return [data[a:b] for a, b in zip(starts.tolist(), ends.tolist())]
+
+
+
+
 if __name__ == "__main__":
-    
+
     # Definimos los datos a empaquetar para el Space Packet
     # Las constantes están arriba definidas
-    packet_type = BUS_PACKET_TYPE_TC  
-    apid = 40  
-    ecf_flag = BUS_PACKET_ECF_EXIST  
-    data = [100, 1, 12, 234, 34, 5]  
-    data_length = len(data)    
-    
+    packet_type = BUS_PACKET_TYPE_TC
+    apid = 40
+    ecf_flag = BUS_PACKET_ECF_EXIST
+    data = [100, 1, 12, 234, 34, 5]
+    data_length = len(data)
+
     # Empaquetamos los datos y los codificamos (comprobar SIEMPRE el status)
     status, buffer_out = bus_packet_EncodePacketize(packet_type, apid, ecf_flag, data,data_length)
 
@@ -78,12 +283,12 @@ if __name__ == "__main__":
         print(f"Encoded and Packetized Data: {buffer_out}")
     else:
         print("Error al codificar y paquetizar los datos.")
-    
-    
-    
+
+
+
     # Comprobamos la codificación y paquetización (comprobar SIEMPRE el status)
     status, packet = bus_packet_Decode(buffer_out)
-    
+
     if status == 0:
         print(f"Packet Type: {packet.packet_type}")
         print(f"APID: {packet.apid}")
@@ -92,5 +297,4 @@ if __name__ == "__main__":
         print(f"Data: {list(packet.data[:packet.length])}")
         print(f"ECF: {packet.ecf}")
     else:
-        print("Error al decodificar los datos.")   
-    
\ No newline at end of file
+        print("Error al decodificar los datos.")
@@ -0,0 +1,191 @@
+import ctypes
+
+from bus_packet import lib, np, as_array, _ptr, _check_offsets
+
+TF_PACKET_MAX_SIZE						=	256
+TF_PACKET_ECF_SIZE						=	2
+TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE	=	4
+TF_PACKET_PRIMARY_BASE_HEADER_SIZE		=	7
+TF_PACKET_DATA_HEADER_SIZE				=	1
+TF_PACKET_USLP_MAX_SIZE					=	65535
+TF_PACKET_ECF32_SIZE					=	4
+
+
+class tf_packet_view_t(ctypes.Structure):
+    _fields_ = [
+        ("id", ctypes.c_uint32),
+        ("length", ctypes.c_uint16),
+        ("flags", ctypes.c_uint8),
+        ("tfdf_header", ctypes.c_uint8),
+        ("vc_frame", ctypes.c_void_p),
+        ("data", ctypes.c_void_p),
+        ("data_length", ctypes.c_uint32),
+        ("ocf", ctypes.c_void_p),
+        ]
+
+
+class tf_packet_header_batch_t(ctypes.Structure):
+    _fields_ = [
+        ("capacity", ctypes.c_uint32),
+        ("count", ctypes.c_uint32),
+        ("scid", ctypes.POINTER(ctypes.c_uint16)),
+        ("vcid", ctypes.POINTER(ctypes.c_uint8)),
+        ("mapid", ctypes.POINTER(ctypes.c_uint8)),
+        ("end_flag", ctypes.POINTER(ctypes.c_uint8)),
+        ("length", ctypes.POINTER(ctypes.c_uint16)),
+        ("flags", ctypes.POINTER(ctypes.c_uint8)),
+        ]
+
+
+# Mismo formato que tf_packet_channel_t
+class tf_packet_channel_t(ctypes.Structure):
+    _fields_ = [
+        ("tfvn", ctypes.c_uint8),
+        ("scid", ctypes.c_uint16),
+        ("source_dest_id", ctypes.c_uint8),
+        ("vcid", ctypes.c_uint8),
+        ("mapid", ctypes.c_uint8),
+        ("bypass_flag", ctypes.c_uint8),
+        ("command_flag", ctypes.c_uint8),
+        ("constr_rule", ctypes.c_uint8),
+        ("protocol_id", ctypes.c_uint8),
+        ("max_size", ctypes.c_uint16),
+        ("ecf_size", ctypes.c_uint8),
+        ("vc_count_length", ctypes.c_uint8),
+        ("ocf_flag", ctypes.c_uint8),
+        ("ocf", ctypes.c_uint32),
+        ("vc_count", ctypes.c_uint64),
+        ]
+
+
+# Funciones sin copia y por lotes (no existen en bus_packet.dll antiguas)
+if hasattr(lib, "tf_packet_DecodeView"):
+    fun_tf_packet_DecodeView = lib.tf_packet_DecodeView
+    fun_tf_packet_DecodeView.argtypes = [ctypes.POINTER(ctypes.c_uint8), ctypes.c_uint32, ctypes.POINTER(tf_packet_view_t)]
+    fun_tf_packet_DecodeView.restype = ctypes.c_uint8
+
+if hasattr(lib, "tf_packet_DecodeHeaderBatch"):
+    fun_tf_packet_DecodeHeaderBatch = lib.tf_packet_DecodeHeaderBatch
+    fun_tf_packet_DecodeHeaderBatch.argtypes = [ctypes.POINTER(ctypes.c_uint8), ctypes.POINTER(ctypes.c_uint32),
+                                                ctypes.c_uint32, ctypes.POINTER(tf_packet_header_batch_t)]
+    fun_tf_packet_DecodeHeaderBatch.restype = ctypes.c_uint32
+
+if hasattr(lib, "tf_packet_PacketizeChannel"):
+    fun_tf_packet_ChannelInit = lib.tf_packet_ChannelInit
+    fun_tf_packet_ChannelInit.argtypes = [ctypes.POINTER(tf_packet_channel_t), ctypes.c_uint16, ctypes.c_uint8, ctypes.c_uint32]
+    fun_tf_packet_ChannelInit.restype = ctypes.c_uint8
+
+    fun_tf_packet_ChannelSetEcf = lib.tf_packet_ChannelSetEcf
+    fun_tf_packet_ChannelSetEcf.argtypes = [ctypes.POINTER(tf_packet_channel_t), ctypes.c_uint8]
+    fun_tf_packet_ChannelSetEcf.restype = ctypes.c_uint8
+
+    fun_tf_packet_PacketizeChannel = lib.tf_packet_PacketizeChannel
+    fun_tf_packet_PacketizeChannel.argtypes = [ctypes.POINTER(tf_packet_channel_t), ctypes.POINTER(ctypes.c_uint8), ctypes.c_uint32,
+                                               ctypes.POINTER(ctypes.c_uint8), ctypes.POINTER(ctypes.c_uint16)]
+    fun_tf_packet_PacketizeChannel.restype = ctypes.c_uint8
+
+
+
+def tf_packet_decode(buffer):
+    """Decodifica un TF packet sin copiar los datos.
+
+    Devuelve (status, campos), donde campos es un diccionario con la TFPH y
+    'data' es una vista NumPy de los datos dentro de buffer.
+    """
+    data = as_array(buffer, np.uint8)
+    view = tf_packet_view_t()
+    status = fun_tf_packet_DecodeView(_ptr(data, ctypes.c_uint8), len(data), ctypes.byref(view))
+    if status != 0:
+        return status, None
+
+    start = view.data - data.ctypes.data
+    ocf = None
+    if view.ocf:
+        ocf_start = view.ocf - data.ctypes.data
+        ocf = int.from_bytes(bytes(data[ocf_start: ocf_start + 4]), "big")
+    fields = {
+        "tfvn": view.id >> 28,
+        "scid": (view.id >> 12) & 0xFFFF,
+        "source_dest_id": (view.id >> 11) & 0x01,
+        "vcid": (view.id >> 5) & 0b00111111,
+        "mapid": (view.id >> 1) & 0b00001111,
+        "end_flag": view.id & 0x01,
+        "length": view.length,
+        "bypass_flag": view.flags >> 7,
+        "command_flag": (view.flags >> 6) & 0x01,
+        "ocf_flag": (view.flags >> 3) & 0x01,
+        "vc_length": view.flags & 0b00000111,
+        "constr_rule": view.tfdf_header >> 5,
+        "protocol_id": view.tfdf_header & 0b00011111,
+        "data": data[start: start + view.data_length],
+        "ocf": ocf,
+    }
+    return status, fields
+
+
+def tf_packet_decode_header_batch(buffer, offsets):
+    """Decodifica la TFPH de los TF packets de buffer en offsets (sin ECF).
+
+    Devuelve un diccionario de columnas NumPy: scid, vcid, mapid, end_flag,
+    length y flags. Lanza ValueError si no pueden leerse 8 bytes desde algún
+    offset. El GIL se libera durante la llamada a C.
+    """
+    data = as_array(buffer, np.uint8)
+    offsets = as_array(offsets, np.uint32)
+    _check_offsets(data, offsets, 8)
+    n = len(offsets)
+
+    columns = {
+        "scid": np.empty(n, np.uint16),
+        "vcid": np.empty(n, np.uint8),
+        "mapid": np.empty(n, np.uint8),
+        "end_flag": np.empty(n, np.uint8),
+        "length": np.empty(n, np.uint16),
+        "flags": np.empty(n, np.uint8),
+    }
+    batch = tf_packet_header_batch_t(n, 0,
+                                     _ptr(columns["scid"], ctypes.c_uint16), _ptr(columns["vcid"], ctypes.c_uint8),
+                                     _ptr(columns["mapid"], ctypes.c_uint8), _ptr(columns["end_flag"], ctypes.c_uint8),
+                                     _ptr(columns["length"], ctypes.c_uint16), _ptr(columns["flags"], ctypes.c_uint8))
+
+    fun_tf_packet_DecodeHeaderBatch(_ptr(data, ctypes.c_uint8), _ptr(offsets, ctypes.c_uint32), n, ctypes.byref(batch))
+    return columns
+
+
+def tf_packet_channel(scid, vcid, max_size=TF_PACKET_MAX_SIZE, ecf_size=TF_PACKET_ECF_SIZE):
+    """Configuración de un canal virtual para tf_packet_encode_batch()."""
+    channel = tf_packet_channel_t()
+    if fun_tf_packet_ChannelInit(ctypes.byref(channel), scid, vcid, max_size) != 0 or \
+       fun_tf_packet_ChannelSetEcf(ctypes.byref(channel), ecf_size) != 0:
+        raise ValueError("Configuración del canal no válida")
+    return channel
+
+
+def tf_packet_encode_batch(channel, data, data_lengths):
+    """Codifica N TF packets de un canal seguidos en un único buffer.
+
+    data contiene los datos de todos los paquetes uno detrás de otro y
+    data_lengths la longitud de cada uno. El VC frame count del canal se
+    incrementa con cada paquete. Devuelve (buffer, offsets), con offsets de
+    N+1 elementos (el último es la longitud total).
+    """
+    data_lengths = as_array(data_lengths, np.uint32)
+    data = as_array(data, np.uint8)
+    n = len(data_lengths)
+    if int(data_lengths.sum()) > len(data):
+        raise ValueError(f"data tiene {len(data)} bytes y data_lengths suma {int(data_lengths.sum())}")
+
+    buffer_out = np.zeros(n * channel.max_size, np.uint8)
+    out_offsets = np.zeros(n + 1, np.uint32)
+    length = ctypes.c_uint16(0)
+    start = 0
+
+    for i, data_length in enumerate(data_lengths.tolist()):
+        status = fun_tf_packet_PacketizeChannel(ctypes.byref(channel), _ptr(data[start:], ctypes.c_uint8), data_length,
+                                                _ptr(buffer_out[out_offsets[i]:], ctypes.c_uint8), ctypes.byref(length))
+        if status != 0:
+            raise ValueError(f"Error al codificar el paquete {i}")
+        start += data_length
+        out_offsets[i + 1] = out_offsets[i] + length.value
+
+    return buffer_out[:out_offsets[n]], out_offsets
@@ -45,6 +45,46 @@
 const uint8_t BUS_PACKET_FRAME_SYNC[4] = {0x1A, 0xCF, 0xFC, 0x1D};
 
 
+/**
+ * Check that a data buffer can contain a bus packet before decoding it. The
+ * length is taken from the header, so it can not be longer than
+ * BUS_PACKET_BUS_SIZE; it does not copy anything nor check the ECF. Jumbo
+ * bus packets are rejected (their 7-bit length is 0).
+ * @param buffer Data buffer with a bus packet
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_Validate(const uint8_t *buffer)
+{
+	return ((buffer[1] & 0b01111111) < BUS_PACKET_HEADER_SIZE + BUS_PACKET_ECF_SIZE) ? HAL_ERROR : HAL_OK;
+}
+
+
+/**
+ * Check that a data buffer can contain a bus packet or a jumbo bus packet
+ * before decoding it. The first BUS_PACKET_JUMBO_HEADER_SIZE bytes must be
+ * readable.
+ * @param buffer Data buffer with a bus packet
+ * @param max_length Bytes that can be read from buffer
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_ValidateJumbo(const uint8_t *buffer, uint32_t max_length)
+{
+	uint32_t length = bus_packet_GetLength(buffer);
+	uint32_t minimum = bus_packet_GetHeaderSize(buffer) + BUS_PACKET_ECF_SIZE;
+
+	if(length < minimum || length > max_length || length > BUS_PACKET_JUMBO_MAX_SIZE)	return HAL_ERROR;
+
+	return HAL_OK;
+}
+
+
+static inline uint8_t bus_packet_CheckECF(const uint8_t *buffer, uint32_t length, uint16_t *ecf)
+{
+	*ecf = buffer[length-BUS_PACKET_ECF_SIZE]<<8 | buffer[length-BUS_PACKET_ECF_SIZE+1];
+	return crc16_ccsds_Calculate(0, buffer, length-BUS_PACKET_ECF_SIZE) == *ecf;
+}
+
+
 /**
  * Decode data buffer that contain a bus packet
  * @param buffer Data buffer with a bus packet to decode
@@ -55,24 +95,14 @@ HAL_StatusTypeDef bus_packet_Decode(uint8_t *buffer, bus_packet_t *packet)
 {
 	uint8_t length = buffer[1] & 0b01111111;
 	uint8_t ecf_flag = (buffer[1] & 0b10000000)>>7;
+	uint16_t ecf;
 
-	if(length-BUS_PACKET_ECF_SIZE-BUS_PACKET_HEADER_SIZE < 0)	return HAL_ERROR;
+	if(bus_packet_Validate(buffer) != HAL_OK)	return HAL_ERROR;
 
 	if (ecf_flag)	// If there is CRC, check it.
 	{
-		if(length-BUS_PACKET_ECF_SIZE < 0)		return HAL_ERROR;
-		uint8_t crc_data[length-BUS_PACKET_ECF_SIZE];
-		memcpy(crc_data, buffer, length-BUS_PACKET_ECF_SIZE);
-
-#ifdef STM32_MCU
-		uint16_t calculated_crc = HAL_CRC_Calculate(&hcrc, (uint32_t *)crc_data, length-BUS_PACKET_ECF_SIZE) & 0xFFFF;
-#else
-		uint16_t calculated_crc = bus_packet_CRC16CCSDSCalculate(0, crc_data, length-BUS_PACKET_ECF_SIZE) & 0xFFFF;
-#endif
-		uint16_t ecf = buffer[length-BUS_PACKET_ECF_SIZE]<<8 | buffer[length-BUS_PACKET_ECF_SIZE+ 1];
-
-		if(calculated_crc == ecf)	packet->ecf = ecf;
-		else 						return HAL_ERROR;
+		if(!bus_packet_CheckECF(buffer, length, &ecf))	return HAL_ERROR;
+		packet->ecf = ecf;
 	}
 
 	// Save data
@@ -87,6 +117,213 @@ HAL_StatusTypeDef bus_packet_Decode(uint8_t *buffer, bus_packet_t *packet)
 }
 
 
+/**
+ * Decode data buffer that contain a bus packet and, if its ECF is wrong,
+ * correct a single bit error in place. Errors of an even number of bits are
+ * never miscorrected, but three or more bits may be (or an error in the
+ * length field), so use it only where a lost bus packet costs more.
+ * @param buffer Data buffer with a bus packet to decode
+ * @param packet Pointer to bus packet structure to save data
+ * @param corrected Pointer where 1 is saved if a bit was corrected, or NULL
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_DecodeCorrect(uint8_t *buffer, bus_packet_t *packet, uint8_t *corrected)
+{
+	uint8_t length = buffer[1] & 0b01111111;
+	uint16_t ecf;
+
+	if(corrected != NULL)	*corrected = 0;
+	if(bus_packet_Decode(buffer, packet) == HAL_OK)		return HAL_OK;
+
+	if(!(buffer[1] & 0b10000000) || bus_packet_Validate(buffer) != HAL_OK)	return HAL_ERROR;
+
+	uint8_t original[BUS_PACKET_BUS_SIZE];
+	memcpy(original, buffer, length);
+
+	bus_packet_CheckECF(buffer, length, &ecf);
+	uint16_t syndrome = crc16_ccsds_Calculate(0, buffer, length-BUS_PACKET_ECF_SIZE) ^ ecf;
+
+	// The corrected bit may be in the header, so the bus packet is decoded again
+	if(crc16_ccsds_CorrectBit(buffer, length, syndrome) != HAL_OK || bus_packet_Decode(buffer, packet) != HAL_OK)
+	{
+		memcpy(buffer, original, length);
+		return HAL_ERROR;
+	}
+
+	if(corrected != NULL)	*corrected = 1;
+	return HAL_OK;
+}
+
+
+/**
+ * Decode data buffer that contain a bus packet without copying the data
+ * @param buffer Data buffer with a bus packet to decode
+ * @param buffer_length Bytes that can be read from buffer
+ * @param view Pointer to compact bus packet to save the header and a
+ * pointer to the data into buffer
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_DecodeView(const uint8_t *buffer, uint32_t buffer_length, bus_packet_view_t *view)
+{
+	uint16_t ecf = 0;
+
+	if(buffer_length < BUS_PACKET_HEADER_SIZE)	return HAL_ERROR;
+	if(bus_packet_Validate(buffer) != HAL_OK || bus_packet_GetLength(buffer) > buffer_length)	return HAL_ERROR;
+	if((buffer[1] & 0b10000000) && !bus_packet_CheckECF(buffer, bus_packet_GetLength(buffer), &ecf))	return HAL_ERROR;
+
+	view->header = ((uint32_t)ecf<<16) | (buffer[0]<<8) | buffer[1];
+	view->length = bus_packet_GetLength(buffer);
+	view->data = &buffer[BUS_PACKET_HEADER_SIZE];
+
+	return HAL_OK;
+}
+
+
+/**
+ * Decode data buffer that contain a bus packet or a jumbo bus packet without
+ * copying the data
+ * @param buffer Data buffer with a bus packet to decode
+ * @param buffer_length Bytes that can be read from buffer
+ * @param view Pointer to compact bus packet to save the header and a
+ * pointer to the data into buffer
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_DecodeViewJumbo(const uint8_t *buffer, uint32_t buffer_length, bus_packet_view_t *view)
+{
+	uint16_t ecf = 0;
+
+	if(buffer_length < BUS_PACKET_JUMBO_HEADER_SIZE)	return HAL_ERROR;
+	if(bus_packet_ValidateJumbo(buffer, buffer_length) != HAL_OK)	return HAL_ERROR;
+
+	uint32_t length = bus_packet_GetLength(buffer);
+	if((buffer[1] & 0b10000000) && !bus_packet_CheckECF(buffer, length, &ecf))	return HAL_ERROR;
+
+	view->header = ((uint32_t)ecf<<16) | (buffer[0]<<8) | buffer[1];
+	view->length = length;
+	view->data = &buffer[bus_packet_GetHeaderSize(buffer)];
+
+	return HAL_OK;
+}
+
+
+/**
+ * Decode the headers of many bus packets into a struct of arrays
+ * @param buffer Data buffer with the bus packets
+ * @param buffer_length Bytes that can be read from buffer
+ * @param offsets Offset of every bus packet into buffer
+ * @param n Number of bus packets
+ * @param batch Pointer to the struct of arrays, filled from position 0
+ * @return Number of bus packets (or jumbo bus packets) decoded without errors
+ */
+uint32_t bus_packet_DecodeBatch(const uint8_t *buffer, uint32_t buffer_length, const uint32_t *offsets, uint32_t n, bus_packet_batch_t *batch)
+{
+	uint32_t decoded = 0;
+	bus_packet_view_t view;
+
+	if(n > batch->capacity)		n = batch->capacity;
+
+	for(uint32_t i=0; i<n; i++)
+	{
+		HAL_StatusTypeDef status = HAL_ERROR;
+
+		view.header = 0;
+		view.length = 0;
+		if(offsets[i] < buffer_length)
+		{
+			const uint8_t *packet = &buffer[offsets[i]];
+			uint32_t available = buffer_length - offsets[i];
+
+			status = bus_packet_DecodeViewJumbo(packet, available, &view);
+			if(status != HAL_OK && available >= BUS_PACKET_HEADER_SIZE)
+			{
+				view.header = (packet[0]<<8) | packet[1];
+				view.length = (available >= BUS_PACKET_JUMBO_HEADER_SIZE) ? bus_packet_GetLength(packet) : packet[1] & 0b01111111;
+			}
+		}
+
+		batch->packet_type[i] = bus_packet_ViewType(&view);
+		batch->apid[i] = bus_packet_ViewApid(&view);
+		batch->ecf_flag[i] = bus_packet_ViewEcfFlag(&view);
+		batch->length[i] = bus_packet_ViewLength(&view);
+		batch->ecf[i] = bus_packet_ViewEcf(&view);
+		batch->offset[i] = offsets[i];
+		batch->status[i] = status;
+
+		decoded += (status == HAL_OK);
+	}
+	batch->count = n;
+
+	return decoded;
+}
+
+
+/**
+ * Search the sync markers of a raw capture and decode every bus packet found
+ * @param buffer Raw capture (sync marker + bus packet, one after another)
+ * @param buffer_length Capture length
+ * @param start Offset where the search starts
+ * @param records Array where the bus packets found are saved
+ * @param max_records Size of records
+ * @param next Offset where the next search must start if records is full,
+ * buffer_length if the whole capture was scanned. It can be NULL.
+ * @return Number of records saved (bus packets and jumbo bus packets)
+ */
+uint32_t bus_packet_ScanCapture(const uint8_t *buffer, uint64_t buffer_length, uint64_t start, bus_packet_record_t *records, uint32_t max_records, uint64_t *next)
+{
+	uint64_t pos = start;
+	uint32_t count = 0;
+
+	while(count < max_records && pos + BUS_PACKET_FRAME_SYNC_SIZE + BUS_PACKET_HEADER_SIZE <= buffer_length)
+	{
+		const uint8_t *sync = memchr(&buffer[pos], BUS_PACKET_FRAME_SYNC[0], buffer_length - pos - BUS_PACKET_HEADER_SIZE - BUS_PACKET_FRAME_SYNC_SIZE + 1);
+		if(sync == NULL)
+		{
+			pos = buffer_length;
+			break;
+		}
+
+		pos = sync - buffer;
+		if(memcmp(sync, BUS_PACKET_FRAME_SYNC, BUS_PACKET_FRAME_SYNC_SIZE) != 0)
+		{
+			pos++;
+			continue;
+		}
+
+		const uint8_t *packet = sync + BUS_PACKET_FRAME_SYNC_SIZE;
+		uint64_t available = buffer_length - pos - BUS_PACKET_FRAME_SYNC_SIZE;
+		uint8_t ecf_flag = (packet[1] & 0b10000000)>>7;
+		uint16_t ecf;
+
+		// The 16-bit length of a jumbo bus packet must be readable
+		if((bus_packet_IsJumbo(packet) && available < BUS_PACKET_JUMBO_HEADER_SIZE) ||
+		   bus_packet_ValidateJumbo(packet, (available < BUS_PACKET_JUMBO_MAX_SIZE) ? available : BUS_PACKET_JUMBO_MAX_SIZE) != HAL_OK)
+		{
+			pos++;
+			continue;
+		}
+
+		uint16_t length = bus_packet_GetLength(packet);
+		bus_packet_record_t *record = &records[count++];
+		record->packet_type = packet[0]>>7;
+		record->apid = packet[0] & 0b01111111;
+		record->ecf_flag = ecf_flag;
+		record->crc_ok = !ecf_flag || bus_packet_CheckECF(packet, length, &ecf);
+		record->length = length;
+		record->header_size = bus_packet_GetHeaderSize(packet);
+		record->reserved = 0;
+		record->offset = pos + BUS_PACKET_FRAME_SYNC_SIZE;
+
+		// A bad CRC may be a false sync marker: keep searching inside it
+		pos += record->crc_ok ? BUS_PACKET_FRAME_SYNC_SIZE + length : 1;
+	}
+
+	if(next != NULL)
+		*next = (pos + BUS_PACKET_FRAME_SYNC_SIZE + BUS_PACKET_HEADER_SIZE > buffer_length) ? buffer_length : pos;
+
+	return count;
+}
+
+
 /**
  * Encode data into a bus packet structure
  * @param type
@@ -119,17 +356,13 @@ HAL_StatusTypeDef bus_packet_Encode(uint8_t type, uint8_t apid, uint8_t ecf_flag
 	{
 		packet->length += BUS_PACKET_ECF_SIZE;
 
-		uint8_t crc_data[packet->length-BUS_PACKET_ECF_SIZE];
+		uint8_t crc_data[BUS_PACKET_BUS_SIZE];
 		crc_data[0] = (packet->packet_type<<7) | (packet->apid & 0b01111111);
 		crc_data[1] = (packet->ecf_flag<<7) | (packet->length & 0b01111111);
 
 		memcpy(&crc_data[2], packet->data, data_length);
 
-#ifdef STM32_MCU
-		packet->ecf = HAL_CRC_Calculate(&hcrc, (uint32_t *)crc_data, packet->length-BUS_PACKET_ECF_SIZE) & 0xFFFF;
-#else
-		packet->ecf = bus_packet_CRC16CCSDSCalculate(0, crc_data, packet->length-BUS_PACKET_ECF_SIZE) & 0xFFFF;
-#endif
+		packet->ecf = crc16_ccsds_Calculate(0, crc_data, packet->length-BUS_PACKET_ECF_SIZE);
 	}
 
 	return HAL_OK;
@@ -189,11 +422,7 @@ HAL_StatusTypeDef bus_packet_EncodePacketize(uint8_t type, uint8_t apid, uint8_t
 
 	if (ecf_flag)	// There is CRC?
 	{
-#ifdef STM32_MCU
-		uint16_t ecf = HAL_CRC_Calculate(&hcrc, (uint32_t *)buffer_out, length-BUS_PACKET_ECF_SIZE);
-#else
-		uint16_t ecf = bus_packet_CRC16CCSDSCalculate(0, buffer_out, length-BUS_PACKET_ECF_SIZE);
-#endif
+		uint16_t ecf = crc16_ccsds_Calculate(0, buffer_out, length-BUS_PACKET_ECF_SIZE);
 		buffer_out[length-BUS_PACKET_ECF_SIZE] = ecf>>8;
 		buffer_out[length-BUS_PACKET_ECF_SIZE+1] = ecf & 0xFF;
 	}
@@ -202,6 +431,73 @@ HAL_StatusTypeDef bus_packet_EncodePacketize(uint8_t type, uint8_t apid, uint8_t
 }
 
 
+/**
+ * Encode and packetize data into a jumbo bus packet for to be transmitted.
+ * The ECF is always encoded.
+ * @param type
+ * 		@arg BUS_PACKET_TYPE_TM if a TM data is contained
+ * 		@arg BUS_PACKET_TYPE_TC if a TC data is contained
+ * @param apid APID number for contained data
+ * @param data Pointer to data that will be encoded
+ * @param data_length Data length, up to BUS_PACKET_JUMBO_DATA_SIZE
+ * @param buffer_out Pointer to a data buffer for to be transmitted, with
+ * data_length + BUS_PACKET_JUMBO_HEADER_SIZE + BUS_PACKET_ECF_SIZE bytes
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_EncodePacketizeJumbo(uint8_t type, uint8_t apid, const uint8_t *data, uint32_t data_length, uint8_t *buffer_out)
+{
+	uint32_t length = data_length + BUS_PACKET_JUMBO_HEADER_SIZE + BUS_PACKET_ECF_SIZE;
+
+	if(length > BUS_PACKET_JUMBO_MAX_SIZE)	return HAL_ERROR;
+
+	memcpy(&buffer_out[BUS_PACKET_JUMBO_HEADER_SIZE], data, data_length);
+
+	buffer_out[0] = (type<<7) | (apid & 0b01111111);
+	buffer_out[1] = BUS_PACKET_JUMBO_MARKER;
+	buffer_out[2] = length>>8;
+	buffer_out[3] = length & 0xFF;
+
+	uint16_t ecf = crc16_ccsds_Calculate(0, buffer_out, length-BUS_PACKET_ECF_SIZE);
+	buffer_out[length-BUS_PACKET_ECF_SIZE] = ecf>>8;
+	buffer_out[length-BUS_PACKET_ECF_SIZE+1] = ecf & 0xFF;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Encode and packetize many bus packets one after another into a buffer
+ * @param type Packet type of every bus packet
+ * @param apid APID of every bus packet
+ * @param ecf_flag ECF flag of every bus packet
+ * @param data Data buffer with the data of all the bus packets
+ * @param data_offsets Offset of the data of every bus packet into data
+ * @param data_lengths Data length of every bus packet
+ * @param n Number of bus packets
+ * @param buffer_out Data buffer where bus packets are written back-to-back.
+ * Its size must be at least the sum of data_lengths + 4 bytes per packet.
+ * @param out_offsets Offset of every bus packet into buffer_out, n+1
+ * elements (the last one is the total length)
+ * @return Number of bus packets encoded; it stops at the first error
+ */
+uint32_t bus_packet_EncodePacketizeBatch(const uint8_t *type, const uint8_t *apid, const uint8_t *ecf_flag, const uint8_t *data, const uint32_t *data_offsets, const uint32_t *data_lengths, uint32_t n, uint8_t *buffer_out, uint32_t *out_offsets)
+{
+	uint32_t offset = 0;
+	uint32_t i;
+
+	for(i=0; i<n; i++)
+	{
+		out_offsets[i] = offset;
+		if(bus_packet_EncodePacketize(type[i], apid[i], ecf_flag[i], (uint8_t *)&data[data_offsets[i]], data_lengths[i], &buffer_out[offset]) != HAL_OK)
+			break;
+		offset += data_lengths[i] + BUS_PACKET_HEADER_SIZE + BUS_PACKET_ECF_SIZE;
+	}
+	out_offsets[i] = offset;
+
+	return i;
+}
+
+
 /**
  * Detect next flag sync based on the input flag and input data
  * @param flag Last flag of your Sync frame
@@ -217,7 +513,7 @@ bus_sync_flag_t bus_packet_SyncFrameDetect(bus_sync_flag_t flag, uint8_t receive
     _first_sync_byte:
     if (received_data != BUS_PACKET_FRAME_SYNC[0])
       flag = BUS_PACKET_SYNC_FIND;
-    else flag = (bus_sync_flag_t)(flag << 1);
+    else flag = BUS_PACKET_SYNC_2;
     break;
 
   case BUS_PACKET_SYNC_2:
@@ -248,7 +544,8 @@ bus_sync_flag_t bus_packet_SyncFrameDetect(bus_sync_flag_t flag, uint8_t receive
 
 
   /*
-  		EXAMPLE FOR SYNC DATA
+  		EXAMPLE FOR SYNC DATA (one interrupt per byte; for higher bus rates use
+  		the circular DMA receiver of bus_packet_rx.h)
 
   void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
   {
@@ -313,46 +610,19 @@ bus_sync_flag_t bus_packet_SyncFrameDetect(bus_sync_flag_t flag, uint8_t receive
  */
 HAL_StatusTypeDef bus_packet_CRC16CCSDSConfig()
 {
-	if(HAL_CRC_DeInit(&hcrc) != HAL_OK)
-			return HAL_ERROR;
-	hcrc.Instance = CRC;
-	hcrc.Init.DefaultPolynomialUse = DEFAULT_POLYNOMIAL_ENABLE;
-	hcrc.Init.DefaultInitValueUse = DEFAULT_INIT_VALUE_DISABLE;
-	hcrc.Init.InitValue = 0;
-	hcrc.Init.InputDataInversionMode = CRC_INPUTDATA_INVERSION_NONE;
-	hcrc.Init.OutputDataInversionMode = CRC_OUTPUTDATA_INVERSION_DISABLE;
-	hcrc.InputDataFormat = CRC_INPUTDATA_FORMAT_BYTES;
-	if (HAL_CRC_Init(&hcrc) != HAL_OK)
-		return HAL_ERROR;
-	if(HAL_CRCEx_Polynomial_Set(&hcrc, 0x1021, CRC_POLYLENGTH_16B) != HAL_OK)
-		return HAL_ERROR;
-	else return HAL_OK;
+	return crc16_ccsds_STM32Config();
 }
+#endif
 
 
-#else
+/**
+ * Compute CRC16 CCSDS with the selected CRC backend
+ * @param seed Initial value of the CRC
+ * @param buf Pointer to data
+ * @param len Data length
+ * @return CRC16
+ */
 uint16_t bus_packet_CRC16CCSDSCalculate(int16_t seed, uint8_t *buf, uint32_t len)
 {
-    unsigned short crc;
-    unsigned short ch, xor_flag;
-    int i, count;
-    crc = seed;
-    count = 0;
-    while (len--) {
-        ch = buf[count++];
-        ch<<=8;
-        for(i=0; i<8; i++)
-        {
-            if ((crc ^ ch) & 0x8000)    xor_flag = 1;
-            else                        xor_flag = 0;
-
-            crc = crc << 1;
-            if (xor_flag)               crc = crc ^ 0x1021;
-
-            ch = ch << 1;
-        }
-    }
-    return (unsigned short)crc;
+	return crc16_ccsds_Calculate((uint16_t)seed, buf, len);
 }
-
-#endif
@@ -14,6 +14,11 @@
   *		communicate different systems connected to the internal bus of
   *		FyCUS 2023 prototype.
   *
+  *		Jumbo bus packets carry up to BUS_PACKET_JUMBO_MAX_SIZE bytes with a
+  *		16-bit length after the header. Their 7-bit length is 0, so the
+  *		legacy decoders reject them; use bus_packet_EncodePacketizeJumbo()
+  *		and bus_packet_DecodeViewJumbo().
+  *
   *	 Example:
   *	 	bus_packet_t packet = {0};
   *	 	uint8_t data[BUS_PACKET_DATA_SIZE] = {100,1,12,234,34,3};
@@ -46,7 +51,7 @@
 extern "C" {
 #endif
 
-#define	STM32_MCU	// Comment this define if crc16 is not computed in STM32 MCU
+// Define STM32_MCU in the build (-DSTM32_MCU) if crc16 is computed in STM32 MCU
 
 
 
@@ -54,15 +59,12 @@ extern "C" {
 #include "main.h"
 #endif
 
+#include "crc16_ccsds.h"
+
 #include <stdint.h>
 #include <string.h>
 
 
-#ifdef STM32_MCU
-extern CRC_HandleTypeDef hcrc;  // In STM32, define your own CRC handle
-#endif
-
-
 
 #ifndef STM32_MCU
 #define HAL_OK      0x00
@@ -78,6 +80,18 @@ extern CRC_HandleTypeDef hcrc;  // In STM32, define your own CRC handle
 #define BUS_PACKET_DATA_SIZE		(BUS_PACKET_BUS_SIZE-BUS_PACKET_ECF_SIZE-BUS_PACKET_HEADER_SIZE)
 #define BUS_PACKET_FRAME_SYNC_SIZE	4
 
+// Jumbo bus packet: ECF flag set and length 0 in the header, followed by the
+// 16-bit length of the whole bus packet. The ECF is always present.
+#define BUS_PACKET_JUMBO_HEADER_SIZE	4
+#ifndef BUS_PACKET_JUMBO_MAX_SIZE
+#define BUS_PACKET_JUMBO_MAX_SIZE		4096
+#endif
+#if BUS_PACKET_JUMBO_MAX_SIZE > 0xFFFF
+#error "BUS_PACKET_JUMBO_MAX_SIZE must fit in the 16-bit length"
+#endif
+#define BUS_PACKET_JUMBO_DATA_SIZE		(BUS_PACKET_JUMBO_MAX_SIZE-BUS_PACKET_ECF_SIZE-BUS_PACKET_JUMBO_HEADER_SIZE)
+#define BUS_PACKET_JUMBO_MARKER			0b10000000	// Second header byte
+
 #define BUS_PACKET_TYPE_TM			0
 #define BUS_PACKET_TYPE_TC			1
 
@@ -96,6 +110,55 @@ typedef struct
 }bus_packet_t;
 
 
+/*
+ * Compact decoded bus packet. The hot header fields are packed in one word
+ * with the same bit order as the wire header, and the data is not copied:
+ *	header bits	31..16: ecf
+ *				15: packet_type, 14..8: apid, 7: ecf_flag, 6..0: length
+ *	(6..0 are 0 in jumbo bus packets; length has the whole length)
+ */
+typedef struct
+{
+	uint32_t header;
+	uint16_t length;			// Bus packet length
+	const uint8_t *data;		// Points into the decoded buffer
+}bus_packet_view_t;
+
+
+/*
+ * Struct of arrays with the headers of many decoded bus packets. Arrays are
+ * owned by the caller and must have capacity elements.
+ */
+typedef struct
+{
+	uint32_t capacity;
+	uint32_t count;
+	uint8_t *packet_type;
+	uint8_t *apid;
+	uint8_t *ecf_flag;
+	uint16_t *length;			// Bus packet length, up to BUS_PACKET_JUMBO_MAX_SIZE
+	uint16_t *ecf;
+	uint32_t *offset;			// Offset of the bus packet in the decoded buffer
+	uint8_t *status;			// HAL status of every bus packet
+}bus_packet_batch_t;
+
+
+/*
+ * Bus packet found in a capture by bus_packet_ScanCapture()
+ */
+typedef struct
+{
+	uint8_t packet_type;
+	uint8_t apid;
+	uint8_t ecf_flag;
+	uint8_t crc_ok;
+	uint16_t length;			// Bus packet length, up to BUS_PACKET_JUMBO_MAX_SIZE
+	uint8_t header_size;		// BUS_PACKET_HEADER_SIZE or BUS_PACKET_JUMBO_HEADER_SIZE
+	uint8_t reserved;
+	uint64_t offset;			// Offset of the bus packet (after the sync marker)
+}bus_packet_record_t;
+
+
 typedef enum
 {
 	BUS_PACKET_SYNC_FIND 		= 0b00000001,
@@ -113,20 +176,39 @@ extern const uint8_t BUS_PACKET_FRAME_SYNC[4];
 
 
 
-#ifndef STM32_MCU
 uint16_t bus_packet_CRC16CCSDSCalculate(int16_t seed, uint8_t *buf, uint32_t len);
-#else
+#ifdef STM32_MCU
 HAL_StatusTypeDef bus_packet_CRC16CCSDSConfig();
 #endif
 
+HAL_StatusTypeDef bus_packet_Validate(const uint8_t *buffer);
+HAL_StatusTypeDef bus_packet_ValidateJumbo(const uint8_t *buffer, uint32_t max_length);
 HAL_StatusTypeDef bus_packet_Decode(uint8_t *buffer, bus_packet_t *packet);
+HAL_StatusTypeDef bus_packet_DecodeCorrect(uint8_t *buffer, bus_packet_t *packet, uint8_t *corrected);
 HAL_StatusTypeDef bus_packet_Encode(uint8_t type, uint8_t apid, uint8_t ecf_flag, uint8_t *data, uint32_t length, bus_packet_t *packet);
 void bus_packet_Packetize(uint8_t *buffer, bus_packet_t *packet);
 HAL_StatusTypeDef bus_packet_EncodePacketize(uint8_t type, uint8_t apid, uint8_t ecf_flag, uint8_t *data, uint32_t data_length, uint8_t *buffer_out);
+HAL_StatusTypeDef bus_packet_EncodePacketizeJumbo(uint8_t type, uint8_t apid, const uint8_t *data, uint32_t data_length, uint8_t *buffer_out);
+uint32_t bus_packet_EncodePacketizeBatch(const uint8_t *type, const uint8_t *apid, const uint8_t *ecf_flag, const uint8_t *data, const uint32_t *data_offsets, const uint32_t *data_lengths, uint32_t n, uint8_t *buffer_out, uint32_t *out_offsets);
 
 bus_sync_flag_t bus_packet_SyncFrameDetect(bus_sync_flag_t flag, uint8_t received_data);
 
-static inline uint8_t bus_packet_GetLength(uint8_t *buffer) {return buffer[1]&0b01111111;}
+HAL_StatusTypeDef bus_packet_DecodeView(const uint8_t *buffer, uint32_t buffer_length, bus_packet_view_t *view);
+HAL_StatusTypeDef bus_packet_DecodeViewJumbo(const uint8_t *buffer, uint32_t buffer_length, bus_packet_view_t *view);
+uint32_t bus_packet_ScanCapture(const uint8_t *buffer, uint64_t buffer_length, uint64_t start, bus_packet_record_t *records, uint32_t max_records, uint64_t *next);
+uint32_t bus_packet_DecodeBatch(const uint8_t *buffer, uint32_t buffer_length, const uint32_t *offsets, uint32_t n, bus_packet_batch_t *batch);
+
+static inline uint8_t bus_packet_IsJumbo(const uint8_t *buffer) {return buffer[1] == BUS_PACKET_JUMBO_MARKER;}
+static inline uint8_t bus_packet_GetHeaderSize(const uint8_t *buffer) {return bus_packet_IsJumbo(buffer) ? BUS_PACKET_JUMBO_HEADER_SIZE : BUS_PACKET_HEADER_SIZE;}
+static inline uint16_t bus_packet_GetLength(const uint8_t *buffer) {return bus_packet_IsJumbo(buffer) ? (buffer[2]<<8) | buffer[3] : buffer[1]&0b01111111;}
+
+static inline uint8_t bus_packet_ViewType(const bus_packet_view_t *view) {return (view->header>>15) & 0x01;}
+static inline uint8_t bus_packet_ViewApid(const bus_packet_view_t *view) {return (view->header>>8) & 0b01111111;}
+static inline uint8_t bus_packet_ViewEcfFlag(const bus_packet_view_t *view) {return (view->header>>7) & 0x01;}
+static inline uint16_t bus_packet_ViewLength(const bus_packet_view_t *view) {return view->length;}
+static inline uint16_t bus_packet_ViewEcf(const bus_packet_view_t *view) {return view->header>>16;}
+static inline uint8_t bus_packet_ViewIsJumbo(const bus_packet_view_t *view) {return (view->header & 0xFF) == BUS_PACKET_JUMBO_MARKER;}
+static inline uint32_t bus_packet_ViewDataLength(const bus_packet_view_t *view) {return bus_packet_ViewLength(view)-BUS_PACKET_ECF_SIZE-(bus_packet_ViewIsJumbo(view) ? BUS_PACKET_JUMBO_HEADER_SIZE : BUS_PACKET_HEADER_SIZE);}
 
 #ifdef __cplusplus
 } // extern "C"
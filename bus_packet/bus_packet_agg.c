@@ -0,0 +1,230 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_agg.c
+  * @brief          : Aggregation packet of small records for bus packet FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Coalescer that packs small records of several APIDs into a container
+  *		bus packet (APID BUS_PACKET_AGG_APID) and splitter that dispatches
+  *		every record of a received container.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet_agg.h"
+
+
+/**
+ * Initialize a coalescer without records
+ * @param agg Pointer to the coalescer
+ * @param max_length Container data length that is not exceeded, up to
+ * BUS_PACKET_AGG_DATA_SIZE. Lower values send smaller containers more often.
+ * @param deadline Ticks that the first record of a container may wait in
+ * bus_packet_AggPoll(), 0 to send containers only when they are full
+ * @param flush Function that sends the container data
+ * @param context User pointer passed to flush (the transmit queue for
+ * bus_packet_AggFlushTx)
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_AggInit(bus_packet_agg_t *agg, uint32_t max_length, uint32_t deadline, bus_packet_agg_flush_t flush, void *context)
+{
+	if(flush == NULL || max_length > BUS_PACKET_AGG_DATA_SIZE || max_length <= BUS_PACKET_AGG_RECORD_HEADER_SIZE)
+		return HAL_ERROR;
+
+	memset(agg, 0, sizeof(*agg));
+	agg->max_length = max_length;
+	agg->deadline = deadline;
+	agg->flush = flush;
+	agg->context = context;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Send the records of the container now
+ * @param agg Pointer to the coalescer
+ * @return HAL status of the flush function
+ */
+HAL_StatusTypeDef bus_packet_AggFlush(bus_packet_agg_t *agg)
+{
+	if(agg->records == 0)	return HAL_OK;
+
+	HAL_StatusTypeDef status = agg->flush(agg->context, agg->data, agg->length);
+	if(status != HAL_OK)
+	{
+		agg->busy++;
+		return status;
+	}
+
+	agg->containers++;
+	agg->sent += agg->records;
+	agg->length = 0;
+	agg->records = 0;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Add a record to the container. If it does not fit, the container is sent
+ * first.
+ * @param agg Pointer to the coalescer
+ * @param type
+ * 		@arg BUS_PACKET_TYPE_TM if a TM data is contained
+ * 		@arg BUS_PACKET_TYPE_TC if a TC data is contained
+ * @param apid APID number of the record (not BUS_PACKET_AGG_APID)
+ * @param data Pointer to the record data
+ * @param data_length Data length, up to max_length - BUS_PACKET_AGG_RECORD_HEADER_SIZE
+ * @param tick Current time, in the units of the deadline
+ * @return HAL status
+ * 		@arg HAL_BUSY if the full container could not be sent; the record
+ * 		was not added
+ */
+HAL_StatusTypeDef bus_packet_AggAdd(bus_packet_agg_t *agg, uint8_t type, uint8_t apid, const uint8_t *data, uint32_t data_length, uint32_t tick)
+{
+	if(type > BUS_PACKET_TYPE_TC || apid >= BUS_PACKET_AGG_APID ||
+	   data_length > agg->max_length - BUS_PACKET_AGG_RECORD_HEADER_SIZE)
+		return HAL_ERROR;
+
+	if(agg->length + BUS_PACKET_AGG_RECORD_HEADER_SIZE + data_length > agg->max_length)
+	{
+		HAL_StatusTypeDef status = bus_packet_AggFlush(agg);
+		if(status != HAL_OK)	return status;
+		agg->size_flushes++;
+	}
+
+	uint8_t *record = &agg->data[agg->length];
+
+	record[0] = BUS_PACKET_DISPATCH_ENTRY(type, apid);
+	record[1] = data_length;
+	memcpy(&record[BUS_PACKET_AGG_RECORD_HEADER_SIZE], data, data_length);
+
+	if(agg->records == 0)	agg->first_tick = tick;
+	agg->length += BUS_PACKET_AGG_RECORD_HEADER_SIZE + data_length;
+	agg->records++;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Send the container if its first record has waited the deadline. Call it
+ * periodically.
+ * @param agg Pointer to the coalescer
+ * @param tick Current time, in the units of the deadline
+ * @return HAL status of the flush function, HAL_OK if nothing was sent
+ */
+HAL_StatusTypeDef bus_packet_AggPoll(bus_packet_agg_t *agg, uint32_t tick)
+{
+	if(agg->records == 0 || agg->deadline == 0 || (uint32_t)(tick - agg->first_tick) < agg->deadline)
+		return HAL_OK;
+
+	HAL_StatusTypeDef status = bus_packet_AggFlush(agg);
+	if(status == HAL_OK)	agg->deadline_flushes++;
+
+	return status;
+}
+
+
+/**
+ * Flush function that sends the container through a transmit queue
+ * @param context Pointer to the transmit queue (bus_packet_tx_t)
+ * @param data Container data
+ * @param data_length Container data length
+ * @return HAL status
+ * 		@arg HAL_BUSY if all transmit buffers are in use
+ */
+HAL_StatusTypeDef bus_packet_AggFlushTx(void *context, uint8_t *data, uint32_t data_length)
+{
+	return bus_packet_TxEncodePacketize((bus_packet_tx_t *)context, BUS_PACKET_TYPE_TM, BUS_PACKET_AGG_APID, BUS_PACKET_ECF_EXIST, data, data_length);
+}
+
+
+
+
+/**
+ * Call the handlers of every record of a container. Every record is given
+ * as the view of the bus packet that it replaces, with the ECF of the
+ * container. The records before a malformed one are dispatched.
+ * @param dispatch Pointer to the dispatch table
+ * @param view Container decoded with bus_packet_DecodeView()
+ * @return HAL status
+ * 		@arg HAL_ERROR if a record exceeds the container or is a container
+ */
+HAL_StatusTypeDef bus_packet_AggSplit(bus_packet_dispatch_t *dispatch, const bus_packet_view_t *view)
+{
+	const uint8_t *data = view->data;
+	uint32_t length = bus_packet_ViewDataLength(view);
+	uint32_t ecf = view->header & 0xFFFF0000;
+	uint32_t pos = 0;
+
+	while(pos < length)
+	{
+		if(length - pos < BUS_PACKET_AGG_RECORD_HEADER_SIZE)	break;
+
+		uint8_t entry = data[pos];
+		uint32_t record_length = data[pos+1];
+
+		if(record_length > BUS_PACKET_AGG_RECORD_MAX_SIZE ||
+		   record_length > length - pos - BUS_PACKET_AGG_RECORD_HEADER_SIZE ||
+		   (entry & 0b01111111) == BUS_PACKET_AGG_APID)
+			break;
+
+		bus_packet_view_t record;
+		record.length = BUS_PACKET_HEADER_SIZE + record_length + BUS_PACKET_ECF_SIZE;
+		record.header = ecf | (entry<<8) | (BUS_PACKET_ECF_EXIST<<7) | record.length;
+		record.data = &data[pos + BUS_PACKET_AGG_RECORD_HEADER_SIZE];
+
+		bus_packet_DispatchView(dispatch, &record);
+		pos += BUS_PACKET_AGG_RECORD_HEADER_SIZE + record_length;
+	}
+
+	if(pos != length)
+	{
+		dispatch->errors++;
+		return HAL_ERROR;
+	}
+
+	return HAL_OK;
+}
+
+
+/**
+ * Dispatch handler of the containers
+ * @param context Pointer to the dispatch table
+ * @param view Container
+ */
+void bus_packet_AggHandler(void *context, const bus_packet_view_t *view)
+{
+	bus_packet_AggSplit((bus_packet_dispatch_t *)context, view);
+}
+
+
+/**
+ * Register the splitter for the TM and TC containers of a dispatch table
+ * @param dispatch Pointer to the dispatch table
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_AggRegister(bus_packet_dispatch_t *dispatch)
+{
+	if(bus_packet_DispatchRegister(dispatch, BUS_PACKET_TYPE_TM, BUS_PACKET_AGG_APID, bus_packet_AggHandler, dispatch) != HAL_OK)
+		return HAL_ERROR;
+
+	if(bus_packet_DispatchRegister(dispatch, BUS_PACKET_TYPE_TC, BUS_PACKET_AGG_APID, bus_packet_AggHandler, dispatch) != HAL_OK)
+	{
+		bus_packet_DispatchUnregister(dispatch, BUS_PACKET_TYPE_TM, BUS_PACKET_AGG_APID, bus_packet_AggHandler, dispatch);
+		return HAL_ERROR;
+	}
+
+	return HAL_OK;
+}
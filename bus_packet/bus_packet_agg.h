@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_agg.h
+  * @brief          : Aggregation packet of small records for bus packet FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Small samples of several APIDs are carried as records of a single
+  *		bus packet with the reserved APID BUS_PACKET_AGG_APID, so the sync
+  *		marker, header and ECF (8 bytes) are paid once per container instead
+  *		of once per sample. The data of the container is a list of records:
+  *
+  *		| type (1) | APID (7) | length (8) | payload (length bytes) | ...
+  *
+  *		The first record byte is the first header byte of the bus packet
+  *		that it replaces, so every record is dispatched as that packet.
+  *		Legacy receivers see a bus packet of an unknown APID.
+  *
+  *		The coalescer collects records and sends the container through the
+  *		flush function when the next record does not fit in max_length or
+  *		the first record is older than the deadline. If the flush function
+  *		fails (HAL_BUSY from the transmit queue), the records are kept and
+  *		sent in the next flush. The splitter is a dispatch handler that
+  *		calls the handlers of every record with a view of it.
+  *
+  *		The coalescer is not reentrant: add records and poll it from the
+  *		same context.
+  *
+  *	 Example:
+  *		// Sender
+  *		bus_packet_agg_t agg;
+  *		bus_packet_AggInit(&agg, BUS_PACKET_AGG_DATA_SIZE, 10, bus_packet_AggFlushTx, &tx);
+  *		bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 90, sample, 6, HAL_GetTick());
+  *		bus_packet_AggPoll(&agg, HAL_GetTick());		// From the main loop
+  *
+  *		// Receiver: records are delivered to the handlers of their APID
+  *		bus_packet_AggRegister(&dispatch);
+  *		bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, 90, Housekeeping_Handler, NULL);
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_BUS_PACKET_AGG_H_
+#define INC_BUS_PACKET_AGG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bus_packet_dispatch.h"
+#include "bus_packet_tx.h"
+
+
+#define BUS_PACKET_AGG_APID					0b01111111	// Reserved for containers
+#define BUS_PACKET_AGG_RECORD_HEADER_SIZE	2
+#define BUS_PACKET_AGG_DATA_SIZE			BUS_PACKET_DATA_SIZE
+#define BUS_PACKET_AGG_RECORD_MAX_SIZE		(BUS_PACKET_AGG_DATA_SIZE-BUS_PACKET_AGG_RECORD_HEADER_SIZE)
+
+
+/*
+ * Sends the data of a container (the records). HAL_OK releases the records.
+ */
+typedef HAL_StatusTypeDef (*bus_packet_agg_flush_t)(void *context, uint8_t *data, uint32_t data_length);
+
+
+typedef struct
+{
+	uint8_t data[BUS_PACKET_AGG_DATA_SIZE];
+	uint32_t length;			// Bytes of records in data
+	uint32_t records;			// Records in data
+	uint32_t first_tick;		// Tick of the first record in data
+
+	uint32_t max_length;		// Container data flushed before exceeding it
+	uint32_t deadline;			// Ticks a record may wait, 0 to flush only by size
+
+	bus_packet_agg_flush_t flush;
+	void *context;
+
+	uint32_t containers;		// Containers sent
+	uint32_t sent;				// Records sent
+	uint32_t size_flushes;		// Containers sent because the next record did not fit
+	uint32_t deadline_flushes;	// Containers sent by bus_packet_AggPoll()
+	uint32_t busy;				// Flushes that failed, the records were kept
+}bus_packet_agg_t;
+
+
+
+
+HAL_StatusTypeDef bus_packet_AggInit(bus_packet_agg_t *agg, uint32_t max_length, uint32_t deadline, bus_packet_agg_flush_t flush, void *context);
+HAL_StatusTypeDef bus_packet_AggAdd(bus_packet_agg_t *agg, uint8_t type, uint8_t apid, const uint8_t *data, uint32_t data_length, uint32_t tick);
+HAL_StatusTypeDef bus_packet_AggPoll(bus_packet_agg_t *agg, uint32_t tick);
+HAL_StatusTypeDef bus_packet_AggFlush(bus_packet_agg_t *agg);
+HAL_StatusTypeDef bus_packet_AggFlushTx(void *context, uint8_t *data, uint32_t data_length);
+
+HAL_StatusTypeDef bus_packet_AggSplit(bus_packet_dispatch_t *dispatch, const bus_packet_view_t *view);
+void bus_packet_AggHandler(void *context, const bus_packet_view_t *view);
+HAL_StatusTypeDef bus_packet_AggRegister(bus_packet_dispatch_t *dispatch);
+
+static inline uint8_t bus_packet_ViewIsAgg(const bus_packet_view_t *view) {return bus_packet_ViewApid(view) == BUS_PACKET_AGG_APID;}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_BUS_PACKET_AGG_H_ */
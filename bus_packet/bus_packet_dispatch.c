@@ -0,0 +1,214 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_dispatch.c
+  * @brief          : APID dispatch table for bus packet FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Routes decoded bus packets to the handlers registered for their APID
+  *		and packet type with a table indexed by the first header byte.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet_dispatch.h"
+
+
+/**
+ * Initialize a dispatch table without handlers
+ * @param dispatch Pointer to the dispatch table
+ */
+void bus_packet_DispatchInit(bus_packet_dispatch_t *dispatch)
+{
+	memset(dispatch, 0, sizeof(*dispatch));
+	memset(dispatch->head, BUS_PACKET_DISPATCH_NONE, sizeof(dispatch->head));
+
+	for(uint32_t i=0; i<BUS_PACKET_DISPATCH_HANDLERS; i++)
+		dispatch->nodes[i].next = (i+1 < BUS_PACKET_DISPATCH_HANDLERS) ? i+1 : BUS_PACKET_DISPATCH_NONE;
+	dispatch->free = 0;
+}
+
+
+/**
+ * Add a handler for the bus packets of an APID and packet type. Handlers of
+ * the same APID are called in the order they were registered.
+ * @param dispatch Pointer to the dispatch table
+ * @param type
+ * 		@arg BUS_PACKET_TYPE_TM for TM packets
+ * 		@arg BUS_PACKET_TYPE_TC for TC packets
+ * @param apid APID number
+ * @param handler Function called with every bus packet
+ * @param context User pointer passed to the handler
+ * @return HAL status
+ * 		@arg HAL_ERROR if the handler is already registered with the same
+ * 		context or there are no free nodes (BUS_PACKET_DISPATCH_HANDLERS)
+ */
+HAL_StatusTypeDef bus_packet_DispatchRegister(bus_packet_dispatch_t *dispatch, uint8_t type, uint8_t apid, bus_packet_handler_t handler, void *context)
+{
+	uint8_t *link = &dispatch->head[BUS_PACKET_DISPATCH_ENTRY(type, apid)];
+
+	if(handler == NULL || dispatch->free == BUS_PACKET_DISPATCH_NONE)	return HAL_ERROR;
+
+	while(*link != BUS_PACKET_DISPATCH_NONE)
+	{
+		bus_packet_dispatch_node_t *node = &dispatch->nodes[*link];
+		if(node->handler == handler && node->context == context)	return HAL_ERROR;
+		link = &node->next;
+	}
+
+	uint8_t index = dispatch->free;
+	bus_packet_dispatch_node_t *node = &dispatch->nodes[index];
+
+	dispatch->free = node->next;
+	node->handler = handler;
+	node->context = context;
+	node->next = BUS_PACKET_DISPATCH_NONE;
+	*link = index;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Remove a handler of an APID and packet type
+ * @param dispatch Pointer to the dispatch table
+ * @param type
+ * 		@arg BUS_PACKET_TYPE_TM for TM packets
+ * 		@arg BUS_PACKET_TYPE_TC for TC packets
+ * @param apid APID number
+ * @param handler Function given to bus_packet_DispatchRegister()
+ * @param context User pointer given to bus_packet_DispatchRegister()
+ * @return HAL status
+ * 		@arg HAL_ERROR if the handler was not registered
+ */
+HAL_StatusTypeDef bus_packet_DispatchUnregister(bus_packet_dispatch_t *dispatch, uint8_t type, uint8_t apid, bus_packet_handler_t handler, void *context)
+{
+	uint8_t *link = &dispatch->head[BUS_PACKET_DISPATCH_ENTRY(type, apid)];
+
+	while(*link != BUS_PACKET_DISPATCH_NONE)
+	{
+		uint8_t index = *link;
+		bus_packet_dispatch_node_t *node = &dispatch->nodes[index];
+
+		if(node->handler == handler && node->context == context)
+		{
+			*link = node->next;
+			node->handler = NULL;
+			node->next = dispatch->free;
+			dispatch->free = index;
+			return HAL_OK;
+		}
+		link = &node->next;
+	}
+
+	return HAL_ERROR;
+}
+
+
+/**
+ * Set the handler called with the bus packets without subscribers
+ * @param dispatch Pointer to the dispatch table
+ * @param handler Function called with the bus packet, or NULL to drop them
+ * @param context User pointer passed to the handler
+ */
+void bus_packet_DispatchSetUnhandled(bus_packet_dispatch_t *dispatch, bus_packet_handler_t handler, void *context)
+{
+	dispatch->unhandled = handler;
+	dispatch->unhandled_context = context;
+}
+
+
+/**
+ * Call the handlers of a decoded bus packet. A handler may unregister
+ * itself or any other handler of the same APID; the unregistered handlers
+ * after it are not called.
+ * @param dispatch Pointer to the dispatch table
+ * @param view Bus packet decoded with bus_packet_DecodeView()
+ * @return Number of handlers called (the unhandled handler is not counted)
+ */
+uint32_t bus_packet_DispatchView(bus_packet_dispatch_t *dispatch, const bus_packet_view_t *view)
+{
+	uint8_t *link = &dispatch->head[(view->header>>8) & 0xFF];
+	uint32_t called = 0;
+
+	if(*link == BUS_PACKET_DISPATCH_NONE)
+	{
+		dispatch->dropped++;
+		if(dispatch->unhandled != NULL)		dispatch->unhandled(dispatch->unhandled_context, view);
+		return 0;
+	}
+
+	while(*link != BUS_PACKET_DISPATCH_NONE)
+	{
+		bus_packet_dispatch_node_t *node = &dispatch->nodes[*link];
+		bus_packet_handler_t handler = node->handler;
+		void *context = node->context;
+
+		// Freed nodes have no handler
+		if(handler != NULL)
+		{
+			handler(context, view);
+			called++;
+		}
+
+		// A handler that unregistered itself was unlinked, so link already holds the next one
+		if(node->handler == handler && node->context == context)	link = &node->next;
+	}
+	dispatch->dispatched++;
+
+	return called;
+}
+
+
+/**
+ * Decode data buffer that contain a bus packet without copying the data and
+ * call the handlers of its APID and packet type
+ * @param dispatch Pointer to the dispatch table
+ * @param buffer Data buffer with a bus packet to decode
+ * @param buffer_length Bytes that can be read from buffer
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_DecodeDispatch(bus_packet_dispatch_t *dispatch, const uint8_t *buffer, uint32_t buffer_length)
+{
+	bus_packet_view_t view;
+
+	if(bus_packet_DecodeView(buffer, buffer_length, &view) != HAL_OK)
+	{
+		dispatch->errors++;
+		return HAL_ERROR;
+	}
+
+	bus_packet_DispatchView(dispatch, &view);
+
+	return HAL_OK;
+}
+
+
+/**
+ * Callback for bus_packet_RxInit() that decodes and dispatches every
+ * received bus packet, jumbo bus packets included
+ * @param context Pointer to the dispatch table
+ * @param buffer Received bus packet
+ * @param length Bus packet length
+ */
+void bus_packet_DispatchRxCallback(void *context, uint8_t *buffer, uint32_t length)
+{
+	bus_packet_dispatch_t *dispatch = (bus_packet_dispatch_t *)context;
+	bus_packet_view_t view;
+
+	if(bus_packet_DecodeViewJumbo(buffer, length, &view) != HAL_OK)
+	{
+		dispatch->errors++;
+		return;
+	}
+
+	bus_packet_DispatchView(dispatch, &view);
+}
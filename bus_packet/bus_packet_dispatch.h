@@ -0,0 +1,112 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_dispatch.h
+  * @brief          : APID dispatch table for bus packet FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Routes decoded bus packets to the handlers registered for their APID
+  *		and packet type. The table has one entry per value of the first
+  *		header byte (packet type and APID), so finding the handlers of a
+  *		packet is a single indexed load whatever the number of APIDs in use.
+  *		Every entry is a list of subscribers taken from a fixed pool of
+  *		BUS_PACKET_DISPATCH_HANDLERS nodes, so no dynamic memory is used.
+  *
+  *		Handlers receive the zero-copy view of the packet: the data points
+  *		into the decoded buffer and is only valid during the call.
+  *
+  *		Do not register or unregister handlers while a packet is being
+  *		dispatched from an interrupt.
+  *
+  *	 Example:
+  *		bus_packet_dispatch_t dispatch;
+  *		bus_packet_DispatchInit(&dispatch);
+  *		bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TC, 90, Command_Handler, NULL);
+  *		bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, 90, Telemetry_Logger, &log);
+  *
+  *		if(bus_packet_DecodeDispatch(&dispatch, buffer, length) != HAL_OK)
+  *			Error_Handle();
+  *
+  *		// Or directly from the DMA receiver
+  *		bus_packet_RxInit(&rx, rx_dma, sizeof(rx_dma), bus_packet_DispatchRxCallback, &dispatch);
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_BUS_PACKET_DISPATCH_H_
+#define INC_BUS_PACKET_DISPATCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bus_packet.h"
+
+
+#ifndef BUS_PACKET_DISPATCH_HANDLERS
+#define BUS_PACKET_DISPATCH_HANDLERS	32		// Subscribers of all the APIDs
+#endif
+#if BUS_PACKET_DISPATCH_HANDLERS > 255
+#error "BUS_PACKET_DISPATCH_HANDLERS must be lower than 256"
+#endif
+#define BUS_PACKET_DISPATCH_ENTRIES		256		// Packet type (1 bit) and APID (7 bits)
+#define BUS_PACKET_DISPATCH_NONE		0xFF
+
+#define BUS_PACKET_DISPATCH_ENTRY(type, apid)	((((type)&0x01)<<7) | ((apid)&0b01111111))
+
+
+/*
+ * Called with every decoded bus packet of the registered APID and type
+ */
+typedef void (*bus_packet_handler_t)(void *context, const bus_packet_view_t *view);
+
+
+typedef struct
+{
+	bus_packet_handler_t handler;
+	void *context;
+	uint8_t next;				// Next subscriber of the same entry
+}bus_packet_dispatch_node_t;
+
+
+typedef struct
+{
+	uint8_t head[BUS_PACKET_DISPATCH_ENTRIES];		// First subscriber of every entry
+	uint8_t free;									// First free node
+	bus_packet_dispatch_node_t nodes[BUS_PACKET_DISPATCH_HANDLERS];
+
+	bus_packet_handler_t unhandled;					// Packets without subscribers, or NULL
+	void *unhandled_context;
+
+	uint32_t dispatched;		// Packets delivered to at least one handler
+	uint32_t dropped;			// Packets without subscribers
+	uint32_t errors;			// Packets that could not be decoded
+}bus_packet_dispatch_t;
+
+
+
+
+void bus_packet_DispatchInit(bus_packet_dispatch_t *dispatch);
+HAL_StatusTypeDef bus_packet_DispatchRegister(bus_packet_dispatch_t *dispatch, uint8_t type, uint8_t apid, bus_packet_handler_t handler, void *context);
+HAL_StatusTypeDef bus_packet_DispatchUnregister(bus_packet_dispatch_t *dispatch, uint8_t type, uint8_t apid, bus_packet_handler_t handler, void *context);
+void bus_packet_DispatchSetUnhandled(bus_packet_dispatch_t *dispatch, bus_packet_handler_t handler, void *context);
+
+uint32_t bus_packet_DispatchView(bus_packet_dispatch_t *dispatch, const bus_packet_view_t *view);
+HAL_StatusTypeDef bus_packet_DecodeDispatch(bus_packet_dispatch_t *dispatch, const uint8_t *buffer, uint32_t buffer_length);
+void bus_packet_DispatchRxCallback(void *context, uint8_t *buffer, uint32_t length);
+
+static inline uint8_t bus_packet_DispatchHasHandler(const bus_packet_dispatch_t *dispatch, uint8_t type, uint8_t apid) {return dispatch->head[BUS_PACKET_DISPATCH_ENTRY(type, apid)] != BUS_PACKET_DISPATCH_NONE;}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_BUS_PACKET_DISPATCH_H_ */
@@ -0,0 +1,197 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_rx.c
+  * @brief          : Circular DMA receiver and deframer for bus packet FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		The UART writes into a circular DMA buffer and this library processes
+  *		the received bytes in chunks on half transfer, transfer complete and
+  *		idle line events. The sync marker is searched, the bus packet is
+  *		copied and the callback is called for every complete bus packet.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet_rx.h"
+
+#ifndef STM32_MCU
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+
+/**
+ * Initialize a bus packet receiver
+ * @param rx Pointer to the receiver
+ * @param dma_buffer Circular buffer written by the DMA
+ * @param dma_size Size of the circular buffer
+ * @param callback Function called for every complete bus packet
+ * @param context User pointer passed to the callback
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_RxInit(bus_packet_rx_t *rx, uint8_t *dma_buffer, uint32_t dma_size, bus_packet_rx_callback_t callback, void *context)
+{
+	if(rx == NULL || callback == NULL)				return HAL_ERROR;
+	if(dma_buffer == NULL && dma_size != 0)			return HAL_ERROR;
+
+	memset(rx, 0, sizeof(*rx));
+	rx->dma_buffer = dma_buffer;
+	rx->dma_size = dma_size;
+	rx->sync_flag = BUS_PACKET_SYNC_FIND;
+	rx->callback = callback;
+	rx->context = context;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Deframe a chunk of received bytes. Complete bus packets are delivered to
+ * the callback; incomplete ones are kept for the next chunk.
+ * @param rx Pointer to the receiver
+ * @param data Received bytes
+ * @param length Number of received bytes
+ */
+void bus_packet_RxFeed(bus_packet_rx_t *rx, const uint8_t *data, uint32_t length)
+{
+	while(length)
+	{
+		if(rx->sync_flag != BUS_PACKET_SYNC_COMPLETED)
+		{
+			if(rx->sync_flag == BUS_PACKET_SYNC_FIND)	// Skip until the first sync byte
+			{
+				const uint8_t *sync = memchr(data, BUS_PACKET_FRAME_SYNC[0], length);
+				if(sync == NULL)	return;
+				length -= sync - data;
+				data = sync;
+			}
+
+			rx->sync_flag = bus_packet_SyncFrameDetect(rx->sync_flag, *data++);
+			length--;
+
+			if(rx->sync_flag == BUS_PACKET_SYNC_COMPLETED)
+			{
+				rx->frame_pos = 0;
+				rx->frame_length = 0;
+			}
+			continue;
+		}
+
+		if(rx->frame_length == 0)	// Header byte by byte
+		{
+			rx->frame[rx->frame_pos++] = *data++;
+			length--;
+
+			// Jumbo bus packets have the 16-bit length after the header
+			if(rx->frame_pos < BUS_PACKET_HEADER_SIZE || rx->frame_pos < bus_packet_GetHeaderSize(rx->frame))
+				continue;
+
+			if(bus_packet_ValidateJumbo(rx->frame, BUS_PACKET_RX_FRAME_SIZE) != HAL_OK)
+			{
+				rx->length_errors++;
+				rx->sync_flag = BUS_PACKET_SYNC_FIND;
+				continue;
+			}
+			rx->frame_length = bus_packet_GetLength(rx->frame);
+		}
+		else	// Data and ECF in chunks
+		{
+			uint32_t n = rx->frame_length - rx->frame_pos;
+			if(n > length)	n = length;
+
+			memcpy(&rx->frame[rx->frame_pos], data, n);
+			rx->frame_pos += n;
+			data += n;
+			length -= n;
+		}
+
+		if(rx->frame_pos >= rx->frame_length)
+		{
+			rx->packets++;
+			rx->sync_flag = BUS_PACKET_SYNC_FIND;
+			rx->callback(rx->context, rx->frame, rx->frame_length);
+		}
+	}
+}
+
+
+/**
+ * Process the bytes written by the DMA since the last event. Call it on
+ * half transfer, transfer complete and idle line events.
+ * @param rx Pointer to the receiver
+ * @param dma_pos Position of dma_buffer where the DMA will write the next
+ * byte (dma_size - NDTR, or Size of HAL_UARTEx_RxEventCallback). A value
+ * of dma_size means that the DMA has just wrapped to the beginning.
+ */
+void bus_packet_RxDMAEvent(bus_packet_rx_t *rx, uint32_t dma_pos)
+{
+	if(dma_pos > rx->dma_size)	return;
+
+	if(dma_pos > rx->read_pos)
+		bus_packet_RxFeed(rx, &rx->dma_buffer[rx->read_pos], dma_pos - rx->read_pos);
+
+	else if(dma_pos < rx->read_pos)	// Wrap around
+	{
+		bus_packet_RxFeed(rx, &rx->dma_buffer[rx->read_pos], rx->dma_size - rx->read_pos);
+		bus_packet_RxFeed(rx, rx->dma_buffer, dma_pos);
+	}
+
+	rx->read_pos = (dma_pos == rx->dma_size) ? 0 : dma_pos;
+}
+
+
+
+
+#ifdef STM32_MCU
+/**
+ * Start the circular DMA reception with idle line detection
+ * @param rx Pointer to the receiver
+ * @param huart UART handle with a DMA channel in circular mode
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_RxStartDMA(bus_packet_rx_t *rx, UART_HandleTypeDef *huart)
+{
+	if(rx->dma_size == 0 || rx->dma_size > 0xFFFF)		return HAL_ERROR;
+
+	rx->read_pos = 0;
+	return HAL_UARTEx_ReceiveToIdle_DMA(huart, rx->dma_buffer, rx->dma_size);
+}
+
+
+#else
+/**
+ * Emulate the circular DMA in a host: read the available bytes of a file
+ * descriptor (pipe, pty or serial port) into dma_buffer and process them as
+ * a DMA event would do.
+ * @param rx Pointer to the receiver
+ * @param fd File descriptor to read
+ * @return HAL status
+ * 		@arg HAL_OK if bytes were processed
+ * 		@arg HAL_TIMEOUT if there were no bytes (end of file or O_NONBLOCK)
+ * 		@arg HAL_ERROR if read() fails
+ */
+HAL_StatusTypeDef bus_packet_RxPollFd(bus_packet_rx_t *rx, int fd)
+{
+	if(rx->dma_size == 0)	return HAL_ERROR;
+
+	ssize_t n = read(fd, &rx->dma_buffer[rx->write_pos], rx->dma_size - rx->write_pos);
+	if(n == 0)	return HAL_TIMEOUT;
+	if(n < 0)	return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? HAL_TIMEOUT : HAL_ERROR;
+
+	rx->write_pos += n;
+	bus_packet_RxDMAEvent(rx, rx->write_pos);
+
+	if(rx->write_pos >= rx->dma_size)	rx->write_pos = 0;
+
+	return HAL_OK;
+}
+#endif
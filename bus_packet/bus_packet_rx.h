@@ -0,0 +1,109 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_rx.h
+  * @brief          : Circular DMA receiver and deframer for bus packet FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		The UART writes into a circular DMA buffer and this library processes
+  *		the received bytes in chunks on half transfer, transfer complete and
+  *		idle line events. The sync marker is searched, the bus packet is
+  *		copied and the callback is called for every complete bus packet, so
+  *		there is one interrupt per chunk instead of one per byte.
+  *
+  *		In a host (Linux) the DMA is emulated with bus_packet_RxPollFd() over
+  *		a pipe, a pty or a serial port, so the same deframer can be tested.
+  *
+  *	 Example (STM32, DMA channel in circular mode):
+  *		uint8_t rx_dma[256];
+  *		bus_packet_rx_t rx;
+  *		bus_packet_RxInit(&rx, rx_dma, sizeof(rx_dma), Packet_Received, NULL);
+  *		bus_packet_RxStartDMA(&rx, &huart1);
+  *
+  *		void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+  *		{
+  *			bus_packet_RxDMAEvent(&rx, Size);
+  *		}
+  *
+  *		void Packet_Received(void *context, uint8_t *buffer, uint32_t length)
+  *		{
+  *			bus_packet_t packet;
+  *			if(bus_packet_Decode(buffer, &packet) != HAL_OK)
+  *				Error_Handle();
+  *		}
+  *
+  *		With -DBUS_PACKET_RX_FRAME_SIZE=BUS_PACKET_JUMBO_MAX_SIZE jumbo bus
+  *		packets are delivered too (decode them with bus_packet_DecodeViewJumbo).
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_BUS_PACKET_RX_H_
+#define INC_BUS_PACKET_RX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bus_packet.h"
+
+
+// Longest bus packet received. Define it as BUS_PACKET_JUMBO_MAX_SIZE to
+// receive jumbo bus packets; longer ones are counted as length errors.
+#ifndef BUS_PACKET_RX_FRAME_SIZE
+#define BUS_PACKET_RX_FRAME_SIZE	BUS_PACKET_BUS_SIZE
+#endif
+
+
+/*
+ * Called from the event context with a complete bus packet (without sync
+ * marker). The buffer is reused after the callback returns.
+ */
+typedef void (*bus_packet_rx_callback_t)(void *context, uint8_t *buffer, uint32_t length);
+
+
+typedef struct
+{
+	uint8_t *dma_buffer;
+	uint32_t dma_size;
+	uint32_t read_pos;			// Next position of dma_buffer to be processed
+	uint32_t write_pos;			// Next position written by the emulated DMA (host)
+
+	bus_sync_flag_t sync_flag;
+	uint32_t frame_pos;
+	uint32_t frame_length;
+	uint8_t frame[BUS_PACKET_RX_FRAME_SIZE];
+
+	bus_packet_rx_callback_t callback;
+	void *context;
+
+	uint32_t packets;			// Bus packets delivered to the callback
+	uint32_t length_errors;		// Headers with an invalid length, or longer than frame
+}bus_packet_rx_t;
+
+
+
+
+HAL_StatusTypeDef bus_packet_RxInit(bus_packet_rx_t *rx, uint8_t *dma_buffer, uint32_t dma_size, bus_packet_rx_callback_t callback, void *context);
+void bus_packet_RxFeed(bus_packet_rx_t *rx, const uint8_t *data, uint32_t length);
+void bus_packet_RxDMAEvent(bus_packet_rx_t *rx, uint32_t dma_pos);
+
+#ifdef STM32_MCU
+HAL_StatusTypeDef bus_packet_RxStartDMA(bus_packet_rx_t *rx, UART_HandleTypeDef *huart);
+#else
+HAL_StatusTypeDef bus_packet_RxPollFd(bus_packet_rx_t *rx, int fd);
+#endif
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_BUS_PACKET_RX_H_ */
@@ -0,0 +1,221 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_seq.c
+  * @brief          : Sequence count and loss tracker for bus packet FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Optional 16-bit sequence count in the first bytes of the data of the
+  *		enabled APIDs, and a receiver tracker with gaps, duplicates and
+  *		reordering per APID.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet_seq.h"
+
+
+/**
+ * Initialize the sender sequence counts. No APID is enabled.
+ * @param seq Pointer to the sender sequence counts
+ */
+void bus_packet_SeqTxInit(bus_packet_seq_tx_t *seq)
+{
+	memset(seq, 0, sizeof(*seq));
+}
+
+
+/**
+ * Enable or disable the sequence count of an APID in the sender. The
+ * receiver must have the same APIDs enabled.
+ * @param seq Pointer to the sender sequence counts
+ * @param apid APID number
+ * @param enable 1 to add the sequence count, 0 to send legacy bus packets
+ */
+void bus_packet_SeqTxEnable(bus_packet_seq_tx_t *seq, uint8_t apid, uint8_t enable)
+{
+	apid &= 0b01111111;
+	if(enable)	seq->enabled[apid>>5] |= 1UL<<(apid&0x1F);
+	else		seq->enabled[apid>>5] &= ~(1UL<<(apid&0x1F));
+}
+
+
+/**
+ * Encode and packetize data into a buffer for to be transmitted, with the
+ * next sequence count of the APID before the data if it is enabled
+ * @param seq Pointer to the sender sequence counts
+ * @param type
+ * 		@arg BUS_PACKET_TYPE_TM if a TM data is contained
+ * 		@arg BUS_PACKET_TYPE_TC if a TC data is contained
+ * @param apid APID number for contained data
+ * @param ecf_flag
+ * 		@arg BUS_PACKET_ECF_NOT_EXIST if an Error Control Field will be not encoded
+ * 		@arg BUS_PACKET_ECF_EXIST if an Error Control Field will be encoded
+ * @param data Pointer to data that will be encoded
+ * @param data_length Data length, up to BUS_PACKET_SEQ_DATA_SIZE if the
+ * sequence count is enabled
+ * @param buffer_out Pointer to a data buffer for to be transmitted
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_SeqEncodePacketize(bus_packet_seq_tx_t *seq, uint8_t type, uint8_t apid, uint8_t ecf_flag, uint8_t *data, uint32_t data_length, uint8_t *buffer_out)
+{
+	if(!bus_packet_SeqTxEnabled(seq, apid))
+		return bus_packet_EncodePacketize(type, apid, ecf_flag, data, data_length, buffer_out);
+
+	uint32_t length = data_length + BUS_PACKET_SEQ_SIZE + BUS_PACKET_HEADER_SIZE + BUS_PACKET_ECF_SIZE;
+	uint16_t count = seq->count[apid & 0b01111111];
+
+	if(length > BUS_PACKET_BUS_SIZE)	return HAL_ERROR;
+
+	buffer_out[0] = (type<<7) | (apid & 0b01111111);
+	buffer_out[1] = (ecf_flag<<7) | (length & 0b01111111);
+	buffer_out[BUS_PACKET_HEADER_SIZE] = count>>8;
+	buffer_out[BUS_PACKET_HEADER_SIZE+1] = count & 0xFF;
+	memcpy(&buffer_out[BUS_PACKET_HEADER_SIZE+BUS_PACKET_SEQ_SIZE], data, data_length);
+
+	if (ecf_flag)	// There is CRC?
+	{
+		uint16_t ecf = crc16_ccsds_Calculate(0, buffer_out, length-BUS_PACKET_ECF_SIZE);
+		buffer_out[length-BUS_PACKET_ECF_SIZE] = ecf>>8;
+		buffer_out[length-BUS_PACKET_ECF_SIZE+1] = ecf & 0xFF;
+	}
+
+	seq->count[apid & 0b01111111] = count + 1;
+
+	return HAL_OK;
+}
+
+
+
+
+/**
+ * Initialize the receiver tracker. No APID is enabled.
+ * @param seq Pointer to the receiver tracker
+ * @param flywheel Longest gap counted as lost (BUS_PACKET_SEQ_DEFAULT_FLYWHEEL),
+ * a longer jump forward is a resync
+ */
+void bus_packet_SeqRxInit(bus_packet_seq_rx_t *seq, uint32_t flywheel)
+{
+	memset(seq, 0, sizeof(*seq));
+	seq->flywheel = flywheel;
+}
+
+
+/**
+ * Enable or disable the sequence count of an APID in the receiver. The
+ * state and statistics of the APID are reset.
+ * @param seq Pointer to the receiver tracker
+ * @param apid APID number
+ * @param enable 1 if the sender adds the sequence count to this APID
+ */
+void bus_packet_SeqRxEnable(bus_packet_seq_rx_t *seq, uint8_t apid, uint8_t enable)
+{
+	apid &= 0b01111111;
+	if(enable)	seq->enabled[apid>>5] |= 1UL<<(apid&0x1F);
+	else		seq->enabled[apid>>5] &= ~(1UL<<(apid&0x1F));
+
+	memset(&seq->apid[apid], 0, sizeof(seq->apid[apid]));
+}
+
+
+/**
+ * Track a received sequence count of an APID
+ * @param seq Pointer to the receiver tracker
+ * @param apid APID number
+ * @param count Received sequence count
+ * @return What the sequence count means for the APID. With
+ * BUS_PACKET_SEQ_DUPLICATE the packet should be dropped.
+ */
+bus_packet_seq_event_t bus_packet_SeqTrack(bus_packet_seq_rx_t *seq, uint8_t apid, uint16_t count)
+{
+	bus_packet_seq_state_t *state = &seq->apid[apid & 0b01111111];
+	int32_t delta = (int16_t)(count - state->expected);
+
+	if(!state->started || delta < -BUS_PACKET_SEQ_WINDOW || (delta > 0 && (uint32_t)delta > seq->flywheel))
+	{
+		bus_packet_seq_event_t event = state->started ? BUS_PACKET_SEQ_RESYNC : BUS_PACKET_SEQ_FIRST;
+
+		state->stats.resyncs += (event == BUS_PACKET_SEQ_RESYNC);
+		state->started = 1;
+		state->expected = count + 1;
+		state->window = ~0U;		// Older counts were never lost: duplicates, or a resync out of the window
+		state->stats.received++;
+		return event;
+	}
+
+	if(delta >= 0)
+	{
+		// The window moves to the new count: delta lost packets and this one
+		state->window = (delta + 1 >= BUS_PACKET_SEQ_WINDOW) ? 1 : (state->window << (delta + 1)) | 1;
+		state->expected = count + 1;
+		state->stats.received++;
+		if(delta == 0)	return BUS_PACKET_SEQ_IN_ORDER;
+
+		state->stats.lost += delta;
+		state->stats.gaps++;
+		return BUS_PACKET_SEQ_GAP;
+	}
+
+	uint32_t bit = 1UL << (-delta - 1);
+	if(state->window & bit)
+	{
+		state->stats.duplicates++;
+		return BUS_PACKET_SEQ_DUPLICATE;
+	}
+
+	state->window |= bit;
+	state->stats.received++;
+	state->stats.reordered++;
+	if(state->stats.lost)	state->stats.lost--;
+	return BUS_PACKET_SEQ_REORDERED;
+}
+
+
+/**
+ * Track the sequence count of a decoded bus packet
+ * @param seq Pointer to the receiver tracker
+ * @param view Bus packet decoded with bus_packet_DecodeView()
+ * @return What the sequence count means for the APID, or
+ * BUS_PACKET_SEQ_DISABLED if the APID has no sequence count or the data is
+ * shorter than it
+ */
+bus_packet_seq_event_t bus_packet_SeqTrackView(bus_packet_seq_rx_t *seq, const bus_packet_view_t *view)
+{
+	uint8_t apid = bus_packet_ViewApid(view);
+
+	if(!bus_packet_SeqRxEnabled(seq, apid) || bus_packet_ViewDataLength(view) < BUS_PACKET_SEQ_SIZE)
+		return BUS_PACKET_SEQ_DISABLED;
+
+	return bus_packet_SeqTrack(seq, apid, bus_packet_SeqGet(view->data));
+}
+
+
+/**
+ * Add the statistics of all the enabled APIDs
+ * @param seq Pointer to the receiver tracker
+ * @param totals Pointer to save the sum
+ */
+void bus_packet_SeqTotals(const bus_packet_seq_rx_t *seq, bus_packet_seq_stats_t *totals)
+{
+	memset(totals, 0, sizeof(*totals));
+
+	for(uint32_t apid=0; apid<BUS_PACKET_SEQ_APIDS; apid++)
+	{
+		const bus_packet_seq_stats_t *stats = &seq->apid[apid].stats;
+
+		totals->received += stats->received;
+		totals->lost += stats->lost;
+		totals->gaps += stats->gaps;
+		totals->duplicates += stats->duplicates;
+		totals->reordered += stats->reordered;
+		totals->resyncs += stats->resyncs;
+	}
+}
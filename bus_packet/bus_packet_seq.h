@@ -0,0 +1,133 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_seq.h
+  * @brief          : Sequence count and loss tracker for bus packet FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Optional 16-bit sequence count per APID. The bus packet header has no
+  *		free bits, so the sequence count is carried in the first
+  *		BUS_PACKET_SEQ_SIZE bytes of the data (MSB first) of the APIDs where
+  *		both ends have enabled it. Legacy receivers still decode these
+  *		packets with bus_packet_Decode(): the sequence count is only part of
+  *		the data.
+  *
+  *		The receiver keeps O(1) state per APID (next expected count and a
+  *		window with the last BUS_PACKET_SEQ_WINDOW counts received) and
+  *		reports gaps, duplicates, reordered packets and resyncs (a jump
+  *		backward out of the window or forward longer than the flywheel, for
+  *		example when the sender restarts). A reordered packet was counted as
+  *		lost when the gap was seen, so it is subtracted from the lost
+  *		packets when it arrives.
+  *
+  *	 Example:
+  *		bus_packet_seq_tx_t seq_tx;				// Sender
+  *		bus_packet_SeqTxInit(&seq_tx);
+  *		bus_packet_SeqTxEnable(&seq_tx, 90, 1);
+  *		bus_packet_SeqEncodePacketize(&seq_tx, 1, 90, 1, data, 6, buffer_out);
+  *
+  *		bus_packet_seq_rx_t seq_rx;				// Receiver
+  *		bus_packet_SeqRxInit(&seq_rx, BUS_PACKET_SEQ_DEFAULT_FLYWHEEL);
+  *		bus_packet_SeqRxEnable(&seq_rx, 90, 1);
+  *		if(bus_packet_DecodeView(buffer, length, &view) == HAL_OK)
+  *			bus_packet_SeqTrackView(&seq_rx, &view);
+  *		lost = seq_rx.apid[90].stats.lost;
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_BUS_PACKET_SEQ_H_
+#define INC_BUS_PACKET_SEQ_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bus_packet.h"
+
+
+#define BUS_PACKET_SEQ_SIZE			2
+#define BUS_PACKET_SEQ_DATA_SIZE	(BUS_PACKET_DATA_SIZE-BUS_PACKET_SEQ_SIZE)
+#define BUS_PACKET_SEQ_APIDS		128
+#define BUS_PACKET_SEQ_WINDOW		32		// Bits of bus_packet_seq_state_t::window
+#define BUS_PACKET_SEQ_DEFAULT_FLYWHEEL	1024	// Longest gap counted as lost
+
+
+typedef enum
+{
+	BUS_PACKET_SEQ_IN_ORDER		= 0,
+	BUS_PACKET_SEQ_FIRST,					// First packet of the APID
+	BUS_PACKET_SEQ_GAP,						// Packets were lost before this one
+	BUS_PACKET_SEQ_DUPLICATE,				// Already received, drop it
+	BUS_PACKET_SEQ_REORDERED,				// Late packet, counted as lost before
+	BUS_PACKET_SEQ_RESYNC,					// Jump out of the flywheel or the window
+	BUS_PACKET_SEQ_DISABLED,				// APID without sequence count
+}bus_packet_seq_event_t;
+
+
+typedef struct
+{
+	uint32_t received;			// Packets received (duplicates are not included)
+	uint32_t lost;				// Packets missing in the gaps and not received later
+	uint32_t gaps;
+	uint32_t duplicates;
+	uint32_t reordered;
+	uint32_t resyncs;
+}bus_packet_seq_stats_t;
+
+
+typedef struct
+{
+	uint16_t expected;			// Next expected sequence count
+	uint8_t started;
+	uint8_t reserved;
+	uint32_t window;			// Bit i: sequence count expected-1-i received
+	bus_packet_seq_stats_t stats;
+}bus_packet_seq_state_t;
+
+
+typedef struct
+{
+	uint32_t enabled[BUS_PACKET_SEQ_APIDS/32];
+	uint16_t count[BUS_PACKET_SEQ_APIDS];		// Next sequence count of every APID
+}bus_packet_seq_tx_t;
+
+
+typedef struct
+{
+	uint32_t flywheel;			// Longest gap counted as lost, longer jumps resync
+	uint32_t enabled[BUS_PACKET_SEQ_APIDS/32];
+	bus_packet_seq_state_t apid[BUS_PACKET_SEQ_APIDS];
+}bus_packet_seq_rx_t;
+
+
+
+
+void bus_packet_SeqTxInit(bus_packet_seq_tx_t *seq);
+void bus_packet_SeqTxEnable(bus_packet_seq_tx_t *seq, uint8_t apid, uint8_t enable);
+HAL_StatusTypeDef bus_packet_SeqEncodePacketize(bus_packet_seq_tx_t *seq, uint8_t type, uint8_t apid, uint8_t ecf_flag, uint8_t *data, uint32_t data_length, uint8_t *buffer_out);
+
+void bus_packet_SeqRxInit(bus_packet_seq_rx_t *seq, uint32_t flywheel);
+void bus_packet_SeqRxEnable(bus_packet_seq_rx_t *seq, uint8_t apid, uint8_t enable);
+bus_packet_seq_event_t bus_packet_SeqTrack(bus_packet_seq_rx_t *seq, uint8_t apid, uint16_t count);
+bus_packet_seq_event_t bus_packet_SeqTrackView(bus_packet_seq_rx_t *seq, const bus_packet_view_t *view);
+void bus_packet_SeqTotals(const bus_packet_seq_rx_t *seq, bus_packet_seq_stats_t *totals);
+
+static inline uint8_t bus_packet_SeqTxEnabled(const bus_packet_seq_tx_t *seq, uint8_t apid) {return (seq->enabled[(apid&0x7F)>>5]>>(apid&0x1F)) & 0x01;}
+static inline uint8_t bus_packet_SeqRxEnabled(const bus_packet_seq_rx_t *seq, uint8_t apid) {return (seq->enabled[(apid&0x7F)>>5]>>(apid&0x1F)) & 0x01;}
+static inline uint16_t bus_packet_SeqGet(const uint8_t *data) {return (data[0]<<8) | data[1];}
+static inline const uint8_t *bus_packet_SeqData(const uint8_t *data) {return &data[BUS_PACKET_SEQ_SIZE];}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_BUS_PACKET_SEQ_H_ */
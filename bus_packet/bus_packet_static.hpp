@@ -0,0 +1,141 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_static.hpp
+  * @brief          : Compile-time encoder for constant bus packets FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		constexpr versions of bus_packet_EncodePacketize() and of the CRC16
+  *		CCSDS used by the ECF. Fixed commands and beacons can be built by the
+  *		compiler and stored in flash, so no header or CRC is computed at run
+  *		time. The output is byte to byte the same as bus_packet_EncodePacketize
+  *		(checked by test/test_bus_packet_static.cpp). Requires C++14 or newer.
+  *
+  *	 Example:
+  *		static constexpr uint8_t beacon_data[] = {100,1,12,234,34,3};
+  *		static constexpr auto beacon = bus_packet::EncodePacketize(
+  *				BUS_PACKET_TYPE_TC, 90, BUS_PACKET_ECF_EXIST, beacon_data);
+  *		HAL_UART_Transmit(&huart, beacon.bytes, beacon.size, 10);
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_BUS_PACKET_STATIC_HPP_
+#define INC_BUS_PACKET_STATIC_HPP_
+
+#include "bus_packet.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace bus_packet
+{
+
+/**
+ * Compute CRC16 CCSDS (Poly 0x1021, without inversion) at compile time
+ * @param buf Pointer to data
+ * @param len Data length
+ * @param seed Initial value of the CRC
+ * @return CRC16
+ */
+constexpr uint16_t CRC16CCSDSCalculate(const uint8_t *buf, std::size_t len, uint16_t seed = 0)
+{
+	uint16_t crc = seed;
+	for (std::size_t count = 0; count < len; count++)
+	{
+		crc ^= static_cast<uint16_t>(buf[count] << 8);
+		for (int i = 0; i < 8; i++)
+			crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+	}
+	return crc;
+}
+
+
+/**
+ * Bus packet built at compile time. Bytes are the same that
+ * bus_packet_EncodePacketize() writes in buffer_out.
+ */
+template <std::size_t DataLength>
+struct StaticPacket
+{
+	static constexpr std::size_t size = DataLength + BUS_PACKET_HEADER_SIZE + BUS_PACKET_ECF_SIZE;
+	uint8_t bytes[size];
+
+	constexpr uint8_t operator[](std::size_t i) const {return bytes[i];}
+};
+
+template <std::size_t DataLength>
+constexpr std::size_t StaticPacket<DataLength>::size;
+
+
+/**
+ * Encode and packetize data at compile time
+ * @param type
+ * 		@arg BUS_PACKET_TYPE_TM if a TM data is contained
+ * 		@arg BUS_PACKET_TYPE_TC if a TC data is contained
+ * @param apid APID number for contained data
+ * @param ecf_flag
+ * 		@arg BUS_PACKET_ECF_NOT_EXIST if an Error Control Field will be not encoded
+ * 		@arg BUS_PACKET_ECF_EXIST if an Error Control Field will be encoded
+ * @param data Array with data that will be encoded
+ * @return Packetized bus packet
+ */
+template <std::size_t DataLength>
+constexpr StaticPacket<DataLength> EncodePacketize(uint8_t type, uint8_t apid, uint8_t ecf_flag, const uint8_t (&data)[DataLength])
+{
+	static_assert(DataLength + BUS_PACKET_HEADER_SIZE + BUS_PACKET_ECF_SIZE <= BUS_PACKET_BUS_SIZE,
+			"Data does not fit in a bus packet");
+
+	StaticPacket<DataLength> packet = {};
+	constexpr std::size_t length = StaticPacket<DataLength>::size;
+
+	packet.bytes[0] = static_cast<uint8_t>((type<<7) | (apid & 0b01111111));
+	packet.bytes[1] = static_cast<uint8_t>((ecf_flag<<7) | (length & 0b01111111));
+
+	for (std::size_t i = 0; i < DataLength; i++)
+		packet.bytes[BUS_PACKET_HEADER_SIZE + i] = data[i];
+
+	if (ecf_flag)	// There is CRC?
+	{
+		uint16_t ecf = CRC16CCSDSCalculate(packet.bytes, length-BUS_PACKET_ECF_SIZE);
+		packet.bytes[length-BUS_PACKET_ECF_SIZE] = static_cast<uint8_t>(ecf>>8);
+		packet.bytes[length-BUS_PACKET_ECF_SIZE+1] = static_cast<uint8_t>(ecf & 0xFF);
+	}
+
+	return packet;
+}
+
+
+/*
+ * Header fields of a packetized buffer, usable in constant expressions
+ */
+constexpr uint8_t GetType(const uint8_t *buffer) {return buffer[0]>>7;}
+constexpr uint8_t GetApid(const uint8_t *buffer) {return buffer[0] & 0b01111111;}
+constexpr uint8_t GetEcfFlag(const uint8_t *buffer) {return (buffer[1] & 0b10000000)>>7;}
+constexpr uint8_t GetLength(const uint8_t *buffer) {return buffer[1] & 0b01111111;}
+
+/**
+ * Check the ECF of a packetized buffer at compile time
+ * @param buffer Data buffer with a bus packet
+ * @return true if there is no ECF or if it is correct
+ */
+constexpr bool CheckECF(const uint8_t *buffer)
+{
+	return !GetEcfFlag(buffer) || (GetLength(buffer) >= BUS_PACKET_HEADER_SIZE + BUS_PACKET_ECF_SIZE &&
+			CRC16CCSDSCalculate(buffer, GetLength(buffer)-BUS_PACKET_ECF_SIZE) ==
+			((buffer[GetLength(buffer)-BUS_PACKET_ECF_SIZE]<<8) | buffer[GetLength(buffer)-BUS_PACKET_ECF_SIZE+1]));
+}
+
+
+} // namespace bus_packet
+
+#endif /* INC_BUS_PACKET_STATIC_HPP_ */
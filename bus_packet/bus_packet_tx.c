@@ -0,0 +1,219 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_tx.c
+  * @brief          : Multi-buffered DMA transmit queue for bus packet FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Bus packets are encoded with their sync marker directly into one of
+  *		BUS_PACKET_TX_SLOTS transmit buffers. While one buffer is being sent
+  *		by the DMA the next ones can be filled, and the transfer complete
+  *		interrupt starts the next buffer back-to-back.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet_tx.h"
+
+#ifndef STM32_MCU
+#include <unistd.h>
+#endif
+
+
+/*
+ * Start the transfer of the oldest buffer. A buffer that cannot be started
+ * is dropped and the next one is tried, so the queue does not stall until
+ * the producer sends again.
+ */
+static void bus_packet_TxStartNext(bus_packet_tx_t *tx)
+{
+	while(tx->count)
+	{
+		if(tx->start(tx->port, tx->buffer[tx->tail], tx->length[tx->tail]) == HAL_OK)
+			return;
+
+		tx->start_errors++;
+		tx->tail = (tx->tail + 1) % BUS_PACKET_TX_SLOTS;
+		tx->count--;
+	}
+	tx->busy = 0;
+}
+
+
+/**
+ * Initialize a transmit queue
+ * @param tx Pointer to the transmit queue
+ * @param start Function that starts the transfer of a buffer
+ * @param port User pointer passed to start (UART handle, simulator...)
+ * @param callback Function called when a transfer is completed, or NULL
+ * @param context User pointer passed to the callback
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_TxInit(bus_packet_tx_t *tx, bus_packet_tx_start_t start, void *port, bus_packet_tx_callback_t callback, void *context)
+{
+	if(tx == NULL || start == NULL)		return HAL_ERROR;
+
+	memset(tx, 0, sizeof(*tx));
+	tx->start = start;
+	tx->port = port;
+	tx->callback = callback;
+	tx->context = context;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Encode and packetize data into the next free transmit buffer and start
+ * the transfer if the line is idle
+ * @param tx Pointer to the transmit queue
+ * @param type
+ * 		@arg BUS_PACKET_TYPE_TM if a TM data is contained
+ * 		@arg BUS_PACKET_TYPE_TC if a TC data is contained
+ * @param apid APID number for contained data
+ * @param ecf_flag
+ * 		@arg BUS_PACKET_ECF_NOT_EXIST if an Error Control Field will be not encoded
+ * 		@arg BUS_PACKET_ECF_EXIST if an Error Control Field will be encoded
+ * @param data Pointer to data that will be encoded
+ * @param data_length Data length
+ * @return HAL status
+ * 		@arg HAL_BUSY if all transmit buffers are in use
+ */
+HAL_StatusTypeDef bus_packet_TxEncodePacketize(bus_packet_tx_t *tx, uint8_t type, uint8_t apid, uint8_t ecf_flag, uint8_t *data, uint32_t data_length)
+{
+	if(tx->count >= BUS_PACKET_TX_SLOTS)
+	{
+		tx->busy_rejects++;
+		return HAL_BUSY;
+	}
+
+	// Only the producer writes head, so the slot can be filled outside the critical section
+	uint32_t slot = tx->head;
+	uint8_t *buffer = tx->buffer[slot];
+
+	memcpy(buffer, BUS_PACKET_FRAME_SYNC, BUS_PACKET_FRAME_SYNC_SIZE);
+	if(bus_packet_EncodePacketize(type, apid, ecf_flag, data, data_length, &buffer[BUS_PACKET_FRAME_SYNC_SIZE]) != HAL_OK)
+		return HAL_ERROR;
+	tx->length[slot] = BUS_PACKET_FRAME_SYNC_SIZE + bus_packet_GetLength(&buffer[BUS_PACKET_FRAME_SYNC_SIZE]);
+
+	BUS_PACKET_TX_ENTER_CRITICAL();
+	tx->head = (slot + 1) % BUS_PACKET_TX_SLOTS;
+	tx->count++;
+	if(!tx->busy)
+	{
+		tx->busy = 1;
+		bus_packet_TxStartNext(tx);
+	}
+	BUS_PACKET_TX_EXIT_CRITICAL();
+
+	return HAL_OK;
+}
+
+
+/**
+ * Release the sent buffer and start the next one. Call it from the transfer
+ * complete interrupt (HAL_UART_TxCpltCallback).
+ * @param tx Pointer to the transmit queue
+ */
+void bus_packet_TxCpltHandler(bus_packet_tx_t *tx)
+{
+	if(!tx->busy || tx->count == 0)		return;
+
+	if(tx->callback != NULL)
+		tx->callback(tx->context, tx->buffer[tx->tail], tx->length[tx->tail]);
+
+	tx->sent++;
+	tx->tail = (tx->tail + 1) % BUS_PACKET_TX_SLOTS;
+	tx->count--;
+
+	bus_packet_TxStartNext(tx);
+}
+
+
+
+
+#ifdef STM32_MCU
+/**
+ * Start function for a UART with DMA
+ * @param port Pointer to the UART handle
+ * @param buffer Buffer to be transmitted
+ * @param length Buffer length
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_TxStartUART(void *port, const uint8_t *buffer, uint32_t length)
+{
+	return HAL_UART_Transmit_DMA((UART_HandleTypeDef *)port, (uint8_t *)buffer, length);
+}
+
+
+#else
+/**
+ * Initialize a simulated UART for a transmit queue. Use bus_packet_TxSimStart
+ * as start function and the simulator as port.
+ * @param sim Pointer to the simulator
+ * @param tx Pointer to the transmit queue
+ * @param fd File descriptor where the transmitted bytes are written, -1 to discard
+ */
+void bus_packet_TxSimInit(bus_packet_tx_sim_t *sim, bus_packet_tx_t *tx, int fd)
+{
+	memset(sim, 0, sizeof(*sim));
+	sim->tx = tx;
+	sim->fd = fd;
+}
+
+
+/**
+ * Start function of the simulated UART
+ * @param port Pointer to the simulator
+ * @param buffer Buffer to be transmitted
+ * @param length Buffer length
+ * @return HAL status
+ */
+HAL_StatusTypeDef bus_packet_TxSimStart(void *port, const uint8_t *buffer, uint32_t length)
+{
+	bus_packet_tx_sim_t *sim = (bus_packet_tx_sim_t *)port;
+
+	if(sim->pending != NULL)	return HAL_BUSY;
+
+	sim->pending = buffer;
+	sim->remaining = length;
+	return HAL_OK;
+}
+
+
+/**
+ * Transmit up to a number of bytes (the line time of a tick) and complete
+ * the transfers that end, as the DMA interrupt would do
+ * @param sim Pointer to the simulator
+ * @param bytes Bytes that the line can transmit in this tick
+ */
+void bus_packet_TxSimTick(bus_packet_tx_sim_t *sim, uint32_t bytes)
+{
+	while(bytes && sim->pending != NULL)
+	{
+		uint32_t n = (sim->remaining < bytes) ? sim->remaining : bytes;
+
+		if(sim->fd >= 0 && write(sim->fd, sim->pending, n) != (ssize_t)n)
+			sim->tx->start_errors++;
+
+		sim->pending += n;
+		sim->remaining -= n;
+		sim->bytes += n;
+		bytes -= n;
+
+		if(sim->remaining == 0)
+		{
+			sim->pending = NULL;
+			bus_packet_TxCpltHandler(sim->tx);
+		}
+	}
+}
+#endif
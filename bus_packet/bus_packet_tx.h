@@ -0,0 +1,130 @@
+/**
+  ******************************************************************************
+  * @file           : bus_packet_tx.h
+  * @brief          : Multi-buffered DMA transmit queue for bus packet FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Bus packets are encoded with their sync marker directly into one of
+  *		BUS_PACKET_TX_SLOTS transmit buffers. While one buffer is being sent
+  *		by the DMA the next ones can be filled, and the transfer complete
+  *		interrupt starts the next buffer back-to-back, so the caller never
+  *		waits for the UART. If all buffers are in use, HAL_BUSY is returned
+  *		(back-pressure) and nothing is overwritten.
+  *
+  *		In a host the UART is emulated with the bus_packet_TxSim backend,
+  *		that transmits a number of bytes per tick.
+  *
+  *	 Example (STM32):
+  *		bus_packet_tx_t tx;
+  *		bus_packet_TxInit(&tx, bus_packet_TxStartUART, &huart1, NULL, NULL);
+  *		if(bus_packet_TxEncodePacketize(&tx, 1, 90, 1, data, 6) != HAL_OK)
+  *			Handle_Busy();
+  *
+  *		void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+  *		{
+  *			bus_packet_TxCpltHandler(&tx);
+  *		}
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_BUS_PACKET_TX_H_
+#define INC_BUS_PACKET_TX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bus_packet.h"
+
+
+#ifndef BUS_PACKET_TX_SLOTS
+#define BUS_PACKET_TX_SLOTS			2
+#endif
+#define BUS_PACKET_TX_SLOT_SIZE		(BUS_PACKET_FRAME_SYNC_SIZE+BUS_PACKET_BUS_SIZE)
+
+// The interrupt mask is restored on exit, so it can be used with interrupts masked
+#ifdef STM32_MCU
+#define BUS_PACKET_TX_ENTER_CRITICAL()	uint32_t bus_packet_tx_primask = __get_PRIMASK(); __disable_irq()
+#define BUS_PACKET_TX_EXIT_CRITICAL()	__set_PRIMASK(bus_packet_tx_primask)
+#else
+#define BUS_PACKET_TX_ENTER_CRITICAL()
+#define BUS_PACKET_TX_EXIT_CRITICAL()
+#endif
+
+
+/*
+ * Starts the transfer of a buffer (for example HAL_UART_Transmit_DMA)
+ */
+typedef HAL_StatusTypeDef (*bus_packet_tx_start_t)(void *port, const uint8_t *buffer, uint32_t length);
+
+/*
+ * Called from the transfer complete context with the sent buffer (sync
+ * marker and bus packet). The buffer is reused after the callback returns.
+ */
+typedef void (*bus_packet_tx_callback_t)(void *context, const uint8_t *buffer, uint32_t length);
+
+
+typedef struct
+{
+	uint8_t buffer[BUS_PACKET_TX_SLOTS][BUS_PACKET_TX_SLOT_SIZE];
+	uint16_t length[BUS_PACKET_TX_SLOTS];
+
+	volatile uint32_t head;		// Next buffer to be filled
+	volatile uint32_t tail;		// Buffer in transfer
+	volatile uint32_t count;	// Buffers filled or in transfer
+	volatile uint8_t busy;
+
+	bus_packet_tx_start_t start;
+	void *port;
+	bus_packet_tx_callback_t callback;
+	void *context;
+
+	uint32_t sent;				// Transfers completed
+	uint32_t busy_rejects;		// Packets rejected because all buffers were in use
+	uint32_t start_errors;		// Transfers that could not be started
+}bus_packet_tx_t;
+
+
+#ifndef STM32_MCU
+typedef struct
+{
+	bus_packet_tx_t *tx;
+	const uint8_t *pending;		// Buffer in transfer
+	uint32_t remaining;			// Bytes of pending not yet transmitted
+	uint64_t bytes;				// Bytes transmitted
+	int fd;						// Where the bytes are written, -1 to discard
+}bus_packet_tx_sim_t;
+#endif
+
+
+
+
+HAL_StatusTypeDef bus_packet_TxInit(bus_packet_tx_t *tx, bus_packet_tx_start_t start, void *port, bus_packet_tx_callback_t callback, void *context);
+HAL_StatusTypeDef bus_packet_TxEncodePacketize(bus_packet_tx_t *tx, uint8_t type, uint8_t apid, uint8_t ecf_flag, uint8_t *data, uint32_t data_length);
+void bus_packet_TxCpltHandler(bus_packet_tx_t *tx);
+
+static inline uint32_t bus_packet_TxFree(bus_packet_tx_t *tx) {return BUS_PACKET_TX_SLOTS - tx->count;}
+
+#ifdef STM32_MCU
+HAL_StatusTypeDef bus_packet_TxStartUART(void *port, const uint8_t *buffer, uint32_t length);
+#else
+void bus_packet_TxSimInit(bus_packet_tx_sim_t *sim, bus_packet_tx_t *tx, int fd);
+HAL_StatusTypeDef bus_packet_TxSimStart(void *port, const uint8_t *buffer, uint32_t length);
+void bus_packet_TxSimTick(bus_packet_tx_sim_t *sim, uint32_t bytes);
+#endif
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_BUS_PACKET_TX_H_ */
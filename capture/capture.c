@@ -0,0 +1,446 @@
+/**
+  ******************************************************************************
+  * @file           : capture.c
+  * @brief          : Capture files of bus packets and TF packets FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		This library is used in the ground station (Linux) to store received
+  *		passes and read them again without searching sync markers.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "capture.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+
+static const uint8_t capture_padding[CAPTURE_ALIGN] = {0};
+
+
+static void capture_IndexPath(const char *path, char *index_path)
+{
+	snprintf(index_path, PATH_MAX, "%s%s", path, CAPTURE_INDEX_SUFFIX);
+}
+
+
+/**
+ * Map a whole file in memory for reading
+ * @param path File path
+ * @param map Pointer where the mapped file is saved
+ * @param size Pointer where the file size is saved
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_MapFile(const char *path, const uint8_t **map, uint64_t *size)
+{
+	struct stat st;
+	int fd = open(path, O_RDONLY);
+
+	if(fd < 0)	return HAL_ERROR;
+	if(fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return HAL_ERROR;
+	}
+
+	void *p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(p == MAP_FAILED)		return HAL_ERROR;
+
+	madvise(p, st.st_size, MADV_WILLNEED);
+	*map = p;
+	*size = st.st_size;
+	return HAL_OK;
+}
+
+
+/**
+ * Unmap a file mapped with capture_MapFile()
+ * @param map Mapped file, or NULL
+ * @param size File size
+ */
+void capture_UnmapFile(const void *map, uint64_t size)
+{
+	if(map != NULL)		munmap((void *)map, size);
+}
+
+
+/**
+ * Walk the records of a mapped capture and save their offsets
+ * @param map Mapped capture file
+ * @param size Capture file size
+ * @param index Array for the offsets, or NULL to count them only
+ * @return Number of complete records
+ */
+static uint64_t capture_WalkRecords(const uint8_t *map, uint64_t size, uint64_t *index)
+{
+	uint64_t offset = ((const capture_file_header_t *)map)->header_size;
+	uint64_t count = 0;
+
+	while(offset + sizeof(capture_record_t) <= size)
+	{
+		const capture_record_t *record = (const capture_record_t *)&map[offset];
+		if(offset + sizeof(capture_record_t) + record->length > size)	break;	// Truncated record
+
+		if(index != NULL)	index[count] = offset;
+		count++;
+		offset += capture_RecordSize(record->length);
+	}
+
+	return count;
+}
+
+
+/**
+ * Check an index file against its mapped capture. Every offset must point to
+ * a complete, aligned record after the capture header, because the reader
+ * uses them without more checks.
+ * @param map Mapped capture file
+ * @param size Capture file size
+ * @param index_map Mapped index file
+ * @param index_size Index file size
+ * @return HAL status
+ */
+static HAL_StatusTypeDef capture_CheckIndex(const uint8_t *map, uint64_t size, const uint8_t *index_map, uint64_t index_size)
+{
+	const capture_index_header_t *index_header = (const capture_index_header_t *)index_map;
+	uint64_t header_size = ((const capture_file_header_t *)map)->header_size;
+
+	if(index_size < sizeof(capture_index_header_t) || index_header->magic != CAPTURE_INDEX_MAGIC ||
+	   index_header->capture_size != size || index_header->header_size < sizeof(capture_index_header_t) ||
+	   index_header->header_size > index_size || index_header->header_size % sizeof(uint64_t) ||
+	   index_header->count > (index_size - index_header->header_size) / sizeof(uint64_t))
+		return HAL_ERROR;
+
+	const uint64_t *index = (const uint64_t *)&index_map[index_header->header_size];
+	for(uint64_t i = 0; i < index_header->count; i++)
+	{
+		if(index[i] < header_size || index[i] % CAPTURE_ALIGN || index[i] > size - sizeof(capture_record_t))
+			return HAL_ERROR;
+
+		const capture_record_t *record = (const capture_record_t *)&map[index[i]];
+		if(record->length > size - index[i] - sizeof(capture_record_t))	return HAL_ERROR;
+	}
+
+	return HAL_OK;
+}
+
+
+/**
+ * Current time to be used as timestamp
+ * @return Nanoseconds since Unix epoch
+ */
+uint64_t capture_TimeNs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+
+
+/**
+ * Create a capture file and its index
+ * @param writer Pointer to the capture writer
+ * @param path Capture file path. The index is <path>.idx
+ * @param link_type
+ * 		@arg CAPTURE_LINK_BUS_PACKET if frames are bus packets
+ * 		@arg CAPTURE_LINK_TF_PACKET if frames are TF packets
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_WriterOpen(capture_writer_t *writer, const char *path, uint8_t link_type)
+{
+	char index_path[PATH_MAX];
+	capture_file_header_t header = {0};
+	capture_index_header_t index_header = {0};
+
+	memset(writer, 0, sizeof(*writer));
+	capture_IndexPath(path, index_path);
+
+	writer->file = fopen(path, "wb");
+	if(writer->file == NULL)	return HAL_ERROR;
+	writer->index_file = fopen(index_path, "wb");
+	if(writer->index_file == NULL)
+	{
+		fclose(writer->file);
+		return HAL_ERROR;
+	}
+
+	header.magic = CAPTURE_MAGIC;
+	header.version = CAPTURE_VERSION;
+	header.header_size = sizeof(header);
+	header.link_type = link_type;
+	header.tf_ecf_size = TF_PACKET_ECF_SIZE;
+	header.created_ns = capture_TimeNs();
+
+	index_header.magic = CAPTURE_INDEX_MAGIC;
+	index_header.version = CAPTURE_VERSION;
+	index_header.header_size = sizeof(index_header);
+
+	if(fwrite(&header, sizeof(header), 1, writer->file) != 1 ||
+	   fwrite(&index_header, sizeof(index_header), 1, writer->index_file) != 1)
+	{
+		fclose(writer->index_file);
+		fclose(writer->file);
+		return HAL_ERROR;
+	}
+
+	tf_packet_ChannelInit(&writer->tf_channel, TF_PACKET_DEFAULT_SCID, 0, TF_PACKET_USLP_MAX_SIZE);
+	writer->offset = sizeof(header);
+	return HAL_OK;
+}
+
+
+/**
+ * Select the ECF of the TF packets of a capture, saved in its header so the
+ * readers check them with the same ECF. Call it before appending frames.
+ * @param writer Pointer to the capture writer
+ * @param ecf_size
+ * 		@arg TF_PACKET_ECF_SIZE for CRC16 (default)
+ * 		@arg TF_PACKET_ECF32_SIZE for CRC32
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_WriterSetTfEcf(capture_writer_t *writer, uint8_t ecf_size)
+{
+	if(writer->count != 0 || tf_packet_ChannelSetEcf(&writer->tf_channel, ecf_size) != HAL_OK)	return HAL_ERROR;
+
+	if(fseek(writer->file, offsetof(capture_file_header_t, tf_ecf_size), SEEK_SET) != 0 ||
+	   fwrite(&ecf_size, sizeof(ecf_size), 1, writer->file) != 1 ||
+	   fseek(writer->file, writer->offset, SEEK_SET) != 0)
+		return HAL_ERROR;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Append a frame to a capture file
+ * @param writer Pointer to the capture writer
+ * @param frame Frame to be saved
+ * @param length Frame length
+ * @param timestamp_ns Receive time (ns since Unix epoch)
+ * @param crc_status
+ * 		@arg CAPTURE_CRC_OK
+ * 		@arg CAPTURE_CRC_ERROR
+ * 		@arg CAPTURE_CRC_UNCHECKED
+ * @param vcid VCID of the frame or CAPTURE_ID_NONE
+ * @param apid APID of the frame or CAPTURE_ID_NONE
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_WriterAppend(capture_writer_t *writer, const uint8_t *frame, uint32_t length, uint64_t timestamp_ns, uint8_t crc_status, uint8_t vcid, uint8_t apid)
+{
+	capture_record_t record = {0};
+	uint64_t size = capture_RecordSize(length);
+
+	record.timestamp_ns = timestamp_ns;
+	record.length = length;
+	record.crc_status = crc_status;
+	record.vcid = vcid;
+	record.apid = apid;
+
+	if(fwrite(&record, sizeof(record), 1, writer->file) != 1)								return HAL_ERROR;
+	if(length && fwrite(frame, length, 1, writer->file) != 1)								return HAL_ERROR;
+	if(size > sizeof(record) + length &&
+	   fwrite(capture_padding, size - sizeof(record) - length, 1, writer->file) != 1)		return HAL_ERROR;
+	if(fwrite(&writer->offset, sizeof(writer->offset), 1, writer->index_file) != 1)		return HAL_ERROR;
+
+	writer->offset += size;
+	writer->count++;
+	return HAL_OK;
+}
+
+
+/**
+ * Append a bus packet or a jumbo bus packet (without sync marker) to a
+ * capture file, checking its ECF
+ * @param writer Pointer to the capture writer
+ * @param buffer Data buffer with a bus packet
+ * @param timestamp_ns Receive time (ns since Unix epoch)
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_WriterAppendBusPacket(capture_writer_t *writer, const uint8_t *buffer, uint64_t timestamp_ns)
+{
+	bus_packet_view_t view;
+	uint8_t crc_status = (bus_packet_DecodeViewJumbo(buffer, bus_packet_GetLength(buffer), &view) == HAL_OK) ? CAPTURE_CRC_OK : CAPTURE_CRC_ERROR;
+
+	return capture_WriterAppend(writer, buffer, bus_packet_GetLength(buffer), timestamp_ns, crc_status, CAPTURE_ID_NONE, buffer[0] & 0b01111111);
+}
+
+
+/**
+ * Append a TF packet to a capture file, checking its ECF (selected with
+ * capture_WriterSetTfEcf())
+ * @param writer Pointer to the capture writer
+ * @param buffer Data buffer with a TF packet
+ * @param length TF packet length
+ * @param timestamp_ns Receive time (ns since Unix epoch)
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_WriterAppendTfPacket(capture_writer_t *writer, const uint8_t *buffer, uint32_t length, uint64_t timestamp_ns)
+{
+	tf_packet_view_t view;
+	uint8_t crc_status = (tf_packet_DecodeViewChannel(&writer->tf_channel, buffer, length, &view) == HAL_OK) ? CAPTURE_CRC_OK : CAPTURE_CRC_ERROR;
+	uint8_t vcid = (length >= TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE) ?
+			((buffer[2] & 0b00000111)<<3) | ((buffer[3] & 0b11100000) >>5) : CAPTURE_ID_NONE;
+
+	return capture_WriterAppend(writer, buffer, length, timestamp_ns, crc_status, vcid, CAPTURE_ID_NONE);
+}
+
+
+/**
+ * Close a capture file and write the number of records in its index
+ * @param writer Pointer to the capture writer
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_WriterClose(capture_writer_t *writer)
+{
+	HAL_StatusTypeDef status = HAL_OK;
+	capture_index_header_t index_header = {0};
+
+	index_header.magic = CAPTURE_INDEX_MAGIC;
+	index_header.version = CAPTURE_VERSION;
+	index_header.header_size = sizeof(index_header);
+	index_header.count = writer->count;
+	index_header.capture_size = writer->offset;
+
+	if(fseek(writer->index_file, 0, SEEK_SET) != 0 ||
+	   fwrite(&index_header, sizeof(index_header), 1, writer->index_file) != 1)	status = HAL_ERROR;
+
+	if(fclose(writer->index_file) != 0)	status = HAL_ERROR;
+	if(fclose(writer->file) != 0)		status = HAL_ERROR;
+
+	memset(writer, 0, sizeof(*writer));
+	return status;
+}
+
+
+
+
+/**
+ * Open a capture file for reading. The capture and its index are mapped in
+ * memory; if the index is not valid, it is rebuilt in memory.
+ * @param reader Pointer to the capture reader
+ * @param path Capture file path
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_ReaderOpen(capture_reader_t *reader, const char *path)
+{
+	char index_path[PATH_MAX];
+	const uint8_t *index_map;
+	uint64_t index_size;
+
+	memset(reader, 0, sizeof(*reader));
+
+	if(capture_MapFile(path, &reader->map, &reader->map_size) != HAL_OK)	return HAL_ERROR;
+	reader->header = (const capture_file_header_t *)reader->map;
+
+	if(reader->map_size < sizeof(capture_file_header_t) || reader->header->magic != CAPTURE_MAGIC ||
+	   reader->header->header_size < sizeof(capture_file_header_t) || reader->header->header_size > reader->map_size ||
+	   reader->header->header_size % CAPTURE_ALIGN)
+	{
+		capture_ReaderClose(reader);
+		return HAL_ERROR;
+	}
+
+	capture_IndexPath(path, index_path);
+	if(capture_MapFile(index_path, &index_map, &index_size) == HAL_OK)
+	{
+		const capture_index_header_t *index_header = (const capture_index_header_t *)index_map;
+
+		reader->index_map = (void *)index_map;
+		reader->index_map_size = index_size;
+
+		if(capture_CheckIndex(reader->map, reader->map_size, index_map, index_size) == HAL_OK)
+		{
+			reader->index = (const uint64_t *)&index_map[index_header->header_size];
+			reader->count = index_header->count;
+			return HAL_OK;
+		}
+	}
+
+	// Missing, unfinished, stale or corrupted index: walk the records
+	reader->count = capture_WalkRecords(reader->map, reader->map_size, NULL);
+	reader->index_owned = malloc((reader->count ? reader->count : 1) * sizeof(uint64_t));
+	if(reader->index_owned == NULL)
+	{
+		capture_ReaderClose(reader);
+		return HAL_ERROR;
+	}
+	capture_WalkRecords(reader->map, reader->map_size, reader->index_owned);
+	reader->index = reader->index_owned;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Close a capture reader
+ * @param reader Pointer to the capture reader
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_ReaderClose(capture_reader_t *reader)
+{
+	capture_UnmapFile(reader->map, reader->map_size);
+	capture_UnmapFile(reader->index_map, reader->index_map_size);
+	free(reader->index_owned);
+
+	memset(reader, 0, sizeof(*reader));
+	return HAL_OK;
+}
+
+
+/**
+ * Rebuild the index file of a capture (for example after a crash of the
+ * writer)
+ * @param path Capture file path
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_BuildIndex(const char *path)
+{
+	char index_path[PATH_MAX];
+	capture_reader_t reader;
+	capture_index_header_t index_header = {0};
+	HAL_StatusTypeDef status = HAL_OK;
+
+	if(capture_ReaderOpen(&reader, path) != HAL_OK)		return HAL_ERROR;
+	if(reader.index_owned == NULL)	// The index is already valid
+		return capture_ReaderClose(&reader);
+
+	capture_IndexPath(path, index_path);
+	FILE *file = fopen(index_path, "wb");
+	if(file == NULL)
+	{
+		capture_ReaderClose(&reader);
+		return HAL_ERROR;
+	}
+
+	index_header.magic = CAPTURE_INDEX_MAGIC;
+	index_header.version = CAPTURE_VERSION;
+	index_header.header_size = sizeof(index_header);
+	index_header.count = reader.count;
+	index_header.capture_size = reader.map_size;
+
+	if(fwrite(&index_header, sizeof(index_header), 1, file) != 1)		status = HAL_ERROR;
+	if(reader.count && fwrite(reader.index, sizeof(uint64_t), reader.count, file) != reader.count)	status = HAL_ERROR;
+	if(fclose(file) != 0)	status = HAL_ERROR;
+
+	capture_ReaderClose(&reader);
+	return status;
+}
@@ -0,0 +1,170 @@
+/**
+  ******************************************************************************
+  * @file           : capture.h
+  * @brief          : Capture files of bus packets and TF packets FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		This library is used in the ground station (Linux) to store received
+  *		passes and read them again without searching sync markers.
+  *
+  *		Capture file (<name>), little endian:
+  *			capture_file_header_t
+  *			capture_record_t + frame + padding to 8 bytes
+  *			capture_record_t + frame + padding to 8 bytes
+  *			...
+  *		Index file (<name>.idx):
+  *			capture_index_header_t
+  *			uint64_t offset of every record in the capture file
+  *
+  *		The reader maps both files with mmap, so any frame is accessed
+  *		directly, without copies. If the index is missing, incomplete or
+  *		does not match the capture it is rebuilt walking the records.
+  *
+  *	 Example:
+  *		capture_writer_t writer;
+  *		capture_WriterOpen(&writer, "pass.ccap", CAPTURE_LINK_TF_PACKET);
+  *		capture_WriterSetTfEcf(&writer, TF_PACKET_ECF32_SIZE);		// Only for CRC32 channels
+  *		capture_WriterAppendTfPacket(&writer, tf_buffer_out, tfph.length, timestamp_ns);
+  *		capture_WriterClose(&writer);
+  *
+  *		capture_reader_t reader;
+  *		if(capture_ReaderOpen(&reader, "pass.ccap") != HAL_OK)
+  *			Error_Handler();
+  *		const capture_record_t *record = capture_GetRecord(&reader, 10);
+  *		tf_packet_DecodeView(capture_GetFrame(record), record->length, &view);
+  *		capture_ReaderClose(&reader);
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_CAPTURE_H_
+#define INC_CAPTURE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bus_packet.h"
+#include "tf_packet.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+#define CAPTURE_MAGIC				0x50414343		// "CCAP"
+#define CAPTURE_INDEX_MAGIC			0x58444943		// "CIDX"
+#define CAPTURE_VERSION				1
+#define CAPTURE_ALIGN				8
+#define CAPTURE_INDEX_SUFFIX		".idx"
+
+#define CAPTURE_LINK_BUS_PACKET		0		// Frames are bus packets (without sync marker)
+#define CAPTURE_LINK_TF_PACKET		1		// Frames are TF packets
+
+#define CAPTURE_CRC_OK				0
+#define CAPTURE_CRC_ERROR			1
+#define CAPTURE_CRC_UNCHECKED		2
+
+#define CAPTURE_ID_NONE				0xFF	// VCID or APID not available
+
+
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t header_size;
+	uint8_t link_type;
+	uint8_t tf_ecf_size;		// ECF of the TF packets, 0 (older captures) is TF_PACKET_ECF_SIZE
+	uint8_t reserved[6];
+	uint64_t created_ns;		// Creation time (ns since Unix epoch)
+}capture_file_header_t;
+
+
+typedef struct
+{
+	uint64_t timestamp_ns;		// Receive time (ns since Unix epoch)
+	uint32_t length;			// Frame length, without padding
+	uint8_t crc_status;
+	uint8_t vcid;
+	uint8_t apid;
+	uint8_t reserved;
+}capture_record_t;
+
+
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t header_size;
+	uint64_t count;				// Number of records
+	uint64_t capture_size;		// Capture file size when the index was written
+}capture_index_header_t;
+
+
+typedef struct
+{
+	FILE *file;
+	FILE *index_file;
+	uint64_t offset;			// Offset of the next record
+	uint64_t count;
+	tf_packet_channel_t tf_channel;		// Checks the ECF of the TF packets
+}capture_writer_t;
+
+
+typedef struct
+{
+	const uint8_t *map;
+	uint64_t map_size;
+	const capture_file_header_t *header;
+
+	const uint64_t *index;		// Offset of every record
+	uint64_t count;
+	void *index_map;			// Mapped index file, or NULL
+	uint64_t index_map_size;
+	uint64_t *index_owned;		// Index rebuilt in memory, or NULL
+}capture_reader_t;
+
+
+
+
+HAL_StatusTypeDef capture_WriterOpen(capture_writer_t *writer, const char *path, uint8_t link_type);
+HAL_StatusTypeDef capture_WriterSetTfEcf(capture_writer_t *writer, uint8_t ecf_size);
+HAL_StatusTypeDef capture_WriterAppend(capture_writer_t *writer, const uint8_t *frame, uint32_t length, uint64_t timestamp_ns, uint8_t crc_status, uint8_t vcid, uint8_t apid);
+HAL_StatusTypeDef capture_WriterAppendBusPacket(capture_writer_t *writer, const uint8_t *buffer, uint64_t timestamp_ns);
+HAL_StatusTypeDef capture_WriterAppendTfPacket(capture_writer_t *writer, const uint8_t *buffer, uint32_t length, uint64_t timestamp_ns);
+HAL_StatusTypeDef capture_WriterClose(capture_writer_t *writer);
+
+HAL_StatusTypeDef capture_ReaderOpen(capture_reader_t *reader, const char *path);
+HAL_StatusTypeDef capture_ReaderClose(capture_reader_t *reader);
+HAL_StatusTypeDef capture_BuildIndex(const char *path);
+
+uint64_t capture_TimeNs(void);
+HAL_StatusTypeDef capture_MapFile(const char *path, const uint8_t **map, uint64_t *size);
+void capture_UnmapFile(const void *map, uint64_t size);
+
+static inline const capture_record_t *capture_GetRecord(const capture_reader_t *reader, uint64_t i)
+{
+	return (const capture_record_t *)&reader->map[reader->index[i]];
+}
+
+static inline const uint8_t *capture_GetFrame(const capture_record_t *record) {return (const uint8_t *)(record + 1);}
+static inline uint8_t capture_GetTfEcfSize(const capture_reader_t *reader) {return (reader->header->tf_ecf_size == TF_PACKET_ECF32_SIZE) ? TF_PACKET_ECF32_SIZE : TF_PACKET_ECF_SIZE;}
+
+static inline uint64_t capture_RecordSize(uint32_t length)
+{
+	return (sizeof(capture_record_t) + length + CAPTURE_ALIGN - 1) & ~(uint64_t)(CAPTURE_ALIGN - 1);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_CAPTURE_H_ */
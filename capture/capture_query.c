@@ -0,0 +1,349 @@
+/**
+  ******************************************************************************
+  * @file           : capture_query.c
+  * @brief          : APID and VCID index of capture files FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		This library is used in the ground station (Linux) to get the
+  *		records of one APID or VCID of an archived capture without decoding
+  *		every frame.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "capture_query.h"
+
+#include <limits.h>
+#include <stdlib.h>
+
+
+typedef struct
+{
+	uint8_t *data;
+	uint64_t size;
+	uint64_t capacity;
+	capture_posting_skip_t *skip;
+	uint64_t skip_count;
+	uint64_t base;
+	uint64_t count;
+	uint64_t min_ns;
+	uint64_t max_ns;
+}capture_posting_builder_t;
+
+
+static void capture_QueryPath(const char *path, char *query_path)
+{
+	snprintf(query_path, PATH_MAX, "%s%s", path, CAPTURE_QUERY_SUFFIX);
+}
+
+
+static HAL_StatusTypeDef capture_PostingAdd(capture_posting_builder_t *list, uint64_t record, uint64_t timestamp_ns)
+{
+	uint64_t delta = record + 1 - list->base;
+
+	if(list->size + 10 > list->capacity)	// Longest varint of 64 bits
+	{
+		uint64_t capacity = list->capacity ? list->capacity * 2 : 4096;
+		uint8_t *data = realloc(list->data, capacity);
+		if(data == NULL)	return HAL_ERROR;
+		list->data = data;
+		list->capacity = capacity;
+	}
+
+	if(list->count % CAPTURE_QUERY_SKIP_INTERVAL == 0)
+	{
+		capture_posting_skip_t *skip = realloc(list->skip, (list->skip_count + 1) * sizeof(capture_posting_skip_t));
+		if(skip == NULL)	return HAL_ERROR;
+		list->skip = skip;
+		list->skip[list->skip_count].base = list->base;
+		list->skip[list->skip_count].timestamp_ns = timestamp_ns;
+		list->skip[list->skip_count].data_pos = list->size;
+		list->skip_count++;
+	}
+
+	while(delta >= 0x80)
+	{
+		list->data[list->size++] = (delta & 0x7F) | 0x80;
+		delta >>= 7;
+	}
+	list->data[list->size++] = delta;
+
+	// Timestamps may go back in the capture: keep the earliest and the latest
+	if(list->count == 0 || timestamp_ns < list->min_ns)	list->min_ns = timestamp_ns;
+	if(list->count == 0 || timestamp_ns > list->max_ns)	list->max_ns = timestamp_ns;
+	list->base = record + 1;
+	list->count++;
+	return HAL_OK;
+}
+
+
+static inline uint64_t capture_VarintRead(const uint8_t **data, const uint8_t *end)
+{
+	const uint8_t *p = *data;
+	uint64_t value = 0;
+	uint32_t shift = 0;
+
+	while(p < end && shift < 64)
+	{
+		uint8_t byte = *p++;
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		if(!(byte & 0x80))	break;
+		shift += 7;
+	}
+
+	*data = p;
+	return value;
+}
+
+
+/**
+ * Build the APID and VCID index of a capture and save it in <path>.apx
+ * @param reader Pointer to the opened capture
+ * @param path Capture file path
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_QueryBuild(const capture_reader_t *reader, const char *path)
+{
+	char query_path[PATH_MAX];
+	capture_posting_builder_t *builder;
+	capture_posting_list_t lists[CAPTURE_QUERY_LISTS] = {0};
+	capture_query_header_t header = {0};
+	HAL_StatusTypeDef status = HAL_OK;
+	uint64_t last_ns = 0;
+	uint32_t i;
+
+	builder = calloc(CAPTURE_QUERY_LISTS, sizeof(capture_posting_builder_t));
+	if(builder == NULL)		return HAL_ERROR;
+
+	header.magic = CAPTURE_QUERY_MAGIC;
+	header.version = CAPTURE_QUERY_VERSION;
+	header.header_size = sizeof(header);
+	header.capture_size = reader->map_size;
+	header.count = reader->count;
+	header.lists = CAPTURE_QUERY_LISTS;
+	header.flags = CAPTURE_QUERY_FLAG_SORTED;
+
+	for(uint64_t n = 0; n < reader->count && status == HAL_OK; n++)
+	{
+		const capture_record_t *record = capture_GetRecord(reader, n);
+
+		if(record->timestamp_ns < last_ns)	header.flags &= ~CAPTURE_QUERY_FLAG_SORTED;
+		last_ns = record->timestamp_ns;
+
+		if(record->apid != CAPTURE_ID_NONE)
+			status = capture_PostingAdd(&builder[CAPTURE_QUERY_APID(record->apid)], n, record->timestamp_ns);
+		if(record->vcid != CAPTURE_ID_NONE && status == HAL_OK)
+			status = capture_PostingAdd(&builder[CAPTURE_QUERY_VCID(record->vcid)], n, record->timestamp_ns);
+	}
+
+	if(status == HAL_OK)
+	{
+		uint64_t offset = sizeof(header) + sizeof(lists);
+
+		for(i = 0; i < CAPTURE_QUERY_LISTS; i++)
+		{
+			lists[i].count = builder[i].count;
+			lists[i].min_ns = builder[i].min_ns;
+			lists[i].max_ns = builder[i].max_ns;
+			lists[i].skip_offset = offset;
+			offset += builder[i].skip_count * sizeof(capture_posting_skip_t);
+		}
+		for(i = 0; i < CAPTURE_QUERY_LISTS; i++)
+		{
+			lists[i].data_offset = offset;
+			lists[i].data_size = builder[i].size;
+			offset += builder[i].size;
+		}
+
+		capture_QueryPath(path, query_path);
+		FILE *file = fopen(query_path, "wb");
+		if(file == NULL)	status = HAL_ERROR;
+		else
+		{
+			if(fwrite(&header, sizeof(header), 1, file) != 1 ||
+			   fwrite(lists, sizeof(lists), 1, file) != 1)		status = HAL_ERROR;
+			for(i = 0; i < CAPTURE_QUERY_LISTS && status == HAL_OK; i++)
+				if(builder[i].skip_count &&
+				   fwrite(builder[i].skip, sizeof(capture_posting_skip_t), builder[i].skip_count, file) != builder[i].skip_count)
+					status = HAL_ERROR;
+			for(i = 0; i < CAPTURE_QUERY_LISTS && status == HAL_OK; i++)
+				if(builder[i].size && fwrite(builder[i].data, builder[i].size, 1, file) != 1)
+					status = HAL_ERROR;
+			if(fclose(file) != 0)	status = HAL_ERROR;
+		}
+	}
+
+	for(i = 0; i < CAPTURE_QUERY_LISTS; i++)
+	{
+		free(builder[i].data);
+		free(builder[i].skip);
+	}
+	free(builder);
+	return status;
+}
+
+
+static uint8_t capture_QueryValid(const capture_query_index_t *index, const capture_reader_t *reader)
+{
+	const capture_query_header_t *header = (const capture_query_header_t *)index->map;
+
+	if(index->map_size < sizeof(capture_query_header_t) + CAPTURE_QUERY_LISTS * sizeof(capture_posting_list_t))	return 0;
+	if(header->magic != CAPTURE_QUERY_MAGIC || header->version != CAPTURE_QUERY_VERSION ||
+	   header->header_size != sizeof(capture_query_header_t) || header->lists != CAPTURE_QUERY_LISTS)			return 0;
+	if(header->capture_size != reader->map_size || header->count != reader->count)								return 0;
+
+	const capture_posting_list_t *lists = (const capture_posting_list_t *)&index->map[header->header_size];
+	for(uint32_t i = 0; i < CAPTURE_QUERY_LISTS; i++)
+	{
+		uint64_t skip_count = (lists[i].count + CAPTURE_QUERY_SKIP_INTERVAL - 1) / CAPTURE_QUERY_SKIP_INTERVAL;
+
+		if(lists[i].count > header->count ||
+		   lists[i].skip_offset > index->map_size ||
+		   skip_count * sizeof(capture_posting_skip_t) > index->map_size - lists[i].skip_offset ||
+		   lists[i].data_offset > index->map_size ||
+		   lists[i].data_size > index->map_size - lists[i].data_offset)											return 0;
+	}
+
+	return 1;
+}
+
+
+/**
+ * Open the APID and VCID index of a capture. If <path>.apx is missing or
+ * does not match the capture, it is built again.
+ * @param index Pointer to the index
+ * @param path Capture file path
+ * @param reader Pointer to the opened capture
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_QueryOpen(capture_query_index_t *index, const char *path, const capture_reader_t *reader)
+{
+	char query_path[PATH_MAX];
+
+	memset(index, 0, sizeof(*index));
+	capture_QueryPath(path, query_path);
+
+	for(uint8_t retry = 0; retry < 2; retry++)
+	{
+		if(capture_MapFile(query_path, &index->map, &index->map_size) == HAL_OK)
+		{
+			if(capture_QueryValid(index, reader))
+			{
+				index->header = (const capture_query_header_t *)index->map;
+				index->lists = (const capture_posting_list_t *)&index->map[index->header->header_size];
+				return HAL_OK;
+			}
+			capture_QueryClose(index);
+		}
+
+		if(retry == 0 && capture_QueryBuild(reader, path) != HAL_OK)	break;
+	}
+
+	return HAL_ERROR;
+}
+
+
+/**
+ * Close the index of a capture
+ * @param index Pointer to the index
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_QueryClose(capture_query_index_t *index)
+{
+	capture_UnmapFile(index->map, index->map_size);
+	memset(index, 0, sizeof(*index));
+	return HAL_OK;
+}
+
+
+/**
+ * Start a query of the records of one APID or VCID in a time range
+ * @param query Pointer to the query
+ * @param index Pointer to the opened index
+ * @param reader Pointer to the opened capture of the index
+ * @param list List to be read
+ * 		@arg CAPTURE_QUERY_APID(apid)
+ * 		@arg CAPTURE_QUERY_VCID(vcid)
+ * @param from_ns First receive time (ns since Unix epoch), included
+ * @param to_ns Last receive time (ns since Unix epoch), included
+ * @return HAL status
+ */
+HAL_StatusTypeDef capture_QueryStart(capture_query_t *query, const capture_query_index_t *index, const capture_reader_t *reader,
+									 uint32_t list, uint64_t from_ns, uint64_t to_ns)
+{
+	memset(query, 0, sizeof(*query));
+	if(list >= CAPTURE_QUERY_LISTS || from_ns > to_ns)		return HAL_ERROR;
+
+	const capture_posting_list_t *posting = &index->lists[list];
+	const capture_posting_skip_t *skip = (const capture_posting_skip_t *)&index->map[posting->skip_offset];
+	uint64_t skip_count = (posting->count + CAPTURE_QUERY_SKIP_INTERVAL - 1) / CAPTURE_QUERY_SKIP_INTERVAL;
+	uint64_t k = 0;
+
+	query->reader = reader;
+	query->data = &index->map[posting->data_offset];
+	query->end = query->data + posting->data_size;
+	query->from_ns = from_ns;
+	query->to_ns = to_ns;
+	query->sorted = (index->header->flags & CAPTURE_QUERY_FLAG_SORTED) != 0;
+
+	// The whole list is out of the time range
+	if(posting->count == 0 || posting->max_ns < from_ns || posting->min_ns > to_ns)
+		return HAL_OK;
+
+	if(query->sorted && skip_count)
+	{
+		// Last skip entry before from_ns
+		uint64_t low = 0, high = skip_count;
+		while(high - low > 1)
+		{
+			uint64_t mid = (low + high) / 2;
+			if(skip[mid].timestamp_ns < from_ns)	low = mid;
+			else									high = mid;
+		}
+		k = low;
+	}
+
+	if(skip_count)
+	{
+		query->data += skip[k].data_pos;
+		query->base = skip[k].base;
+	}
+	query->remaining = posting->count - k * CAPTURE_QUERY_SKIP_INTERVAL;
+	return HAL_OK;
+}
+
+
+/**
+ * Get the next record of a query. Its record number is saved in query->record.
+ * @param query Pointer to the query
+ * @return Pointer to the record, or NULL at the end of the query
+ */
+const capture_record_t *capture_QueryNext(capture_query_t *query)
+{
+	while(query->remaining && query->data < query->end)
+	{
+		query->base += capture_VarintRead(&query->data, query->end);
+		query->remaining--;
+
+		if(query->base == 0 || query->base > query->reader->count)	break;	// Corrupted list
+
+		const capture_record_t *record = capture_GetRecord(query->reader, query->base - 1);
+		if(record->timestamp_ns > query->to_ns && query->sorted)	break;
+		if(record->timestamp_ns < query->from_ns || record->timestamp_ns > query->to_ns)	continue;
+
+		query->record = query->base - 1;
+		return record;
+	}
+
+	query->remaining = 0;
+	return NULL;
+}
@@ -0,0 +1,150 @@
+/**
+  ******************************************************************************
+  * @file           : capture_query.h
+  * @brief          : APID and VCID index of capture files FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		This library is used in the ground station (Linux) to get the
+  *		records of one APID or VCID of an archived capture without decoding
+  *		every frame.
+  *
+  *		There is a posting list for every APID and every VCID with the
+  *		numbers of the records that contain it. Every number + 1 is saved as
+  *		the difference with the previous one in a LEB128 varint (one byte
+  *		for near records), with the time range of the list and a skip entry
+  *		every CAPTURE_QUERY_SKIP_INTERVAL records to start a time query
+  *		without decoding the list from the beginning.
+  *
+  *		Query file (<name>.apx), little endian:
+  *			capture_query_header_t
+  *			capture_posting_list_t [CAPTURE_QUERY_LISTS]
+  *			capture_posting_skip_t of every list
+  *			varints of every list
+  *
+  *	 Example:
+  *		capture_query_index_t index;
+  *		capture_query_t query;
+  *		const capture_record_t *record;
+  *
+  *		capture_ReaderOpen(&reader, "pass.ccap");
+  *		if(capture_QueryOpen(&index, "pass.ccap", &reader) != HAL_OK)
+  *			Error_Handler();
+  *		capture_QueryStart(&query, &index, &reader, CAPTURE_QUERY_APID(90), from_ns, to_ns);
+  *		while((record = capture_QueryNext(&query)) != NULL)
+  *			bus_packet_DecodeView(capture_GetFrame(record), record->length, &view);
+  *		capture_QueryClose(&index);
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_CAPTURE_QUERY_H_
+#define INC_CAPTURE_QUERY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "capture.h"
+
+#include <stdint.h>
+
+
+#define CAPTURE_QUERY_MAGIC				0x58504143		// "CAPX"
+#define CAPTURE_QUERY_VERSION			2				// Older .apx files are built again
+#define CAPTURE_QUERY_SUFFIX			".apx"
+
+#define CAPTURE_QUERY_APIDS				128
+#define CAPTURE_QUERY_VCIDS				64
+#define CAPTURE_QUERY_LISTS				(CAPTURE_QUERY_APIDS + CAPTURE_QUERY_VCIDS)
+#define CAPTURE_QUERY_APID(apid)		((apid) & 0b01111111)
+#define CAPTURE_QUERY_VCID(vcid)		(CAPTURE_QUERY_APIDS + ((vcid) & 0b00111111))
+
+#define CAPTURE_QUERY_SKIP_INTERVAL		256
+#define CAPTURE_QUERY_TIME_ALL			0, UINT64_MAX	// from_ns, to_ns of a query without time range
+
+#define CAPTURE_QUERY_FLAG_SORTED		0x01	// Timestamps of the capture never go back
+
+
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t header_size;
+	uint64_t capture_size;		// Capture file size when the index was written
+	uint64_t count;				// Number of records of the capture
+	uint32_t lists;				// CAPTURE_QUERY_LISTS
+	uint32_t flags;
+}capture_query_header_t;
+
+
+typedef struct
+{
+	uint64_t count;				// Number of records
+	uint64_t min_ns;			// Earliest and latest timestamps of the records
+	uint64_t max_ns;
+	uint64_t skip_offset;		// File offset of the skip entries
+	uint64_t data_offset;		// File offset of the varints
+	uint64_t data_size;
+}capture_posting_list_t;
+
+
+typedef struct
+{
+	uint64_t base;				// Record number + 1 before the entry
+	uint64_t timestamp_ns;		// Timestamp of the entry
+	uint64_t data_pos;			// Position of its varint in the list
+}capture_posting_skip_t;
+
+
+typedef struct
+{
+	const uint8_t *map;
+	uint64_t map_size;
+	const capture_query_header_t *header;
+	const capture_posting_list_t *lists;
+}capture_query_index_t;
+
+
+typedef struct
+{
+	const capture_reader_t *reader;
+	const uint8_t *data;		// Next varint
+	const uint8_t *end;
+	uint64_t record;			// Number of the last record returned
+	uint64_t base;				// record + 1, base of the next varint
+	uint64_t remaining;			// Records of the list not read
+	uint64_t from_ns;
+	uint64_t to_ns;
+	uint8_t sorted;
+}capture_query_t;
+
+
+
+
+HAL_StatusTypeDef capture_QueryBuild(const capture_reader_t *reader, const char *path);
+HAL_StatusTypeDef capture_QueryOpen(capture_query_index_t *index, const char *path, const capture_reader_t *reader);
+HAL_StatusTypeDef capture_QueryClose(capture_query_index_t *index);
+
+HAL_StatusTypeDef capture_QueryStart(capture_query_t *query, const capture_query_index_t *index, const capture_reader_t *reader,
+									 uint32_t list, uint64_t from_ns, uint64_t to_ns);
+const capture_record_t *capture_QueryNext(capture_query_t *query);
+
+static inline uint64_t capture_QueryCount(const capture_query_index_t *index, uint32_t list)
+{
+	return (list < CAPTURE_QUERY_LISTS) ? index->lists[list].count : 0;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_CAPTURE_QUERY_H_ */
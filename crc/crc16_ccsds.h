@@ -0,0 +1,154 @@
+/**
+  ******************************************************************************
+  * @file           : crc16_ccsds.h
+  * @brief          : CRC16 CCSDS backends for bus packet and TF FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		CRC16 CCSDS used as ECF by bus packets and TF packets. Each way to
+  *		compute the CRC is a backend (a table of function pointers), so the
+  *		same sources can be built for the MCU and for a host and every target
+  *		uses the fastest CRC available:
+  *			- CRC16_CCSDS_STM32:	STM32 CRC peripheral (only with STM32_MCU)
+  *			- CRC16_CCSDS_BITWISE:	Bit to bit, without tables
+  *			- CRC16_CCSDS_TABLE:	One byte per step, 512 bytes table
+  *			- CRC16_CCSDS_SLICE8:	Eight bytes per step, 4 KB of const tables
+  *			- CRC16_CCSDS_PCLMUL:	Sixteen bytes per step with carry-less
+  *									multiply (only x86-64 with PCLMULQDQ)
+  *
+  *		CRC16 CCSDS has no init value nor final XOR here, so it is linear
+  *		and crc16_ccsds_Patch() updates a CRC when a few bytes change (a
+  *		header field) without reading the rest of the data.
+  *		crc16_ccsds_CorrectBit() locates and corrects a single bit error
+  *		from the syndrome of a codeword up to 4095 bytes.
+  *
+  *		The default backend is selected in the build with
+  *		-DCRC16_CCSDS_DEFAULT_BACKEND=<backend> and can be changed at init:
+  *			crc16_ccsds_SetBackend(crc16_ccsds_GetFastest());
+  *
+  *		STM32_MCU must be defined in the build (-DSTM32_MCU) for the MCU
+  *		target and left undefined for the host target.
+  *
+  *	 Warning:
+  *		With STM32, define your own CRC handle and make sure that is correctly
+  *		configured:
+  *	  		crc16_ccsds_STM32Config();
+  *
+  *	  	- Poly 16 bits: X^16 + X^12 + X^5 + 1
+  *	  	- 8 bits input
+  *	  	- Input and output without bit inversion
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_CRC16_CCSDS_H_
+#define INC_CRC16_CCSDS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifdef STM32_MCU
+#include "main.h"
+#endif
+
+#include <stdint.h>
+
+
+#ifdef STM32_MCU
+extern CRC_HandleTypeDef hcrc;  // In STM32, define your own CRC handle
+#endif
+
+
+#ifndef STM32_MCU
+#define HAL_OK      0x00
+#define HAL_ERROR   0x01
+#define HAL_BUSY    0x02
+#define HAL_TIMEOUT 0x03
+#define HAL_StatusTypeDef uint8_t
+#endif
+
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define CRC16_CCSDS_HAS_PCLMUL
+#endif
+
+#define CRC16_CCSDS_CORRECT_MAX_BITS	32767		// Order of x mod P
+#define CRC16_CCSDS_CORRECT_MAX_SIZE	(CRC16_CCSDS_CORRECT_MAX_BITS/8)
+
+#ifndef CRC16_CCSDS_DEFAULT_BACKEND
+#ifdef STM32_MCU
+#define CRC16_CCSDS_DEFAULT_BACKEND		CRC16_CCSDS_STM32
+#else
+#define CRC16_CCSDS_DEFAULT_BACKEND		CRC16_CCSDS_SLICE8
+#endif
+#endif
+
+
+typedef struct
+{
+	const char *name;
+	HAL_StatusTypeDef (*init)(void);	// Optional, called by crc16_ccsds_SetBackend()
+	uint8_t (*is_supported)(void);		// Optional, NULL if it is always supported
+	uint16_t (*calculate)(uint16_t seed, const uint8_t *buf, uint32_t len);
+}crc16_ccsds_backend_t;
+
+
+extern const crc16_ccsds_backend_t CRC16_CCSDS_BITWISE;
+extern const crc16_ccsds_backend_t CRC16_CCSDS_TABLE;
+extern const crc16_ccsds_backend_t CRC16_CCSDS_SLICE8;
+#ifdef CRC16_CCSDS_HAS_PCLMUL
+extern const crc16_ccsds_backend_t CRC16_CCSDS_PCLMUL;
+#endif
+#ifdef STM32_MCU
+extern const crc16_ccsds_backend_t CRC16_CCSDS_STM32;
+#endif
+
+extern const uint16_t CRC16_CCSDS_TABLE_8[256];
+extern const uint16_t CRC16_CCSDS_SHIFT_8[32];
+extern const crc16_ccsds_backend_t *crc16_ccsds_backend;
+
+
+
+
+HAL_StatusTypeDef crc16_ccsds_SetBackend(const crc16_ccsds_backend_t *backend);
+const crc16_ccsds_backend_t *crc16_ccsds_GetFastest(void);
+
+uint16_t crc16_ccsds_Shift(uint16_t crc, uint32_t zero_bytes);
+uint16_t crc16_ccsds_Patch(uint16_t crc, uint32_t length, uint32_t offset, const uint8_t *old_data, const uint8_t *new_data, uint32_t patch_length);
+
+HAL_StatusTypeDef crc16_ccsds_CorrectBit(uint8_t *buffer, uint32_t length, uint16_t syndrome);
+#ifndef STM32_MCU
+HAL_StatusTypeDef crc16_ccsds_SyndromeInit(void);
+#endif
+
+#ifdef STM32_MCU
+HAL_StatusTypeDef crc16_ccsds_STM32Config(void);
+#endif
+
+/**
+ * Compute CRC16 CCSDS with the selected backend
+ * @param seed Initial value of the CRC (0 for bus packets and TF packets)
+ * @param buf Pointer to data
+ * @param len Data length
+ * @return CRC16
+ */
+static inline uint16_t crc16_ccsds_Calculate(uint16_t seed, const uint8_t *buf, uint32_t len)
+{
+	return crc16_ccsds_backend->calculate(seed, buf, len);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_CRC16_CCSDS_H_ */
@@ -0,0 +1,575 @@
+/**
+  ******************************************************************************
+  * @file           : crc32_ccsds.c
+  * @brief          : CRC32 CCSDS backends for TF FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		CRC32 of the 32-bit FECF of USLP TF packets. Each way to compute the
+  *		CRC is a backend, as in crc16_ccsds.c.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "crc32_ccsds.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#ifdef CRC16_CCSDS_HAS_PCLMUL
+#include <immintrin.h>
+#endif
+
+
+/*
+ * CRC32 CCSDS of every byte value (Poly 0x00A00805, without inversion)
+ */
+const uint32_t CRC32_CCSDS_TABLE_8[256] =
+{
+	0x00000000, 0x00A00805, 0x0140100A, 0x01E0180F, 0x02802014, 0x02202811, 0x03C0301E, 0x0360381B,
+	0x05004028, 0x05A0482D, 0x04405022, 0x04E05827, 0x0780603C, 0x07206839, 0x06C07036, 0x06607833,
+	0x0A008050, 0x0AA08855, 0x0B40905A, 0x0BE0985F, 0x0880A044, 0x0820A841, 0x09C0B04E, 0x0960B84B,
+	0x0F00C078, 0x0FA0C87D, 0x0E40D072, 0x0EE0D877, 0x0D80E06C, 0x0D20E869, 0x0CC0F066, 0x0C60F863,
+	0x140100A0, 0x14A108A5, 0x154110AA, 0x15E118AF, 0x168120B4, 0x162128B1, 0x17C130BE, 0x176138BB,
+	0x11014088, 0x11A1488D, 0x10415082, 0x10E15887, 0x1381609C, 0x13216899, 0x12C17096, 0x12617893,
+	0x1E0180F0, 0x1EA188F5, 0x1F4190FA, 0x1FE198FF, 0x1C81A0E4, 0x1C21A8E1, 0x1DC1B0EE, 0x1D61B8EB,
+	0x1B01C0D8, 0x1BA1C8DD, 0x1A41D0D2, 0x1AE1D8D7, 0x1981E0CC, 0x1921E8C9, 0x18C1F0C6, 0x1861F8C3,
+	0x28020140, 0x28A20945, 0x2942114A, 0x29E2194F, 0x2A822154, 0x2A222951, 0x2BC2315E, 0x2B62395B,
+	0x2D024168, 0x2DA2496D, 0x2C425162, 0x2CE25967, 0x2F82617C, 0x2F226979, 0x2EC27176, 0x2E627973,
+	0x22028110, 0x22A28915, 0x2342911A, 0x23E2991F, 0x2082A104, 0x2022A901, 0x21C2B10E, 0x2162B90B,
+	0x2702C138, 0x27A2C93D, 0x2642D132, 0x26E2D937, 0x2582E12C, 0x2522E929, 0x24C2F126, 0x2462F923,
+	0x3C0301E0, 0x3CA309E5, 0x3D4311EA, 0x3DE319EF, 0x3E8321F4, 0x3E2329F1, 0x3FC331FE, 0x3F6339FB,
+	0x390341C8, 0x39A349CD, 0x384351C2, 0x38E359C7, 0x3B8361DC, 0x3B2369D9, 0x3AC371D6, 0x3A6379D3,
+	0x360381B0, 0x36A389B5, 0x374391BA, 0x37E399BF, 0x3483A1A4, 0x3423A9A1, 0x35C3B1AE, 0x3563B9AB,
+	0x3303C198, 0x33A3C99D, 0x3243D192, 0x32E3D997, 0x3183E18C, 0x3123E989, 0x30C3F186, 0x3063F983,
+	0x50040280, 0x50A40A85, 0x5144128A, 0x51E41A8F, 0x52842294, 0x52242A91, 0x53C4329E, 0x53643A9B,
+	0x550442A8, 0x55A44AAD, 0x544452A2, 0x54E45AA7, 0x578462BC, 0x57246AB9, 0x56C472B6, 0x56647AB3,
+	0x5A0482D0, 0x5AA48AD5, 0x5B4492DA, 0x5BE49ADF, 0x5884A2C4, 0x5824AAC1, 0x59C4B2CE, 0x5964BACB,
+	0x5F04C2F8, 0x5FA4CAFD, 0x5E44D2F2, 0x5EE4DAF7, 0x5D84E2EC, 0x5D24EAE9, 0x5CC4F2E6, 0x5C64FAE3,
+	0x44050220, 0x44A50A25, 0x4545122A, 0x45E51A2F, 0x46852234, 0x46252A31, 0x47C5323E, 0x47653A3B,
+	0x41054208, 0x41A54A0D, 0x40455202, 0x40E55A07, 0x4385621C, 0x43256A19, 0x42C57216, 0x42657A13,
+	0x4E058270, 0x4EA58A75, 0x4F45927A, 0x4FE59A7F, 0x4C85A264, 0x4C25AA61, 0x4DC5B26E, 0x4D65BA6B,
+	0x4B05C258, 0x4BA5CA5D, 0x4A45D252, 0x4AE5DA57, 0x4985E24C, 0x4925EA49, 0x48C5F246, 0x4865FA43,
+	0x780603C0, 0x78A60BC5, 0x794613CA, 0x79E61BCF, 0x7A8623D4, 0x7A262BD1, 0x7BC633DE, 0x7B663BDB,
+	0x7D0643E8, 0x7DA64BED, 0x7C4653E2, 0x7CE65BE7, 0x7F8663FC, 0x7F266BF9, 0x7EC673F6, 0x7E667BF3,
+	0x72068390, 0x72A68B95, 0x7346939A, 0x73E69B9F, 0x7086A384, 0x7026AB81, 0x71C6B38E, 0x7166BB8B,
+	0x7706C3B8, 0x77A6CBBD, 0x7646D3B2, 0x76E6DBB7, 0x7586E3AC, 0x7526EBA9, 0x74C6F3A6, 0x7466FBA3,
+	0x6C070360, 0x6CA70B65, 0x6D47136A, 0x6DE71B6F, 0x6E872374, 0x6E272B71, 0x6FC7337E, 0x6F673B7B,
+	0x69074348, 0x69A74B4D, 0x68475342, 0x68E75B47, 0x6B87635C, 0x6B276B59, 0x6AC77356, 0x6A677B53,
+	0x66078330, 0x66A78B35, 0x6747933A, 0x67E79B3F, 0x6487A324, 0x6427AB21, 0x65C7B32E, 0x6567BB2B,
+	0x6307C318, 0x63A7CB1D, 0x6247D312, 0x62E7DB17, 0x6187E30C, 0x6127EB09, 0x60C7F306, 0x6067FB03,
+};
+
+const crc32_ccsds_backend_t *crc32_ccsds_backend = &CRC32_CCSDS_DEFAULT_BACKEND;
+
+
+/**
+ * Select the backend used by crc32_ccsds_Calculate()
+ * @param backend Pointer to the backend
+ * @return HAL status
+ */
+HAL_StatusTypeDef crc32_ccsds_SetBackend(const crc32_ccsds_backend_t *backend)
+{
+	if(backend == NULL || backend->calculate == NULL)				return HAL_ERROR;
+	if(backend->is_supported != NULL && !backend->is_supported())	return HAL_ERROR;
+	if(backend->init != NULL && backend->init() != HAL_OK)			return HAL_ERROR;
+
+	crc32_ccsds_backend = backend;
+	return HAL_OK;
+}
+
+
+/**
+ * Get the fastest backend supported by this target. With STM32 it is the
+ * table backend, the peripheral backend blocks the interrupts.
+ * @return Pointer to the backend
+ */
+const crc32_ccsds_backend_t *crc32_ccsds_GetFastest(void)
+{
+#ifdef STM32_MCU
+	return &CRC32_CCSDS_TABLE;
+#else
+#ifdef CRC16_CCSDS_HAS_PCLMUL
+	if(CRC32_CCSDS_PCLMUL.is_supported())
+		return &CRC32_CCSDS_PCLMUL;
+#endif
+	return &CRC32_CCSDS_SLICE8;
+#endif
+}
+
+
+
+
+/*
+ * Bitwise backend
+ */
+static uint32_t crc32_ccsds_BitwiseCalculate(uint32_t seed, const uint8_t *buf, uint32_t len)
+{
+	uint32_t crc = seed;
+
+	while(len--)
+	{
+		crc ^= (uint32_t)*buf++ << 24;
+		for(uint32_t i=0; i<8; i++)
+			crc = (crc & 0x80000000) ? (crc<<1) ^ CRC32_CCSDS_POLY : crc<<1;
+	}
+
+	return crc;
+}
+
+const crc32_ccsds_backend_t CRC32_CCSDS_BITWISE = {"bitwise", NULL, NULL, crc32_ccsds_BitwiseCalculate};
+
+
+
+
+/*
+ * Table backend
+ */
+static uint32_t crc32_ccsds_TableCalculate(uint32_t seed, const uint8_t *buf, uint32_t len)
+{
+	uint32_t crc = seed;
+
+	while(len--)
+		crc = (crc<<8) ^ CRC32_CCSDS_TABLE_8[(crc>>24) ^ *buf++];
+
+	return crc;
+}
+
+const crc32_ccsds_backend_t CRC32_CCSDS_TABLE = {"table", NULL, NULL, crc32_ccsds_TableCalculate};
+
+
+
+
+/*
+ * Slice-by-8 backend. crc32_slice8[k][b] is the CRC of byte b followed by k
+ * zero bytes.
+ */
+static const uint32_t crc32_slice8[8][256] =
+{
+	{	// 0 zero bytes
+		0x00000000, 0x00A00805, 0x0140100A, 0x01E0180F, 0x02802014, 0x02202811, 0x03C0301E, 0x0360381B,
+		0x05004028, 0x05A0482D, 0x04405022, 0x04E05827, 0x0780603C, 0x07206839, 0x06C07036, 0x06607833,
+		0x0A008050, 0x0AA08855, 0x0B40905A, 0x0BE0985F, 0x0880A044, 0x0820A841, 0x09C0B04E, 0x0960B84B,
+		0x0F00C078, 0x0FA0C87D, 0x0E40D072, 0x0EE0D877, 0x0D80E06C, 0x0D20E869, 0x0CC0F066, 0x0C60F863,
+		0x140100A0, 0x14A108A5, 0x154110AA, 0x15E118AF, 0x168120B4, 0x162128B1, 0x17C130BE, 0x176138BB,
+		0x11014088, 0x11A1488D, 0x10415082, 0x10E15887, 0x1381609C, 0x13216899, 0x12C17096, 0x12617893,
+		0x1E0180F0, 0x1EA188F5, 0x1F4190FA, 0x1FE198FF, 0x1C81A0E4, 0x1C21A8E1, 0x1DC1B0EE, 0x1D61B8EB,
+		0x1B01C0D8, 0x1BA1C8DD, 0x1A41D0D2, 0x1AE1D8D7, 0x1981E0CC, 0x1921E8C9, 0x18C1F0C6, 0x1861F8C3,
+		0x28020140, 0x28A20945, 0x2942114A, 0x29E2194F, 0x2A822154, 0x2A222951, 0x2BC2315E, 0x2B62395B,
+		0x2D024168, 0x2DA2496D, 0x2C425162, 0x2CE25967, 0x2F82617C, 0x2F226979, 0x2EC27176, 0x2E627973,
+		0x22028110, 0x22A28915, 0x2342911A, 0x23E2991F, 0x2082A104, 0x2022A901, 0x21C2B10E, 0x2162B90B,
+		0x2702C138, 0x27A2C93D, 0x2642D132, 0x26E2D937, 0x2582E12C, 0x2522E929, 0x24C2F126, 0x2462F923,
+		0x3C0301E0, 0x3CA309E5, 0x3D4311EA, 0x3DE319EF, 0x3E8321F4, 0x3E2329F1, 0x3FC331FE, 0x3F6339FB,
+		0x390341C8, 0x39A349CD, 0x384351C2, 0x38E359C7, 0x3B8361DC, 0x3B2369D9, 0x3AC371D6, 0x3A6379D3,
+		0x360381B0, 0x36A389B5, 0x374391BA, 0x37E399BF, 0x3483A1A4, 0x3423A9A1, 0x35C3B1AE, 0x3563B9AB,
+		0x3303C198, 0x33A3C99D, 0x3243D192, 0x32E3D997, 0x3183E18C, 0x3123E989, 0x30C3F186, 0x3063F983,
+		0x50040280, 0x50A40A85, 0x5144128A, 0x51E41A8F, 0x52842294, 0x52242A91, 0x53C4329E, 0x53643A9B,
+		0x550442A8, 0x55A44AAD, 0x544452A2, 0x54E45AA7, 0x578462BC, 0x57246AB9, 0x56C472B6, 0x56647AB3,
+		0x5A0482D0, 0x5AA48AD5, 0x5B4492DA, 0x5BE49ADF, 0x5884A2C4, 0x5824AAC1, 0x59C4B2CE, 0x5964BACB,
+		0x5F04C2F8, 0x5FA4CAFD, 0x5E44D2F2, 0x5EE4DAF7, 0x5D84E2EC, 0x5D24EAE9, 0x5CC4F2E6, 0x5C64FAE3,
+		0x44050220, 0x44A50A25, 0x4545122A, 0x45E51A2F, 0x46852234, 0x46252A31, 0x47C5323E, 0x47653A3B,
+		0x41054208, 0x41A54A0D, 0x40455202, 0x40E55A07, 0x4385621C, 0x43256A19, 0x42C57216, 0x42657A13,
+		0x4E058270, 0x4EA58A75, 0x4F45927A, 0x4FE59A7F, 0x4C85A264, 0x4C25AA61, 0x4DC5B26E, 0x4D65BA6B,
+		0x4B05C258, 0x4BA5CA5D, 0x4A45D252, 0x4AE5DA57, 0x4985E24C, 0x4925EA49, 0x48C5F246, 0x4865FA43,
+		0x780603C0, 0x78A60BC5, 0x794613CA, 0x79E61BCF, 0x7A8623D4, 0x7A262BD1, 0x7BC633DE, 0x7B663BDB,
+		0x7D0643E8, 0x7DA64BED, 0x7C4653E2, 0x7CE65BE7, 0x7F8663FC, 0x7F266BF9, 0x7EC673F6, 0x7E667BF3,
+		0x72068390, 0x72A68B95, 0x7346939A, 0x73E69B9F, 0x7086A384, 0x7026AB81, 0x71C6B38E, 0x7166BB8B,
+		0x7706C3B8, 0x77A6CBBD, 0x7646D3B2, 0x76E6DBB7, 0x7586E3AC, 0x7526EBA9, 0x74C6F3A6, 0x7466FBA3,
+		0x6C070360, 0x6CA70B65, 0x6D47136A, 0x6DE71B6F, 0x6E872374, 0x6E272B71, 0x6FC7337E, 0x6F673B7B,
+		0x69074348, 0x69A74B4D, 0x68475342, 0x68E75B47, 0x6B87635C, 0x6B276B59, 0x6AC77356, 0x6A677B53,
+		0x66078330, 0x66A78B35, 0x6747933A, 0x67E79B3F, 0x6487A324, 0x6427AB21, 0x65C7B32E, 0x6567BB2B,
+		0x6307C318, 0x63A7CB1D, 0x6247D312, 0x62E7DB17, 0x6187E30C, 0x6127EB09, 0x60C7F306, 0x6067FB03
+	},
+	{	// 1 zero byte
+		0x00000000, 0xA0080500, 0x40B00205, 0xE0B80705, 0x8160040A, 0x2168010A, 0xC1D0060F, 0x61D8030F,
+		0x02600011, 0xA2680511, 0x42D00214, 0xE2D80714, 0x8300041B, 0x2308011B, 0xC3B0061E, 0x63B8031E,
+		0x04C00022, 0xA4C80522, 0x44700227, 0xE4780727, 0x85A00428, 0x25A80128, 0xC510062D, 0x6518032D,
+		0x06A00033, 0xA6A80533, 0x46100236, 0xE6180736, 0x87C00439, 0x27C80139, 0xC770063C, 0x6778033C,
+		0x09800044, 0xA9880544, 0x49300241, 0xE9380741, 0x88E0044E, 0x28E8014E, 0xC850064B, 0x6858034B,
+		0x0BE00055, 0xABE80555, 0x4B500250, 0xEB580750, 0x8A80045F, 0x2A88015F, 0xCA30065A, 0x6A38035A,
+		0x0D400066, 0xAD480566, 0x4DF00263, 0xEDF80763, 0x8C20046C, 0x2C28016C, 0xCC900669, 0x6C980369,
+		0x0F200077, 0xAF280577, 0x4F900272, 0xEF980772, 0x8E40047D, 0x2E48017D, 0xCEF00678, 0x6EF80378,
+		0x13000088, 0xB3080588, 0x53B0028D, 0xF3B8078D, 0x92600482, 0x32680182, 0xD2D00687, 0x72D80387,
+		0x11600099, 0xB1680599, 0x51D0029C, 0xF1D8079C, 0x90000493, 0x30080193, 0xD0B00696, 0x70B80396,
+		0x17C000AA, 0xB7C805AA, 0x577002AF, 0xF77807AF, 0x96A004A0, 0x36A801A0, 0xD61006A5, 0x761803A5,
+		0x15A000BB, 0xB5A805BB, 0x551002BE, 0xF51807BE, 0x94C004B1, 0x34C801B1, 0xD47006B4, 0x747803B4,
+		0x1A8000CC, 0xBA8805CC, 0x5A3002C9, 0xFA3807C9, 0x9BE004C6, 0x3BE801C6, 0xDB5006C3, 0x7B5803C3,
+		0x18E000DD, 0xB8E805DD, 0x585002D8, 0xF85807D8, 0x998004D7, 0x398801D7, 0xD93006D2, 0x793803D2,
+		0x1E4000EE, 0xBE4805EE, 0x5EF002EB, 0xFEF807EB, 0x9F2004E4, 0x3F2801E4, 0xDF9006E1, 0x7F9803E1,
+		0x1C2000FF, 0xBC2805FF, 0x5C9002FA, 0xFC9807FA, 0x9D4004F5, 0x3D4801F5, 0xDDF006F0, 0x7DF803F0,
+		0x26000110, 0x86080410, 0x66B00315, 0xC6B80615, 0xA760051A, 0x0768001A, 0xE7D0071F, 0x47D8021F,
+		0x24600101, 0x84680401, 0x64D00304, 0xC4D80604, 0xA500050B, 0x0508000B, 0xE5B0070E, 0x45B8020E,
+		0x22C00132, 0x82C80432, 0x62700337, 0xC2780637, 0xA3A00538, 0x03A80038, 0xE310073D, 0x4318023D,
+		0x20A00123, 0x80A80423, 0x60100326, 0xC0180626, 0xA1C00529, 0x01C80029, 0xE170072C, 0x4178022C,
+		0x2F800154, 0x8F880454, 0x6F300351, 0xCF380651, 0xAEE0055E, 0x0EE8005E, 0xEE50075B, 0x4E58025B,
+		0x2DE00145, 0x8DE80445, 0x6D500340, 0xCD580640, 0xAC80054F, 0x0C88004F, 0xEC30074A, 0x4C38024A,
+		0x2B400176, 0x8B480476, 0x6BF00373, 0xCBF80673, 0xAA20057C, 0x0A28007C, 0xEA900779, 0x4A980279,
+		0x29200167, 0x89280467, 0x69900362, 0xC9980662, 0xA840056D, 0x0848006D, 0xE8F00768, 0x48F80268,
+		0x35000198, 0x95080498, 0x75B0039D, 0xD5B8069D, 0xB4600592, 0x14680092, 0xF4D00797, 0x54D80297,
+		0x37600189, 0x97680489, 0x77D0038C, 0xD7D8068C, 0xB6000583, 0x16080083, 0xF6B00786, 0x56B80286,
+		0x31C001BA, 0x91C804BA, 0x717003BF, 0xD17806BF, 0xB0A005B0, 0x10A800B0, 0xF01007B5, 0x501802B5,
+		0x33A001AB, 0x93A804AB, 0x731003AE, 0xD31806AE, 0xB2C005A1, 0x12C800A1, 0xF27007A4, 0x527802A4,
+		0x3C8001DC, 0x9C8804DC, 0x7C3003D9, 0xDC3806D9, 0xBDE005D6, 0x1DE800D6, 0xFD5007D3, 0x5D5802D3,
+		0x3EE001CD, 0x9EE804CD, 0x7E5003C8, 0xDE5806C8, 0xBF8005C7, 0x1F8800C7, 0xFF3007C2, 0x5F3802C2,
+		0x384001FE, 0x984804FE, 0x78F003FB, 0xD8F806FB, 0xB92005F4, 0x192800F4, 0xF99007F1, 0x599802F1,
+		0x3A2001EF, 0x9A2804EF, 0x7A9003EA, 0xDA9806EA, 0xBB4005E5, 0x1B4800E5, 0xFBF007E0, 0x5BF802E0
+	},
+	{	// 2 zero bytes
+		0x00000000, 0x4C000220, 0x98000440, 0xD4000660, 0x30A00085, 0x7CA002A5, 0xA8A004C5, 0xE4A006E5,
+		0x6140010A, 0x2D40032A, 0xF940054A, 0xB540076A, 0x51E0018F, 0x1DE003AF, 0xC9E005CF, 0x85E007EF,
+		0xC2800214, 0x8E800034, 0x5A800654, 0x16800474, 0xF2200291, 0xBE2000B1, 0x6A2006D1, 0x262004F1,
+		0xA3C0031E, 0xEFC0013E, 0x3BC0075E, 0x77C0057E, 0x9360039B, 0xDF6001BB, 0x0B6007DB, 0x476005FB,
+		0x85A00C2D, 0xC9A00E0D, 0x1DA0086D, 0x51A00A4D, 0xB5000CA8, 0xF9000E88, 0x2D0008E8, 0x61000AC8,
+		0xE4E00D27, 0xA8E00F07, 0x7CE00967, 0x30E00B47, 0xD4400DA2, 0x98400F82, 0x4C4009E2, 0x00400BC2,
+		0x47200E39, 0x0B200C19, 0xDF200A79, 0x93200859, 0x77800EBC, 0x3B800C9C, 0xEF800AFC, 0xA38008DC,
+		0x26600F33, 0x6A600D13, 0xBE600B73, 0xF2600953, 0x16C00FB6, 0x5AC00D96, 0x8EC00BF6, 0xC2C009D6,
+		0x0BE0105F, 0x47E0127F, 0x93E0141F, 0xDFE0163F, 0x3B4010DA, 0x774012FA, 0xA340149A, 0xEF4016BA,
+		0x6AA01155, 0x26A01375, 0xF2A01515, 0xBEA01735, 0x5A0011D0, 0x160013F0, 0xC2001590, 0x8E0017B0,
+		0xC960124B, 0x8560106B, 0x5160160B, 0x1D60142B, 0xF9C012CE, 0xB5C010EE, 0x61C0168E, 0x2DC014AE,
+		0xA8201341, 0xE4201161, 0x30201701, 0x7C201521, 0x988013C4, 0xD48011E4, 0x00801784, 0x4C8015A4,
+		0x8E401C72, 0xC2401E52, 0x16401832, 0x5A401A12, 0xBEE01CF7, 0xF2E01ED7, 0x26E018B7, 0x6AE01A97,
+		0xEF001D78, 0xA3001F58, 0x77001938, 0x3B001B18, 0xDFA01DFD, 0x93A01FDD, 0x47A019BD, 0x0BA01B9D,
+		0x4CC01E66, 0x00C01C46, 0xD4C01A26, 0x98C01806, 0x7C601EE3, 0x30601CC3, 0xE4601AA3, 0xA8601883,
+		0x2D801F6C, 0x61801D4C, 0xB5801B2C, 0xF980190C, 0x1D201FE9, 0x51201DC9, 0x85201BA9, 0xC9201989,
+		0x17C020BE, 0x5BC0229E, 0x8FC024FE, 0xC3C026DE, 0x2760203B, 0x6B60221B, 0xBF60247B, 0xF360265B,
+		0x768021B4, 0x3A802394, 0xEE8025F4, 0xA28027D4, 0x46202131, 0x0A202311, 0xDE202571, 0x92202751,
+		0xD54022AA, 0x9940208A, 0x4D4026EA, 0x014024CA, 0xE5E0222F, 0xA9E0200F, 0x7DE0266F, 0x31E0244F,
+		0xB40023A0, 0xF8002180, 0x2C0027E0, 0x600025C0, 0x84A02325, 0xC8A02105, 0x1CA02765, 0x50A02545,
+		0x92602C93, 0xDE602EB3, 0x0A6028D3, 0x46602AF3, 0xA2C02C16, 0xEEC02E36, 0x3AC02856, 0x76C02A76,
+		0xF3202D99, 0xBF202FB9, 0x6B2029D9, 0x27202BF9, 0xC3802D1C, 0x8F802F3C, 0x5B80295C, 0x17802B7C,
+		0x50E02E87, 0x1CE02CA7, 0xC8E02AC7, 0x84E028E7, 0x60402E02, 0x2C402C22, 0xF8402A42, 0xB4402862,
+		0x31A02F8D, 0x7DA02DAD, 0xA9A02BCD, 0xE5A029ED, 0x01002F08, 0x4D002D28, 0x99002B48, 0xD5002968,
+		0x1C2030E1, 0x502032C1, 0x842034A1, 0xC8203681, 0x2C803064, 0x60803244, 0xB4803424, 0xF8803604,
+		0x7D6031EB, 0x316033CB, 0xE56035AB, 0xA960378B, 0x4DC0316E, 0x01C0334E, 0xD5C0352E, 0x99C0370E,
+		0xDEA032F5, 0x92A030D5, 0x46A036B5, 0x0AA03495, 0xEE003270, 0xA2003050, 0x76003630, 0x3A003410,
+		0xBFE033FF, 0xF3E031DF, 0x27E037BF, 0x6BE0359F, 0x8F40337A, 0xC340315A, 0x1740373A, 0x5B40351A,
+		0x99803CCC, 0xD5803EEC, 0x0180388C, 0x4D803AAC, 0xA9203C49, 0xE5203E69, 0x31203809, 0x7D203A29,
+		0xF8C03DC6, 0xB4C03FE6, 0x60C03986, 0x2CC03BA6, 0xC8603D43, 0x84603F63, 0x50603903, 0x1C603B23,
+		0x5B003ED8, 0x17003CF8, 0xC3003A98, 0x8F0038B8, 0x6BA03E5D, 0x27A03C7D, 0xF3A03A1D, 0xBFA0383D,
+		0x3A403FD2, 0x76403DF2, 0xA2403B92, 0xEE4039B2, 0x0AE03F57, 0x46E03D77, 0x92E03B17, 0xDEE03937
+	},
+	{	// 3 zero bytes
+		0x00000000, 0x2F80417C, 0x5F0082F8, 0x7080C384, 0xBE0105F0, 0x9181448C, 0xE1018708, 0xCE81C674,
+		0x7CA203E5, 0x53224299, 0x23A2811D, 0x0C22C061, 0xC2A30615, 0xED234769, 0x9DA384ED, 0xB223C591,
+		0xF94407CA, 0xD6C446B6, 0xA6448532, 0x89C4C44E, 0x4745023A, 0x68C54346, 0x184580C2, 0x37C5C1BE,
+		0x85E6042F, 0xAA664553, 0xDAE686D7, 0xF566C7AB, 0x3BE701DF, 0x146740A3, 0x64E78327, 0x4B67C25B,
+		0xF2280791, 0xDDA846ED, 0xAD288569, 0x82A8C415, 0x4C290261, 0x63A9431D, 0x13298099, 0x3CA9C1E5,
+		0x8E8A0474, 0xA10A4508, 0xD18A868C, 0xFE0AC7F0, 0x308B0184, 0x1F0B40F8, 0x6F8B837C, 0x400BC200,
+		0x0B6C005B, 0x24EC4127, 0x546C82A3, 0x7BECC3DF, 0xB56D05AB, 0x9AED44D7, 0xEA6D8753, 0xC5EDC62F,
+		0x77CE03BE, 0x584E42C2, 0x28CE8146, 0x074EC03A, 0xC9CF064E, 0xE64F4732, 0x96CF84B6, 0xB94FC5CA,
+		0xE4F00727, 0xCB70465B, 0xBBF085DF, 0x9470C4A3, 0x5AF102D7, 0x757143AB, 0x05F1802F, 0x2A71C153,
+		0x985204C2, 0xB7D245BE, 0xC752863A, 0xE8D2C746, 0x26530132, 0x09D3404E, 0x795383CA, 0x56D3C2B6,
+		0x1DB400ED, 0x32344191, 0x42B48215, 0x6D34C369, 0xA3B5051D, 0x8C354461, 0xFCB587E5, 0xD335C699,
+		0x61160308, 0x4E964274, 0x3E1681F0, 0x1196C08C, 0xDF1706F8, 0xF0974784, 0x80178400, 0xAF97C57C,
+		0x16D800B6, 0x395841CA, 0x49D8824E, 0x6658C332, 0xA8D90546, 0x8759443A, 0xF7D987BE, 0xD859C6C2,
+		0x6A7A0353, 0x45FA422F, 0x357A81AB, 0x1AFAC0D7, 0xD47B06A3, 0xFBFB47DF, 0x8B7B845B, 0xA4FBC527,
+		0xEF9C077C, 0xC01C4600, 0xB09C8584, 0x9F1CC4F8, 0x519D028C, 0x7E1D43F0, 0x0E9D8074, 0x211DC108,
+		0x933E0499, 0xBCBE45E5, 0xCC3E8661, 0xE3BEC71D, 0x2D3F0169, 0x02BF4015, 0x723F8391, 0x5DBFC2ED,
+		0xC940064B, 0xE6C04737, 0x964084B3, 0xB9C0C5CF, 0x774103BB, 0x58C142C7, 0x28418143, 0x07C1C03F,
+		0xB5E205AE, 0x9A6244D2, 0xEAE28756, 0xC562C62A, 0x0BE3005E, 0x24634122, 0x54E382A6, 0x7B63C3DA,
+		0x30040181, 0x1F8440FD, 0x6F048379, 0x4084C205, 0x8E050471, 0xA185450D, 0xD1058689, 0xFE85C7F5,
+		0x4CA60264, 0x63264318, 0x13A6809C, 0x3C26C1E0, 0xF2A70794, 0xDD2746E8, 0xADA7856C, 0x8227C410,
+		0x3B6801DA, 0x14E840A6, 0x64688322, 0x4BE8C25E, 0x8569042A, 0xAAE94556, 0xDA6986D2, 0xF5E9C7AE,
+		0x47CA023F, 0x684A4343, 0x18CA80C7, 0x374AC1BB, 0xF9CB07CF, 0xD64B46B3, 0xA6CB8537, 0x894BC44B,
+		0xC22C0610, 0xEDAC476C, 0x9D2C84E8, 0xB2ACC594, 0x7C2D03E0, 0x53AD429C, 0x232D8118, 0x0CADC064,
+		0xBE8E05F5, 0x910E4489, 0xE18E870D, 0xCE0EC671, 0x008F0005, 0x2F0F4179, 0x5F8F82FD, 0x700FC381,
+		0x2DB0016C, 0x02304010, 0x72B08394, 0x5D30C2E8, 0x93B1049C, 0xBC3145E0, 0xCCB18664, 0xE331C718,
+		0x51120289, 0x7E9243F5, 0x0E128071, 0x2192C10D, 0xEF130779, 0xC0934605, 0xB0138581, 0x9F93C4FD,
+		0xD4F406A6, 0xFB7447DA, 0x8BF4845E, 0xA474C522, 0x6AF50356, 0x4575422A, 0x35F581AE, 0x1A75C0D2,
+		0xA8560543, 0x87D6443F, 0xF75687BB, 0xD8D6C6C7, 0x165700B3, 0x39D741CF, 0x4957824B, 0x66D7C337,
+		0xDF9806FD, 0xF0184781, 0x80988405, 0xAF18C579, 0x6199030D, 0x4E194271, 0x3E9981F5, 0x1119C089,
+		0xA33A0518, 0x8CBA4464, 0xFC3A87E0, 0xD3BAC69C, 0x1D3B00E8, 0x32BB4194, 0x423B8210, 0x6DBBC36C,
+		0x26DC0137, 0x095C404B, 0x79DC83CF, 0x565CC2B3, 0x98DD04C7, 0xB75D45BB, 0xC7DD863F, 0xE85DC743,
+		0x5A7E02D2, 0x75FE43AE, 0x057E802A, 0x2AFEC156, 0xE47F0722, 0xCBFF465E, 0xBB7F85DA, 0x94FFC4A6
+	},
+	{	// 4 zero bytes
+		0x00000000, 0x92200493, 0x24E00123, 0xB6C005B0, 0x49C00246, 0xDBE006D5, 0x6D200365, 0xFF0007F6,
+		0x9380048C, 0x01A0001F, 0xB76005AF, 0x2540013C, 0xDA4006CA, 0x48600259, 0xFEA007E9, 0x6C80037A,
+		0x27A0011D, 0xB580058E, 0x0340003E, 0x916004AD, 0x6E60035B, 0xFC4007C8, 0x4A800278, 0xD8A006EB,
+		0xB4200591, 0x26000102, 0x90C004B2, 0x02E00021, 0xFDE007D7, 0x6FC00344, 0xD90006F4, 0x4B200267,
+		0x4F40023A, 0xDD6006A9, 0x6BA00319, 0xF980078A, 0x0680007C, 0x94A004EF, 0x2260015F, 0xB04005CC,
+		0xDCC006B6, 0x4EE00225, 0xF8200795, 0x6A000306, 0x950004F0, 0x07200063, 0xB1E005D3, 0x23C00140,
+		0x68E00327, 0xFAC007B4, 0x4C000204, 0xDE200697, 0x21200161, 0xB30005F2, 0x05C00042, 0x97E004D1,
+		0xFB6007AB, 0x69400338, 0xDF800688, 0x4DA0021B, 0xB2A005ED, 0x2080017E, 0x964004CE, 0x0460005D,
+		0x9E800474, 0x0CA000E7, 0xBA600557, 0x284001C4, 0xD7400632, 0x456002A1, 0xF3A00711, 0x61800382,
+		0x0D0000F8, 0x9F20046B, 0x29E001DB, 0xBBC00548, 0x44C002BE, 0xD6E0062D, 0x6020039D, 0xF200070E,
+		0xB9200569, 0x2B0001FA, 0x9DC0044A, 0x0FE000D9, 0xF0E0072F, 0x62C003BC, 0xD400060C, 0x4620029F,
+		0x2AA001E5, 0xB8800576, 0x0E4000C6, 0x9C600455, 0x636003A3, 0xF1400730, 0x47800280, 0xD5A00613,
+		0xD1C0064E, 0x43E002DD, 0xF520076D, 0x670003FE, 0x98000408, 0x0A20009B, 0xBCE0052B, 0x2EC001B8,
+		0x424002C2, 0xD0600651, 0x66A003E1, 0xF4800772, 0x0B800084, 0x99A00417, 0x2F6001A7, 0xBD400534,
+		0xF6600753, 0x644003C0, 0xD2800670, 0x40A002E3, 0xBFA00515, 0x2D800186, 0x9B400436, 0x096000A5,
+		0x65E003DF, 0xF7C0074C, 0x410002FC, 0xD320066F, 0x2C200199, 0xBE00050A, 0x08C000BA, 0x9AE00429,
+		0x3DA000ED, 0xAF80047E, 0x194001CE, 0x8B60055D, 0x746002AB, 0xE6400638, 0x50800388, 0xC2A0071B,
+		0xAE200461, 0x3C0000F2, 0x8AC00542, 0x18E001D1, 0xE7E00627, 0x75C002B4, 0xC3000704, 0x51200397,
+		0x1A0001F0, 0x88200563, 0x3EE000D3, 0xACC00440, 0x53C003B6, 0xC1E00725, 0x77200295, 0xE5000606,
+		0x8980057C, 0x1BA001EF, 0xAD60045F, 0x3F4000CC, 0xC040073A, 0x526003A9, 0xE4A00619, 0x7680028A,
+		0x72E002D7, 0xE0C00644, 0x560003F4, 0xC4200767, 0x3B200091, 0xA9000402, 0x1FC001B2, 0x8DE00521,
+		0xE160065B, 0x734002C8, 0xC5800778, 0x57A003EB, 0xA8A0041D, 0x3A80008E, 0x8C40053E, 0x1E6001AD,
+		0x554003CA, 0xC7600759, 0x71A002E9, 0xE380067A, 0x1C80018C, 0x8EA0051F, 0x386000AF, 0xAA40043C,
+		0xC6C00746, 0x54E003D5, 0xE2200665, 0x700002F6, 0x8F000500, 0x1D200193, 0xABE00423, 0x39C000B0,
+		0xA3200499, 0x3100000A, 0x87C005BA, 0x15E00129, 0xEAE006DF, 0x78C0024C, 0xCE0007FC, 0x5C20036F,
+		0x30A00015, 0xA2800486, 0x14400136, 0x866005A5, 0x79600253, 0xEB4006C0, 0x5D800370, 0xCFA007E3,
+		0x84800584, 0x16A00117, 0xA06004A7, 0x32400034, 0xCD4007C2, 0x5F600351, 0xE9A006E1, 0x7B800272,
+		0x17000108, 0x8520059B, 0x33E0002B, 0xA1C004B8, 0x5EC0034E, 0xCCE007DD, 0x7A20026D, 0xE80006FE,
+		0xEC6006A3, 0x7E400230, 0xC8800780, 0x5AA00313, 0xA5A004E5, 0x37800076, 0x814005C6, 0x13600155,
+		0x7FE0022F, 0xEDC006BC, 0x5B00030C, 0xC920079F, 0x36200069, 0xA40004FA, 0x12C0014A, 0x80E005D9,
+		0xCBC007BE, 0x59E0032D, 0xEF20069D, 0x7D00020E, 0x820005F8, 0x1020016B, 0xA6E004DB, 0x34C00048,
+		0x58400332, 0xCA6007A1, 0x7CA00211, 0xEE800682, 0x11800174, 0x83A005E7, 0x35600057, 0xA74004C4
+	},
+	{	// 5 zero bytes
+		0x00000000, 0x7B4001DA, 0xF68003B4, 0x8DC0026E, 0xEDA00F6D, 0x96E00EB7, 0x1B200CD9, 0x60600D03,
+		0xDBE016DF, 0xA0A01705, 0x2D60156B, 0x562014B1, 0x364019B2, 0x4D001868, 0xC0C01A06, 0xBB801BDC,
+		0xB76025BB, 0xCC202461, 0x41E0260F, 0x3AA027D5, 0x5AC02AD6, 0x21802B0C, 0xAC402962, 0xD70028B8,
+		0x6C803364, 0x17C032BE, 0x9A0030D0, 0xE140310A, 0x81203C09, 0xFA603DD3, 0x77A03FBD, 0x0CE03E67,
+		0x6E604373, 0x152042A9, 0x98E040C7, 0xE3A0411D, 0x83C04C1E, 0xF8804DC4, 0x75404FAA, 0x0E004E70,
+		0xB58055AC, 0xCEC05476, 0x43005618, 0x384057C2, 0x58205AC1, 0x23605B1B, 0xAEA05975, 0xD5E058AF,
+		0xD90066C8, 0xA2406712, 0x2F80657C, 0x54C064A6, 0x34A069A5, 0x4FE0687F, 0xC2206A11, 0xB9606BCB,
+		0x02E07017, 0x79A071CD, 0xF46073A3, 0x8F207279, 0xEF407F7A, 0x94007EA0, 0x19C07CCE, 0x62807D14,
+		0xDCC086E6, 0xA780873C, 0x2A408552, 0x51008488, 0x3160898B, 0x4A208851, 0xC7E08A3F, 0xBCA08BE5,
+		0x07209039, 0x7C6091E3, 0xF1A0938D, 0x8AE09257, 0xEA809F54, 0x91C09E8E, 0x1C009CE0, 0x67409D3A,
+		0x6BA0A35D, 0x10E0A287, 0x9D20A0E9, 0xE660A133, 0x8600AC30, 0xFD40ADEA, 0x7080AF84, 0x0BC0AE5E,
+		0xB040B582, 0xCB00B458, 0x46C0B636, 0x3D80B7EC, 0x5DE0BAEF, 0x26A0BB35, 0xAB60B95B, 0xD020B881,
+		0xB2A0C595, 0xC9E0C44F, 0x4420C621, 0x3F60C7FB, 0x5F00CAF8, 0x2440CB22, 0xA980C94C, 0xD2C0C896,
+		0x6940D34A, 0x1200D290, 0x9FC0D0FE, 0xE480D124, 0x84E0DC27, 0xFFA0DDFD, 0x7260DF93, 0x0920DE49,
+		0x05C0E02E, 0x7E80E1F4, 0xF340E39A, 0x8800E240, 0xE860EF43, 0x9320EE99, 0x1EE0ECF7, 0x65A0ED2D,
+		0xDE20F6F1, 0xA560F72B, 0x28A0F545, 0x53E0F49F, 0x3380F99C, 0x48C0F846, 0xC500FA28, 0xBE40FBF2,
+		0xB92105C9, 0xC2610413, 0x4FA1067D, 0x34E107A7, 0x54810AA4, 0x2FC10B7E, 0xA2010910, 0xD94108CA,
+		0x62C11316, 0x198112CC, 0x944110A2, 0xEF011178, 0x8F611C7B, 0xF4211DA1, 0x79E11FCF, 0x02A11E15,
+		0x0E412072, 0x750121A8, 0xF8C123C6, 0x8381221C, 0xE3E12F1F, 0x98A12EC5, 0x15612CAB, 0x6E212D71,
+		0xD5A136AD, 0xAEE13777, 0x23213519, 0x586134C3, 0x380139C0, 0x4341381A, 0xCE813A74, 0xB5C13BAE,
+		0xD74146BA, 0xAC014760, 0x21C1450E, 0x5A8144D4, 0x3AE149D7, 0x41A1480D, 0xCC614A63, 0xB7214BB9,
+		0x0CA15065, 0x77E151BF, 0xFA2153D1, 0x8161520B, 0xE1015F08, 0x9A415ED2, 0x17815CBC, 0x6CC15D66,
+		0x60216301, 0x1B6162DB, 0x96A160B5, 0xEDE1616F, 0x8D816C6C, 0xF6C16DB6, 0x7B016FD8, 0x00416E02,
+		0xBBC175DE, 0xC0817404, 0x4D41766A, 0x360177B0, 0x56617AB3, 0x2D217B69, 0xA0E17907, 0xDBA178DD,
+		0x65E1832F, 0x1EA182F5, 0x9361809B, 0xE8218141, 0x88418C42, 0xF3018D98, 0x7EC18FF6, 0x05818E2C,
+		0xBE0195F0, 0xC541942A, 0x48819644, 0x33C1979E, 0x53A19A9D, 0x28E19B47, 0xA5219929, 0xDE6198F3,
+		0xD281A694, 0xA9C1A74E, 0x2401A520, 0x5F41A4FA, 0x3F21A9F9, 0x4461A823, 0xC9A1AA4D, 0xB2E1AB97,
+		0x0961B04B, 0x7221B191, 0xFFE1B3FF, 0x84A1B225, 0xE4C1BF26, 0x9F81BEFC, 0x1241BC92, 0x6901BD48,
+		0x0B81C05C, 0x70C1C186, 0xFD01C3E8, 0x8641C232, 0xE621CF31, 0x9D61CEEB, 0x10A1CC85, 0x6BE1CD5F,
+		0xD061D683, 0xAB21D759, 0x26E1D537, 0x5DA1D4ED, 0x3DC1D9EE, 0x4681D834, 0xCB41DA5A, 0xB001DB80,
+		0xBCE1E5E7, 0xC7A1E43D, 0x4A61E653, 0x3121E789, 0x5141EA8A, 0x2A01EB50, 0xA7C1E93E, 0xDC81E8E4,
+		0x6701F338, 0x1C41F2E2, 0x9181F08C, 0xEAC1F156, 0x8AA1FC55, 0xF1E1FD8F, 0x7C21FFE1, 0x0761FE3B
+	},
+	{	// 6 zero bytes
+		0x00000000, 0x72E20397, 0xE5C4072E, 0x972604B9, 0xCB280659, 0xB9CA05CE, 0x2EEC0177, 0x5C0E02E0,
+		0x96F004B7, 0xE4120720, 0x73340399, 0x01D6000E, 0x5DD802EE, 0x2F3A0179, 0xB81C05C0, 0xCAFE0657,
+		0x2D40016B, 0x5FA202FC, 0xC8840645, 0xBA6605D2, 0xE6680732, 0x948A04A5, 0x03AC001C, 0x714E038B,
+		0xBBB005DC, 0xC952064B, 0x5E7402F2, 0x2C960165, 0x70980385, 0x027A0012, 0x955C04AB, 0xE7BE073C,
+		0x5A8002D6, 0x28620141, 0xBF4405F8, 0xCDA6066F, 0x91A8048F, 0xE34A0718, 0x746C03A1, 0x068E0036,
+		0xCC700661, 0xBE9205F6, 0x29B4014F, 0x5B5602D8, 0x07580038, 0x75BA03AF, 0xE29C0716, 0x907E0481,
+		0x77C003BD, 0x0522002A, 0x92040493, 0xE0E60704, 0xBCE805E4, 0xCE0A0673, 0x592C02CA, 0x2BCE015D,
+		0xE130070A, 0x93D2049D, 0x04F40024, 0x761603B3, 0x2A180153, 0x58FA02C4, 0xCFDC067D, 0xBD3E05EA,
+		0xB50005AC, 0xC7E2063B, 0x50C40282, 0x22260115, 0x7E2803F5, 0x0CCA0062, 0x9BEC04DB, 0xE90E074C,
+		0x23F0011B, 0x5112028C, 0xC6340635, 0xB4D605A2, 0xE8D80742, 0x9A3A04D5, 0x0D1C006C, 0x7FFE03FB,
+		0x984004C7, 0xEAA20750, 0x7D8403E9, 0x0F66007E, 0x5368029E, 0x218A0109, 0xB6AC05B0, 0xC44E0627,
+		0x0EB00070, 0x7C5203E7, 0xEB74075E, 0x999604C9, 0xC5980629, 0xB77A05BE, 0x205C0107, 0x52BE0290,
+		0xEF80077A, 0x9D6204ED, 0x0A440054, 0x78A603C3, 0x24A80123, 0x564A02B4, 0xC16C060D, 0xB38E059A,
+		0x797003CD, 0x0B92005A, 0x9CB404E3, 0xEE560774, 0xB2580594, 0xC0BA0603, 0x579C02BA, 0x257E012D,
+		0xC2C00611, 0xB0220586, 0x2704013F, 0x55E602A8, 0x09E80048, 0x7B0A03DF, 0xEC2C0766, 0x9ECE04F1,
+		0x543002A6, 0x26D20131, 0xB1F40588, 0xC316061F, 0x9F1804FF, 0xEDFA0768, 0x7ADC03D1, 0x083E0046,
+		0x6AA0035D, 0x184200CA, 0x8F640473, 0xFD8607E4, 0xA1880504, 0xD36A0693, 0x444C022A, 0x36AE01BD,
+		0xFC5007EA, 0x8EB2047D, 0x199400C4, 0x6B760353, 0x377801B3, 0x459A0224, 0xD2BC069D, 0xA05E050A,
+		0x47E00236, 0x350201A1, 0xA2240518, 0xD0C6068F, 0x8CC8046F, 0xFE2A07F8, 0x690C0341, 0x1BEE00D6,
+		0xD1100681, 0xA3F20516, 0x34D401AF, 0x46360238, 0x1A3800D8, 0x68DA034F, 0xFFFC07F6, 0x8D1E0461,
+		0x3020018B, 0x42C2021C, 0xD5E406A5, 0xA7060532, 0xFB0807D2, 0x89EA0445, 0x1ECC00FC, 0x6C2E036B,
+		0xA6D0053C, 0xD43206AB, 0x43140212, 0x31F60185, 0x6DF80365, 0x1F1A00F2, 0x883C044B, 0xFADE07DC,
+		0x1D6000E0, 0x6F820377, 0xF8A407CE, 0x8A460459, 0xD64806B9, 0xA4AA052E, 0x338C0197, 0x416E0200,
+		0x8B900457, 0xF97207C0, 0x6E540379, 0x1CB600EE, 0x40B8020E, 0x325A0199, 0xA57C0520, 0xD79E06B7,
+		0xDFA006F1, 0xAD420566, 0x3A6401DF, 0x48860248, 0x148800A8, 0x666A033F, 0xF14C0786, 0x83AE0411,
+		0x49500246, 0x3BB201D1, 0xAC940568, 0xDE7606FF, 0x8278041F, 0xF09A0788, 0x67BC0331, 0x155E00A6,
+		0xF2E0079A, 0x8002040D, 0x172400B4, 0x65C60323, 0x39C801C3, 0x4B2A0254, 0xDC0C06ED, 0xAEEE057A,
+		0x6410032D, 0x16F200BA, 0x81D40403, 0xF3360794, 0xAF380574, 0xDDDA06E3, 0x4AFC025A, 0x381E01CD,
+		0x85200427, 0xF7C207B0, 0x60E40309, 0x1206009E, 0x4E08027E, 0x3CEA01E9, 0xABCC0550, 0xD92E06C7,
+		0x13D00090, 0x61320307, 0xF61407BE, 0x84F60429, 0xD8F806C9, 0xAA1A055E, 0x3D3C01E7, 0x4FDE0270,
+		0xA860054C, 0xDA8206DB, 0x4DA40262, 0x3F4601F5, 0x63480315, 0x11AA0082, 0x868C043B, 0xF46E07AC,
+		0x3E9001FB, 0x4C72026C, 0xDB5406D5, 0xA9B60542, 0xF5B807A2, 0x875A0435, 0x107C008C, 0x629E031B
+	},
+	{	// 7 zero bytes
+		0x00000000, 0xD54006BA, 0xAA200571, 0x7F6003CB, 0x54E002E7, 0x81A0045D, 0xFEC00796, 0x2B80012C,
+		0xA9C005CE, 0x7C800374, 0x03E000BF, 0xD6A00605, 0xFD200729, 0x28600193, 0x57000258, 0x824004E2,
+		0x53200399, 0x86600523, 0xF90006E8, 0x2C400052, 0x07C0017E, 0xD28007C4, 0xADE0040F, 0x78A002B5,
+		0xFAE00657, 0x2FA000ED, 0x50C00326, 0x8580059C, 0xAE0004B0, 0x7B40020A, 0x042001C1, 0xD160077B,
+		0xA6400732, 0x73000188, 0x0C600243, 0xD92004F9, 0xF2A005D5, 0x27E0036F, 0x588000A4, 0x8DC0061E,
+		0x0F8002FC, 0xDAC00446, 0xA5A0078D, 0x70E00137, 0x5B60001B, 0x8E2006A1, 0xF140056A, 0x240003D0,
+		0xF56004AB, 0x20200211, 0x5F4001DA, 0x8A000760, 0xA180064C, 0x74C000F6, 0x0BA0033D, 0xDEE00587,
+		0x5CA00165, 0x89E007DF, 0xF6800414, 0x23C002AE, 0x08400382, 0xDD000538, 0xA26006F3, 0x77200049,
+		0x4C200661, 0x996000DB, 0xE6000310, 0x334005AA, 0x18C00486, 0xCD80023C, 0xB2E001F7, 0x67A0074D,
+		0xE5E003AF, 0x30A00515, 0x4FC006DE, 0x9A800064, 0xB1000148, 0x644007F2, 0x1B200439, 0xCE600283,
+		0x1F0005F8, 0xCA400342, 0xB5200089, 0x60600633, 0x4BE0071F, 0x9EA001A5, 0xE1C0026E, 0x348004D4,
+		0xB6C00036, 0x6380068C, 0x1CE00547, 0xC9A003FD, 0xE22002D1, 0x3760046B, 0x480007A0, 0x9D40011A,
+		0xEA600153, 0x3F2007E9, 0x40400422, 0x95000298, 0xBE8003B4, 0x6BC0050E, 0x14A006C5, 0xC1E0007F,
+		0x43A0049D, 0x96E00227, 0xE98001EC, 0x3CC00756, 0x1740067A, 0xC20000C0, 0xBD60030B, 0x682005B1,
+		0xB94002CA, 0x6C000470, 0x136007BB, 0xC6200101, 0xEDA0002D, 0x38E00697, 0x4780055C, 0x92C003E6,
+		0x10800704, 0xC5C001BE, 0xBAA00275, 0x6FE004CF, 0x446005E3, 0x91200359, 0xEE400092, 0x3B000628,
+		0x98400CC2, 0x4D000A78, 0x326009B3, 0xE7200F09, 0xCCA00E25, 0x19E0089F, 0x66800B54, 0xB3C00DEE,
+		0x3180090C, 0xE4C00FB6, 0x9BA00C7D, 0x4EE00AC7, 0x65600BEB, 0xB0200D51, 0xCF400E9A, 0x1A000820,
+		0xCB600F5B, 0x1E2009E1, 0x61400A2A, 0xB4000C90, 0x9F800DBC, 0x4AC00B06, 0x35A008CD, 0xE0E00E77,
+		0x62A00A95, 0xB7E00C2F, 0xC8800FE4, 0x1DC0095E, 0x36400872, 0xE3000EC8, 0x9C600D03, 0x49200BB9,
+		0x3E000BF0, 0xEB400D4A, 0x94200E81, 0x4160083B, 0x6AE00917, 0xBFA00FAD, 0xC0C00C66, 0x15800ADC,
+		0x97C00E3E, 0x42800884, 0x3DE00B4F, 0xE8A00DF5, 0xC3200CD9, 0x16600A63, 0x690009A8, 0xBC400F12,
+		0x6D200869, 0xB8600ED3, 0xC7000D18, 0x12400BA2, 0x39C00A8E, 0xEC800C34, 0x93E00FFF, 0x46A00945,
+		0xC4E00DA7, 0x11A00B1D, 0x6EC008D6, 0xBB800E6C, 0x90000F40, 0x454009FA, 0x3A200A31, 0xEF600C8B,
+		0xD4600AA3, 0x01200C19, 0x7E400FD2, 0xAB000968, 0x80800844, 0x55C00EFE, 0x2AA00D35, 0xFFE00B8F,
+		0x7DA00F6D, 0xA8E009D7, 0xD7800A1C, 0x02C00CA6, 0x29400D8A, 0xFC000B30, 0x836008FB, 0x56200E41,
+		0x8740093A, 0x52000F80, 0x2D600C4B, 0xF8200AF1, 0xD3A00BDD, 0x06E00D67, 0x79800EAC, 0xACC00816,
+		0x2E800CF4, 0xFBC00A4E, 0x84A00985, 0x51E00F3F, 0x7A600E13, 0xAF2008A9, 0xD0400B62, 0x05000DD8,
+		0x72200D91, 0xA7600B2B, 0xD80008E0, 0x0D400E5A, 0x26C00F76, 0xF38009CC, 0x8CE00A07, 0x59A00CBD,
+		0xDBE0085F, 0x0EA00EE5, 0x71C00D2E, 0xA4800B94, 0x8F000AB8, 0x5A400C02, 0x25200FC9, 0xF0600973,
+		0x21000E08, 0xF44008B2, 0x8B200B79, 0x5E600DC3, 0x75E00CEF, 0xA0A00A55, 0xDFC0099E, 0x0A800F24,
+		0x88C00BC6, 0x5D800D7C, 0x22E00EB7, 0xF7A0080D, 0xDC200921, 0x09600F9B, 0x76000C50, 0xA3400AEA
+	}
+};
+
+static uint32_t crc32_ccsds_Slice8Calculate(uint32_t seed, const uint8_t *buf, uint32_t len)
+{
+	uint32_t crc = seed;
+
+	while(len >= 8)
+	{
+		uint32_t x = crc ^ (((uint32_t)buf[0]<<24) | ((uint32_t)buf[1]<<16) | ((uint32_t)buf[2]<<8) | buf[3]);
+		crc = crc32_slice8[7][x>>24] ^ crc32_slice8[6][(x>>16) & 0xFF] ^
+			  crc32_slice8[5][(x>>8) & 0xFF] ^ crc32_slice8[4][x & 0xFF] ^
+			  crc32_slice8[3][buf[4]] ^ crc32_slice8[2][buf[5]] ^
+			  crc32_slice8[1][buf[6]] ^ crc32_slice8[0][buf[7]];
+		buf += 8;
+		len -= 8;
+	}
+
+	while(len--)
+		crc = (crc<<8) ^ CRC32_CCSDS_TABLE_8[(crc>>24) ^ *buf++];
+
+	return crc;
+}
+
+const crc32_ccsds_backend_t CRC32_CCSDS_SLICE8 = {"slice8", NULL, NULL, crc32_ccsds_Slice8Calculate};
+
+
+
+
+#ifdef CRC16_CCSDS_HAS_PCLMUL
+/*
+ * PCLMULQDQ backend, the folding of crc16_ccsds.c with 32 bits constants.
+ * Blocks of 16 bytes are folded into a 128 bits accumulator
+ * X = Xh*x^64 + Xl with
+ * 		X = Xh*(x^192 mod P) ^ Xl*(x^128 mod P) ^ next block
+ * Then X is reduced to 64 bits M and the CRC (M * x^32) mod P is computed
+ * with a Barrett reduction:
+ * 		q = M ^ (clmul(M, mu) >> 64),	mu = x^96 / P without the x^64 term
+ * 		crc = clmul(q, P) mod x^32
+ */
+#define CRC32_CCSDS_PCLMUL_MU		0x00A04C2F927B72D5ULL
+#define CRC32_CCSDS_PCLMUL_POLY		0x00A00805ULL
+#define CRC32_CCSDS_PCLMUL_K64		0x92200493ULL		// x^64 mod P
+#define CRC32_CCSDS_PCLMUL_K128		0x7AA003D1ULL		// x^128 mod P
+#define CRC32_CCSDS_PCLMUL_K192		0x11E00087ULL		// x^192 mod P
+
+static uint8_t crc32_ccsds_PclmulIsSupported(void)
+{
+	__builtin_cpu_init();
+	return (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3")) ? 1 : 0;
+}
+
+__attribute__((target("pclmul,ssse3")))
+static inline uint32_t crc32_ccsds_PclmulBarrett(uint64_t m)
+{
+	const __m128i mu = _mm_cvtsi64_si128((long long)CRC32_CCSDS_PCLMUL_MU);
+	const __m128i poly = _mm_cvtsi64_si128((long long)CRC32_CCSDS_PCLMUL_POLY);
+
+	__m128i t = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)m), mu, 0x00);
+	uint64_t q = m ^ (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(t, t));
+	t = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)q), poly, 0x00);
+
+	return (uint32_t)_mm_cvtsi128_si64(t);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static uint32_t crc32_ccsds_PclmulCalculate(uint32_t seed, const uint8_t *buf, uint32_t len)
+{
+	uint32_t crc = seed;
+
+	if(len >= 32)
+	{
+		const __m128i bswap = _mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+		const __m128i k_fold = _mm_set_epi64x((long long)CRC32_CCSDS_PCLMUL_K192, (long long)CRC32_CCSDS_PCLMUL_K128);
+		const __m128i k64 = _mm_cvtsi64_si128((long long)CRC32_CCSDS_PCLMUL_K64);
+
+		__m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)buf), bswap);
+		x = _mm_xor_si128(x, _mm_set_epi64x((long long)((uint64_t)crc<<32), 0));
+		buf += 16;
+		len -= 16;
+
+		while(len >= 16)
+		{
+			__m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)buf), bswap);
+			x = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k_fold, 0x11), _mm_clmulepi64_si128(x, k_fold, 0x00)), b);
+			buf += 16;
+			len -= 16;
+		}
+
+		// 128 bits -> 96 bits -> 64 bits, all congruent mod P
+		x = _mm_xor_si128(_mm_clmulepi64_si128(x, k64, 0x01), _mm_move_epi64(x));
+		x = _mm_xor_si128(_mm_clmulepi64_si128(x, k64, 0x01), _mm_move_epi64(x));
+		crc = crc32_ccsds_PclmulBarrett((uint64_t)_mm_cvtsi128_si64(x));
+	}
+
+	while(len >= 8)
+	{
+		uint64_t m;
+		memcpy(&m, buf, 8);
+		crc = crc32_ccsds_PclmulBarrett(__builtin_bswap64(m) ^ ((uint64_t)crc<<32));
+		buf += 8;
+		len -= 8;
+	}
+
+	while(len--)
+		crc = (crc<<8) ^ CRC32_CCSDS_TABLE_8[(crc>>24) ^ *buf++];
+
+	return crc;
+}
+
+const crc32_ccsds_backend_t CRC32_CCSDS_PCLMUL = {"pclmul", NULL, crc32_ccsds_PclmulIsSupported, crc32_ccsds_PclmulCalculate};
+#endif
+
+
+
+
+#ifdef STM32_MCU
+/*
+ * STM32 CRC peripheral backend. The peripheral configured by
+ * crc16_ccsds_STM32Config() (InitValue 0, 8 bits input, without inversion)
+ * is switched to the 32 bits poly for every CRC and back to the CRC16 one.
+ * The interrupts are disabled meanwhile, so a CRC16 computed in an
+ * interrupt never uses the 32 bits poly. Other seeds are computed by
+ * software.
+ */
+static uint32_t crc32_ccsds_STM32Calculate(uint32_t seed, const uint8_t *buf, uint32_t len)
+{
+	uint32_t crc;
+	uint32_t primask;
+
+	if(seed != 0)	return crc32_ccsds_TableCalculate(seed, buf, len);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(HAL_CRCEx_Polynomial_Set(&hcrc, CRC32_CCSDS_POLY, CRC_POLYLENGTH_32B) != HAL_OK)
+	{
+		__set_PRIMASK(primask);
+		return crc32_ccsds_TableCalculate(seed, buf, len);
+	}
+	crc = HAL_CRC_Calculate(&hcrc, (uint32_t *)buf, len);
+	HAL_CRCEx_Polynomial_Set(&hcrc, 0x1021, CRC_POLYLENGTH_16B);
+	__set_PRIMASK(primask);
+
+	return crc;
+}
+
+const crc32_ccsds_backend_t CRC32_CCSDS_STM32 = {"stm32", crc16_ccsds_STM32Config, NULL, crc32_ccsds_STM32Calculate};
+#endif
@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file           : crc32_ccsds.h
+  * @brief          : CRC32 CCSDS backends for TF FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		CRC32 of the 32-bit FECF of USLP TF packets (CCSDS 732.1-B):
+  *			- Poly 32 bits: X^32 + X^23 + X^21 + X^11 + X^2 + 1 (0x00A00805)
+  *			- Init value 0, without final XOR
+  *			- Input and output without bit inversion
+  *
+  *		It is not the CRC32 of Ethernet/zlib nor the CRC32C of the SSE4.2
+  *		crc32 instruction, so it uses the same kind of backends as
+  *		crc16_ccsds.h:
+  *			- CRC32_CCSDS_STM32:	STM32 CRC peripheral in 32 bits mode
+  *									(only with STM32_MCU)
+  *			- CRC32_CCSDS_BITWISE:	Bit to bit, without tables
+  *			- CRC32_CCSDS_TABLE:	One byte per step, 1 KB table
+  *			- CRC32_CCSDS_SLICE8:	Eight bytes per step, 8 KB of const tables
+  *			- CRC32_CCSDS_PCLMUL:	Sixteen bytes per step with carry-less
+  *									multiply (only x86-64 with PCLMULQDQ)
+  *
+  *		The default backend is selected in the build with
+  *		-DCRC32_CCSDS_DEFAULT_BACKEND=<backend> and can be changed at init:
+  *			crc32_ccsds_SetBackend(crc32_ccsds_GetFastest());
+  *
+  *	 Warning:
+  *		With STM32 the peripheral is shared with crc16_ccsds.h and configured
+  *		by crc16_ccsds_STM32Config(). Every CRC32 sets the 32 bits poly and
+  *		restores the 16 bits one with the interrupts disabled, so a CRC16 of
+  *		an interrupt waits for the whole CRC32. That is why the default and
+  *		fastest backend of STM32 is CRC32_CCSDS_TABLE: select
+  *		CRC32_CCSDS_STM32 only if that interrupt latency is acceptable.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_CRC32_CCSDS_H_
+#define INC_CRC32_CCSDS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "crc16_ccsds.h"
+
+
+#define CRC32_CCSDS_POLY		0x00A00805
+
+#ifndef CRC32_CCSDS_DEFAULT_BACKEND
+#ifdef STM32_MCU
+#define CRC32_CCSDS_DEFAULT_BACKEND		CRC32_CCSDS_TABLE		// See the warning of CRC32_CCSDS_STM32
+#else
+#define CRC32_CCSDS_DEFAULT_BACKEND		CRC32_CCSDS_SLICE8
+#endif
+#endif
+
+
+typedef struct
+{
+	const char *name;
+	HAL_StatusTypeDef (*init)(void);	// Optional, called by crc32_ccsds_SetBackend()
+	uint8_t (*is_supported)(void);		// Optional, NULL if it is always supported
+	uint32_t (*calculate)(uint32_t seed, const uint8_t *buf, uint32_t len);
+}crc32_ccsds_backend_t;
+
+
+extern const crc32_ccsds_backend_t CRC32_CCSDS_BITWISE;
+extern const crc32_ccsds_backend_t CRC32_CCSDS_TABLE;
+extern const crc32_ccsds_backend_t CRC32_CCSDS_SLICE8;
+#ifdef CRC16_CCSDS_HAS_PCLMUL
+extern const crc32_ccsds_backend_t CRC32_CCSDS_PCLMUL;
+#endif
+#ifdef STM32_MCU
+extern const crc32_ccsds_backend_t CRC32_CCSDS_STM32;
+#endif
+
+extern const uint32_t CRC32_CCSDS_TABLE_8[256];
+extern const crc32_ccsds_backend_t *crc32_ccsds_backend;
+
+
+
+
+HAL_StatusTypeDef crc32_ccsds_SetBackend(const crc32_ccsds_backend_t *backend);
+const crc32_ccsds_backend_t *crc32_ccsds_GetFastest(void);
+
+/**
+ * Compute CRC32 CCSDS with the selected backend
+ * @param seed Initial value of the CRC (0 for TF packets)
+ * @param buf Pointer to data
+ * @param len Data length
+ * @return CRC32
+ */
+static inline uint32_t crc32_ccsds_Calculate(uint32_t seed, const uint8_t *buf, uint32_t len)
+{
+	return crc32_ccsds_backend->calculate(seed, buf, len);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_CRC32_CCSDS_H_ */
@@ -0,0 +1,672 @@
+/**
+  ******************************************************************************
+  * @file           : fuzz_driver.c
+  * @brief          : Standalone driver of the fuzz targets FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Driver of fuzz_targets.c without libFuzzer:
+  *			- AFL: the input is read from stdin (persistent mode with
+  *			  afl-clang-fast)
+  *			- Timing: every input of a corpus is run several times and the
+  *			  driver reports exec/s and the slowest inputs, to find the
+  *			  inputs that would stall the ingest
+  *			- Mutation (-m): a simple random fuzzer over the corpus, for
+  *			  machines without clang. Crashing inputs are saved in the
+  *			  output directory (with AddressSanitizer too) and the slowest
+  *			  inputs can be saved with -w.
+  *			- Seeds (-g): writes valid bus packets, TF packets, space packets, streams and
+  *			  captures to start a corpus
+  *
+  *	 Build:
+  *		gcc -g -O1 -fsanitize=address,undefined -Icrc -Ibus_packet -Itf_packet -Icapture -Ispace_packet \
+  *			fuzz/fuzz_driver.c fuzz/fuzz_targets.c crc/crc16_ccsds.c crc/crc32_ccsds.c bus_packet/bus_packet.c \
+  *			bus_packet/bus_packet_rx.c bus_packet/bus_packet_dispatch.c bus_packet/bus_packet_tx.c \
+  *			bus_packet/bus_packet_agg.c tf_packet/tf_packet.c capture/capture.c \
+  *			space_packet/space_packet.c -o fuzz_driver
+  *		AFL: the same with afl-clang-fast and -DFUZZ_TARGET='"name"'
+  *
+  *	 Usage:
+  *		fuzz_driver -g corpus/
+  *		fuzz_driver [-t target] [-r repeats] [-n top] corpus/ ...
+  *		fuzz_driver -t target -m iterations [-S seed] [-o dir] [-w] corpus/
+  *		fuzz_driver -t target < input
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "fuzz_targets.h"
+
+#include "bus_packet.h"
+#include "bus_packet_agg.h"
+#include "capture.h"
+#include "space_packet.h"
+#include "tf_packet.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+
+#define FUZZ_MAX_INPUT		4096
+#define FUZZ_MAX_TOP		64
+
+
+typedef struct
+{
+	char name[PATH_MAX];
+	uint8_t *data;
+	size_t size;
+}fuzz_input_t;
+
+
+typedef struct
+{
+	fuzz_input_t *inputs;
+	uint32_t count;
+	uint32_t capacity;
+}fuzz_corpus_t;
+
+
+typedef struct
+{
+	uint64_t ns;
+	uint32_t input;					// Corpus input, or mutation number
+	size_t size;
+	uint8_t data[FUZZ_MAX_INPUT];	// Only for mutations
+}fuzz_slow_t;
+
+
+// Input being run, saved if the target crashes
+static const uint8_t *fuzz_current_data;
+static size_t fuzz_current_size;
+static char fuzz_crash_path[PATH_MAX];
+
+
+extern void __sanitizer_set_death_callback(void (*callback)(void)) __attribute__((weak));
+
+
+
+
+static uint64_t fuzz_Ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static void fuzz_SaveCrash(void)
+{
+	if(fuzz_current_data == NULL || fuzz_crash_path[0] == 0)	return;
+
+	int fd = open(fuzz_crash_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd >= 0)
+	{
+		if(write(fd, fuzz_current_data, fuzz_current_size) < 0) {}
+		close(fd);
+		if(write(STDERR_FILENO, "crashing input saved in ", 24) < 0 ||
+		   write(STDERR_FILENO, fuzz_crash_path, strlen(fuzz_crash_path)) < 0 ||
+		   write(STDERR_FILENO, "\n", 1) < 0) {}
+	}
+	fuzz_current_data = NULL;
+}
+
+
+static void fuzz_SignalHandler(int signal_number)
+{
+	fuzz_SaveCrash();
+	signal(signal_number, SIG_DFL);
+	raise(signal_number);
+}
+
+
+static inline int fuzz_Run(const fuzz_target_t *target, const uint8_t *data, size_t size)
+{
+	fuzz_current_data = data;
+	fuzz_current_size = size;
+	int result = target->run(data, size);
+	fuzz_current_data = NULL;
+	return result;
+}
+
+
+
+
+static void fuzz_AddInput(fuzz_corpus_t *corpus, const char *name, const uint8_t *data, size_t size)
+{
+	if(corpus->count == corpus->capacity)
+	{
+		corpus->capacity = corpus->capacity ? corpus->capacity * 2 : 256;
+		corpus->inputs = realloc(corpus->inputs, corpus->capacity * sizeof(fuzz_input_t));
+		if(corpus->inputs == NULL)	abort();
+	}
+
+	fuzz_input_t *input = &corpus->inputs[corpus->count++];
+	snprintf(input->name, sizeof(input->name), "%s", name);
+	input->data = malloc(size ? size : 1);
+	if(input->data == NULL)		abort();
+	memcpy(input->data, data, size);
+	input->size = size;
+}
+
+
+static void fuzz_LoadFile(fuzz_corpus_t *corpus, const char *path)
+{
+	uint8_t data[FUZZ_MAX_INPUT];
+	FILE *file = fopen(path, "rb");
+
+	if(file == NULL)	return;
+	size_t size = fread(data, 1, sizeof(data), file);
+	fclose(file);
+	fuzz_AddInput(corpus, path, data, size);
+}
+
+
+static void fuzz_LoadPath(fuzz_corpus_t *corpus, const char *path)
+{
+	struct stat st;
+
+	if(stat(path, &st) != 0)
+	{
+		fprintf(stderr, "%s: not found\n", path);
+		return;
+	}
+	if(!S_ISDIR(st.st_mode))
+	{
+		fuzz_LoadFile(corpus, path);
+		return;
+	}
+
+	DIR *dir = opendir(path);
+	struct dirent *entry;
+	char file_path[PATH_MAX];
+
+	if(dir == NULL)		return;
+	while((entry = readdir(dir)) != NULL)
+	{
+		if(entry->d_name[0] == '.')		continue;
+		snprintf(file_path, sizeof(file_path), "%s/%s", path, entry->d_name);
+		if(stat(file_path, &st) == 0 && S_ISREG(st.st_mode))	fuzz_LoadFile(corpus, file_path);
+	}
+	closedir(dir);
+}
+
+
+
+
+static void fuzz_WriteSeed(const char *dir, const char *name, const uint8_t *data, size_t size)
+{
+	char path[PATH_MAX];
+	FILE *file;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	file = fopen(path, "wb");
+	if(file == NULL)	return;
+	fwrite(data, 1, size, file);
+	fclose(file);
+}
+
+
+/**
+ * Write valid inputs to start a corpus
+ */
+static void fuzz_GenerateSeeds(const char *dir)
+{
+	uint8_t data[TF_PACKET_DATA_MAX_SIZE], buffer[2 * TF_PACKET_MAX_SIZE];
+	char name[64];
+	uint32_t i;
+
+	mkdir(dir, 0755);
+	for(i = 0; i < sizeof(data); i++)	data[i] = i * 37;
+
+	// Bus packets, with and without ECF
+	for(i = 0; i <= BUS_PACKET_DATA_SIZE; i += 41)
+	{
+		bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, i % 128, BUS_PACKET_ECF_EXIST, data, i, buffer);
+		snprintf(name, sizeof(name), "bus_ecf_%u", i);
+		fuzz_WriteSeed(dir, name, buffer, bus_packet_GetLength(buffer));
+
+		bus_packet_EncodePacketize(BUS_PACKET_TYPE_TC, i % 128, BUS_PACKET_ECF_NOT_EXIST, data, i, buffer);
+		snprintf(name, sizeof(name), "bus_%u", i);
+		fuzz_WriteSeed(dir, name, buffer, bus_packet_GetLength(buffer));
+	}
+
+	// Jumbo bus packets
+	for(i = 0; i < 3; i++)
+	{
+		bus_packet_EncodePacketizeJumbo(BUS_PACKET_TYPE_TM, i, data, 60 * i, buffer);
+		snprintf(name, sizeof(name), "bus_jumbo_%u", 60 * i);
+		fuzz_WriteSeed(dir, name, buffer, bus_packet_GetLength(buffer));
+	}
+
+	// Aggregation packet data with a record of every length up to 10 bytes
+	uint8_t records[BUS_PACKET_AGG_DATA_SIZE];
+	uint32_t records_length = 0;
+	for(i = 0; i <= 10; i++)
+	{
+		records[records_length++] = BUS_PACKET_DISPATCH_ENTRY(BUS_PACKET_TYPE_TM, i);
+		records[records_length++] = i;
+		memcpy(&records[records_length], data, i);
+		records_length += i;
+	}
+	fuzz_WriteSeed(dir, "agg_records", records, records_length);
+
+	// Stream of bus packets with sync markers. The first byte is the chunk size of bus_packet_RxFeed.
+	uint32_t length = 1;
+	buffer[0] = 31;
+	for(i = 0; i < 3; i++)
+	{
+		memcpy(&buffer[length], BUS_PACKET_FRAME_SYNC, BUS_PACKET_FRAME_SYNC_SIZE);
+		bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, i, BUS_PACKET_ECF_EXIST, data, 20 + i * 10, &buffer[length + BUS_PACKET_FRAME_SYNC_SIZE]);
+		length += BUS_PACKET_FRAME_SYNC_SIZE + bus_packet_GetLength(&buffer[length + BUS_PACKET_FRAME_SYNC_SIZE]);
+	}
+	fuzz_WriteSeed(dir, "bus_stream", buffer, length);
+
+	// Space packets. The first byte is the ECF flag of space_packet_DecodeView.
+	for(i = 0; i < 2; i++)
+	{
+		buffer[0] = i;
+		space_packet_EncodePacketize(SPACE_PACKET_TYPE_TM, 0x123 + i, SPACE_PACKET_SEQ_UNSEGMENTED, i, data, i * 4, data, 60, i, &buffer[1]);
+		snprintf(name, sizeof(name), "space_%u", i);
+		fuzz_WriteSeed(dir, name, buffer, 1 + space_packet_GetLength(&buffer[1]));
+	}
+
+	// TF packets with every VC frame count length, the odd ones with OCF
+	for(i = 0; i < 8; i++)
+	{
+		tfph_packet_t tfph = {0};
+		tfdf_packet_t tfdf = {0};
+
+		tfph.tfvn = TF_PACKET_TFVN;
+		tfph.scid = TF_PACKET_DEFAULT_SCID;
+		tfph.vcid = i;
+		tfph.end_flag = TF_PACKET_NOT_TRUNCATED;
+		tfph.vc_length = i;
+		memset(tfph.vc_frame, 0x55, i);
+		tfph.ocf_flag = i & 0x01;
+		tfph.ocf = 0x01000000 | i;
+		tfph.length = TF_PACKET_PRIMARY_BASE_HEADER_SIZE + i + TF_PACKET_DATA_HEADER_SIZE + 16 * i + TF_PACKET_OCF_SIZE * tfph.ocf_flag + TF_PACKET_ECF_SIZE;
+		tfdf.constr_rule = TF_PACKET_DEFAULT_CONSTR_RULE;
+		memcpy(tfdf.data, data, 16 * i);
+		tf_packet_Packetize(16 * i, &tfph, &tfdf, buffer);
+		snprintf(name, sizeof(name), "tf_vc%u", i);
+		fuzz_WriteSeed(dir, name, buffer, tfph.length);
+	}
+
+	// TF packet longer than TF_PACKET_MAX_SIZE, sent through a channel
+	tf_packet_channel_t channel;
+	uint16_t frame_length;
+	tf_packet_ChannelInit(&channel, TF_PACKET_DEFAULT_SCID, 1, sizeof(buffer));
+	tf_packet_PacketizeChannel(&channel, data, sizeof(data), buffer, &frame_length);
+	fuzz_WriteSeed(dir, "tf_channel", buffer, frame_length);
+	tf_packet_ChannelSetEcf(&channel, TF_PACKET_ECF32_SIZE);
+	tf_packet_ChannelSetOcf(&channel, TF_PACKET_OCF_EXIST, 0x01000000);
+	tf_packet_PacketizeChannel(&channel, data, sizeof(data), buffer, &frame_length);
+	fuzz_WriteSeed(dir, "tf_channel_crc32", buffer, frame_length);
+
+	// Truncated TF packet: TFPH of 4 bytes, the length is the buffer length
+	length = TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE + 32;
+	buffer[0] = (TF_PACKET_TFVN<<4) | ((TF_PACKET_DEFAULT_SCID & 0xF000)>>12);
+	buffer[1] = (TF_PACKET_DEFAULT_SCID & 0x0FF0)>>4;
+	buffer[2] = (TF_PACKET_DEFAULT_SCID & 0x000F)<<4;
+	buffer[3] = TF_PACKET_TRUNCATED;
+	buffer[4] = TF_PACKET_DEFAULT_CONSTR_RULE<<5;
+	memcpy(&buffer[5], data, 32);
+	uint16_t crc = crc16_ccsds_Calculate(0, buffer, length);
+	buffer[length] = crc>>8;
+	buffer[length + 1] = crc;
+	fuzz_WriteSeed(dir, "tf_truncated", buffer, length + TF_PACKET_ECF_SIZE);
+
+	// Capture file with a few TF packets
+	char path[PATH_MAX];
+	capture_writer_t writer;
+	snprintf(path, sizeof(path), "%s/capture", dir);
+	if(capture_WriterOpen(&writer, path, CAPTURE_LINK_TF_PACKET) == HAL_OK)
+	{
+		for(i = 0; i < 3; i++)
+		{
+			FILE *file;
+			snprintf(path, sizeof(path), "%s/tf_vc%u", dir, i + 1);
+			if((file = fopen(path, "rb")) == NULL)	continue;
+			length = fread(buffer, 1, sizeof(buffer), file);
+			fclose(file);
+			capture_WriterAppendTfPacket(&writer, buffer, length, 1000 * i);
+		}
+		capture_WriterClose(&writer);
+	}
+
+	// Input of capture_ReaderOpen: capture length, flags, capture and index
+	uint8_t capture_seed[4096];
+	size_t capture_length = 0, index_length = 0;
+	FILE *file;
+	snprintf(path, sizeof(path), "%s/capture", dir);
+	if((file = fopen(path, "rb")) != NULL)
+	{
+		capture_length = fread(&capture_seed[3], 1, sizeof(capture_seed) - 3, file);
+		fclose(file);
+	}
+	remove(path);
+	snprintf(path, sizeof(path), "%s/capture%s", dir, CAPTURE_INDEX_SUFFIX);
+	if((file = fopen(path, "rb")) != NULL)
+	{
+		index_length = fread(&capture_seed[3 + capture_length], 1, sizeof(capture_seed) - 3 - capture_length, file);
+		fclose(file);
+	}
+	remove(path);
+	capture_seed[0] = capture_length>>8;
+	capture_seed[1] = capture_length;
+	capture_seed[2] = 0;
+	fuzz_WriteSeed(dir, "capture", capture_seed, 3 + capture_length + index_length);
+}
+
+
+
+
+static void fuzz_AddSlow(fuzz_slow_t *top, uint32_t *count, uint32_t max, uint64_t ns, uint32_t input, const uint8_t *data, size_t size)
+{
+	uint32_t i;
+
+	if(*count == max && ns <= top[max - 1].ns)	return;
+	if(*count < max)	(*count)++;
+
+	// Insertion sort, slowest first
+	for(i = *count - 1; i > 0 && top[i - 1].ns < ns; i--)	top[i] = top[i - 1];
+	top[i].ns = ns;
+	top[i].input = input;
+	top[i].size = size;
+	if(data != NULL)	memcpy(top[i].data, data, size);
+}
+
+
+static int fuzz_CompareSlow(const void *a, const void *b)
+{
+	uint64_t ns_a = ((const fuzz_slow_t *)a)->ns, ns_b = ((const fuzz_slow_t *)b)->ns;
+	return (ns_a < ns_b) - (ns_a > ns_b);
+}
+
+
+/**
+ * Run every input of the corpus and report exec/s and the slowest inputs
+ */
+static void fuzz_Timing(const fuzz_target_t *target, const fuzz_corpus_t *corpus, uint32_t repeats, uint32_t top_count)
+{
+	static fuzz_slow_t top[FUZZ_MAX_TOP];
+	uint32_t count = 0;
+	uint64_t total_ns = 0, execs = 0;
+
+	for(uint32_t i = 0; i < corpus->count; i++)
+	{
+		uint64_t best = UINT64_MAX;
+
+		for(uint32_t r = 0; r < repeats; r++)
+		{
+			uint64_t t0 = fuzz_Ns();
+			fuzz_Run(target, corpus->inputs[i].data, corpus->inputs[i].size);
+			uint64_t ns = fuzz_Ns() - t0;
+
+			total_ns += ns;
+			if(ns < best)	best = ns;
+		}
+		execs += repeats;
+		fuzz_AddSlow(top, &count, top_count, best, i, NULL, corpus->inputs[i].size);
+	}
+
+	printf("%-30s %8lu execs, %12.0f exec/s\n", target->name, (unsigned long)execs, total_ns ? execs * 1e9 / total_ns : 0);
+	for(uint32_t i = 0; i < count; i++)
+		printf("    %10.0f ns  %5zu bytes  %s\n", (double)top[i].ns, top[i].size, corpus->inputs[top[i].input].name);
+}
+
+
+static inline uint64_t fuzz_Random(uint64_t *state)
+{
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+
+static size_t fuzz_Mutate(uint64_t *state, const fuzz_corpus_t *corpus, uint8_t *data, size_t size)
+{
+	uint32_t mutations = 1 + fuzz_Random(state) % 4;
+
+	while(mutations--)
+	{
+		uint64_t r = fuzz_Random(state);
+		size_t pos = size ? (r >> 8) % size : 0;
+
+		switch(r % 7)
+		{
+		case 0:		// Bit flip
+			if(size)	data[pos] ^= 1 << ((r >> 40) & 7);
+			break;
+		case 1:		// Random byte
+			if(size)	data[pos] = r >> 40;
+			break;
+		case 2:		// Interesting byte in the length and flag fields
+			if(size)
+			{
+				static const uint8_t interesting[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x07, 0x7F, 0x80, 0xFF, 0xFE, 0x1A};
+				data[(r >> 40) % (size < 8 ? size : 8)] = interesting[(r >> 48) % sizeof(interesting)];
+			}
+			break;
+		case 3:		// Insert a byte
+			if(size < FUZZ_MAX_INPUT)
+			{
+				memmove(&data[pos + 1], &data[pos], size - pos);
+				data[pos] = r >> 40;
+				size++;
+			}
+			break;
+		case 4:		// Delete bytes
+			if(size)
+			{
+				size_t n = 1 + (r >> 40) % 8;
+				if(n > size - pos)	n = size - pos;
+				memmove(&data[pos], &data[pos + n], size - pos - n);
+				size -= n;
+			}
+			break;
+		case 5:		// Truncate
+			size = pos;
+			break;
+		default:	// Splice another input
+		{
+			const fuzz_input_t *other = &corpus->inputs[(r >> 32) % corpus->count];
+			size_t n = other->size;
+			if(pos + n > FUZZ_MAX_INPUT)	n = FUZZ_MAX_INPUT - pos;
+			memcpy(&data[pos], other->data, n);
+			if(pos + n > size)	size = pos + n;
+			break;
+		}
+		}
+	}
+
+	return size;
+}
+
+
+static void fuzz_WriteInput(const char *path, const uint8_t *data, size_t size)
+{
+	FILE *file = fopen(path, "wb");
+
+	if(file == NULL)	return;
+	fwrite(data, 1, size, file);
+	fclose(file);
+}
+
+
+/**
+ * Random mutations of the corpus inputs
+ */
+static void fuzz_Mutation(const fuzz_target_t *target, const fuzz_corpus_t *corpus, uint64_t iterations, uint64_t seed,
+						  const char *output, uint32_t repeats, uint32_t top_count, uint8_t write_slow)
+{
+	static fuzz_slow_t top[FUZZ_MAX_TOP];
+	static uint8_t data[FUZZ_MAX_INPUT];
+	uint32_t count = 0;
+	uint64_t state = seed, total_ns = 0;
+	char path[PATH_MAX];
+
+	for(uint64_t i = 0; i < iterations; i++)
+	{
+		const fuzz_input_t *input = &corpus->inputs[fuzz_Random(&state) % corpus->count];
+		size_t size = input->size < FUZZ_MAX_INPUT ? input->size : FUZZ_MAX_INPUT;
+
+		memcpy(data, input->data, size);
+		size = fuzz_Mutate(&state, corpus, data, size);
+
+		uint64_t t0 = fuzz_Ns();
+		fuzz_Run(target, data, size);
+		uint64_t ns = fuzz_Ns() - t0;
+
+		total_ns += ns;
+		fuzz_AddSlow(top, &count, top_count, ns, i, data, size);
+	}
+
+	// Time the slowest mutations again, one slow run may be a preemption
+	for(uint32_t i = 0; i < count; i++)
+	{
+		uint64_t best = UINT64_MAX;
+		for(uint32_t r = 0; r < repeats; r++)
+		{
+			uint64_t t0 = fuzz_Ns();
+			fuzz_Run(target, top[i].data, top[i].size);
+			uint64_t ns = fuzz_Ns() - t0;
+			if(ns < best)	best = ns;
+		}
+		top[i].ns = best;
+	}
+	qsort(top, count, sizeof(fuzz_slow_t), fuzz_CompareSlow);
+
+	printf("%-30s %8lu execs, %12.0f exec/s (mutations, seed %lu)\n", target->name, (unsigned long)iterations,
+		   total_ns ? iterations * 1e9 / total_ns : 0, (unsigned long)seed);
+	for(uint32_t i = 0; i < count; i++)
+	{
+		printf("    %10.0f ns  %5zu bytes  mutation %u", (double)top[i].ns, top[i].size, top[i].input);
+		if(write_slow)
+		{
+			snprintf(path, sizeof(path), "%s/slow-%s-%u", output, target->name, i);
+			fuzz_WriteInput(path, top[i].data, top[i].size);
+			printf("  %s", path);
+		}
+		printf("\n");
+	}
+}
+
+
+static void fuzz_Usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-t target] [-r repeats] [-n top] [-m iterations [-S seed] [-o dir] [-w]] inputs...\n"
+			"       %s -g dir\n"
+			"       %s -t target < input\n"
+			"targets:", name, name, name);
+	for(uint32_t i = 0; i < fuzz_targets_count; i++)
+		fprintf(stderr, " %s", fuzz_targets[i].name);
+	fprintf(stderr, "\n");
+}
+
+
+int main(int argc, char **argv)
+{
+	const fuzz_target_t *target = NULL;
+	fuzz_corpus_t corpus = {0};
+	uint32_t repeats = 10, top_count = 5;
+	uint64_t iterations = 0, seed = 1;
+	const char *output = ".";
+	uint8_t write_slow = 0;
+	int opt;
+
+#ifdef FUZZ_TARGET
+	target = fuzz_FindTarget(FUZZ_TARGET);
+#endif
+
+	while((opt = getopt(argc, argv, "t:r:n:m:S:o:wg:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 't':
+			if((target = fuzz_FindTarget(optarg)) == NULL)
+			{
+				fuzz_Usage(argv[0]);
+				return 2;
+			}
+			break;
+		case 'r':	repeats = strtoul(optarg, NULL, 0);			break;
+		case 'n':	top_count = strtoul(optarg, NULL, 0);		break;
+		case 'm':	iterations = strtoull(optarg, NULL, 0);		break;
+		case 'S':	seed = strtoull(optarg, NULL, 0);			break;
+		case 'o':	output = optarg;							break;
+		case 'w':	write_slow = 1;								break;
+		case 'g':	fuzz_GenerateSeeds(optarg);					return 0;
+		default:	fuzz_Usage(argv[0]);						return 2;
+		}
+	}
+	if(repeats == 0)	repeats = 1;
+	if(top_count > FUZZ_MAX_TOP)	top_count = FUZZ_MAX_TOP;
+
+	signal(SIGSEGV, fuzz_SignalHandler);
+	signal(SIGBUS, fuzz_SignalHandler);
+	signal(SIGABRT, fuzz_SignalHandler);
+	if(__sanitizer_set_death_callback != NULL)	__sanitizer_set_death_callback(fuzz_SaveCrash);
+
+	// AFL: one input from stdin
+	if(optind == argc)
+	{
+		snprintf(fuzz_crash_path, sizeof(fuzz_crash_path), "%s/crash-stdin", output);
+
+		static uint8_t data[FUZZ_MAX_INPUT];
+
+		if(target == NULL || isatty(STDIN_FILENO))
+		{
+			fuzz_Usage(argv[0]);
+			return 2;
+		}
+#ifdef __AFL_LOOP
+		while(__AFL_LOOP(10000))
+#endif
+		{
+			ssize_t size = read(STDIN_FILENO, data, sizeof(data));
+			if(size >= 0)	fuzz_Run(target, data, size);
+		}
+		return 0;
+	}
+
+	for(int i = optind; i < argc; i++)		fuzz_LoadPath(&corpus, argv[i]);
+	if(corpus.count == 0)
+	{
+		fprintf(stderr, "no inputs\n");
+		return 1;
+	}
+
+	for(uint32_t i = 0; i < fuzz_targets_count; i++)
+	{
+		const fuzz_target_t *t = (target != NULL) ? target : &fuzz_targets[i];
+
+		snprintf(fuzz_crash_path, sizeof(fuzz_crash_path), "%s/crash-%s-%lu", output, t->name, (unsigned long)seed);
+
+		if(iterations)	fuzz_Mutation(t, &corpus, iterations, seed, output, repeats, top_count, write_slow);
+		else			fuzz_Timing(t, &corpus, repeats, top_count);
+
+		if(target != NULL)	break;
+	}
+
+	for(uint32_t i = 0; i < corpus.count; i++)	free(corpus.inputs[i].data);
+	free(corpus.inputs);
+	return 0;
+}
@@ -0,0 +1,459 @@
+/**
+  ******************************************************************************
+  * @file           : fuzz_targets.c
+  * @brief          : Fuzz targets of the decoders FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Every target copies the input into a buffer of the size that the
+  *		decoder is allowed to read, so AddressSanitizer reports any read
+  *		out of it:
+  *			- tf_packet and space_packet decoders, captures: exactly the input
+  *			- bus_packet_Decode and bus_packet_DecodeCorrect:
+  *			  BUS_PACKET_BUS_SIZE bytes, because they take the bus packet
+  *			  length from the header; the other bus packet decoders: exactly
+  *			  the input
+  *		The first bytes of some inputs are used as parameters (chunk sizes,
+  *		offsets), the rest is the data.
+  *
+  *	 Build (libFuzzer, one binary per target):
+  *		clang -g -O1 -fsanitize=fuzzer,address,undefined -DFUZZ_TARGET='"tf_packet_Decode"' \
+  *			-Icrc -Ibus_packet -Itf_packet -Icapture -Ispace_packet fuzz/fuzz_targets.c \
+  *			crc/crc16_ccsds.c crc/crc32_ccsds.c bus_packet/bus_packet.c bus_packet/bus_packet_rx.c \
+  *			bus_packet/bus_packet_dispatch.c bus_packet/bus_packet_tx.c bus_packet/bus_packet_agg.c \
+  *			tf_packet/tf_packet.c capture/capture.c space_packet/space_packet.c \
+  *			-o fuzz_tf_packet_Decode
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "fuzz_targets.h"
+
+#include "bus_packet.h"
+#include "bus_packet_agg.h"
+#include "bus_packet_rx.h"
+#include "capture.h"
+#include "space_packet.h"
+#include "tf_packet.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+#define FUZZ_MAX_BATCH		64
+
+
+static uint8_t *fuzz_Copy(const uint8_t *data, size_t size, size_t buffer_size)
+{
+	uint8_t *buffer = calloc(buffer_size ? buffer_size : 1, 1);
+
+	if(buffer == NULL)	abort();
+	memcpy(buffer, data, (size < buffer_size) ? size : buffer_size);
+	return buffer;
+}
+
+
+
+
+static int fuzz_TfPacketDecode(const uint8_t *data, size_t size)
+{
+	tfph_packet_t tfph;
+	tfdf_packet_t tfdf;
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+
+	tf_packet_Decode(buffer, size, &tfph, &tfdf);
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_TfPacketDecodeCorrect(const uint8_t *data, size_t size)
+{
+	tfph_packet_t tfph;
+	tfdf_packet_t tfdf;
+	uint8_t corrected;
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+
+	tf_packet_DecodeCorrect(buffer, size, &tfph, &tfdf, &corrected);
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_TfPacketDecodeView(const uint8_t *data, size_t size)
+{
+	tf_packet_view_t view;
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+
+	if(tf_packet_DecodeView(buffer, size, &view) == HAL_OK)
+	{
+		// The view must point into the buffer
+		if(view.data < buffer || view.data + view.data_length > buffer + size)	abort();
+		if(view.vc_frame != NULL && (view.vc_frame < buffer || view.vc_frame + tf_packet_ViewVcLength(&view) > buffer + size))
+			abort();
+		if(view.ocf != NULL && (view.ocf < view.data + view.data_length || view.ocf + TF_PACKET_OCF_SIZE > buffer + size))
+			abort();
+	}
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_TfPacketDecodeViewChannel(const uint8_t *data, size_t size)
+{
+	tf_packet_channel_t channel;
+	tf_packet_view_t view;
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+
+	tf_packet_ChannelInit(&channel, TF_PACKET_DEFAULT_SCID, 1, TF_PACKET_USLP_MAX_SIZE);
+	tf_packet_ChannelSetEcf(&channel, TF_PACKET_ECF32_SIZE);
+	if(tf_packet_DecodeViewChannel(&channel, buffer, size, &view) == HAL_OK)
+	{
+		if(view.data < buffer || view.data + view.data_length + TF_PACKET_ECF32_SIZE > buffer + size)	abort();
+		if(view.vc_frame != NULL && (view.vc_frame < buffer || view.vc_frame + tf_packet_ViewVcLength(&view) > buffer + size))
+			abort();
+		if(view.ocf != NULL && (view.ocf < view.data + view.data_length || view.ocf + TF_PACKET_OCF_SIZE + TF_PACKET_ECF32_SIZE > buffer + size))
+			abort();
+	}
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_TfPacketDecodeHeaderBatch(const uint8_t *data, size_t size)
+{
+	uint32_t offsets[FUZZ_MAX_BATCH];
+	uint16_t scid[FUZZ_MAX_BATCH], length[FUZZ_MAX_BATCH];
+	uint8_t vcid[FUZZ_MAX_BATCH], mapid[FUZZ_MAX_BATCH], end_flag[FUZZ_MAX_BATCH], flags[FUZZ_MAX_BATCH];
+	tf_packet_header_batch_t batch = {FUZZ_MAX_BATCH, 0, scid, vcid, mapid, end_flag, length, flags};
+	uint32_t n = 0;
+
+	// 8 bytes must be readable from every offset
+	if(size < 8)	return 0;
+	for(size_t pos = 0; pos + 8 <= size && n < FUZZ_MAX_BATCH; pos += 1 + (data[pos] & 0x1F))
+		offsets[n++] = pos;
+
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+	tf_packet_DecodeHeaderBatch(buffer, offsets, n, &batch);
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_BusPacketDecode(const uint8_t *data, size_t size)
+{
+	bus_packet_t packet;
+	uint8_t *buffer = fuzz_Copy(data, size, BUS_PACKET_BUS_SIZE);
+
+	bus_packet_Decode(buffer, &packet);
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_BusPacketDecodeCorrect(const uint8_t *data, size_t size)
+{
+	bus_packet_t packet;
+	uint8_t corrected;
+	uint8_t *buffer = fuzz_Copy(data, size, BUS_PACKET_BUS_SIZE);
+
+	bus_packet_DecodeCorrect(buffer, &packet, &corrected);
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_BusPacketDecodeView(const uint8_t *data, size_t size)
+{
+	bus_packet_view_t view;
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+
+	if(bus_packet_DecodeView(buffer, size, &view) == HAL_OK &&
+	   view.data + bus_packet_ViewDataLength(&view) + BUS_PACKET_ECF_SIZE > buffer + size)	abort();
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_BusPacketDecodeViewJumbo(const uint8_t *data, size_t size)
+{
+	bus_packet_view_t view;
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+
+	if(bus_packet_DecodeViewJumbo(buffer, size, &view) == HAL_OK &&
+	   view.data + bus_packet_ViewDataLength(&view) + BUS_PACKET_ECF_SIZE > buffer + size)	abort();
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_BusPacketDecodeBatch(const uint8_t *data, size_t size)
+{
+	uint32_t offsets[FUZZ_MAX_BATCH], offset[FUZZ_MAX_BATCH];
+	uint8_t type[FUZZ_MAX_BATCH], apid[FUZZ_MAX_BATCH], ecf_flag[FUZZ_MAX_BATCH], status[FUZZ_MAX_BATCH];
+	uint16_t length[FUZZ_MAX_BATCH], ecf[FUZZ_MAX_BATCH];
+	bus_packet_batch_t batch = {FUZZ_MAX_BATCH, 0, type, apid, ecf_flag, length, ecf, offset, status};
+	uint32_t n = 0;
+
+	// The last offsets may be past the end or point to truncated bus packets
+	for(size_t pos = 0; pos < size + 8 && n < FUZZ_MAX_BATCH; pos += 1 + ((pos < size) ? (data[pos] & 0x3F) : 0))
+		offsets[n++] = pos;
+
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+	bus_packet_DecodeBatch(buffer, size, offsets, n, &batch);
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_BusPacketScanCapture(const uint8_t *data, size_t size)
+{
+	bus_packet_record_t records[8];
+	uint64_t start = 0, next;
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+
+	while(start < size)
+	{
+		uint32_t n = bus_packet_ScanCapture(buffer, size, start, records, 8, &next);
+
+		for(uint32_t i = 0; i < n; i++)
+			if(records[i].offset + records[i].length > size)	abort();
+		if(next <= start && n == 8)		abort();		// No progress
+		if(n < 8)	break;
+		start = next;
+	}
+
+	free(buffer);
+	return 0;
+}
+
+
+static void fuzz_RxCallback(void *context, uint8_t *buffer, uint32_t length)
+{
+	bus_packet_view_t view;
+	uint8_t *frame = fuzz_Copy(buffer, length, length);
+
+	(void)context;
+	if(length > BUS_PACKET_RX_FRAME_SIZE)	abort();
+	bus_packet_DecodeViewJumbo(frame, length, &view);
+	free(frame);
+}
+
+
+static int fuzz_BusPacketRxFeed(const uint8_t *data, size_t size)
+{
+	uint8_t dma_buffer[64];
+	bus_packet_rx_t rx;
+
+	if(size < 1)	return 0;
+
+	// The first byte is the size of the chunks, as the DMA events would give them
+	uint32_t chunk = 1 + data[0];
+	uint8_t *buffer = fuzz_Copy(data + 1, size - 1, size - 1);
+
+	bus_packet_RxInit(&rx, dma_buffer, sizeof(dma_buffer), fuzz_RxCallback, NULL);
+	for(size_t pos = 0; pos < size - 1; pos += chunk)
+		bus_packet_RxFeed(&rx, &buffer[pos], (size - 1 - pos < chunk) ? size - 1 - pos : chunk);
+
+	free(buffer);
+	return 0;
+}
+
+
+static void fuzz_AggRecord(void *context, const bus_packet_view_t *view)
+{
+	const uint8_t *end = (const uint8_t *)context;
+
+	if(view->data + bus_packet_ViewDataLength(view) > end || bus_packet_ViewIsAgg(view))	abort();
+}
+
+
+static int fuzz_BusPacketAggSplit(const uint8_t *data, size_t size)
+{
+	bus_packet_dispatch_t dispatch;
+	bus_packet_view_t view;
+
+	// The input is the container data, so the records are reached without a valid ECF
+	if(size > BUS_PACKET_AGG_DATA_SIZE)		return 0;
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+
+	view.length = BUS_PACKET_HEADER_SIZE + size + BUS_PACKET_ECF_SIZE;
+	view.header = (BUS_PACKET_DISPATCH_ENTRY(BUS_PACKET_TYPE_TM, BUS_PACKET_AGG_APID)<<8) | (BUS_PACKET_ECF_EXIST<<7) | view.length;
+	view.data = buffer;
+
+	// Every record is checked to lie inside the container
+	bus_packet_DispatchInit(&dispatch);
+	bus_packet_DispatchSetUnhandled(&dispatch, fuzz_AggRecord, buffer + size);
+	bus_packet_AggSplit(&dispatch, &view);
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_BusPacketSyncFrameDetect(const uint8_t *data, size_t size)
+{
+	bus_sync_flag_t flag = BUS_PACKET_SYNC_FIND;
+
+	for(size_t i = 0; i < size; i++)
+		flag = bus_packet_SyncFrameDetect(flag, data[i]);
+	return 0;
+}
+
+
+static int fuzz_SpacePacketDecodeView(const uint8_t *data, size_t size)
+{
+	space_packet_view_t view;
+
+	if(size < 1)	return 0;
+
+	// The first byte selects the ECF flag
+	uint8_t ecf_flag = data[0] & 0x01;
+	uint8_t *buffer = fuzz_Copy(data + 1, size - 1, size - 1);
+
+	if(space_packet_DecodeView(buffer, size - 1, ecf_flag, &view) == HAL_OK &&
+	   view.data + view.data_length > buffer + size - 1)	abort();
+	free(buffer);
+	return 0;
+}
+
+
+static int fuzz_SpacePacketFromBusPacket(const uint8_t *data, size_t size)
+{
+	space_packet_view_t view;
+	uint32_t length;
+	uint8_t *buffer = fuzz_Copy(data, size, size);
+
+	if(space_packet_FromBusPacket(buffer, size, 0, 0, SPACE_PACKET_ECF_EXIST, &length) == HAL_OK &&
+	   space_packet_DecodeView(buffer, length, SPACE_PACKET_ECF_EXIST, &view) != HAL_OK)	abort();
+	free(buffer);
+	return 0;
+}
+
+
+/*
+ * Write a file of the capture_ReaderOpen target
+ */
+static int fuzz_WriteFile(const char *path, const uint8_t *data, size_t size)
+{
+	FILE *file = fopen(path, "wb");
+
+	if(file == NULL)	return -1;
+	if(size && fwrite(data, size, 1, file) != 1)
+	{
+		fclose(file);
+		return -1;
+	}
+	return fclose(file);
+}
+
+
+/*
+ * data[0..1]: capture length, data[2]: bit 0 to set the index magic and
+ * capture size (so the offsets are reached), then the capture and the index
+ */
+static int fuzz_CaptureReaderOpen(const uint8_t *data, size_t size)
+{
+	char path[PATH_MAX];
+	char index_path[PATH_MAX];
+	capture_reader_t reader;
+
+	if(size < 3)	return 0;
+	size_t capture_size = ((data[0]<<8) | data[1]) % (size - 3 + 1);
+	size_t index_size = size - 3 - capture_size;
+	uint8_t patch = data[2] & 0x01;
+	data += 3;
+
+	uint8_t *index = fuzz_Copy(&data[capture_size], index_size, index_size);
+	if(patch && index_size >= sizeof(capture_index_header_t))
+	{
+		capture_index_header_t *index_header = (capture_index_header_t *)index;
+		index_header->magic = CAPTURE_INDEX_MAGIC;
+		index_header->capture_size = capture_size;
+	}
+
+	snprintf(path, sizeof(path), "%s/fuzz_capture_%d.ccap", P_tmpdir, (int)getpid());
+	snprintf(index_path, sizeof(index_path), "%s/fuzz_capture_%d.ccap%s", P_tmpdir, (int)getpid(), CAPTURE_INDEX_SUFFIX);
+	if(fuzz_WriteFile(path, data, capture_size) != 0 || fuzz_WriteFile(index_path, index, index_size) != 0)
+		goto end;
+
+	if(capture_ReaderOpen(&reader, path) == HAL_OK)
+	{
+		for(uint64_t i = 0; i < reader.count; i++)
+		{
+			const capture_record_t *record = capture_GetRecord(&reader, i);
+			const uint8_t *frame = capture_GetFrame(record);
+			tf_packet_view_t view;
+
+			if((const uint8_t *)record < reader.map + reader.header->header_size ||
+			   frame + record->length > reader.map + reader.map_size)	abort();
+			tf_packet_DecodeView(frame, record->length, &view);
+		}
+		capture_ReaderClose(&reader);
+	}
+
+end:
+	unlink(path);
+	unlink(index_path);
+	free(index);
+	return 0;
+}
+
+
+
+
+const fuzz_target_t fuzz_targets[] =
+{
+	{"tf_packet_Decode",				fuzz_TfPacketDecode},
+	{"tf_packet_DecodeCorrect",			fuzz_TfPacketDecodeCorrect},
+	{"tf_packet_DecodeView",			fuzz_TfPacketDecodeView},
+	{"tf_packet_DecodeViewChannel",		fuzz_TfPacketDecodeViewChannel},
+	{"tf_packet_DecodeHeaderBatch",		fuzz_TfPacketDecodeHeaderBatch},
+	{"bus_packet_Decode",				fuzz_BusPacketDecode},
+	{"bus_packet_DecodeCorrect",		fuzz_BusPacketDecodeCorrect},
+	{"bus_packet_DecodeView",			fuzz_BusPacketDecodeView},
+	{"bus_packet_DecodeViewJumbo",		fuzz_BusPacketDecodeViewJumbo},
+	{"bus_packet_DecodeBatch",			fuzz_BusPacketDecodeBatch},
+	{"bus_packet_ScanCapture",			fuzz_BusPacketScanCapture},
+	{"bus_packet_RxFeed",				fuzz_BusPacketRxFeed},
+	{"bus_packet_SyncFrameDetect",		fuzz_BusPacketSyncFrameDetect},
+	{"bus_packet_AggSplit",				fuzz_BusPacketAggSplit},
+	{"space_packet_DecodeView",			fuzz_SpacePacketDecodeView},
+	{"space_packet_FromBusPacket",		fuzz_SpacePacketFromBusPacket},
+	{"capture_ReaderOpen",				fuzz_CaptureReaderOpen},
+};
+
+const uint32_t fuzz_targets_count = sizeof(fuzz_targets) / sizeof(fuzz_targets[0]);
+
+
+/**
+ * Search a fuzz target by the name of its entry point
+ * @param name Name of the decode function
+ * @return Pointer to the target, or NULL if it does not exist
+ */
+const fuzz_target_t *fuzz_FindTarget(const char *name)
+{
+	for(uint32_t i = 0; i < fuzz_targets_count; i++)
+		if(strcmp(fuzz_targets[i].name, name) == 0)		return &fuzz_targets[i];
+	return NULL;
+}
+
+
+#ifdef FUZZ_TARGET
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	static const fuzz_target_t *target = NULL;
+
+	if(target == NULL && (target = fuzz_FindTarget(FUZZ_TARGET)) == NULL)	abort();
+	return target->run(data, size);
+}
+#endif
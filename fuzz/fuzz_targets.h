@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file           : fuzz_targets.h
+  * @brief          : Fuzz targets of the decoders FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		One fuzz target for every decode entry point. The same targets are
+  *		used by libFuzzer (LLVMFuzzerTestOneInput, the target is chosen with
+  *		-DFUZZ_TARGET="name"), by AFL and by the standalone driver
+  *		(fuzz_driver.c).
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_FUZZ_TARGETS_H_
+#define INC_FUZZ_TARGETS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+typedef int (*fuzz_target_function_t)(const uint8_t *data, size_t size);
+
+
+typedef struct
+{
+	const char *name;
+	fuzz_target_function_t run;
+}fuzz_target_t;
+
+
+extern const fuzz_target_t fuzz_targets[];
+extern const uint32_t fuzz_targets_count;
+
+
+const fuzz_target_t *fuzz_FindTarget(const char *name);
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_FUZZ_TARGETS_H_ */
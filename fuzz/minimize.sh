@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Corpus and crash minimizer for the fuzz targets of FyCUS 2023
+#
+# Usage:
+#	fuzz/minimize.sh corpus <fuzzer> <corpus_dir> <out_dir>
+#		Keep the smallest set of inputs of corpus_dir with the same coverage.
+#	fuzz/minimize.sh crash <fuzzer> <crash_file> [out_file]
+#		Shrink an input that crashes the fuzzer.
+#
+# The engine is taken from FUZZ_ENGINE:
+#	libfuzzer (default)	<fuzzer> built with -fsanitize=fuzzer
+#	afl					<fuzzer> built with afl-clang-fast and fuzz_driver.c
+#
+# Copyright (C) 2023 Rubén Torres Bermúdez
+#
+
+set -e
+
+ENGINE=${FUZZ_ENGINE:-libfuzzer}
+MODE=$1
+FUZZER=$2
+
+usage()
+{
+	sed -n '3,16p' "$0" | sed 's/^#//'
+	exit 2
+}
+
+[ $# -ge 3 ] || usage
+[ -x "$FUZZER" ] || { echo "$FUZZER: not executable" >&2; exit 1; }
+
+case "$MODE:$ENGINE" in
+corpus:libfuzzer)
+	mkdir -p "$4"
+	"$FUZZER" -merge=1 "$4" "$3"
+	;;
+corpus:afl)
+	afl-cmin -i "$3" -o "$4" -- "$FUZZER"
+	;;
+crash:libfuzzer)
+	OUT=${4:-$3.min}
+	"$FUZZER" -minimize_crash=1 -runs=100000 -exact_artifact_path="$OUT" "$3"
+	;;
+crash:afl)
+	OUT=${4:-$3.min}
+	afl-tmin -i "$3" -o "$OUT" -- "$FUZZER"
+	;;
+*)
+	usage
+	;;
+esac
+
+if [ "$MODE" = corpus ]; then
+	echo "$(ls "$3" | wc -l) inputs -> $(ls "$4" | wc -l) inputs in $4"
+else
+	echo "$(wc -c < "$3") bytes -> $(wc -c < "$OUT") bytes in $OUT"
+fi
@@ -0,0 +1,296 @@
+/**
+  ******************************************************************************
+  * @file           : space_packet.c
+  * @brief          : Encoder and decoder for CCSDS Space Packets FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Space Packet Protocol (CCSDS 133.0-B) codec with zero-copy view,
+  *		struct of arrays batch and in place translation from bus packets.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "space_packet.h"
+
+
+static inline uint8_t space_packet_CheckECF(const uint8_t *buffer, uint32_t length, uint16_t *ecf)
+{
+	*ecf = buffer[length-SPACE_PACKET_ECF_SIZE]<<8 | buffer[length-SPACE_PACKET_ECF_SIZE+1];
+	return crc16_ccsds_Calculate(0, buffer, length-SPACE_PACKET_ECF_SIZE) == *ecf;
+}
+
+
+static inline void space_packet_WriteHeader(uint8_t *buffer, uint8_t type, uint8_t sec_header_flag, uint16_t apid, uint8_t seq_flags, uint16_t seq_count, uint32_t data_field_length)
+{
+	buffer[0] = (SPACE_PACKET_VERSION<<5) | ((type & 0x01)<<4) | ((sec_header_flag & 0x01)<<3) | ((apid>>8) & 0b111);
+	buffer[1] = apid & 0xFF;
+	buffer[2] = ((seq_flags & 0b11)<<6) | ((seq_count>>8) & 0b00111111);
+	buffer[3] = seq_count & 0xFF;
+	buffer[4] = (data_field_length-1)>>8;
+	buffer[5] = (data_field_length-1) & 0xFF;
+}
+
+
+/**
+ * Check that a data buffer contains a whole space packet before decoding it.
+ * It does not copy anything nor check the ECF.
+ * @param buffer Data buffer with a space packet
+ * @param buffer_length Bytes that can be read from buffer
+ * @param ecf_flag
+ * 		@arg SPACE_PACKET_ECF_NOT_EXIST if the APID has no packet error control
+ * 		@arg SPACE_PACKET_ECF_EXIST if the APID has packet error control
+ * @return HAL status
+ */
+HAL_StatusTypeDef space_packet_Validate(const uint8_t *buffer, uint32_t buffer_length, uint8_t ecf_flag)
+{
+	if(buffer_length < SPACE_PACKET_HEADER_SIZE + 1)		return HAL_ERROR;
+	if((buffer[0]>>5) != SPACE_PACKET_VERSION)				return HAL_ERROR;
+
+	uint32_t length = space_packet_GetLength(buffer);
+	if(length > buffer_length)								return HAL_ERROR;
+	if(ecf_flag && length < SPACE_PACKET_HEADER_SIZE + SPACE_PACKET_ECF_SIZE)	return HAL_ERROR;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Decode the primary header of a space packet and check its ECF
+ * @param buffer Data buffer with a space packet to decode
+ * @param buffer_length Bytes that can be read from buffer
+ * @param ecf_flag
+ * 		@arg SPACE_PACKET_ECF_NOT_EXIST if the APID has no packet error control
+ * 		@arg SPACE_PACKET_ECF_EXIST if the APID has packet error control
+ * @param header Pointer to the primary header structure to save the fields
+ * @return HAL status
+ */
+HAL_StatusTypeDef space_packet_DecodeHeader(const uint8_t *buffer, uint32_t buffer_length, uint8_t ecf_flag, space_packet_header_t *header)
+{
+	uint16_t ecf = 0;
+
+	if(space_packet_Validate(buffer, buffer_length, ecf_flag) != HAL_OK)	return HAL_ERROR;
+	if(ecf_flag && !space_packet_CheckECF(buffer, space_packet_GetLength(buffer), &ecf))	return HAL_ERROR;
+
+	header->version = buffer[0]>>5;
+	header->packet_type = (buffer[0]>>4) & 0x01;
+	header->sec_header_flag = (buffer[0]>>3) & 0x01;
+	header->apid = ((buffer[0] & 0b111)<<8) | buffer[1];
+	header->seq_flags = buffer[2]>>6;
+	header->seq_count = ((buffer[2] & 0b00111111)<<8) | buffer[3];
+	header->data_length = (buffer[4]<<8) | buffer[5];
+	header->ecf = ecf;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Decode data buffer that contain a space packet without copying the data
+ * @param buffer Data buffer with a space packet to decode
+ * @param buffer_length Bytes that can be read from buffer
+ * @param ecf_flag
+ * 		@arg SPACE_PACKET_ECF_NOT_EXIST if the APID has no packet error control
+ * 		@arg SPACE_PACKET_ECF_EXIST if the APID has packet error control
+ * @param view Pointer to compact space packet to save the header and a
+ * pointer to the data into buffer
+ * @return HAL status
+ */
+HAL_StatusTypeDef space_packet_DecodeView(const uint8_t *buffer, uint32_t buffer_length, uint8_t ecf_flag, space_packet_view_t *view)
+{
+	uint16_t ecf;
+
+	if(space_packet_Validate(buffer, buffer_length, ecf_flag) != HAL_OK)	return HAL_ERROR;
+
+	uint32_t length = space_packet_GetLength(buffer);
+	if(ecf_flag && !space_packet_CheckECF(buffer, length, &ecf))	return HAL_ERROR;
+
+	view->id = ((uint32_t)buffer[0]<<24) | (buffer[1]<<16) | (buffer[2]<<8) | buffer[3];
+	view->data_length = length - SPACE_PACKET_HEADER_SIZE - (ecf_flag ? SPACE_PACKET_ECF_SIZE : 0);
+	view->data = &buffer[SPACE_PACKET_HEADER_SIZE];
+
+	return HAL_OK;
+}
+
+
+/**
+ * Decode the primary headers of many space packets into a struct of arrays
+ * @param buffer Data buffer with the space packets
+ * @param buffer_length Bytes that can be read from buffer
+ * @param offsets Offset of every space packet into buffer
+ * @param n Number of space packets
+ * @param ecf_flag ECF flag of all the space packets
+ * @param batch Pointer to the struct of arrays, filled from position 0
+ * @return Number of space packets decoded without errors
+ */
+uint32_t space_packet_DecodeBatch(const uint8_t *buffer, uint32_t buffer_length, const uint32_t *offsets, uint32_t n, uint8_t ecf_flag, space_packet_batch_t *batch)
+{
+	uint32_t decoded = 0;
+	space_packet_view_t view;
+
+	if(n > batch->capacity)		n = batch->capacity;
+
+	for(uint32_t i=0; i<n; i++)
+	{
+		HAL_StatusTypeDef status = HAL_ERROR;
+
+		view.id = 0;
+		view.data_length = 0;
+		if(offsets[i] < buffer_length)
+		{
+			status = space_packet_DecodeView(&buffer[offsets[i]], buffer_length - offsets[i], ecf_flag, &view);
+			if(status != HAL_OK && buffer_length - offsets[i] >= 4)
+			{
+				const uint8_t *packet = &buffer[offsets[i]];
+				view.id = ((uint32_t)packet[0]<<24) | (packet[1]<<16) | (packet[2]<<8) | packet[3];
+			}
+		}
+
+		batch->packet_type[i] = space_packet_ViewType(&view);
+		batch->sec_header_flag[i] = space_packet_ViewSecHeaderFlag(&view);
+		batch->apid[i] = space_packet_ViewApid(&view);
+		batch->seq_flags[i] = space_packet_ViewSeqFlags(&view);
+		batch->seq_count[i] = space_packet_ViewSeqCount(&view);
+		batch->data_length[i] = view.data_length;
+		batch->offset[i] = offsets[i];
+		batch->status[i] = status;
+
+		decoded += (status == HAL_OK);
+	}
+	batch->count = n;
+
+	return decoded;
+}
+
+
+/**
+ * Encode and packetize data into a space packet for to be transmitted
+ * @param type
+ * 		@arg SPACE_PACKET_TYPE_TM if a TM data is contained
+ * 		@arg SPACE_PACKET_TYPE_TC if a TC data is contained
+ * @param apid APID number (11 bits)
+ * @param seq_flags
+ * 		@arg SPACE_PACKET_SEQ_CONTINUATION
+ * 		@arg SPACE_PACKET_SEQ_FIRST
+ * 		@arg SPACE_PACKET_SEQ_LAST
+ * 		@arg SPACE_PACKET_SEQ_UNSEGMENTED
+ * @param seq_count Sequence count (14 bits)
+ * @param sec_header Secondary header, or NULL
+ * @param sec_header_length Secondary header length (0 if there is not)
+ * @param data Pointer to data that will be encoded
+ * @param data_length Data length
+ * @param ecf_flag
+ * 		@arg SPACE_PACKET_ECF_NOT_EXIST if an Error Control Field will be not encoded
+ * 		@arg SPACE_PACKET_ECF_EXIST if an Error Control Field will be encoded
+ * @param buffer_out Pointer to a data buffer for to be transmitted, with
+ * SPACE_PACKET_HEADER_SIZE + sec_header_length + data_length (+ ECF) bytes
+ * @return HAL status
+ */
+HAL_StatusTypeDef space_packet_EncodePacketize(uint8_t type, uint16_t apid, uint8_t seq_flags, uint16_t seq_count, const uint8_t *sec_header, uint32_t sec_header_length, const uint8_t *data, uint32_t data_length, uint8_t ecf_flag, uint8_t *buffer_out)
+{
+	uint32_t data_field_length = sec_header_length + data_length + (ecf_flag ? SPACE_PACKET_ECF_SIZE : 0);
+
+	if(data_field_length == 0 || data_field_length > SPACE_PACKET_DATA_MAX_SIZE)	return HAL_ERROR;
+	if(sec_header_length != 0 && sec_header == NULL)	return HAL_ERROR;
+
+	space_packet_WriteHeader(buffer_out, type, sec_header_length != 0, apid, seq_flags, seq_count, data_field_length);
+	if(sec_header_length)	memcpy(&buffer_out[SPACE_PACKET_HEADER_SIZE], sec_header, sec_header_length);
+	memcpy(&buffer_out[SPACE_PACKET_HEADER_SIZE+sec_header_length], data, data_length);
+
+	if (ecf_flag)	// There is CRC?
+	{
+		uint32_t length = SPACE_PACKET_HEADER_SIZE + data_field_length;
+		uint16_t ecf = crc16_ccsds_Calculate(0, buffer_out, length-SPACE_PACKET_ECF_SIZE);
+		buffer_out[length-SPACE_PACKET_ECF_SIZE] = ecf>>8;
+		buffer_out[length-SPACE_PACKET_ECF_SIZE+1] = ecf & 0xFF;
+	}
+
+	return HAL_OK;
+}
+
+
+/**
+ * Encode and packetize many unsegmented space packets without secondary
+ * header one after another into a buffer
+ * @param type Packet type of every space packet
+ * @param apid APID of every space packet
+ * @param seq_count Sequence count of every space packet
+ * @param data Data buffer with the data of all the space packets
+ * @param data_offsets Offset of the data of every space packet into data
+ * @param data_lengths Data length of every space packet
+ * @param n Number of space packets
+ * @param ecf_flag ECF flag of all the space packets
+ * @param buffer_out Data buffer where space packets are written back-to-back
+ * @param out_offsets Offset of every space packet into buffer_out, n+1
+ * elements (the last one is the total length)
+ * @return Number of space packets encoded; it stops at the first error
+ */
+uint32_t space_packet_EncodePacketizeBatch(const uint8_t *type, const uint16_t *apid, const uint16_t *seq_count, const uint8_t *data, const uint32_t *data_offsets, const uint32_t *data_lengths, uint32_t n, uint8_t ecf_flag, uint8_t *buffer_out, uint32_t *out_offsets)
+{
+	uint32_t offset = 0;
+	uint32_t i;
+
+	for(i=0; i<n; i++)
+	{
+		out_offsets[i] = offset;
+		if(space_packet_EncodePacketize(type[i], apid[i], SPACE_PACKET_SEQ_UNSEGMENTED, seq_count[i], NULL, 0, &data[data_offsets[i]], data_lengths[i], ecf_flag, &buffer_out[offset]) != HAL_OK)
+			break;
+		offset += space_packet_GetLength(&buffer_out[offset]);
+	}
+	out_offsets[i] = offset;
+
+	return i;
+}
+
+
+/**
+ * Translate a received bus packet into an unsegmented space packet in
+ * place. The primary header is written over the sync marker and the bus
+ * packet header, and the bus packet ECF slot is used for the space packet
+ * ECF, so the data is not moved.
+ * @param frame Sync marker followed by the bus packet (as sent on the bus)
+ * @param frame_length Bytes that can be read from frame
+ * @param apid_base Bits of the 11-bit APID above the 7 bits of the bus
+ * packet APID (for example the subsystem), 0 to keep the same APID
+ * @param seq_count Sequence count of the space packet (14 bits)
+ * @param ecf_flag
+ * 		@arg SPACE_PACKET_ECF_NOT_EXIST to drop the ECF
+ * 		@arg SPACE_PACKET_ECF_EXIST to compute the space packet ECF
+ * @param length Pointer to save the space packet length, from frame[0]
+ * @return HAL status
+ * 		@arg HAL_ERROR if the bus packet is not valid or its ECF is wrong;
+ * 		frame is not modified
+ */
+HAL_StatusTypeDef space_packet_FromBusPacket(uint8_t *frame, uint32_t frame_length, uint16_t apid_base, uint16_t seq_count, uint8_t ecf_flag, uint32_t *length)
+{
+	bus_packet_view_t view;
+
+	if(frame_length < BUS_PACKET_FRAME_SYNC_SIZE ||
+	   bus_packet_DecodeView(&frame[BUS_PACKET_FRAME_SYNC_SIZE], frame_length - BUS_PACKET_FRAME_SYNC_SIZE, &view) != HAL_OK)
+		return HAL_ERROR;
+
+	uint32_t data_length = bus_packet_ViewDataLength(&view);
+	uint32_t data_field_length = data_length + (ecf_flag ? SPACE_PACKET_ECF_SIZE : 0);
+	if(data_field_length == 0)	return HAL_ERROR;
+
+	space_packet_WriteHeader(frame, bus_packet_ViewType(&view), SPACE_PACKET_SEC_HEADER_NOT_EXIST,
+			(apid_base & 0x7FF) | bus_packet_ViewApid(&view), SPACE_PACKET_SEQ_UNSEGMENTED, seq_count, data_field_length);
+
+	*length = SPACE_PACKET_HEADER_SIZE + data_field_length;
+	if (ecf_flag)	// The bus packet ECF slot follows the data
+	{
+		uint16_t ecf = crc16_ccsds_Calculate(0, frame, *length-SPACE_PACKET_ECF_SIZE);
+		frame[*length-SPACE_PACKET_ECF_SIZE] = ecf>>8;
+		frame[*length-SPACE_PACKET_ECF_SIZE+1] = ecf & 0xFF;
+	}
+
+	return HAL_OK;
+}
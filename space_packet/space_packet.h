@@ -0,0 +1,153 @@
+/**
+  ******************************************************************************
+  * @file           : space_packet.h
+  * @brief          : Encoder and decoder for CCSDS Space Packets FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Space Packet Protocol (CCSDS 133.0-B) codec for the space link, with
+  *		the same zero-copy view and struct of arrays batch as bus packets:
+  *
+  *		| version (3) | type (1) | sec. header flag (1) | APID (11) |
+  *		| sequence flags (2) | sequence count (14) | data length (16) |
+  *		| secondary header (optional) | user data | ECF (optional) |
+  *
+  *		The data length field is the length of the packet data field minus
+  *		one. The secondary header format is mission specific, so its length
+  *		is given by the caller. The ECF is the optional packet error control
+  *		(CRC16 CCSDS over the whole packet); it is not signalled in the
+  *		header, so both ends must agree on it per APID.
+  *
+  *		space_packet_FromBusPacket() translates a received bus packet into
+  *		a space packet in place: the 6 bytes primary header is written over
+  *		the sync marker and the bus packet header (4 + 2 bytes), so the data
+  *		is never copied.
+  *
+  *	 Example:
+  *		uint8_t data[] = {100,1,12,234,34,3};
+  *		uint8_t buffer_out[SPACE_PACKET_HEADER_SIZE+sizeof(data)+SPACE_PACKET_ECF_SIZE];
+  *		space_packet_view_t view;
+  *		space_packet_EncodePacketize(SPACE_PACKET_TYPE_TM, 0x123, SPACE_PACKET_SEQ_UNSEGMENTED,
+  *				seq_count, NULL, 0, data, sizeof(data), SPACE_PACKET_ECF_EXIST, buffer_out);
+  *		if(space_packet_DecodeView(buffer_out, sizeof(buffer_out), SPACE_PACKET_ECF_EXIST, &view) != HAL_OK)
+  *			Error_Handle();
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_SPACE_PACKET_H_
+#define INC_SPACE_PACKET_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bus_packet.h"
+
+
+#define SPACE_PACKET_HEADER_SIZE		6
+#define SPACE_PACKET_ECF_SIZE			2
+#define SPACE_PACKET_DATA_MAX_SIZE		65536		// Packet data field
+#define SPACE_PACKET_MAX_SIZE			(SPACE_PACKET_HEADER_SIZE+SPACE_PACKET_DATA_MAX_SIZE)
+
+#define SPACE_PACKET_VERSION			0b000
+
+#define SPACE_PACKET_TYPE_TM			0
+#define SPACE_PACKET_TYPE_TC			1
+
+#define SPACE_PACKET_SEC_HEADER_NOT_EXIST	0
+#define SPACE_PACKET_SEC_HEADER_EXIST		1
+
+#define SPACE_PACKET_SEQ_CONTINUATION	0b00
+#define SPACE_PACKET_SEQ_FIRST			0b01
+#define SPACE_PACKET_SEQ_LAST			0b10
+#define SPACE_PACKET_SEQ_UNSEGMENTED	0b11
+
+#define SPACE_PACKET_ECF_NOT_EXIST		0
+#define SPACE_PACKET_ECF_EXIST			1
+
+#define SPACE_PACKET_APID_IDLE			0x7FF
+#define SPACE_PACKET_SEQ_COUNT_MASK		0x3FFF
+
+
+typedef struct
+{
+	uint8_t version;
+	uint8_t packet_type;
+	uint8_t sec_header_flag;
+	uint16_t apid;
+	uint8_t seq_flags;
+	uint16_t seq_count;
+	uint16_t data_length;		// Packet data field length - 1, as in the wire
+	uint16_t ecf;
+}space_packet_header_t;
+
+
+/*
+ * Compact decoded space packet. The first 4 bytes of the primary header are
+ * kept packed as in the wire and the data is not copied:
+ *	id bits		31..29: version, 28: packet_type, 27: sec_header_flag,
+ *				26..16: apid, 15..14: seq_flags, 13..0: seq_count
+ */
+typedef struct
+{
+	uint32_t id;
+	uint32_t data_length;		// Packet data field without ECF
+	const uint8_t *data;		// Points into the decoded buffer (secondary header and user data)
+}space_packet_view_t;
+
+
+/*
+ * Struct of arrays with the primary headers of many decoded space packets.
+ * Arrays are owned by the caller and must have capacity elements.
+ */
+typedef struct
+{
+	uint32_t capacity;
+	uint32_t count;
+	uint8_t *packet_type;
+	uint8_t *sec_header_flag;
+	uint16_t *apid;
+	uint8_t *seq_flags;
+	uint16_t *seq_count;
+	uint32_t *data_length;		// Packet data field without ECF, 0 if status is not HAL_OK
+	uint32_t *offset;			// Offset of the space packet in the decoded buffer
+	uint8_t *status;			// HAL status of every space packet
+}space_packet_batch_t;
+
+
+
+
+HAL_StatusTypeDef space_packet_Validate(const uint8_t *buffer, uint32_t buffer_length, uint8_t ecf_flag);
+HAL_StatusTypeDef space_packet_DecodeHeader(const uint8_t *buffer, uint32_t buffer_length, uint8_t ecf_flag, space_packet_header_t *header);
+HAL_StatusTypeDef space_packet_DecodeView(const uint8_t *buffer, uint32_t buffer_length, uint8_t ecf_flag, space_packet_view_t *view);
+uint32_t space_packet_DecodeBatch(const uint8_t *buffer, uint32_t buffer_length, const uint32_t *offsets, uint32_t n, uint8_t ecf_flag, space_packet_batch_t *batch);
+
+HAL_StatusTypeDef space_packet_EncodePacketize(uint8_t type, uint16_t apid, uint8_t seq_flags, uint16_t seq_count, const uint8_t *sec_header, uint32_t sec_header_length, const uint8_t *data, uint32_t data_length, uint8_t ecf_flag, uint8_t *buffer_out);
+uint32_t space_packet_EncodePacketizeBatch(const uint8_t *type, const uint16_t *apid, const uint16_t *seq_count, const uint8_t *data, const uint32_t *data_offsets, const uint32_t *data_lengths, uint32_t n, uint8_t ecf_flag, uint8_t *buffer_out, uint32_t *out_offsets);
+
+HAL_StatusTypeDef space_packet_FromBusPacket(uint8_t *frame, uint32_t frame_length, uint16_t apid_base, uint16_t seq_count, uint8_t ecf_flag, uint32_t *length);
+
+static inline uint32_t space_packet_GetLength(const uint8_t *buffer) {return SPACE_PACKET_HEADER_SIZE + ((buffer[4]<<8) | buffer[5]) + 1;}
+static inline uint16_t space_packet_NextSeqCount(uint16_t seq_count) {return (seq_count + 1) & SPACE_PACKET_SEQ_COUNT_MASK;}
+
+static inline uint8_t space_packet_ViewVersion(const space_packet_view_t *view) {return view->id>>29;}
+static inline uint8_t space_packet_ViewType(const space_packet_view_t *view) {return (view->id>>28) & 0x01;}
+static inline uint8_t space_packet_ViewSecHeaderFlag(const space_packet_view_t *view) {return (view->id>>27) & 0x01;}
+static inline uint16_t space_packet_ViewApid(const space_packet_view_t *view) {return (view->id>>16) & 0x7FF;}
+static inline uint8_t space_packet_ViewSeqFlags(const space_packet_view_t *view) {return (view->id>>14) & 0b11;}
+static inline uint16_t space_packet_ViewSeqCount(const space_packet_view_t *view) {return view->id & SPACE_PACKET_SEQ_COUNT_MASK;}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_SPACE_PACKET_H_ */
@@ -0,0 +1,45 @@
+#!/bin/sh
+#
+# Unit tests of FyCUS 2023
+#
+# Usage:
+#	test/run_tests.sh [build_dir]
+#		Build every test/test_*.c and test/test_*.cpp against the library
+#		with the host compiler (AddressSanitizer and UBSan by default) and
+#		run it. The exit code is the number of failed tests.
+#
+# The compilers and flags are taken from CC, CXX and CFLAGS.
+#
+# Copyright (C) 2023 Rubén Torres Bermúdez
+#
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+CC=${CC:-cc}
+CXX=${CXX:-c++}
+CFLAGS=${CFLAGS:--g -O1 -fsanitize=address,undefined -fno-sanitize-recover=undefined -Wall -Wextra}
+OUT=${1:-build_test}
+INC="-Icrc -Ibus_packet -Itf_packet -Icapture -Ispace_packet -Itest"
+LIB="crc/*.c bus_packet/*.c tf_packet/*.c capture/*.c space_packet/*.c"
+
+mkdir -p "$OUT/lib"
+for SRC in $LIB; do
+	$CC $CFLAGS $INC -c "$SRC" -o "$OUT/lib/$(basename "$SRC" .c).o"
+done
+
+FAILED=0
+for SRC in test/test_*.c test/test_*.cpp; do
+	[ -f "$SRC" ] || continue
+	NAME=$(basename "${SRC%.*}")
+	case "$SRC" in
+	*.cpp)	$CXX -std=c++14 $CFLAGS $INC "$SRC" "$OUT"/lib/*.o -o "$OUT/$NAME" -lpthread -lm ;;
+	*)		$CC $CFLAGS $INC "$SRC" "$OUT"/lib/*.o -o "$OUT/$NAME" -lpthread -lm ;;
+	esac
+	echo "== $NAME"
+	"$OUT/$NAME" || FAILED=$((FAILED + 1))
+done
+
+echo "$FAILED tests failed"
+exit $FAILED
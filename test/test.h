@@ -0,0 +1,76 @@
+/**
+  ******************************************************************************
+  * @file           : test.h
+  * @brief          : Minimal unit test checks FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Every test of test/ is one program with its own main(). TEST_CHECK
+  *		reports a failed condition and goes on, TEST_RUN runs a test case
+  *		and test_Report() returns the exit code. test/run_tests.sh builds
+  *		and runs all of them.
+  *
+  *	 Example:
+  *		static void test_CheckValue(void)
+  *		{
+  *			TEST_CHECK(crc16_ccsds_Calculate(0, (const uint8_t *)"123456789", 9) == 0x31C3);
+  *		}
+  *
+  *		int main(void)
+  *		{
+  *			TEST_RUN(test_CheckValue);
+  *			return test_Report();
+  *		}
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_TEST_H_
+#define INC_TEST_H_
+
+#include <stdio.h>
+
+
+static unsigned int test_checks = 0;
+static unsigned int test_failures = 0;
+
+
+#define TEST_CHECK(condition)																\
+	do																						\
+	{																						\
+		test_checks++;																		\
+		if(!(condition))																	\
+		{																					\
+			test_failures++;																\
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);			\
+		}																					\
+	} while(0)
+
+#define TEST_RUN(test)																		\
+	do																						\
+	{																						\
+		unsigned int failures = test_failures;												\
+		test();																				\
+		printf("%-40s %s\n", #test, (test_failures == failures) ? "ok" : "FAILED");			\
+	} while(0)
+
+
+/**
+ * Print the summary of the checks
+ * @return Exit code, 0 if every check passed
+ */
+static inline int test_Report(void)
+{
+	printf("%u checks, %u failed\n", test_checks, test_failures);
+	return test_failures != 0;
+}
+
+#endif /* INC_TEST_H_ */
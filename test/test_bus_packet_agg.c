@@ -0,0 +1,293 @@
+/**
+  ******************************************************************************
+  * @file           : test_bus_packet_agg.c
+  * @brief          : Tests of the bus packet coalescer and splitter FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		The flush function of the tests saves the containers, so the tests
+  *		check when they are sent (size, deadline, busy transmit queue) and
+  *		split them again through a dispatch table.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet_agg.h"
+
+#include "test.h"
+
+
+#define TEST_CONTAINERS		8
+#define TEST_RECORDS		32
+
+
+typedef struct
+{
+	HAL_StatusTypeDef status;			// Returned by the flush function
+	uint32_t count;
+	uint8_t data[TEST_CONTAINERS][BUS_PACKET_AGG_DATA_SIZE];
+	uint32_t length[TEST_CONTAINERS];
+}test_flush_t;
+
+
+typedef struct
+{
+	uint32_t count;
+	uint8_t type[TEST_RECORDS];
+	uint8_t apid[TEST_RECORDS];
+	uint8_t first[TEST_RECORDS];		// First data byte
+	uint32_t data_length[TEST_RECORDS];
+}test_records_t;
+
+
+static test_flush_t flushed;
+static test_records_t received;
+static bus_packet_dispatch_t dispatch;
+
+
+static HAL_StatusTypeDef test_Flush(void *context, uint8_t *data, uint32_t data_length)
+{
+	test_flush_t *flush = (test_flush_t *)context;
+
+	if(flush->status != HAL_OK)				return flush->status;
+	if(flush->count >= TEST_CONTAINERS)		return HAL_ERROR;
+
+	memcpy(flush->data[flush->count], data, data_length);
+	flush->length[flush->count] = data_length;
+	flush->count++;
+	return HAL_OK;
+}
+
+
+static void test_Handler(void *context, const bus_packet_view_t *view)
+{
+	test_records_t *records = (test_records_t *)context;
+
+	if(records->count >= TEST_RECORDS)	return;
+	records->type[records->count] = bus_packet_ViewType(view);
+	records->apid[records->count] = bus_packet_ViewApid(view);
+	records->data_length[records->count] = bus_packet_ViewDataLength(view);
+	records->first[records->count] = bus_packet_ViewDataLength(view) ? view->data[0] : 0;
+	records->count++;
+}
+
+
+static void test_Reset(void)
+{
+	memset(&flushed, 0, sizeof(flushed));
+	memset(&received, 0, sizeof(received));
+
+	bus_packet_DispatchInit(&dispatch);
+	bus_packet_AggRegister(&dispatch);
+	for(uint8_t apid = 0; apid < 8; apid++)
+	{
+		bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, apid, test_Handler, &received);
+		bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TC, apid, test_Handler, &received);
+	}
+}
+
+
+/*
+ * Encode a saved container as a bus packet and dispatch it
+ */
+static HAL_StatusTypeDef test_Receive(uint32_t container)
+{
+	uint8_t buffer[BUS_PACKET_BUS_SIZE];
+
+	bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, BUS_PACKET_AGG_APID, BUS_PACKET_ECF_EXIST,
+							   flushed.data[container], flushed.length[container], buffer);
+	return bus_packet_DecodeDispatch(&dispatch, buffer, sizeof(buffer));
+}
+
+
+static void test_Arguments(void)
+{
+	bus_packet_agg_t agg;
+	uint8_t data[BUS_PACKET_AGG_DATA_SIZE] = {0};
+
+	TEST_CHECK(bus_packet_AggInit(&agg, 32, 0, NULL, NULL) == HAL_ERROR);
+	TEST_CHECK(bus_packet_AggInit(&agg, BUS_PACKET_AGG_DATA_SIZE + 1, 0, test_Flush, &flushed) == HAL_ERROR);
+	TEST_CHECK(bus_packet_AggInit(&agg, BUS_PACKET_AGG_RECORD_HEADER_SIZE, 0, test_Flush, &flushed) == HAL_ERROR);
+	TEST_CHECK(bus_packet_AggInit(&agg, 32, 0, test_Flush, &flushed) == HAL_OK);
+
+	TEST_CHECK(bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, BUS_PACKET_AGG_APID, data, 1, 0) == HAL_ERROR);
+	TEST_CHECK(bus_packet_AggAdd(&agg, 2, 1, data, 1, 0) == HAL_ERROR);
+	TEST_CHECK(bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 1, data, 32 - BUS_PACKET_AGG_RECORD_HEADER_SIZE + 1, 0) == HAL_ERROR);
+	TEST_CHECK(bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 1, data, 32 - BUS_PACKET_AGG_RECORD_HEADER_SIZE, 0) == HAL_OK);
+	TEST_CHECK(agg.records == 1 && agg.length == 32);
+}
+
+
+static void test_SizeFlush(void)
+{
+	bus_packet_agg_t agg;
+	uint8_t data[20] = {10, 11, 12, 13, 14, 15};
+
+	test_Reset();
+	bus_packet_AggInit(&agg, 20, 0, test_Flush, &flushed);
+
+	// Two records of 8 bytes fit in 20, the third one sends them
+	TEST_CHECK(bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 1, data, 6, 0) == HAL_OK);
+	TEST_CHECK(bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TC, 2, data, 6, 0) == HAL_OK);
+	TEST_CHECK(flushed.count == 0);
+	TEST_CHECK(bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 3, data, 6, 0) == HAL_OK);
+	TEST_CHECK(flushed.count == 1 && flushed.length[0] == 16);
+	TEST_CHECK(agg.records == 1 && agg.length == 8);
+
+	// The container bytes: entry, length and data of every record
+	const uint8_t expected[16] = {BUS_PACKET_DISPATCH_ENTRY(BUS_PACKET_TYPE_TM, 1), 6, 10, 11, 12, 13, 14, 15,
+								  BUS_PACKET_DISPATCH_ENTRY(BUS_PACKET_TYPE_TC, 2), 6, 10, 11, 12, 13, 14, 15};
+	TEST_CHECK(memcmp(flushed.data[0], expected, sizeof(expected)) == 0);
+
+	// A record that fills the rest exactly does not send
+	TEST_CHECK(bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 4, data, 20 - 8 - BUS_PACKET_AGG_RECORD_HEADER_SIZE, 0) == HAL_OK);
+	TEST_CHECK(flushed.count == 1 && agg.length == 20);
+
+	TEST_CHECK(bus_packet_AggFlush(&agg) == HAL_OK);
+	TEST_CHECK(flushed.count == 2 && agg.records == 0);
+	TEST_CHECK(bus_packet_AggFlush(&agg) == HAL_OK && flushed.count == 2);		// Empty container
+
+	TEST_CHECK(agg.containers == 2 && agg.sent == 4 && agg.size_flushes == 1 && agg.deadline_flushes == 0);
+}
+
+
+static void test_Deadline(void)
+{
+	bus_packet_agg_t agg;
+	uint8_t data[2] = {1, 2};
+
+	test_Reset();
+	bus_packet_AggInit(&agg, BUS_PACKET_AGG_DATA_SIZE, 10, test_Flush, &flushed);
+
+	TEST_CHECK(bus_packet_AggPoll(&agg, 1000) == HAL_OK && flushed.count == 0);		// Nothing to send
+	bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 1, data, 2, 100);
+	bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 1, data, 2, 105);		// The deadline is of the first record
+	TEST_CHECK(bus_packet_AggPoll(&agg, 109) == HAL_OK && flushed.count == 0);
+	TEST_CHECK(bus_packet_AggPoll(&agg, 110) == HAL_OK && flushed.count == 1);
+	TEST_CHECK(flushed.length[0] == 8 && agg.deadline_flushes == 1);
+
+	// Across the tick wraparound
+	bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 1, data, 2, 0xFFFFFFFA);
+	TEST_CHECK(bus_packet_AggPoll(&agg, 0xFFFFFFFF) == HAL_OK && flushed.count == 1);
+	TEST_CHECK(bus_packet_AggPoll(&agg, 3) == HAL_OK && flushed.count == 1);
+	TEST_CHECK(bus_packet_AggPoll(&agg, 4) == HAL_OK && flushed.count == 2);
+
+	// Without deadline only the size sends
+	bus_packet_AggInit(&agg, BUS_PACKET_AGG_DATA_SIZE, 0, test_Flush, &flushed);
+	bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 1, data, 2, 0);
+	TEST_CHECK(bus_packet_AggPoll(&agg, 0x80000000) == HAL_OK && flushed.count == 2);
+}
+
+
+static void test_Busy(void)
+{
+	bus_packet_agg_t agg;
+	uint8_t data[6] = {0};
+
+	test_Reset();
+	bus_packet_AggInit(&agg, 16, 5, test_Flush, &flushed);
+
+	data[0] = 1;
+	bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 1, data, 6, 0);
+	data[0] = 2;
+	bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 2, data, 6, 0);
+
+	// The records are kept while the transmit queue is busy
+	flushed.status = HAL_BUSY;
+	data[0] = 3;
+	TEST_CHECK(bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 3, data, 6, 1) == HAL_BUSY);
+	TEST_CHECK(bus_packet_AggPoll(&agg, 5) == HAL_BUSY);
+	TEST_CHECK(agg.records == 2 && agg.busy == 2 && agg.containers == 0);
+
+	flushed.status = HAL_OK;
+	TEST_CHECK(bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 3, data, 6, 6) == HAL_OK);
+	TEST_CHECK(flushed.count == 1 && flushed.length[0] == 16);
+	TEST_CHECK(bus_packet_AggPoll(&agg, 11) == HAL_OK && flushed.count == 2);
+
+	TEST_CHECK(test_Receive(0) == HAL_OK && test_Receive(1) == HAL_OK);
+	TEST_CHECK(received.count == 3);
+	TEST_CHECK(received.first[0] == 1 && received.first[1] == 2 && received.first[2] == 3);
+	TEST_CHECK(agg.sent == 3 && agg.size_flushes == 1 && agg.deadline_flushes == 1);
+}
+
+
+static void test_Split(void)
+{
+	bus_packet_agg_t agg;
+	uint8_t data[BUS_PACKET_AGG_RECORD_MAX_SIZE];
+
+	test_Reset();
+	bus_packet_AggInit(&agg, BUS_PACKET_AGG_DATA_SIZE, 0, test_Flush, &flushed);
+	for(uint32_t i = 0; i < sizeof(data); i++)		data[i] = i;
+
+	// Records are delivered in order as the bus packets that they replace
+	bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 0, &data[5], 3, 0);
+	bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TC, 7, &data[9], 0, 0);
+	bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 6, &data[1], 10, 0);
+	bus_packet_AggFlush(&agg);
+
+	TEST_CHECK(test_Receive(0) == HAL_OK);
+	TEST_CHECK(received.count == 3);
+	TEST_CHECK(received.type[0] == BUS_PACKET_TYPE_TM && received.apid[0] == 0 && received.data_length[0] == 3 && received.first[0] == 5);
+	TEST_CHECK(received.type[1] == BUS_PACKET_TYPE_TC && received.apid[1] == 7 && received.data_length[1] == 0);
+	TEST_CHECK(received.type[2] == BUS_PACKET_TYPE_TM && received.apid[2] == 6 && received.data_length[2] == 10 && received.first[2] == 1);
+
+	// The longest record fills the container alone
+	memset(&received, 0, sizeof(received));
+	TEST_CHECK(bus_packet_AggAdd(&agg, BUS_PACKET_TYPE_TM, 2, data, BUS_PACKET_AGG_RECORD_MAX_SIZE, 0) == HAL_OK);
+	bus_packet_AggFlush(&agg);
+	TEST_CHECK(flushed.length[1] == BUS_PACKET_AGG_DATA_SIZE);
+	TEST_CHECK(test_Receive(1) == HAL_OK);
+	TEST_CHECK(received.count == 1 && received.data_length[0] == BUS_PACKET_AGG_RECORD_MAX_SIZE);
+	TEST_CHECK(dispatch.errors == 0);
+}
+
+
+static void test_SplitMalformed(void)
+{
+	const uint8_t entry = BUS_PACKET_DISPATCH_ENTRY(BUS_PACKET_TYPE_TM, 1);
+
+	test_Reset();
+
+	// The second record is longer than the container: only the first is delivered
+	const uint8_t too_long[] = {entry, 1, 0xAA, entry, 5, 1, 2};
+	memcpy(flushed.data[0], too_long, sizeof(too_long));
+	flushed.length[0] = sizeof(too_long);
+	TEST_CHECK(test_Receive(0) == HAL_OK);
+	TEST_CHECK(received.count == 1 && received.first[0] == 0xAA);
+	TEST_CHECK(dispatch.errors == 1);
+
+	// A container inside a container
+	const uint8_t nested[] = {BUS_PACKET_DISPATCH_ENTRY(BUS_PACKET_TYPE_TM, BUS_PACKET_AGG_APID), 2, entry, 0};
+	memcpy(flushed.data[0], nested, sizeof(nested));
+	flushed.length[0] = sizeof(nested);
+	TEST_CHECK(test_Receive(0) == HAL_OK);
+	TEST_CHECK(received.count == 1 && dispatch.errors == 2);
+
+	// A trailing byte without room for a record header
+	const uint8_t trailing[] = {entry, 0, entry};
+	memcpy(flushed.data[0], trailing, sizeof(trailing));
+	flushed.length[0] = sizeof(trailing);
+	TEST_CHECK(test_Receive(0) == HAL_OK);
+	TEST_CHECK(received.count == 2 && dispatch.errors == 3);
+}
+
+
+int main(void)
+{
+	TEST_RUN(test_Arguments);
+	TEST_RUN(test_SizeFlush);
+	TEST_RUN(test_Deadline);
+	TEST_RUN(test_Busy);
+	TEST_RUN(test_Split);
+	TEST_RUN(test_SplitMalformed);
+	return test_Report();
+}
@@ -0,0 +1,300 @@
+/**
+  ******************************************************************************
+  * @file           : test_bus_packet_dispatch.c
+  * @brief          : Tests of the bus packet dispatch table FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Handlers log their calls, so the tests check which handlers receive
+  *		every packet and in which order, the unhandled packets, the node
+  *		pool and the decode errors.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet_dispatch.h"
+
+#include "test.h"
+
+#include <string.h>
+
+
+#define TEST_APID		90
+#define TEST_LOG_SIZE	64
+
+
+static bus_packet_dispatch_t dispatch;
+static char test_log[TEST_LOG_SIZE];
+static uint32_t test_log_length;
+static uint8_t test_last_apid;
+static uint8_t test_last_type;
+static uint32_t test_last_data_length;
+static void *test_unregister_context;
+
+
+/*
+ * The context is the character logged by the handler
+ */
+static void test_Handler(void *context, const bus_packet_view_t *view)
+{
+	if(test_log_length < TEST_LOG_SIZE - 1)		test_log[test_log_length++] = *(const char *)context;
+	test_log[test_log_length] = '\0';
+	test_last_apid = bus_packet_ViewApid(view);
+	test_last_type = bus_packet_ViewType(view);
+	test_last_data_length = bus_packet_ViewDataLength(view);
+}
+
+
+static void test_OtherHandler(void *context, const bus_packet_view_t *view)
+{
+	test_Handler(context, view);
+}
+
+
+static void test_UnregisterHandler(void *context, const bus_packet_view_t *view)
+{
+	test_Handler(context, view);
+	bus_packet_DispatchUnregister(&dispatch, bus_packet_ViewType(view), bus_packet_ViewApid(view), test_UnregisterHandler, context);
+}
+
+
+/*
+ * Unregisters the test_Handler() of test_unregister_context
+ */
+static void test_UnregisterOtherHandler(void *context, const bus_packet_view_t *view)
+{
+	test_Handler(context, view);
+	bus_packet_DispatchUnregister(&dispatch, bus_packet_ViewType(view), bus_packet_ViewApid(view), test_Handler, test_unregister_context);
+}
+
+
+static void test_ClearLog(void)
+{
+	test_log_length = 0;
+	test_log[0] = '\0';
+	test_last_apid = 0xFF;
+	test_last_type = 0xFF;
+	test_last_data_length = 0;
+}
+
+
+/*
+ * Encode a bus packet and dispatch it
+ * @return Number of handlers called
+ */
+static uint32_t test_Dispatch(uint8_t type, uint8_t apid)
+{
+	uint8_t data[4] = {1, 2, 3, 4};
+	uint8_t buffer[BUS_PACKET_BUS_SIZE];
+	bus_packet_view_t view;
+
+	test_ClearLog();
+	bus_packet_EncodePacketize(type, apid, BUS_PACKET_ECF_EXIST, data, sizeof(data), buffer);
+	if(bus_packet_DecodeView(buffer, sizeof(buffer), &view) != HAL_OK)	return 0xFFFFFFFF;
+	return bus_packet_DispatchView(&dispatch, &view);
+}
+
+
+static void test_Order(void)
+{
+	static char a = 'A', b = 'B', c = 'C';
+
+	bus_packet_DispatchInit(&dispatch);
+	TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &a) == HAL_OK);
+	TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &b) == HAL_OK);
+	TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_OtherHandler, &c) == HAL_OK);
+
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 3);
+	TEST_CHECK(strcmp(test_log, "ABC") == 0);
+	TEST_CHECK(test_last_apid == TEST_APID && test_last_type == BUS_PACKET_TYPE_TM && test_last_data_length == 4);
+
+	// Removed from the middle and added again at the end
+	TEST_CHECK(bus_packet_DispatchUnregister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &b) == HAL_OK);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 2);
+	TEST_CHECK(strcmp(test_log, "AC") == 0);
+	TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &b) == HAL_OK);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 3);
+	TEST_CHECK(strcmp(test_log, "ACB") == 0);
+
+	// Removed from the head
+	TEST_CHECK(bus_packet_DispatchUnregister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &a) == HAL_OK);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 2);
+	TEST_CHECK(strcmp(test_log, "CB") == 0);
+	TEST_CHECK(dispatch.dispatched == 4 && dispatch.dropped == 0);
+}
+
+
+static void test_TypeAndApid(void)
+{
+	static char tm = 'M', tc = 'C', other = 'O';
+
+	bus_packet_DispatchInit(&dispatch);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &tm);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TC, TEST_APID, test_Handler, &tc);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, 127, test_Handler, &other);
+
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TC, TEST_APID) == 1 && strcmp(test_log, "C") == 0);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 1 && strcmp(test_log, "M") == 0);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, 127) == 1 && strcmp(test_log, "O") == 0);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TC, 127) == 0 && test_log_length == 0);
+
+	TEST_CHECK(bus_packet_DispatchHasHandler(&dispatch, BUS_PACKET_TYPE_TC, TEST_APID));
+	TEST_CHECK(!bus_packet_DispatchHasHandler(&dispatch, BUS_PACKET_TYPE_TC, 127));
+}
+
+
+static void test_Unhandled(void)
+{
+	static char handled = 'H', unhandled = 'U';
+
+	bus_packet_DispatchInit(&dispatch);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &handled);
+
+	// Dropped without an unhandled handler
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, 1) == 0 && test_log_length == 0);
+	TEST_CHECK(dispatch.dropped == 1);
+
+	bus_packet_DispatchSetUnhandled(&dispatch, test_Handler, &unhandled);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, 1) == 0 && strcmp(test_log, "U") == 0 && test_last_apid == 1);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 1 && strcmp(test_log, "H") == 0);
+	TEST_CHECK(dispatch.dropped == 2 && dispatch.dispatched == 1);
+}
+
+
+static void test_Registration(void)
+{
+	static char a = 'A', b = 'B';
+
+	bus_packet_DispatchInit(&dispatch);
+	TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, NULL, &a) == HAL_ERROR);
+	TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &a) == HAL_OK);
+	TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &a) == HAL_ERROR);
+	TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &b) == HAL_OK);
+
+	TEST_CHECK(bus_packet_DispatchUnregister(&dispatch, BUS_PACKET_TYPE_TC, TEST_APID, test_Handler, &a) == HAL_ERROR);
+	TEST_CHECK(bus_packet_DispatchUnregister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_OtherHandler, &a) == HAL_ERROR);
+	TEST_CHECK(bus_packet_DispatchUnregister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &a) == HAL_OK);
+	TEST_CHECK(bus_packet_DispatchUnregister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &a) == HAL_ERROR);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 1 && strcmp(test_log, "B") == 0);
+}
+
+
+static void test_Pool(void)
+{
+	static char contexts[BUS_PACKET_DISPATCH_HANDLERS + 1];
+
+	bus_packet_DispatchInit(&dispatch);
+	for(uint32_t i = 0; i < BUS_PACKET_DISPATCH_HANDLERS; i++)
+	{
+		contexts[i] = 'a' + i % 26;
+		TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, i % 4, test_Handler, &contexts[i]) == HAL_OK);
+	}
+	TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, 5, test_Handler, &contexts[BUS_PACKET_DISPATCH_HANDLERS]) == HAL_ERROR);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, 0) == BUS_PACKET_DISPATCH_HANDLERS / 4);
+
+	// A released node can be used by another APID
+	TEST_CHECK(bus_packet_DispatchUnregister(&dispatch, BUS_PACKET_TYPE_TM, 1, test_Handler, &contexts[1]) == HAL_OK);
+	TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, 5, test_Handler, &contexts[BUS_PACKET_DISPATCH_HANDLERS]) == HAL_OK);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, 5) == 1);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, 1) == BUS_PACKET_DISPATCH_HANDLERS / 4 - 1);
+}
+
+
+static void test_SelfUnregister(void)
+{
+	static char a = 'A', b = 'B', c = 'C';
+
+	bus_packet_DispatchInit(&dispatch);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TC, TEST_APID, test_Handler, &a);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TC, TEST_APID, test_UnregisterHandler, &b);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TC, TEST_APID, test_Handler, &c);
+
+	// A one-shot handler: the handlers after it are still called
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TC, TEST_APID) == 3 && strcmp(test_log, "ABC") == 0);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TC, TEST_APID) == 2 && strcmp(test_log, "AC") == 0);
+}
+
+
+static void test_UnregisterOther(void)
+{
+	static char a = 'A', b = 'B', c = 'C', d = 'D';
+
+	// The next handler is unregistered and not called
+	bus_packet_DispatchInit(&dispatch);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &a);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_UnregisterOtherHandler, &b);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &c);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &d);
+	test_unregister_context = &c;
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 3 && strcmp(test_log, "ABD") == 0);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 3 && strcmp(test_log, "ABD") == 0);
+
+	// The last handler
+	test_unregister_context = &d;
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 2 && strcmp(test_log, "AB") == 0);
+
+	// The previous handler, called before
+	test_unregister_context = &a;
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &c);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 3 && strcmp(test_log, "ABC") == 0);
+	TEST_CHECK(test_Dispatch(BUS_PACKET_TYPE_TM, TEST_APID) == 2 && strcmp(test_log, "BC") == 0);
+
+	// Every node is back in the pool
+	TEST_CHECK(bus_packet_DispatchUnregister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_UnregisterOtherHandler, &b) == HAL_OK);
+	TEST_CHECK(bus_packet_DispatchUnregister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &c) == HAL_OK);
+	for(uint32_t i = 0; i < BUS_PACKET_DISPATCH_HANDLERS; i++)
+		TEST_CHECK(bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TC, i % 128, test_Handler, &a) == HAL_OK);
+}
+
+
+static void test_DecodeErrors(void)
+{
+	static char a = 'A';
+	uint8_t data[4] = {1, 2, 3, 4};
+	uint8_t buffer[BUS_PACKET_BUS_SIZE];
+
+	bus_packet_DispatchInit(&dispatch);
+	bus_packet_DispatchRegister(&dispatch, BUS_PACKET_TYPE_TM, TEST_APID, test_Handler, &a);
+	bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, TEST_APID, BUS_PACKET_ECF_EXIST, data, sizeof(data), buffer);
+	uint32_t length = bus_packet_GetLength(buffer);
+
+	test_ClearLog();
+	TEST_CHECK(bus_packet_DecodeDispatch(&dispatch, buffer, length) == HAL_OK && strcmp(test_log, "A") == 0);
+
+	// Shorter than its header says
+	test_ClearLog();
+	TEST_CHECK(bus_packet_DecodeDispatch(&dispatch, buffer, length - 1) == HAL_ERROR && test_log_length == 0);
+
+	// Wrong ECF, also through the receiver callback
+	buffer[3] ^= 0x10;
+	TEST_CHECK(bus_packet_DecodeDispatch(&dispatch, buffer, length) == HAL_ERROR && test_log_length == 0);
+	bus_packet_DispatchRxCallback(&dispatch, buffer, length);
+	TEST_CHECK(test_log_length == 0);
+	buffer[3] ^= 0x10;
+	bus_packet_DispatchRxCallback(&dispatch, buffer, length);
+	TEST_CHECK(strcmp(test_log, "A") == 0);
+
+	TEST_CHECK(dispatch.errors == 3 && dispatch.dispatched == 2);
+}
+
+
+int main(void)
+{
+	TEST_RUN(test_Order);
+	TEST_RUN(test_TypeAndApid);
+	TEST_RUN(test_Unhandled);
+	TEST_RUN(test_Registration);
+	TEST_RUN(test_Pool);
+	TEST_RUN(test_SelfUnregister);
+	TEST_RUN(test_UnregisterOther);
+	TEST_RUN(test_DecodeErrors);
+	return test_Report();
+}
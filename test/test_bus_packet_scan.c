@@ -0,0 +1,134 @@
+/**
+  ******************************************************************************
+  * @file           : test_bus_packet_scan.c
+  * @brief          : Tests of the bus packet capture scan and batch decoder FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Raw captures with bus packets and jumbo bus packets (sync marker
+  *		inside the payload, corrupted and truncated ones) searched with
+  *		bus_packet_ScanCapture(), and the same bus packets decoded with
+  *		bus_packet_DecodeBatch().
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet.h"
+
+#include "test.h"
+
+
+#define TEST_CAPTURE_SIZE		(4 * (BUS_PACKET_FRAME_SYNC_SIZE + BUS_PACKET_JUMBO_MAX_SIZE))
+
+
+static uint8_t capture[TEST_CAPTURE_SIZE];
+static uint32_t capture_length;
+
+
+static uint32_t test_Append(const uint8_t *packet)
+{
+	uint32_t offset = capture_length + BUS_PACKET_FRAME_SYNC_SIZE;
+
+	memcpy(&capture[capture_length], BUS_PACKET_FRAME_SYNC, BUS_PACKET_FRAME_SYNC_SIZE);
+	memcpy(&capture[offset], packet, bus_packet_GetLength(packet));
+	capture_length = offset + bus_packet_GetLength(packet);
+	return offset;
+}
+
+
+static void test_ScanJumbo(void)
+{
+	uint8_t data[BUS_PACKET_JUMBO_DATA_SIZE];
+	uint8_t packet[BUS_PACKET_JUMBO_MAX_SIZE];
+	uint32_t offsets[3];
+	bus_packet_record_t records[8];
+	uint64_t next;
+
+	// The jumbo payload holds a sync marker and a valid bus packet
+	memset(data, 0x55, sizeof(data));
+	memcpy(&data[100], BUS_PACKET_FRAME_SYNC, BUS_PACKET_FRAME_SYNC_SIZE);
+	TEST_CHECK(bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, 3, BUS_PACKET_ECF_EXIST, data, 10, &data[100 + BUS_PACKET_FRAME_SYNC_SIZE]) == HAL_OK);
+
+	capture_length = 0;
+	TEST_CHECK(bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, 1, BUS_PACKET_ECF_EXIST, data, 20, packet) == HAL_OK);
+	offsets[0] = test_Append(packet);
+	TEST_CHECK(bus_packet_EncodePacketizeJumbo(BUS_PACKET_TYPE_TC, 2, data, 1000, packet) == HAL_OK);
+	offsets[1] = test_Append(packet);
+	TEST_CHECK(bus_packet_EncodePacketizeJumbo(BUS_PACKET_TYPE_TM, 4, data, 30, packet) == HAL_OK);
+	offsets[2] = test_Append(packet);
+
+	TEST_CHECK(bus_packet_ScanCapture(capture, capture_length, 0, records, 8, &next) == 3);
+	TEST_CHECK(next == capture_length);
+
+	TEST_CHECK(records[0].offset == offsets[0] && records[0].length == 24 && records[0].apid == 1);
+	TEST_CHECK(records[0].header_size == BUS_PACKET_HEADER_SIZE && records[0].crc_ok);
+
+	TEST_CHECK(records[1].offset == offsets[1] && records[1].apid == 2 && records[1].packet_type == BUS_PACKET_TYPE_TC);
+	TEST_CHECK(records[1].length == 1000 + BUS_PACKET_JUMBO_HEADER_SIZE + BUS_PACKET_ECF_SIZE);
+	TEST_CHECK(records[1].header_size == BUS_PACKET_JUMBO_HEADER_SIZE && records[1].ecf_flag && records[1].crc_ok);
+
+	// A short jumbo bus packet, where the 7-bit length is 0
+	TEST_CHECK(records[2].offset == offsets[2] && records[2].apid == 4);
+	TEST_CHECK(records[2].length == 30 + BUS_PACKET_JUMBO_HEADER_SIZE + BUS_PACKET_ECF_SIZE && records[2].crc_ok);
+
+	// A corrupted jumbo bus packet is reported and searched inside
+	capture[offsets[1] + 500] ^= 0x01;
+	TEST_CHECK(bus_packet_ScanCapture(capture, capture_length, 0, records, 8, &next) == 4);
+	TEST_CHECK(records[1].offset == offsets[1] && !records[1].crc_ok);
+	TEST_CHECK(records[2].offset == offsets[1] + 4 + 100 + BUS_PACKET_FRAME_SYNC_SIZE && records[2].apid == 3 && records[2].crc_ok);
+	TEST_CHECK(records[3].offset == offsets[2]);
+	capture[offsets[1] + 500] ^= 0x01;
+
+	// A truncated jumbo bus packet is not a record
+	TEST_CHECK(bus_packet_ScanCapture(capture, offsets[2] + 20, 0, records, 8, &next) == 2);
+	TEST_CHECK(bus_packet_ScanCapture(capture, offsets[2] + 3, 0, records, 8, &next) == 2);
+
+	// Full records: the next search starts after the last one
+	TEST_CHECK(bus_packet_ScanCapture(capture, capture_length, 0, records, 2, &next) == 2);
+	TEST_CHECK(next == offsets[2] - BUS_PACKET_FRAME_SYNC_SIZE);
+	TEST_CHECK(bus_packet_ScanCapture(capture, capture_length, next, records, 2, &next) == 1);
+	TEST_CHECK(records[0].offset == offsets[2]);
+}
+
+
+static void test_DecodeBatch(void)
+{
+	uint8_t data[BUS_PACKET_JUMBO_DATA_SIZE] = {0};
+	uint8_t packet[BUS_PACKET_JUMBO_MAX_SIZE];
+	uint32_t offsets[4];
+	uint8_t type[4], apid[4], ecf_flag[4], status[4];
+	uint16_t length[4], ecf[4], view_ecf;
+	uint32_t offset[4];
+	bus_packet_batch_t batch = {4, 0, type, apid, ecf_flag, length, ecf, offset, status};
+
+	capture_length = 0;
+	TEST_CHECK(bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, 1, BUS_PACKET_ECF_EXIST, data, 20, packet) == HAL_OK);
+	offsets[0] = test_Append(packet);
+	TEST_CHECK(bus_packet_EncodePacketizeJumbo(BUS_PACKET_TYPE_TM, 2, data, BUS_PACKET_JUMBO_DATA_SIZE, packet) == HAL_OK);
+	offsets[1] = test_Append(packet);
+	view_ecf = (packet[BUS_PACKET_JUMBO_MAX_SIZE - 2]<<8) | packet[BUS_PACKET_JUMBO_MAX_SIZE - 1];
+	offsets[2] = offsets[1] + 2;			// Length 0
+	offsets[3] = capture_length - 2;		// Truncated header
+
+	TEST_CHECK(bus_packet_DecodeBatch(capture, capture_length, offsets, 4, &batch) == 2);
+	TEST_CHECK(status[0] == HAL_OK && length[0] == 24 && apid[0] == 1);
+	TEST_CHECK(status[1] == HAL_OK && length[1] == BUS_PACKET_JUMBO_MAX_SIZE && apid[1] == 2);
+	TEST_CHECK(ecf_flag[1] == 1 && ecf[1] == view_ecf && offset[1] == offsets[1]);
+	TEST_CHECK(status[2] == HAL_ERROR && status[3] == HAL_ERROR);
+}
+
+
+int main(void)
+{
+	TEST_RUN(test_ScanJumbo);
+	TEST_RUN(test_DecodeBatch);
+	return test_Report();
+}
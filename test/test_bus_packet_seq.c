@@ -0,0 +1,311 @@
+/**
+  ******************************************************************************
+  * @file           : test_bus_packet_seq.c
+  * @brief          : Tests of the bus packet sequence count tracker FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Fixed sequences of counts with gaps, duplicates, reordered packets,
+  *		resyncs and the 16-bit wraparound, and the sender and receiver
+  *		together through bus_packet_DecodeView().
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet_seq.h"
+
+#include "test.h"
+
+
+#define TEST_APID		90
+
+
+static bus_packet_seq_rx_t seq_rx;
+
+
+static const bus_packet_seq_stats_t *test_Stats(void)
+{
+	return &seq_rx.apid[TEST_APID].stats;
+}
+
+
+static void test_Reset(void)
+{
+	bus_packet_SeqRxInit(&seq_rx, BUS_PACKET_SEQ_DEFAULT_FLYWHEEL);
+	bus_packet_SeqRxEnable(&seq_rx, TEST_APID, 1);
+}
+
+
+static void test_InOrder(void)
+{
+	test_Reset();
+
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 100) == BUS_PACKET_SEQ_FIRST);
+	for(uint16_t count = 101; count < 200; count++)
+		TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, count) == BUS_PACKET_SEQ_IN_ORDER);
+
+	TEST_CHECK(test_Stats()->received == 100);
+	TEST_CHECK(test_Stats()->lost == 0 && test_Stats()->gaps == 0 && test_Stats()->resyncs == 0);
+	TEST_CHECK(seq_rx.apid[TEST_APID].expected == 200);
+}
+
+
+static void test_Gap(void)
+{
+	test_Reset();
+
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 0) == BUS_PACKET_SEQ_FIRST);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1) == BUS_PACKET_SEQ_IN_ORDER);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 4) == BUS_PACKET_SEQ_GAP);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 5) == BUS_PACKET_SEQ_IN_ORDER);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 100) == BUS_PACKET_SEQ_GAP);
+
+	TEST_CHECK(test_Stats()->received == 5);
+	TEST_CHECK(test_Stats()->lost == 2 + 94);
+	TEST_CHECK(test_Stats()->gaps == 2);
+}
+
+
+static void test_Duplicate(void)
+{
+	test_Reset();
+
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 7) == BUS_PACKET_SEQ_FIRST);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 7) == BUS_PACKET_SEQ_DUPLICATE);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 8) == BUS_PACKET_SEQ_IN_ORDER);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 9) == BUS_PACKET_SEQ_IN_ORDER);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 7) == BUS_PACKET_SEQ_DUPLICATE);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 8) == BUS_PACKET_SEQ_DUPLICATE);
+
+	TEST_CHECK(test_Stats()->received == 3);
+	TEST_CHECK(test_Stats()->duplicates == 3);
+	TEST_CHECK(test_Stats()->lost == 0);
+}
+
+
+static void test_Reordered(void)
+{
+	test_Reset();
+
+	// 10, 13, 11, 12: 11 and 12 are counted as lost and then found
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 10) == BUS_PACKET_SEQ_FIRST);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 13) == BUS_PACKET_SEQ_GAP);
+	TEST_CHECK(test_Stats()->lost == 2);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 11) == BUS_PACKET_SEQ_REORDERED);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 12) == BUS_PACKET_SEQ_REORDERED);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 11) == BUS_PACKET_SEQ_DUPLICATE);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 14) == BUS_PACKET_SEQ_IN_ORDER);
+
+	TEST_CHECK(test_Stats()->received == 5);
+	TEST_CHECK(test_Stats()->lost == 0);
+	TEST_CHECK(test_Stats()->reordered == 2);
+	TEST_CHECK(test_Stats()->duplicates == 1);
+	TEST_CHECK(test_Stats()->gaps == 1);
+}
+
+
+static void test_Window(void)
+{
+	test_Reset();
+
+	// The oldest count of the window is expected-BUS_PACKET_SEQ_WINDOW
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1000) == BUS_PACKET_SEQ_FIRST);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1000 + BUS_PACKET_SEQ_WINDOW) == BUS_PACKET_SEQ_GAP);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1001) == BUS_PACKET_SEQ_REORDERED);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1001) == BUS_PACKET_SEQ_DUPLICATE);
+	TEST_CHECK(test_Stats()->lost == BUS_PACKET_SEQ_WINDOW - 2);
+
+	// A gap as long as the window clears it, so the counts before the gap are new again
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1000 + 2 * BUS_PACKET_SEQ_WINDOW) == BUS_PACKET_SEQ_GAP);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1001 + BUS_PACKET_SEQ_WINDOW) == BUS_PACKET_SEQ_REORDERED);
+
+	// One count before the window is a resync and starts again from it
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1000 + BUS_PACKET_SEQ_WINDOW) == BUS_PACKET_SEQ_RESYNC);
+	TEST_CHECK(test_Stats()->resyncs == 1);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1001 + BUS_PACKET_SEQ_WINDOW) == BUS_PACKET_SEQ_IN_ORDER);
+}
+
+
+static void test_Resync(void)
+{
+	test_Reset();
+
+	// The sender restarts from 0
+	for(uint16_t count = 500; count < 510; count++)
+		bus_packet_SeqTrack(&seq_rx, TEST_APID, count);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 0) == BUS_PACKET_SEQ_RESYNC);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1) == BUS_PACKET_SEQ_IN_ORDER);
+
+	TEST_CHECK(test_Stats()->received == 12);
+	TEST_CHECK(test_Stats()->resyncs == 1);
+	TEST_CHECK(test_Stats()->lost == 0 && test_Stats()->gaps == 0);
+}
+
+
+static void test_BeforeFirst(void)
+{
+	test_Reset();
+
+	// Counts before the first packet were never counted as lost
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 10) == BUS_PACKET_SEQ_FIRST);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 15) == BUS_PACKET_SEQ_GAP);
+	TEST_CHECK(test_Stats()->lost == 4);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 5) == BUS_PACKET_SEQ_DUPLICATE);
+	TEST_CHECK(test_Stats()->lost == 4 && test_Stats()->reordered == 0);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 12) == BUS_PACKET_SEQ_REORDERED);
+	TEST_CHECK(test_Stats()->lost == 3);
+
+	// The same after a resync
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 5000) == BUS_PACKET_SEQ_RESYNC);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 4999) == BUS_PACKET_SEQ_DUPLICATE);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 5001 - BUS_PACKET_SEQ_WINDOW) == BUS_PACKET_SEQ_DUPLICATE);
+	TEST_CHECK(test_Stats()->lost == 3 && test_Stats()->reordered == 1);
+}
+
+
+static void test_Flywheel(void)
+{
+	bus_packet_SeqRxInit(&seq_rx, 100);
+	bus_packet_SeqRxEnable(&seq_rx, TEST_APID, 1);
+
+	// The longest gap counted as lost
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 0) == BUS_PACKET_SEQ_FIRST);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 101) == BUS_PACKET_SEQ_GAP);
+	TEST_CHECK(test_Stats()->lost == 100);
+
+	// The sender restarted: a longer jump forward is not lost
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 203) == BUS_PACKET_SEQ_RESYNC);
+	TEST_CHECK(test_Stats()->lost == 100 && test_Stats()->gaps == 1 && test_Stats()->resyncs == 1);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 204) == BUS_PACKET_SEQ_IN_ORDER);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 204 + 32767) == BUS_PACKET_SEQ_RESYNC);
+	TEST_CHECK(test_Stats()->lost == 100 && test_Stats()->received == 5);
+
+	// Every jump forward counted as lost with the longest flywheel
+	bus_packet_SeqRxInit(&seq_rx, 0xFFFFFFFF);
+	bus_packet_SeqRxEnable(&seq_rx, TEST_APID, 1);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 0) == BUS_PACKET_SEQ_FIRST);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 32768) == BUS_PACKET_SEQ_GAP);
+	TEST_CHECK(test_Stats()->lost == 32767);
+}
+
+
+static void test_Wraparound(void)
+{
+	test_Reset();
+
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 65534) == BUS_PACKET_SEQ_FIRST);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 65535) == BUS_PACKET_SEQ_IN_ORDER);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 0) == BUS_PACKET_SEQ_IN_ORDER);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 3) == BUS_PACKET_SEQ_GAP);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 65535) == BUS_PACKET_SEQ_DUPLICATE);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 1) == BUS_PACKET_SEQ_REORDERED);
+
+	TEST_CHECK(test_Stats()->received == 5);
+	TEST_CHECK(test_Stats()->lost == 1);
+	TEST_CHECK(test_Stats()->duplicates == 1);
+	TEST_CHECK(test_Stats()->resyncs == 0);
+
+	// A gap across the wraparound
+	test_Reset();
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 65530) == BUS_PACKET_SEQ_FIRST);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 4) == BUS_PACKET_SEQ_GAP);
+	TEST_CHECK(test_Stats()->lost == 9);
+}
+
+
+static void test_EnableResets(void)
+{
+	test_Reset();
+
+	bus_packet_SeqTrack(&seq_rx, TEST_APID, 0);
+	bus_packet_SeqTrack(&seq_rx, TEST_APID, 10);
+	bus_packet_SeqRxEnable(&seq_rx, TEST_APID, 1);
+
+	TEST_CHECK(test_Stats()->received == 0 && test_Stats()->lost == 0);
+	TEST_CHECK(bus_packet_SeqTrack(&seq_rx, TEST_APID, 10) == BUS_PACKET_SEQ_FIRST);
+}
+
+
+static void test_SenderReceiver(void)
+{
+	bus_packet_seq_tx_t seq_tx;
+	uint8_t data[BUS_PACKET_DATA_SIZE] = {1, 2, 3, 4, 5, 6};
+	uint8_t buffer[BUS_PACKET_BUS_SIZE];
+	bus_packet_view_t view;
+
+	test_Reset();
+	bus_packet_SeqTxInit(&seq_tx);
+	bus_packet_SeqTxEnable(&seq_tx, TEST_APID, 1);
+
+	for(uint32_t n = 0; n < 10; n++)
+	{
+		TEST_CHECK(bus_packet_SeqEncodePacketize(&seq_tx, BUS_PACKET_TYPE_TM, TEST_APID, BUS_PACKET_ECF_EXIST, data, 6, buffer) == HAL_OK);
+		if(n == 4 || n == 5)	continue;	// Lost in the bus
+
+		TEST_CHECK(bus_packet_DecodeView(buffer, sizeof(buffer), &view) == HAL_OK);
+		TEST_CHECK(bus_packet_ViewDataLength(&view) == 6 + BUS_PACKET_SEQ_SIZE);
+		TEST_CHECK(bus_packet_SeqGet(view.data) == n);
+		TEST_CHECK(bus_packet_SeqData(view.data)[0] == 1 && bus_packet_SeqData(view.data)[5] == 6);
+		TEST_CHECK(bus_packet_SeqTrackView(&seq_rx, &view) == ((n == 0) ? BUS_PACKET_SEQ_FIRST :
+				   (n == 6) ? BUS_PACKET_SEQ_GAP : BUS_PACKET_SEQ_IN_ORDER));
+	}
+	TEST_CHECK(test_Stats()->received == 8 && test_Stats()->lost == 2);
+
+	// The longest data with the sequence count
+	TEST_CHECK(bus_packet_SeqEncodePacketize(&seq_tx, BUS_PACKET_TYPE_TM, TEST_APID, BUS_PACKET_ECF_EXIST, data, BUS_PACKET_SEQ_DATA_SIZE, buffer) == HAL_OK);
+	TEST_CHECK(bus_packet_SeqEncodePacketize(&seq_tx, BUS_PACKET_TYPE_TM, TEST_APID, BUS_PACKET_ECF_EXIST, data, BUS_PACKET_SEQ_DATA_SIZE + 1, buffer) == HAL_ERROR);
+	TEST_CHECK(seq_tx.count[TEST_APID] == 11);
+
+	// Other APIDs are legacy bus packets
+	TEST_CHECK(bus_packet_SeqEncodePacketize(&seq_tx, BUS_PACKET_TYPE_TM, TEST_APID + 1, BUS_PACKET_ECF_EXIST, data, 6, buffer) == HAL_OK);
+	TEST_CHECK(bus_packet_DecodeView(buffer, sizeof(buffer), &view) == HAL_OK);
+	TEST_CHECK(bus_packet_ViewDataLength(&view) == 6 && view.data[0] == 1);
+	TEST_CHECK(bus_packet_SeqTrackView(&seq_rx, &view) == BUS_PACKET_SEQ_DISABLED);
+	TEST_CHECK(seq_tx.count[TEST_APID + 1] == 0);
+}
+
+
+static void test_Totals(void)
+{
+	bus_packet_seq_stats_t totals;
+
+	bus_packet_SeqRxInit(&seq_rx, BUS_PACKET_SEQ_DEFAULT_FLYWHEEL);
+	bus_packet_SeqRxEnable(&seq_rx, 1, 1);
+	bus_packet_SeqRxEnable(&seq_rx, 127, 1);
+
+	bus_packet_SeqTrack(&seq_rx, 1, 0);
+	bus_packet_SeqTrack(&seq_rx, 1, 3);
+	bus_packet_SeqTrack(&seq_rx, 127, 0);
+	bus_packet_SeqTrack(&seq_rx, 127, 0);
+	bus_packet_SeqTotals(&seq_rx, &totals);
+
+	TEST_CHECK(totals.received == 3);
+	TEST_CHECK(totals.lost == 2 && totals.gaps == 1);
+	TEST_CHECK(totals.duplicates == 1);
+}
+
+
+int main(void)
+{
+	TEST_RUN(test_InOrder);
+	TEST_RUN(test_Gap);
+	TEST_RUN(test_Duplicate);
+	TEST_RUN(test_Reordered);
+	TEST_RUN(test_Window);
+	TEST_RUN(test_Resync);
+	TEST_RUN(test_BeforeFirst);
+	TEST_RUN(test_Flywheel);
+	TEST_RUN(test_Wraparound);
+	TEST_RUN(test_EnableResets);
+	TEST_RUN(test_SenderReceiver);
+	TEST_RUN(test_Totals);
+	return test_Report();
+}
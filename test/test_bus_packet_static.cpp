@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file           : test_bus_packet_static.cpp
+  * @brief          : Tests of the compile-time bus packet encoder FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		The constexpr encoder of bus_packet_static.hpp is checked against
+  *		known vectors at compile time and against bus_packet_EncodePacketize()
+  *		at run time for every data length, APID, type and ECF flag.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet_static.hpp"
+
+#include "test.h"
+
+#include <cstring>
+#include <utility>
+
+
+namespace
+{
+
+/*
+ * Compile-time checks against vectors produced by bus_packet_EncodePacketize()
+ */
+constexpr uint8_t check_string[] = {'1','2','3','4','5','6','7','8','9'};
+static_assert(bus_packet::CRC16CCSDSCalculate(check_string, sizeof(check_string)) == 0x31C3, "CRC16 CCSDS check value");
+
+constexpr uint8_t check_data[] = {100,1,12,234,34,3};
+constexpr auto check_packet = bus_packet::EncodePacketize(BUS_PACKET_TYPE_TC, 90, BUS_PACKET_ECF_EXIST, check_data);
+static_assert(check_packet.size == 10, "Bus packet size");
+static_assert(check_packet[0] == 0xDA && check_packet[1] == 0x8A, "Bus packet header");
+static_assert(check_packet[2] == 100 && check_packet[7] == 3, "Bus packet data");
+static_assert(check_packet[8] == 0x74 && check_packet[9] == 0xE3, "Bus packet ECF");
+static_assert(bus_packet::CheckECF(check_packet.bytes), "Bus packet ECF check");
+static_assert(bus_packet::GetType(check_packet.bytes) == BUS_PACKET_TYPE_TC && bus_packet::GetApid(check_packet.bytes) == 90 &&
+		bus_packet::GetLength(check_packet.bytes) == check_packet.size, "Bus packet header decode");
+
+constexpr auto check_packet_no_ecf = bus_packet::EncodePacketize(BUS_PACKET_TYPE_TM, 5, BUS_PACKET_ECF_NOT_EXIST, check_data);
+static_assert(check_packet_no_ecf[1] == 0x0A && check_packet_no_ecf[8] == 0 && check_packet_no_ecf[9] == 0, "Bus packet without ECF");
+
+
+/*
+ * Both encoders with DataLength bytes, for every APID, type and ECF flag.
+ * Without ECF the last 2 bytes are left as they were by
+ * bus_packet_EncodePacketize(), so only the header and data are compared.
+ */
+template <std::size_t DataLength>
+void test_CompareLength()
+{
+	uint8_t data[DataLength];
+	uint8_t buffer[BUS_PACKET_BUS_SIZE + 1];
+
+	for(uint32_t type = 0; type < 2; type++)
+		for(uint32_t ecf_flag = 0; ecf_flag < 2; ecf_flag++)
+			for(uint32_t apid = 0; apid < 128; apid++)
+			{
+				for(std::size_t i = 0; i < DataLength; i++)		data[i] = static_cast<uint8_t>(i * 37 + apid);
+
+				const auto packet = bus_packet::EncodePacketize(type, apid, ecf_flag, data);
+
+				std::memset(buffer, 0xAA, sizeof(buffer));
+				TEST_CHECK(bus_packet_EncodePacketize(type, apid, ecf_flag, data, DataLength, buffer) == HAL_OK);
+				TEST_CHECK(packet.size == bus_packet::GetLength(buffer));
+				TEST_CHECK(std::memcmp(packet.bytes, buffer, ecf_flag ? packet.size : packet.size - BUS_PACKET_ECF_SIZE) == 0);
+				TEST_CHECK(bus_packet::CheckECF(packet.bytes));
+			}
+}
+
+template <std::size_t... DataLength>
+void test_CompareLengths(std::index_sequence<DataLength...>)
+{
+	// Lengths 1..BUS_PACKET_DATA_SIZE (a zero length array cannot be passed)
+	int expand[] = {(test_CompareLength<DataLength + 1>(), 0)...};
+	(void)expand;
+}
+
+void test_CompareEncoders()
+{
+	test_CompareLengths(std::make_index_sequence<BUS_PACKET_DATA_SIZE>());
+}
+
+
+void test_CheckECF()
+{
+	static constexpr uint8_t data[] = {1,2,3,4,5,6,7,8};
+	auto packet = bus_packet::EncodePacketize(BUS_PACKET_TYPE_TM, 12, BUS_PACKET_ECF_EXIST, data);
+
+	TEST_CHECK(bus_packet::CheckECF(packet.bytes));
+	// The second byte (ECF flag and length) is not flipped: it sets what is checked
+	for(std::size_t bit = 0; bit < 8 * packet.size; bit++)
+	{
+		if(bit / 8 == 1)	continue;
+		packet.bytes[bit / 8] ^= 0x80 >> (bit % 8);
+		TEST_CHECK(!bus_packet::CheckECF(packet.bytes));
+		packet.bytes[bit / 8] ^= 0x80 >> (bit % 8);
+	}
+}
+
+} // namespace
+
+
+int main()
+{
+	TEST_RUN(test_CompareEncoders);
+	TEST_RUN(test_CheckECF);
+	return test_Report();
+}
@@ -0,0 +1,180 @@
+/**
+  ******************************************************************************
+  * @file           : test_capture.c
+  * @brief          : Tests of the capture files FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Bus packets and jumbo bus packets written with the capture writer
+  *		and read again, checking the CRC status and the ids of the records,
+  *		and APID queries over time ranges of sorted and unsorted captures.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "capture.h"
+#include "capture_query.h"
+
+#include "test.h"
+
+#include <limits.h>
+#include <unistd.h>
+
+
+static char test_path[PATH_MAX];
+static char test_index_path[PATH_MAX];
+static char test_query_path[PATH_MAX];
+
+
+static void test_RemoveFiles(void)
+{
+	unlink(test_path);
+	unlink(test_index_path);
+	unlink(test_query_path);
+}
+
+
+static void test_BusPacketRoundTrip(void)
+{
+	capture_writer_t writer;
+	capture_reader_t reader;
+	bus_packet_view_t view;
+	uint8_t data[BUS_PACKET_JUMBO_DATA_SIZE];
+	uint8_t legacy[BUS_PACKET_BUS_SIZE];
+	uint8_t jumbo_short[BUS_PACKET_JUMBO_MAX_SIZE];
+	uint8_t jumbo_long[BUS_PACKET_JUMBO_MAX_SIZE];
+	uint8_t jumbo_bad[BUS_PACKET_JUMBO_MAX_SIZE];
+
+	for(uint32_t i = 0; i < sizeof(data); i++)
+		data[i] = i * 31;
+
+	TEST_CHECK(bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, 9, BUS_PACKET_ECF_EXIST, data, 20, legacy) == HAL_OK);
+	TEST_CHECK(bus_packet_EncodePacketizeJumbo(BUS_PACKET_TYPE_TM, 10, data, 40, jumbo_short) == HAL_OK);
+	TEST_CHECK(bus_packet_EncodePacketizeJumbo(BUS_PACKET_TYPE_TC, 11, data, BUS_PACKET_JUMBO_DATA_SIZE, jumbo_long) == HAL_OK);
+	memcpy(jumbo_bad, jumbo_long, sizeof(jumbo_bad));
+	jumbo_bad[100] ^= 0x01;
+
+	TEST_CHECK(capture_WriterOpen(&writer, test_path, CAPTURE_LINK_BUS_PACKET) == HAL_OK);
+	TEST_CHECK(capture_WriterAppendBusPacket(&writer, legacy, 1000) == HAL_OK);
+	TEST_CHECK(capture_WriterAppendBusPacket(&writer, jumbo_short, 2000) == HAL_OK);
+	TEST_CHECK(capture_WriterAppendBusPacket(&writer, jumbo_long, 3000) == HAL_OK);
+	TEST_CHECK(capture_WriterAppendBusPacket(&writer, jumbo_bad, 4000) == HAL_OK);
+	TEST_CHECK(capture_WriterClose(&writer) == HAL_OK);
+
+	TEST_CHECK(capture_ReaderOpen(&reader, test_path) == HAL_OK);
+	TEST_CHECK(reader.count == 4);
+	if(reader.count != 4)
+	{
+		capture_ReaderClose(&reader);
+		return;
+	}
+
+	const capture_record_t *record = capture_GetRecord(&reader, 0);
+	TEST_CHECK(record->length == bus_packet_GetLength(legacy) && record->crc_status == CAPTURE_CRC_OK);
+	TEST_CHECK(record->apid == 9 && record->vcid == CAPTURE_ID_NONE && record->timestamp_ns == 1000);
+	TEST_CHECK(memcmp(capture_GetFrame(record), legacy, record->length) == 0);
+
+	// A jumbo bus packet short enough for the legacy length
+	record = capture_GetRecord(&reader, 1);
+	TEST_CHECK(record->length == 40 + BUS_PACKET_JUMBO_HEADER_SIZE + BUS_PACKET_ECF_SIZE);
+	TEST_CHECK(record->crc_status == CAPTURE_CRC_OK && record->apid == 10);
+	TEST_CHECK(bus_packet_DecodeViewJumbo(capture_GetFrame(record), record->length, &view) == HAL_OK);
+	TEST_CHECK(bus_packet_ViewIsJumbo(&view) && bus_packet_ViewDataLength(&view) == 40);
+
+	record = capture_GetRecord(&reader, 2);
+	TEST_CHECK(record->length == BUS_PACKET_JUMBO_MAX_SIZE);
+	TEST_CHECK(record->crc_status == CAPTURE_CRC_OK && record->apid == 11);
+	TEST_CHECK(bus_packet_DecodeViewJumbo(capture_GetFrame(record), record->length, &view) == HAL_OK);
+	TEST_CHECK(bus_packet_ViewType(&view) == BUS_PACKET_TYPE_TC);
+	TEST_CHECK(memcmp(view.data, data, BUS_PACKET_JUMBO_DATA_SIZE) == 0);
+
+	// A corrupted jumbo bus packet is stored with its CRC error
+	record = capture_GetRecord(&reader, 3);
+	TEST_CHECK(record->length == BUS_PACKET_JUMBO_MAX_SIZE);
+	TEST_CHECK(record->crc_status == CAPTURE_CRC_ERROR);
+
+	TEST_CHECK(capture_ReaderClose(&reader) == HAL_OK);
+	test_RemoveFiles();
+}
+
+
+static uint32_t test_Query(const capture_query_index_t *index, const capture_reader_t *reader, uint8_t apid, uint64_t from_ns, uint64_t to_ns)
+{
+	capture_query_t query;
+	uint32_t count = 0;
+
+	if(capture_QueryStart(&query, index, reader, CAPTURE_QUERY_APID(apid), from_ns, to_ns) != HAL_OK)	return 0xFFFFFFFF;
+	while(capture_QueryNext(&query) != NULL)
+		count++;
+	return count;
+}
+
+
+static void test_QueryTimeRange(void)
+{
+	const uint64_t timestamps[2][4] = {{100, 50, 70, 300}, {10, 20, 30, 40}};
+	const uint8_t apids[4] = {9, 9, 10, 9};
+	uint8_t frame[8] = {0};
+
+	for(uint32_t sorted = 0; sorted < 2; sorted++)
+	{
+		capture_writer_t writer;
+		capture_reader_t reader;
+		capture_query_index_t index;
+		const uint64_t *t = timestamps[sorted];
+
+		test_RemoveFiles();
+		TEST_CHECK(capture_WriterOpen(&writer, test_path, CAPTURE_LINK_BUS_PACKET) == HAL_OK);
+		for(uint32_t i = 0; i < 4; i++)
+			TEST_CHECK(capture_WriterAppend(&writer, frame, sizeof(frame), t[i], CAPTURE_CRC_UNCHECKED, CAPTURE_ID_NONE, apids[i]) == HAL_OK);
+		TEST_CHECK(capture_WriterClose(&writer) == HAL_OK);
+
+		TEST_CHECK(capture_ReaderOpen(&reader, test_path) == HAL_OK);
+		TEST_CHECK(capture_QueryOpen(&index, test_path, &reader) == HAL_OK);
+		TEST_CHECK(((index.header->flags & CAPTURE_QUERY_FLAG_SORTED) != 0) == sorted);
+		TEST_CHECK(capture_QueryCount(&index, CAPTURE_QUERY_APID(9)) == 3);
+
+		if(!sorted)
+		{
+			// The list starts at t=100 but holds a record at t=50
+			TEST_CHECK(index.lists[CAPTURE_QUERY_APID(9)].min_ns == 50 && index.lists[CAPTURE_QUERY_APID(9)].max_ns == 300);
+			TEST_CHECK(test_Query(&index, &reader, 9, 60, 200) == 1);
+			TEST_CHECK(test_Query(&index, &reader, 9, 40, 60) == 1);
+			TEST_CHECK(test_Query(&index, &reader, 9, 0, 49) == 0);
+		}
+		else
+		{
+			TEST_CHECK(test_Query(&index, &reader, 9, 15, 35) == 1);
+			TEST_CHECK(test_Query(&index, &reader, 9, 41, 100) == 0);
+		}
+		TEST_CHECK(test_Query(&index, &reader, 9, CAPTURE_QUERY_TIME_ALL) == 3);
+		TEST_CHECK(test_Query(&index, &reader, 10, CAPTURE_QUERY_TIME_ALL) == 1);
+		TEST_CHECK(test_Query(&index, &reader, 11, CAPTURE_QUERY_TIME_ALL) == 0);
+
+		TEST_CHECK(capture_QueryClose(&index) == HAL_OK);
+		TEST_CHECK(capture_ReaderClose(&reader) == HAL_OK);
+	}
+	test_RemoveFiles();
+}
+
+
+int main(void)
+{
+	snprintf(test_path, sizeof(test_path), "%s/test_capture_%d.ccap", P_tmpdir, (int)getpid());
+	snprintf(test_index_path, sizeof(test_index_path), "%s/test_capture_%d.ccap%s", P_tmpdir, (int)getpid(), CAPTURE_INDEX_SUFFIX);
+	snprintf(test_query_path, sizeof(test_query_path), "%s/test_capture_%d.ccap%s", P_tmpdir, (int)getpid(), CAPTURE_QUERY_SUFFIX);
+
+	TEST_RUN(test_BusPacketRoundTrip);
+	TEST_RUN(test_QueryTimeRange);
+
+	test_RemoveFiles();
+	return test_Report();
+}
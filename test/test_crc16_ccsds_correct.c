@@ -0,0 +1,211 @@
+/**
+  ******************************************************************************
+  * @file           : test_crc16_ccsds_correct.c
+  * @brief          : Tests of the CRC16 CCSDS single bit correction FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Every single bit error of a codeword, a bus packet and a TF packet
+  *		corrected by crc16_ccsds_CorrectBit(), bus_packet_DecodeCorrect()
+  *		and tf_packet_DecodeCorrect(), first dividing the syndrome and then
+  *		with the table of crc16_ccsds_SyndromeInit(). Every double bit error
+  *		is rejected with the buffer unchanged, and a correct one is decoded
+  *		without correction.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "crc16_ccsds.h"
+#include "bus_packet.h"
+#include "tf_packet.h"
+
+#include "test.h"
+
+
+#define TEST_FLIP(buffer, bit)		((buffer)[(bit) / 8] ^= 0x80 >> ((bit) % 8))
+
+
+// Bits that set the length: the bus packet length and ECF flag (byte 1)
+static uint8_t test_BusFixed(uint32_t bit)
+{
+	return bit / 8 == 1;
+}
+
+
+// Bits that set the length: end_flag, the length field, ocf_flag and vc_length
+static uint8_t test_TfFixed(uint32_t bit)
+{
+	return bit == 31 || bit / 8 == 4 || bit / 8 == 5 || (bit >= 52 && bit < 56);
+}
+
+
+static void test_CorrectBit(void)
+{
+	uint8_t codeword[300];
+	uint8_t original[300];
+	uint32_t wrong = 0;
+
+	for(uint32_t i = 0; i < sizeof(codeword) - 2; i++)
+		codeword[i] = i * 73 + 5;
+	uint16_t crc = crc16_ccsds_Calculate(0, codeword, sizeof(codeword) - 2);
+	codeword[sizeof(codeword) - 2] = crc>>8;
+	codeword[sizeof(codeword) - 1] = crc;
+	memcpy(original, codeword, sizeof(codeword));
+
+	for(uint32_t bit = 0; bit < 8 * sizeof(codeword); bit++)
+	{
+		TEST_FLIP(codeword, bit);
+		uint16_t received = (codeword[sizeof(codeword) - 2]<<8) | codeword[sizeof(codeword) - 1];
+		uint16_t syndrome = crc16_ccsds_Calculate(0, codeword, sizeof(codeword) - 2) ^ received;
+
+		wrong += crc16_ccsds_CorrectBit(codeword, sizeof(codeword), syndrome) != HAL_OK ||
+				 memcmp(codeword, original, sizeof(codeword)) != 0;
+		memcpy(codeword, original, sizeof(codeword));
+	}
+	TEST_CHECK(wrong == 0);
+
+	// No error, and the syndrome of a bit before the codeword
+	TEST_CHECK(crc16_ccsds_CorrectBit(codeword, sizeof(codeword), 0) == HAL_ERROR);
+	TEST_CHECK(crc16_ccsds_CorrectBit(codeword, 2, crc16_ccsds_Shift(1, 2)) == HAL_ERROR);
+	TEST_CHECK(crc16_ccsds_CorrectBit(codeword, CRC16_CCSDS_CORRECT_MAX_SIZE + 1, 1) == HAL_ERROR);
+	TEST_CHECK(memcmp(codeword, original, sizeof(codeword)) == 0);
+}
+
+
+static void test_BusPacket(void)
+{
+	uint8_t data[BUS_PACKET_DATA_SIZE];
+	uint8_t buffer[BUS_PACKET_BUS_SIZE];
+	uint8_t original[BUS_PACKET_BUS_SIZE];
+	bus_packet_t packet;
+	uint8_t corrected;
+	uint32_t wrong = 0;
+
+	for(uint32_t i = 0; i < sizeof(data); i++)
+		data[i] = i * 29 + 1;
+
+	TEST_CHECK(bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, 17, BUS_PACKET_ECF_EXIST, data, 20, buffer) == HAL_OK);
+	uint32_t length = bus_packet_GetLength(buffer);
+	memcpy(original, buffer, length);
+
+	// No error
+	TEST_CHECK(bus_packet_DecodeCorrect(buffer, &packet, &corrected) == HAL_OK && !corrected);
+	TEST_CHECK(packet.apid == 17 && memcmp(packet.data, data, 20) == 0);
+
+	// Every single bit error
+	for(uint32_t bit = 0; bit < 8 * length; bit++)
+	{
+		if(test_BusFixed(bit))	continue;
+
+		TEST_FLIP(buffer, bit);
+		memset(&packet, 0, sizeof(packet));
+		wrong += bus_packet_DecodeCorrect(buffer, &packet, &corrected) != HAL_OK || !corrected ||
+				 memcmp(buffer, original, length) != 0 || packet.apid != 17 || memcmp(packet.data, data, 20) != 0;
+		memcpy(buffer, original, length);
+	}
+	TEST_CHECK(wrong == 0);
+
+	// Every double bit error is rejected and the bus packet is not changed
+	for(uint32_t first = 0; first < 8 * length; first++)
+		for(uint32_t second = first + 1; second < 8 * length; second++)
+		{
+			if(test_BusFixed(first) || test_BusFixed(second))	continue;
+
+			TEST_FLIP(buffer, first);
+			TEST_FLIP(buffer, second);
+			wrong += bus_packet_DecodeCorrect(buffer, &packet, &corrected) != HAL_ERROR || corrected;
+			TEST_FLIP(buffer, first);
+			TEST_FLIP(buffer, second);
+			wrong += memcmp(buffer, original, length) != 0;
+			memcpy(buffer, original, length);
+		}
+	TEST_CHECK(wrong == 0);
+
+	// Without ECF nothing is corrected
+	TEST_CHECK(bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, 17, BUS_PACKET_ECF_NOT_EXIST, data, 20, buffer) == HAL_OK);
+	memcpy(original, buffer, bus_packet_GetLength(buffer));
+	TEST_FLIP(buffer, 40);
+	TEST_CHECK(bus_packet_DecodeCorrect(buffer, &packet, &corrected) == HAL_OK && !corrected);
+	TEST_CHECK(memcmp(buffer, original, bus_packet_GetLength(buffer)) != 0);
+}
+
+
+static void test_TfPacket(void)
+{
+	static tfph_packet_t tfph;
+	static tfdf_packet_t tfdf;
+	tf_packet_channel_t channel;
+	uint8_t data[32];
+	uint8_t buffer[TF_PACKET_MAX_SIZE];
+	uint8_t original[TF_PACKET_MAX_SIZE];
+	uint16_t length;
+	uint8_t corrected;
+	uint32_t wrong = 0;
+
+	for(uint32_t i = 0; i < sizeof(data); i++)
+		data[i] = i * 53 + 7;
+
+	TEST_CHECK(tf_packet_ChannelInit(&channel, TF_PACKET_DEFAULT_SCID, 5, sizeof(buffer)) == HAL_OK);
+	TEST_CHECK(tf_packet_ChannelSetVcCount(&channel, 2, 0x1234) == HAL_OK);
+	TEST_CHECK(tf_packet_ChannelSetOcf(&channel, TF_PACKET_OCF_EXIST, 0x01020304) == HAL_OK);
+	TEST_CHECK(tf_packet_PacketizeChannel(&channel, data, sizeof(data), buffer, &length) == HAL_OK);
+	memcpy(original, buffer, length);
+
+	// No error
+	TEST_CHECK(tf_packet_DecodeCorrect(buffer, length, &tfph, &tfdf, &corrected) == HAL_OK && !corrected);
+	TEST_CHECK(tfph.vcid == 5 && tfph.ocf == 0x01020304 && memcmp(tfdf.data, data, sizeof(data)) == 0);
+
+	// Every single bit error
+	for(uint32_t bit = 0; bit < 8 * (uint32_t)length; bit++)
+	{
+		if(test_TfFixed(bit))	continue;
+
+		TEST_FLIP(buffer, bit);
+		memset(&tfph, 0, sizeof(tfph));
+		wrong += tf_packet_DecodeCorrect(buffer, length, &tfph, &tfdf, &corrected) != HAL_OK || !corrected ||
+				 memcmp(buffer, original, length) != 0 || tfph.vcid != 5 || tfph.ocf != 0x01020304 ||
+				 memcmp(tfdf.data, data, sizeof(data)) != 0;
+		memcpy(buffer, original, length);
+	}
+	TEST_CHECK(wrong == 0);
+
+	// Every double bit error is rejected and the TF packet is not changed
+	for(uint32_t first = 0; first < 8 * (uint32_t)length; first++)
+		for(uint32_t second = first + 1; second < 8 * (uint32_t)length; second++)
+		{
+			if(test_TfFixed(first) || test_TfFixed(second))	continue;
+
+			TEST_FLIP(buffer, first);
+			TEST_FLIP(buffer, second);
+			wrong += tf_packet_DecodeCorrect(buffer, length, &tfph, &tfdf, &corrected) != HAL_ERROR || corrected;
+			TEST_FLIP(buffer, first);
+			TEST_FLIP(buffer, second);
+			wrong += memcmp(buffer, original, length) != 0;
+			memcpy(buffer, original, length);
+		}
+	TEST_CHECK(wrong == 0);
+}
+
+
+int main(void)
+{
+	// Dividing the syndrome, as in the MCU
+	TEST_RUN(test_CorrectBit);
+	TEST_RUN(test_BusPacket);
+	TEST_RUN(test_TfPacket);
+
+	// With the syndrome table
+	TEST_CHECK(crc16_ccsds_SyndromeInit() == HAL_OK);
+	TEST_RUN(test_CorrectBit);
+	TEST_RUN(test_BusPacket);
+	TEST_RUN(test_TfPacket);
+	return test_Report();
+}
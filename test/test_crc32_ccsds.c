@@ -0,0 +1,188 @@
+/**
+  ******************************************************************************
+  * @file           : test_crc32_ccsds.c
+  * @brief          : Tests of the CRC32 CCSDS backends FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Check value of every backend, the backends against the bitwise one
+  *		for every length, alignment and seed, and TF packets with the CRC32
+  *		ECF from tf_packet_PacketizeChannel() to tf_packet_DecodeViewChannel().
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "crc32_ccsds.h"
+#include "tf_packet.h"
+
+#include "test.h"
+
+
+#define TEST_CHECK_VALUE		0x51693C0C		// CRC32 of "123456789"
+
+
+static const crc32_ccsds_backend_t *const test_backends[] =
+{
+	&CRC32_CCSDS_BITWISE,
+	&CRC32_CCSDS_TABLE,
+	&CRC32_CCSDS_SLICE8,
+#ifdef CRC16_CCSDS_HAS_PCLMUL
+	&CRC32_CCSDS_PCLMUL,
+#endif
+};
+
+#define TEST_BACKENDS		(sizeof(test_backends) / sizeof(test_backends[0]))
+
+
+static uint8_t test_Supported(const crc32_ccsds_backend_t *backend)
+{
+	return backend->is_supported == NULL || backend->is_supported();
+}
+
+
+static void test_CheckValue(void)
+{
+	const uint8_t check[] = "123456789";
+
+	for(uint32_t i = 0; i < TEST_BACKENDS; i++)
+	{
+		if(!test_Supported(test_backends[i]))	continue;
+
+		TEST_CHECK(test_backends[i]->calculate(0, check, 9) == TEST_CHECK_VALUE);
+		TEST_CHECK(test_backends[i]->calculate(0, check, 0) == 0);
+		TEST_CHECK(test_backends[i]->calculate(0x12345678, check, 0) == 0x12345678);
+	}
+
+	TEST_CHECK(crc32_ccsds_Calculate(0, check, 9) == TEST_CHECK_VALUE);
+}
+
+
+static void test_BackendsAgree(void)
+{
+	uint8_t data[320 + 16];
+
+	for(uint32_t i = 0; i < sizeof(data); i++)
+		data[i] = (i * 167 + 13) ^ (i >> 3);
+
+	// Every length and alignment around the 8 and 16 bytes steps
+	for(uint32_t i = 1; i < TEST_BACKENDS; i++)
+	{
+		uint32_t mismatches = 0;
+
+		if(!test_Supported(test_backends[i]))	continue;
+
+		for(uint32_t offset = 0; offset < 16; offset++)
+			for(uint32_t len = 0; len <= 320; len++)
+			{
+				uint32_t seed = (len & 1) ? 0 : 0xA5A5A5A5 ^ len;
+				mismatches += test_backends[i]->calculate(seed, &data[offset], len) !=
+							  CRC32_CCSDS_BITWISE.calculate(seed, &data[offset], len);
+			}
+
+		TEST_CHECK(mismatches == 0);
+	}
+
+	// The seed continues a CRC
+	for(uint32_t i = 0; i < TEST_BACKENDS; i++)
+	{
+		if(!test_Supported(test_backends[i]))	continue;
+
+		uint32_t crc = test_backends[i]->calculate(0, data, 100);
+		TEST_CHECK(test_backends[i]->calculate(crc, &data[100], 200) == test_backends[i]->calculate(0, data, 300));
+	}
+
+	// The CRC appended MSB first leaves a zero remainder
+	uint32_t crc = crc32_ccsds_Calculate(0, data, 200);
+	data[200] = crc>>24;
+	data[201] = crc>>16;
+	data[202] = crc>>8;
+	data[203] = crc;
+	TEST_CHECK(crc32_ccsds_Calculate(0, data, 204) == 0);
+}
+
+
+static void test_SetBackend(void)
+{
+	const crc32_ccsds_backend_t *previous = crc32_ccsds_backend;
+	const crc32_ccsds_backend_t *fastest = crc32_ccsds_GetFastest();
+
+	TEST_CHECK(fastest != NULL && test_Supported(fastest));
+	TEST_CHECK(crc32_ccsds_SetBackend(fastest) == HAL_OK && crc32_ccsds_backend == fastest);
+	TEST_CHECK(crc32_ccsds_Calculate(0, (const uint8_t *)"123456789", 9) == TEST_CHECK_VALUE);
+
+	TEST_CHECK(crc32_ccsds_SetBackend(NULL) == HAL_ERROR);
+	TEST_CHECK(crc32_ccsds_backend == fastest);
+
+	TEST_CHECK(crc32_ccsds_SetBackend(previous) == HAL_OK);
+}
+
+
+static void test_TfPacketEcf32(void)
+{
+	tf_packet_channel_t channel;
+	tf_packet_channel_t channel16;
+	tf_packet_view_t view;
+	uint8_t data[64];
+	uint8_t buffer[TF_PACKET_MAX_SIZE];
+	uint16_t length;
+	uint32_t detected = 0;
+
+	for(uint32_t i = 0; i < sizeof(data); i++)
+		data[i] = i;
+
+	TEST_CHECK(tf_packet_ChannelInit(&channel, TF_PACKET_DEFAULT_SCID, 2, sizeof(buffer)) == HAL_OK);
+	TEST_CHECK(tf_packet_ChannelSetEcf(&channel, TF_PACKET_ECF32_SIZE) == HAL_OK);
+	TEST_CHECK(tf_packet_ChannelInit(&channel16, TF_PACKET_DEFAULT_SCID, 2, sizeof(buffer)) == HAL_OK);
+	TEST_CHECK(tf_packet_ChannelSetEcf(&channel, 3) == HAL_ERROR);
+
+	TEST_CHECK(tf_packet_PacketizeChannel(&channel, data, sizeof(data), buffer, &length) == HAL_OK);
+	TEST_CHECK(crc32_ccsds_Calculate(0, buffer, length) == 0);
+	TEST_CHECK(tf_packet_DecodeViewChannel(&channel, buffer, length, &view) == HAL_OK);
+	TEST_CHECK(tf_packet_ViewVcid(&view) == 2);
+	TEST_CHECK(view.data_length == sizeof(data) && memcmp(view.data, data, sizeof(data)) == 0);
+
+	// The CRC16 decoders do not take the CRC32 ECF
+	TEST_CHECK(tf_packet_DecodeViewChannel(&channel16, buffer, length, &view) == HAL_ERROR);
+
+	// Every single bit error is detected
+	for(uint32_t bit = 0; bit < 8 * (uint32_t)length; bit++)
+	{
+		buffer[bit / 8] ^= 0x80 >> (bit % 8);
+		detected += tf_packet_DecodeViewChannel(&channel, buffer, length, &view) != HAL_OK;
+		buffer[bit / 8] ^= 0x80 >> (bit % 8);
+	}
+	TEST_CHECK(detected == 8 * (uint32_t)length);
+	TEST_CHECK(tf_packet_DecodeViewChannel(&channel, buffer, length, &view) == HAL_OK);
+
+	// The same TF packets with every backend
+	for(uint32_t i = 0; i < TEST_BACKENDS; i++)
+	{
+		const crc32_ccsds_backend_t *previous = crc32_ccsds_backend;
+		uint8_t other[TF_PACKET_MAX_SIZE];
+		uint16_t other_length;
+
+		if(crc32_ccsds_SetBackend(test_backends[i]) != HAL_OK)	continue;
+		TEST_CHECK(tf_packet_PacketizeChannel(&channel, data, sizeof(data), other, &other_length) == HAL_OK);
+		TEST_CHECK(other_length == length && memcmp(other, buffer, length) == 0);
+		TEST_CHECK(tf_packet_DecodeViewChannel(&channel, buffer, length, &view) == HAL_OK);
+		crc32_ccsds_SetBackend(previous);
+	}
+}
+
+
+int main(void)
+{
+	TEST_RUN(test_CheckValue);
+	TEST_RUN(test_BackendsAgree);
+	TEST_RUN(test_SetBackend);
+	TEST_RUN(test_TfPacketEcf32);
+	return test_Report();
+}
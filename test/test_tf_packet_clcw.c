@@ -0,0 +1,218 @@
+/**
+  ******************************************************************************
+  * @file           : test_tf_packet_clcw.c
+  * @brief          : Tests of the TF packet CLCW FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Bit position of every CLCW field, masking of the fields and of the
+  *		spare bits, round trips of all the field values, and the CLCW sent
+  *		in the OCF of a channel and patched in an encoded TF packet. The OCF
+  *		decoded into a TFPH is cleared by TF packets without it.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "tf_packet_clcw.h"
+
+#include "test.h"
+
+
+static int test_Equal(const tf_packet_clcw_t *a, const tf_packet_clcw_t *b)
+{
+	return a->status == b->status && a->cop_in_effect == b->cop_in_effect &&
+		   a->vcid == b->vcid && a->no_rf_available == b->no_rf_available &&
+		   a->no_bit_lock == b->no_bit_lock && a->lockout == b->lockout &&
+		   a->wait == b->wait && a->retransmit == b->retransmit &&
+		   a->farm_b_counter == b->farm_b_counter && a->report_value == b->report_value;
+}
+
+
+static void test_FieldPositions(void)
+{
+	tf_packet_clcw_t clcw;
+
+	memset(&clcw, 0, sizeof(clcw));
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x00000000);
+
+	// Every field at its largest value alone
+	memset(&clcw, 0, sizeof(clcw));	clcw.status = 0b111;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x1C000000);
+	memset(&clcw, 0, sizeof(clcw));	clcw.cop_in_effect = 0b11;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x03000000);
+	memset(&clcw, 0, sizeof(clcw));	clcw.vcid = 0b00111111;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x00FC0000);
+	memset(&clcw, 0, sizeof(clcw));	clcw.no_rf_available = 1;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x00008000);
+	memset(&clcw, 0, sizeof(clcw));	clcw.no_bit_lock = 1;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x00004000);
+	memset(&clcw, 0, sizeof(clcw));	clcw.lockout = 1;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x00002000);
+	memset(&clcw, 0, sizeof(clcw));	clcw.wait = 1;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x00001000);
+	memset(&clcw, 0, sizeof(clcw));	clcw.retransmit = 1;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x00000800);
+	memset(&clcw, 0, sizeof(clcw));	clcw.farm_b_counter = 0b11;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x00000600);
+	memset(&clcw, 0, sizeof(clcw));	clcw.report_value = 0xFF;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x000000FF);
+
+	// A CLCW of COP-1 on VC 1 asking for retransmission from 0x42
+	memset(&clcw, 0, sizeof(clcw));
+	clcw.cop_in_effect = TF_PACKET_CLCW_COP1;
+	clcw.vcid = 1;
+	clcw.retransmit = 1;
+	clcw.report_value = 0x42;
+	TEST_CHECK(tf_packet_EncodeClcw(&clcw) == 0x01040842);
+}
+
+
+static void test_Masking(void)
+{
+	tf_packet_clcw_t clcw;
+	tf_packet_clcw_t decoded;
+
+	// Values longer than the fields do not reach the other fields
+	memset(&clcw, 0xFF, sizeof(clcw));
+	uint32_t ocf = tf_packet_EncodeClcw(&clcw);
+
+	TEST_CHECK(ocf == 0x1FFCFEFF);
+	TEST_CHECK((ocf & 0x80000000) == 0);			// Type
+	TEST_CHECK((ocf & 0x60000000) == 0);			// Version
+	TEST_CHECK((ocf & 0x00030000) == 0);			// Spare after the VCID
+	TEST_CHECK((ocf & 0x00000100) == 0);			// Spare before the report value
+
+	TEST_CHECK(tf_packet_DecodeClcw(ocf, &decoded) == HAL_OK);
+	TEST_CHECK(decoded.status == 0b111 && decoded.cop_in_effect == 0b11 && decoded.vcid == 0b00111111);
+	TEST_CHECK(decoded.no_rf_available == 1 && decoded.no_bit_lock == 1 && decoded.lockout == 1);
+	TEST_CHECK(decoded.wait == 1 && decoded.retransmit == 1);
+	TEST_CHECK(decoded.farm_b_counter == 0b11 && decoded.report_value == 0xFF);
+
+	// The spare bits received are ignored
+	TEST_CHECK(tf_packet_DecodeClcw(0x00030100, &decoded) == HAL_OK);
+	memset(&clcw, 0, sizeof(clcw));
+	TEST_CHECK(test_Equal(&clcw, &decoded));
+}
+
+
+static void test_DecodeErrors(void)
+{
+	tf_packet_clcw_t clcw;
+
+	// Other control word types and CLCW versions
+	TEST_CHECK(tf_packet_DecodeClcw(0x80000000, &clcw) == HAL_ERROR);
+	TEST_CHECK(tf_packet_DecodeClcw(0x20000000, &clcw) == HAL_ERROR);
+	TEST_CHECK(tf_packet_DecodeClcw(0x40000000, &clcw) == HAL_ERROR);
+	TEST_CHECK(tf_packet_DecodeClcw(0x60000000, &clcw) == HAL_ERROR);
+	TEST_CHECK(tf_packet_DecodeClcw(0xFFFFFFFF, &clcw) == HAL_ERROR);
+	TEST_CHECK(tf_packet_DecodeClcw(0x1FFFFFFF, &clcw) == HAL_OK);
+}
+
+
+static void test_RoundTrip(void)
+{
+	tf_packet_clcw_t clcw;
+	tf_packet_clcw_t decoded;
+
+	// Every value of every field, with the others walking too
+	for(uint32_t n = 0; n < 256; n++)
+	{
+		clcw.status = n & 0b111;
+		clcw.cop_in_effect = (n>>1) & 0b11;
+		clcw.vcid = (n * 7) & 0b00111111;
+		clcw.no_rf_available = n & 0b1;
+		clcw.no_bit_lock = (n>>1) & 0b1;
+		clcw.lockout = (n>>2) & 0b1;
+		clcw.wait = (n>>3) & 0b1;
+		clcw.retransmit = (n>>4) & 0b1;
+		clcw.farm_b_counter = (n>>5) & 0b11;
+		clcw.report_value = n;
+
+		TEST_CHECK(tf_packet_DecodeClcw(tf_packet_EncodeClcw(&clcw), &decoded) == HAL_OK);
+		TEST_CHECK(test_Equal(&clcw, &decoded));
+	}
+
+	for(uint32_t vcid = 0; vcid < 64; vcid++)
+	{
+		memset(&clcw, 0, sizeof(clcw));
+		clcw.vcid = vcid;
+		TEST_CHECK(tf_packet_DecodeClcw(tf_packet_EncodeClcw(&clcw), &decoded) == HAL_OK);
+		TEST_CHECK(decoded.vcid == vcid && decoded.report_value == 0);
+	}
+}
+
+
+static void test_ChannelOcf(void)
+{
+	tf_packet_channel_t channel;
+	tf_packet_clcw_t clcw = {.cop_in_effect = TF_PACKET_CLCW_COP1, .vcid = 3, .wait = 1, .report_value = 200};
+	tf_packet_clcw_t decoded;
+	uint8_t data[16] = {1, 2, 3, 4, 5, 6};
+	uint8_t buffer[TF_PACKET_MAX_SIZE];
+	uint16_t length;
+	tf_packet_view_t view;
+
+	TEST_CHECK(tf_packet_ChannelInit(&channel, TF_PACKET_DEFAULT_SCID, 1, sizeof(buffer)) == HAL_OK);
+	TEST_CHECK(tf_packet_ChannelSetOcf(&channel, TF_PACKET_OCF_EXIST, tf_packet_EncodeClcw(&clcw)) == HAL_OK);
+	TEST_CHECK(tf_packet_PacketizeChannel(&channel, data, sizeof(data), buffer, &length) == HAL_OK);
+
+	TEST_CHECK(tf_packet_DecodeView(buffer, length, &view) == HAL_OK);
+	TEST_CHECK(tf_packet_ViewOcfFlag(&view) == 1 && view.ocf != NULL);
+	TEST_CHECK(tf_packet_DecodeClcw(tf_packet_ViewOcf(&view), &decoded) == HAL_OK);
+	TEST_CHECK(test_Equal(&clcw, &decoded));
+
+	// The CLCW sent again with a new report value
+	clcw.wait = 0;
+	clcw.retransmit = 1;
+	clcw.report_value = 201;
+	TEST_CHECK(tf_packet_PatchOcf(buffer, length, tf_packet_EncodeClcw(&clcw)) == HAL_OK);
+	TEST_CHECK(tf_packet_DecodeView(buffer, length, &view) == HAL_OK);
+	TEST_CHECK(tf_packet_DecodeClcw(tf_packet_ViewOcf(&view), &decoded) == HAL_OK);
+	TEST_CHECK(test_Equal(&clcw, &decoded));
+	TEST_CHECK(view.data[0] == 1 && view.data[5] == 6);
+}
+
+
+static void test_DecodeOcf(void)
+{
+	static tfph_packet_t tfph;
+	static tfdf_packet_t tfdf;
+	tf_packet_channel_t channel;
+	uint8_t data[8] = {1, 2, 3};
+	uint8_t with_ocf[TF_PACKET_MAX_SIZE];
+	uint8_t without_ocf[TF_PACKET_MAX_SIZE];
+	uint16_t with_length, without_length;
+
+	TEST_CHECK(tf_packet_ChannelInit(&channel, TF_PACKET_DEFAULT_SCID, 1, sizeof(with_ocf)) == HAL_OK);
+	TEST_CHECK(tf_packet_PacketizeChannel(&channel, data, sizeof(data), without_ocf, &without_length) == HAL_OK);
+	TEST_CHECK(tf_packet_ChannelSetOcf(&channel, TF_PACKET_OCF_EXIST, 0x01040842) == HAL_OK);
+	TEST_CHECK(tf_packet_PacketizeChannel(&channel, data, sizeof(data), with_ocf, &with_length) == HAL_OK);
+
+	// The same TFPH for TF packets with and without OCF
+	TEST_CHECK(tf_packet_Decode(with_ocf, with_length, &tfph, &tfdf) == HAL_OK);
+	TEST_CHECK(tfph.ocf_flag == 1 && tfph.ocf == 0x01040842);
+	TEST_CHECK(tf_packet_Decode(without_ocf, without_length, &tfph, &tfdf) == HAL_OK);
+	TEST_CHECK(tfph.ocf_flag == 0 && tfph.ocf == 0);
+	TEST_CHECK(tf_packet_Decode(with_ocf, with_length, &tfph, &tfdf) == HAL_OK);
+	TEST_CHECK(tfph.ocf == 0x01040842);
+}
+
+
+int main(void)
+{
+	TEST_RUN(test_FieldPositions);
+	TEST_RUN(test_Masking);
+	TEST_RUN(test_DecodeErrors);
+	TEST_RUN(test_RoundTrip);
+	TEST_RUN(test_ChannelOcf);
+	TEST_RUN(test_DecodeOcf);
+	return test_Report();
+}
@@ -0,0 +1,180 @@
+/**
+  ******************************************************************************
+  * @file           : test_tf_packet_patch.c
+  * @brief          : Tests of the TF packet header patches FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		crc16_ccsds_Patch() against the CRC computed again for every offset
+  *		and length, and TF packets changed with tf_packet_PatchHeader(),
+  *		tf_packet_PatchVcid() and tf_packet_PatchFlags() against the same
+  *		TF packets encoded with the new values. The bytes that set the
+  *		length cannot be patched.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "crc16_ccsds.h"
+#include "tf_packet.h"
+
+#include "test.h"
+
+
+static const uint8_t test_data[40] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+
+
+static uint16_t test_Encode(uint16_t scid, uint8_t vcid, uint8_t bypass_flag, uint8_t command_flag, uint8_t *buffer)
+{
+	tf_packet_channel_t channel;
+	uint16_t length = 0;
+
+	tf_packet_ChannelInit(&channel, scid, vcid, TF_PACKET_MAX_SIZE);
+	tf_packet_ChannelSetVcCount(&channel, 3, 0x00ABCDEF);
+	tf_packet_ChannelSetOcf(&channel, TF_PACKET_OCF_EXIST, 0x01000000);
+	channel.bypass_flag = bypass_flag;
+	channel.command_flag = command_flag;
+	tf_packet_PacketizeChannel(&channel, test_data, sizeof(test_data), buffer, &length);
+
+	return length;
+}
+
+
+static void test_CrcPatch(void)
+{
+	uint8_t data[96];
+	uint8_t patched[96];
+	uint8_t patch[8] = {0xFF, 0x00, 0x5A, 0xA5, 0x12, 0x34, 0x56, 0x78};
+	uint32_t wrong = 0;
+
+	for(uint32_t i = 0; i < sizeof(data); i++)
+		data[i] = i * 37 + 11;
+	uint16_t crc = crc16_ccsds_Calculate(0, data, sizeof(data));
+
+	// Every offset and length that fits, up to 8 bytes
+	for(uint32_t patch_length = 0; patch_length <= sizeof(patch); patch_length++)
+		for(uint32_t offset = 0; offset + patch_length <= sizeof(data); offset++)
+		{
+			memcpy(patched, data, sizeof(data));
+			memcpy(&patched[offset], patch, patch_length);
+			wrong += crc16_ccsds_Patch(crc, sizeof(data), offset, &data[offset], patch, patch_length) !=
+					 crc16_ccsds_Calculate(0, patched, sizeof(data));
+		}
+	TEST_CHECK(wrong == 0);
+}
+
+
+static void test_PatchVcid(void)
+{
+	uint8_t buffer[TF_PACKET_MAX_SIZE];
+	uint8_t expected[TF_PACKET_MAX_SIZE];
+	uint32_t wrong = 0;
+
+	uint16_t length = test_Encode(TF_PACKET_DEFAULT_SCID, 1, 0, 0, buffer);
+	TEST_CHECK(length != 0);
+
+	// Every VCID, from the last one patched
+	for(uint8_t vcid = 0; vcid < 64; vcid++)
+	{
+		wrong += test_Encode(TF_PACKET_DEFAULT_SCID, vcid, 0, 0, expected) != length;
+		wrong += tf_packet_PatchVcid(buffer, length, vcid) != HAL_OK;
+		wrong += memcmp(buffer, expected, length) != 0;
+	}
+	TEST_CHECK(wrong == 0);
+
+	TEST_CHECK(tf_packet_PatchVcid(buffer, length, 64) == HAL_ERROR);
+	TEST_CHECK(memcmp(buffer, expected, length) == 0);
+}
+
+
+static void test_PatchFlags(void)
+{
+	uint8_t buffer[TF_PACKET_MAX_SIZE];
+	uint8_t expected[TF_PACKET_MAX_SIZE];
+	uint32_t wrong = 0;
+
+	uint16_t length = test_Encode(TF_PACKET_DEFAULT_SCID, 7, 0, 0, buffer);
+
+	for(uint8_t flags = 0; flags < 4; flags++)
+	{
+		uint8_t bypass_flag = flags & 0b01;
+		uint8_t command_flag = (flags>>1) & 0b01;
+
+		wrong += test_Encode(TF_PACKET_DEFAULT_SCID, 7, bypass_flag, command_flag, expected) != length;
+		wrong += tf_packet_PatchFlags(buffer, length, bypass_flag, command_flag) != HAL_OK;
+		wrong += memcmp(buffer, expected, length) != 0;
+	}
+	TEST_CHECK(wrong == 0);
+
+	TEST_CHECK(tf_packet_PatchFlags(buffer, length, 2, 0) == HAL_ERROR);
+	TEST_CHECK(tf_packet_PatchFlags(buffer, length, 0, 2) == HAL_ERROR);
+	TEST_CHECK(memcmp(buffer, expected, length) == 0);
+}
+
+
+static void test_PatchHeader(void)
+{
+	uint8_t buffer[TF_PACKET_MAX_SIZE];
+	uint8_t expected[TF_PACKET_MAX_SIZE];
+	uint8_t header[TF_PACKET_PRIMARY_BASE_HEADER_SIZE];
+	tf_packet_view_t view;
+
+	// A new SCID and VCID in one patch of the first 4 bytes
+	uint16_t length = test_Encode(TF_PACKET_DEFAULT_SCID, 2, 1, 0, buffer);
+	TEST_CHECK(test_Encode(0x1234, 9, 1, 0, expected) == length);
+	memcpy(header, expected, sizeof(header));
+	TEST_CHECK(tf_packet_PatchHeader(buffer, length, 0, header, 4) == HAL_OK);
+	TEST_CHECK(memcmp(buffer, expected, length) == 0);
+	TEST_CHECK(tf_packet_DecodeView(buffer, length, &view) == HAL_OK && tf_packet_ViewVcid(&view) == 9);
+
+	// The whole TFPH with the same length bytes
+	test_Encode(TF_PACKET_DEFAULT_SCID, 2, 0, 0, buffer);
+	TEST_CHECK(tf_packet_PatchHeader(buffer, length, 0, header, sizeof(header)) == HAL_OK);
+	TEST_CHECK(memcmp(buffer, expected, length) == 0);
+
+	// Data bytes up to the ECF, but not the ECF
+	memcpy(header, "PATCHED", 7);
+	memcpy(&expected[length - TF_PACKET_ECF_SIZE - TF_PACKET_OCF_SIZE - 7], header, 7);
+	uint16_t crc = crc16_ccsds_Calculate(0, expected, length - TF_PACKET_ECF_SIZE);
+	expected[length - 2] = crc>>8;
+	expected[length - 1] = crc;
+	TEST_CHECK(tf_packet_PatchHeader(buffer, length, length - TF_PACKET_ECF_SIZE - TF_PACKET_OCF_SIZE - 7, header, 7) == HAL_OK);
+	TEST_CHECK(memcmp(buffer, expected, length) == 0);
+	TEST_CHECK(tf_packet_PatchHeader(buffer, length, length - TF_PACKET_ECF_SIZE - 1, header, 2) == HAL_ERROR);
+
+	// The bytes that set the length are rejected and nothing is changed
+	memcpy(header, buffer, sizeof(header));
+	header[3] ^= 0b00000001;
+	TEST_CHECK(tf_packet_PatchHeader(buffer, length, 0, header, sizeof(header)) == HAL_ERROR);
+	header[3] ^= 0b00000001;
+	header[4] ^= 0x01;
+	TEST_CHECK(tf_packet_PatchHeader(buffer, length, 0, header, sizeof(header)) == HAL_ERROR);
+	header[4] ^= 0x01;
+	header[6] ^= 0b00001000;
+	TEST_CHECK(tf_packet_PatchHeader(buffer, length, 0, header, sizeof(header)) == HAL_ERROR);
+	header[6] ^= 0b00001001;
+	TEST_CHECK(tf_packet_PatchHeader(buffer, length, 0, header, sizeof(header)) == HAL_ERROR);
+	TEST_CHECK(memcmp(buffer, expected, length) == 0);
+
+	// A wrong ECF stays wrong after the patch
+	buffer[20] ^= 0x10;
+	TEST_CHECK(tf_packet_PatchVcid(buffer, length, 3) == HAL_OK);
+	TEST_CHECK(tf_packet_DecodeView(buffer, length, &view) == HAL_ERROR);
+}
+
+
+int main(void)
+{
+	TEST_RUN(test_CrcPatch);
+	TEST_RUN(test_PatchVcid);
+	TEST_RUN(test_PatchFlags);
+	TEST_RUN(test_PatchHeader);
+	return test_Report();
+}
@@ -0,0 +1,338 @@
+/**
+  ******************************************************************************
+  * @file           : test_tf_packet_vcc.c
+  * @brief          : Tests of the TF packet VC frame count tracker FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Fixed sequences of VC frame counts with gaps, duplicates, reordered
+  *		TF packets, resyncs and the wraparound of short and long counts, and
+  *		the channel and the tracker together through tf_packet_DecodeView().
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "tf_packet_vcc.h"
+
+#include "test.h"
+
+
+#define TEST_VCID		5
+
+
+static tf_packet_vcc_t vcc;
+
+
+static const tf_packet_vcc_stats_t *test_Stats(void)
+{
+	return &vcc.vc[TEST_VCID].stats;
+}
+
+
+static tf_packet_vcc_event_t test_Track(uint64_t vc_count, uint8_t vc_length)
+{
+	return tf_packet_VccTrack(&vcc, TEST_VCID, vc_count, vc_length);
+}
+
+
+static void test_InOrder(void)
+{
+	tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+
+	TEST_CHECK(test_Track(1000, 2) == TF_PACKET_VCC_FIRST);
+	for(uint64_t count = 1001; count < 1100; count++)
+		TEST_CHECK(test_Track(count, 2) == TF_PACKET_VCC_IN_ORDER);
+
+	TEST_CHECK(test_Stats()->received == 100);
+	TEST_CHECK(test_Stats()->lost == 0 && test_Stats()->gaps == 0 && test_Stats()->resyncs == 0);
+	TEST_CHECK(vcc.vc[TEST_VCID].expected == 1100);
+	TEST_CHECK(vcc.vc[TEST_VCID].vc_length == 2);
+}
+
+
+static void test_Gap(void)
+{
+	tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+
+	test_Track(0, 2);
+	test_Track(1, 2);
+	TEST_CHECK(test_Track(5, 2) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(vcc.vc[TEST_VCID].gap_start == 2 && vcc.vc[TEST_VCID].gap_length == 3);
+	TEST_CHECK(test_Stats()->lost == 3 && test_Stats()->gaps == 1 && test_Stats()->max_gap == 3);
+	TEST_CHECK(test_Track(6, 2) == TF_PACKET_VCC_IN_ORDER);
+
+	// The last gap is kept, max_gap the longest one
+	TEST_CHECK(test_Track(8, 2) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(vcc.vc[TEST_VCID].gap_start == 7 && vcc.vc[TEST_VCID].gap_length == 1);
+	TEST_CHECK(test_Stats()->lost == 4 && test_Stats()->gaps == 2 && test_Stats()->max_gap == 3);
+	TEST_CHECK(test_Stats()->received == 5);
+
+	// The longest gap that is still flywheeled over
+	TEST_CHECK(test_Track(9 + TF_PACKET_VCC_DEFAULT_FLYWHEEL, 2) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(test_Stats()->max_gap == TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+	TEST_CHECK(test_Stats()->resyncs == 0);
+}
+
+
+static void test_Duplicate(void)
+{
+	tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+
+	test_Track(10, 2);
+	TEST_CHECK(test_Track(10, 2) == TF_PACKET_VCC_DUPLICATE);
+	test_Track(11, 2);
+	test_Track(12, 2);
+	TEST_CHECK(test_Track(11, 2) == TF_PACKET_VCC_DUPLICATE);
+	TEST_CHECK(test_Track(10, 2) == TF_PACKET_VCC_DUPLICATE);
+
+	TEST_CHECK(test_Stats()->received == 3 && test_Stats()->duplicates == 3);
+	TEST_CHECK(test_Stats()->lost == 0 && test_Stats()->late == 0);
+	TEST_CHECK(vcc.vc[TEST_VCID].expected == 13);
+}
+
+
+static void test_Reordered(void)
+{
+	tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+
+	// 0 1 4 2 3 5: 2 and 3 are counted as lost and received late
+	test_Track(0, 2);
+	test_Track(1, 2);
+	TEST_CHECK(test_Track(4, 2) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(test_Stats()->lost == 2);
+	TEST_CHECK(test_Track(2, 2) == TF_PACKET_VCC_LATE);
+	TEST_CHECK(test_Stats()->lost == 1);
+	TEST_CHECK(test_Track(3, 2) == TF_PACKET_VCC_LATE);
+	TEST_CHECK(test_Stats()->lost == 0 && test_Stats()->late == 2);
+	TEST_CHECK(test_Track(5, 2) == TF_PACKET_VCC_IN_ORDER);
+
+	// A late TF packet received again is a duplicate
+	TEST_CHECK(test_Track(2, 2) == TF_PACKET_VCC_DUPLICATE);
+
+	TEST_CHECK(test_Stats()->received == 6 && test_Stats()->duplicates == 1);
+	TEST_CHECK(test_Stats()->gaps == 1 && test_Stats()->resyncs == 0);
+	TEST_CHECK(vcc.vc[TEST_VCID].expected == 6);
+}
+
+
+static void test_BeforeFirst(void)
+{
+	tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+
+	// Counts before the first TF packet were never counted as lost
+	TEST_CHECK(test_Track(10, 2) == TF_PACKET_VCC_FIRST);
+	TEST_CHECK(test_Track(15, 2) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(test_Stats()->lost == 4);
+	TEST_CHECK(test_Track(5, 2) == TF_PACKET_VCC_DUPLICATE);
+	TEST_CHECK(test_Stats()->lost == 4 && test_Stats()->late == 0);
+	TEST_CHECK(test_Track(12, 2) == TF_PACKET_VCC_LATE);
+	TEST_CHECK(test_Stats()->lost == 3);
+
+	// Out of the window they are a resync
+	TEST_CHECK(test_Track(15 - TF_PACKET_VCC_WINDOW, 2) == TF_PACKET_VCC_RESYNC);
+
+	// The same after a resync
+	TEST_CHECK(test_Track(1000, 2) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(test_Track(5000, 2) == TF_PACKET_VCC_RESYNC);
+	TEST_CHECK(test_Track(4999, 2) == TF_PACKET_VCC_DUPLICATE);
+	TEST_CHECK(test_Track(5000 - (TF_PACKET_VCC_WINDOW - 1), 2) == TF_PACKET_VCC_DUPLICATE);
+	TEST_CHECK(test_Stats()->late == 1 && test_Stats()->resyncs == 2);
+}
+
+
+static void test_Window(void)
+{
+	tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+
+	// A gap longer than the window clears it: 1 to 39 are lost
+	test_Track(0, 2);
+	TEST_CHECK(test_Track(40, 2) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(vcc.vc[TEST_VCID].window == 1);
+	TEST_CHECK(test_Stats()->lost == 39);
+
+	// The oldest count in the window is late, one more is out of it
+	TEST_CHECK(test_Track(40 - (TF_PACKET_VCC_WINDOW - 1), 2) == TF_PACKET_VCC_LATE);
+	TEST_CHECK(test_Stats()->lost == 38);
+	TEST_CHECK(test_Track(40 - (TF_PACKET_VCC_WINDOW - 1), 2) == TF_PACKET_VCC_DUPLICATE);
+	TEST_CHECK(test_Track(40 - TF_PACKET_VCC_WINDOW, 2) == TF_PACKET_VCC_RESYNC);
+	TEST_CHECK(test_Stats()->lost == 38 && test_Stats()->resyncs == 1);
+	TEST_CHECK(vcc.vc[TEST_VCID].expected == 40 - TF_PACKET_VCC_WINDOW + 1);
+}
+
+
+static void test_Resync(void)
+{
+	tf_packet_VccInit(&vcc, 100);
+
+	// Jump forward longer than the flywheel
+	test_Track(0, 2);
+	TEST_CHECK(test_Track(101, 2) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(test_Stats()->lost == 100);
+	TEST_CHECK(test_Track(203, 2) == TF_PACKET_VCC_RESYNC);
+	TEST_CHECK(test_Stats()->lost == 100 && test_Stats()->gaps == 1 && test_Stats()->resyncs == 1);
+	TEST_CHECK(vcc.vc[TEST_VCID].expected == 204 && vcc.vc[TEST_VCID].window == 0xFFFFFFFF);
+	TEST_CHECK(test_Track(204, 2) == TF_PACKET_VCC_IN_ORDER);
+
+	// The sender restarted with a new vc_length
+	TEST_CHECK(test_Track(205, 3) == TF_PACKET_VCC_RESYNC);
+	TEST_CHECK(vcc.vc[TEST_VCID].vc_length == 3);
+	TEST_CHECK(test_Stats()->resyncs == 2);
+
+	// ... and with the same count again, which is not a duplicate
+	TEST_CHECK(test_Track(205, 2) == TF_PACKET_VCC_RESYNC);
+	TEST_CHECK(test_Track(206, 2) == TF_PACKET_VCC_IN_ORDER);
+	TEST_CHECK(test_Stats()->received == 7 && test_Stats()->duplicates == 0);
+}
+
+
+static void test_Wraparound(void)
+{
+	tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+
+	// 1 byte counts, the flywheel is longer than the modulo
+	test_Track(254, 1);
+	TEST_CHECK(test_Track(255, 1) == TF_PACKET_VCC_IN_ORDER);
+	TEST_CHECK(test_Track(0, 1) == TF_PACKET_VCC_IN_ORDER);
+	TEST_CHECK(vcc.vc[TEST_VCID].expected == 1);
+	TEST_CHECK(test_Track(255, 1) == TF_PACKET_VCC_DUPLICATE);
+
+	// Gap across the wraparound, then reordered across it
+	tf_packet_VccReset(&vcc, TEST_VCID);
+	test_Track(253, 1);
+	TEST_CHECK(test_Track(2, 1) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(vcc.vc[TEST_VCID].gap_start == 254 && vcc.vc[TEST_VCID].gap_length == 4);
+	TEST_CHECK(test_Track(255, 1) == TF_PACKET_VCC_LATE);
+	TEST_CHECK(test_Track(0, 1) == TF_PACKET_VCC_LATE);
+	TEST_CHECK(test_Stats()->lost == 2 && test_Stats()->late == 2);
+
+	// Counts out of the window are a gap of a short count, not a resync
+	TEST_CHECK(test_Track(2 - TF_PACKET_VCC_WINDOW, 1) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(vcc.vc[TEST_VCID].gap_length == 256 - TF_PACKET_VCC_WINDOW - 1);
+	TEST_CHECK(test_Stats()->resyncs == 0);
+
+	// The longest count
+	tf_packet_VccReset(&vcc, TEST_VCID);
+	const uint64_t last = (1ULL<<(8*TF_PACKET_VC_COUNT_MAX_SIZE)) - 1;
+	test_Track(last - 1, TF_PACKET_VC_COUNT_MAX_SIZE);
+	TEST_CHECK(test_Track(last, TF_PACKET_VC_COUNT_MAX_SIZE) == TF_PACKET_VCC_IN_ORDER);
+	TEST_CHECK(vcc.vc[TEST_VCID].expected == 0);
+	TEST_CHECK(test_Track(3, TF_PACKET_VC_COUNT_MAX_SIZE) == TF_PACKET_VCC_GAP);
+	TEST_CHECK(vcc.vc[TEST_VCID].gap_start == 0 && vcc.vc[TEST_VCID].gap_length == 3);
+	TEST_CHECK(test_Track(last, TF_PACKET_VC_COUNT_MAX_SIZE) == TF_PACKET_VCC_DUPLICATE);
+
+	// Bits over vc_length are ignored
+	TEST_CHECK(test_Track((1ULL<<(8*TF_PACKET_VC_COUNT_MAX_SIZE)) + 4, TF_PACKET_VC_COUNT_MAX_SIZE) == TF_PACKET_VCC_IN_ORDER);
+	TEST_CHECK(test_Stats()->resyncs == 0);
+}
+
+
+static void test_NoCount(void)
+{
+	tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+
+	TEST_CHECK(test_Track(1, 0) == TF_PACKET_VCC_NO_COUNT);
+	TEST_CHECK(test_Track(1, TF_PACKET_VC_COUNT_MAX_SIZE + 1) == TF_PACKET_VCC_NO_COUNT);
+	TEST_CHECK(test_Stats()->received == 0 && vcc.vc[TEST_VCID].vc_length == 0);
+
+	// VCIDs are kept apart and a reset only clears its own VC
+	TEST_CHECK(test_Track(7, 1) == TF_PACKET_VCC_FIRST);
+	TEST_CHECK(tf_packet_VccTrack(&vcc, TEST_VCID + 1, 7, 1) == TF_PACKET_VCC_FIRST);
+	TEST_CHECK(tf_packet_VccTrack(&vcc, TEST_VCID + 1, 8, 1) == TF_PACKET_VCC_IN_ORDER);
+	tf_packet_VccReset(&vcc, TEST_VCID);
+	TEST_CHECK(test_Track(8, 1) == TF_PACKET_VCC_FIRST);
+	TEST_CHECK(vcc.vc[TEST_VCID + 1].stats.received == 2);
+}
+
+
+static void test_ChannelTracker(void)
+{
+	tf_packet_channel_t channel;
+	uint8_t data[16] = {1, 2, 3, 4, 5, 6};
+	uint8_t buffer[TF_PACKET_MAX_SIZE];
+	uint16_t length;
+	tf_packet_view_t view;
+
+	tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+	TEST_CHECK(tf_packet_ChannelInit(&channel, TF_PACKET_DEFAULT_SCID, TEST_VCID, sizeof(buffer)) == HAL_OK);
+
+	// Without VC frame count
+	TEST_CHECK(tf_packet_PacketizeChannel(&channel, data, sizeof(data), buffer, &length) == HAL_OK);
+	TEST_CHECK(tf_packet_DecodeView(buffer, length, &view) == HAL_OK);
+	TEST_CHECK(tf_packet_VccTrackView(&vcc, &view) == TF_PACKET_VCC_NO_COUNT);
+
+	// 1 byte count from 250, wrapping around and with 253 lost
+	TEST_CHECK(tf_packet_ChannelSetVcCount(&channel, 1, 250) == HAL_OK);
+	for(uint32_t n = 0; n < 10; n++)
+	{
+		TEST_CHECK(tf_packet_PacketizeChannel(&channel, data, sizeof(data), buffer, &length) == HAL_OK);
+		if(n == 3)	continue;	// Lost in the link
+
+		TEST_CHECK(tf_packet_DecodeView(buffer, length, &view) == HAL_OK);
+		TEST_CHECK(tf_packet_ViewVcid(&view) == TEST_VCID);
+		TEST_CHECK(tf_packet_ViewVcLength(&view) == 1);
+		TEST_CHECK(tf_packet_ViewVcCount(&view) == ((250 + n) & 0xFF));
+		TEST_CHECK(tf_packet_VccTrackView(&vcc, &view) == ((n == 0) ? TF_PACKET_VCC_FIRST :
+				   (n == 4) ? TF_PACKET_VCC_GAP : TF_PACKET_VCC_IN_ORDER));
+	}
+	TEST_CHECK(vcc.vc[TEST_VCID].gap_start == 253 && vcc.vc[TEST_VCID].gap_length == 1);
+	TEST_CHECK(test_Stats()->received == 9 && test_Stats()->lost == 1);
+
+	// The last TF packet received again
+	TEST_CHECK(tf_packet_VccTrackView(&vcc, &view) == TF_PACKET_VCC_DUPLICATE);
+
+	// Longer counts resync the VC
+	TEST_CHECK(tf_packet_ChannelSetVcCount(&channel, 4, 0x01020304) == HAL_OK);
+	TEST_CHECK(tf_packet_PacketizeChannel(&channel, data, sizeof(data), buffer, &length) == HAL_OK);
+	TEST_CHECK(tf_packet_DecodeView(buffer, length, &view) == HAL_OK);
+	TEST_CHECK(tf_packet_ViewVcCount(&view) == 0x01020304);
+	TEST_CHECK(tf_packet_VccTrackView(&vcc, &view) == TF_PACKET_VCC_RESYNC);
+	TEST_CHECK(tf_packet_PacketizeChannel(&channel, data, sizeof(data), buffer, &length) == HAL_OK);
+	TEST_CHECK(tf_packet_DecodeView(buffer, length, &view) == HAL_OK);
+	TEST_CHECK(tf_packet_VccTrackView(&vcc, &view) == TF_PACKET_VCC_IN_ORDER);
+}
+
+
+static void test_Totals(void)
+{
+	tf_packet_vcc_stats_t totals;
+
+	tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+
+	tf_packet_VccTrack(&vcc, 0, 0, 2);
+	tf_packet_VccTrack(&vcc, 0, 3, 2);
+	tf_packet_VccTrack(&vcc, 63, 0, 1);
+	tf_packet_VccTrack(&vcc, 63, 0, 1);
+	tf_packet_VccTrack(&vcc, 63, 6, 1);
+	tf_packet_VccTrack(&vcc, 63, 4, 1);
+	tf_packet_VccTrack(&vcc, 63, 100, 2);
+	tf_packet_VccTotals(&vcc, &totals);
+
+	TEST_CHECK(totals.received == 6);
+	TEST_CHECK(totals.lost == 6 && totals.gaps == 2 && totals.max_gap == 5);
+	TEST_CHECK(totals.duplicates == 1 && totals.late == 1 && totals.resyncs == 1);
+}
+
+
+int main(void)
+{
+	TEST_RUN(test_InOrder);
+	TEST_RUN(test_Gap);
+	TEST_RUN(test_Duplicate);
+	TEST_RUN(test_Reordered);
+	TEST_RUN(test_BeforeFirst);
+	TEST_RUN(test_Window);
+	TEST_RUN(test_Resync);
+	TEST_RUN(test_Wraparound);
+	TEST_RUN(test_NoCount);
+	TEST_RUN(test_ChannelTracker);
+	TEST_RUN(test_Totals);
+	return test_Report();
+}
@@ -46,72 +46,312 @@
 
 #include "tf_packet.h"
 
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define TF_PACKET_HAS_SSSE3
+#include <immintrin.h>
+#endif
+
+
+/**
+ * Check the length invariants of a TF packet with branch-free comparisons:
+ * TFPH and TFDF header, vc_length, ocf_flag, buffer_length, length field
+ * and max_size. Only the first 7 bytes are read.
+ * @param buffer_in Data buffer with a TF packet
+ * @param buffer_length Data buffer length
+ * @param max_size Longest TF packet accepted
+ * @param ecf_size ECF length, TF_PACKET_ECF_SIZE or TF_PACKET_ECF32_SIZE
+ * @param header_length Pointer where the TFPH length is saved
+ * @param trailer_length Pointer where the OCF and ECF length is saved
+ * @return TF packet length, or 0 if the TF packet is not valid
+ */
+static inline uint32_t tf_packet_ValidLength(const uint8_t *buffer_in, uint32_t buffer_length, uint32_t max_size, uint32_t ecf_size, uint32_t *header_length, uint32_t *trailer_length)
+{
+	// The shortest TF packet (truncated TFPH) is as long as the non-truncated TFPH
+	if(buffer_length < TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE + ecf_size)
+		return 0;
+
+	uint32_t truncated = -(uint32_t)(buffer_in[3] & 0b00000001);
+	uint32_t length_field = (buffer_in[4]<<8) | buffer_in[5];
+	uint32_t base_header = TF_PACKET_PRIMARY_BASE_HEADER_SIZE + (buffer_in[6] & 0b00000111);
+
+	uint32_t length = (buffer_length & truncated) | (length_field & ~truncated);
+	uint32_t header = (TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE & truncated) | (base_header & ~truncated);
+	uint32_t trailer = (TF_PACKET_OCF_SIZE & -(uint32_t)((buffer_in[6]>>3) & 0x01) & ~truncated) + ecf_size;
+
+	uint32_t error = (length > buffer_length) | (length > max_size) |
+					 (length < header + TF_PACKET_DATA_HEADER_SIZE + trailer);
+
+	*header_length = header;
+	*trailer_length = trailer;
+	return length & (error - 1);
+}
+
+
+/**
+ * Check that a data buffer can contain a TF packet before decoding it. It
+ * does not copy anything nor check the ECF, so garbage is rejected in a few
+ * cycles.
+ * @param buffer_in Data buffer with a TF packet
+ * @param buffer_length Data buffer length
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_Validate(const uint8_t *buffer_in, uint32_t buffer_length)
+{
+	uint32_t header_length, trailer_length;
+	return tf_packet_ValidLength(buffer_in, buffer_length, TF_PACKET_MAX_SIZE, TF_PACKET_ECF_SIZE, &header_length, &trailer_length) ? HAL_OK : HAL_ERROR;
+}
+
+
+static inline uint8_t tf_packet_CheckECF(const uint8_t *buffer_in, uint32_t length)
+{
+	uint16_t ecf = (buffer_in[length-TF_PACKET_ECF_SIZE]<<8) | buffer_in[length-TF_PACKET_ECF_SIZE+1];
+	return crc16_ccsds_Calculate(0, buffer_in, length - TF_PACKET_ECF_SIZE) == ecf;
+}
+
+
+static inline uint8_t tf_packet_CheckECF32(const uint8_t *buffer_in, uint32_t length)
+{
+	const uint8_t *ecf_in = &buffer_in[length-TF_PACKET_ECF32_SIZE];
+	uint32_t ecf = ((uint32_t)ecf_in[0]<<24) | (ecf_in[1]<<16) | (ecf_in[2]<<8) | ecf_in[3];
+	return crc32_ccsds_Calculate(0, buffer_in, length - TF_PACKET_ECF32_SIZE) == ecf;
+}
+
 
 /**
  * Decode data buffer that contain a Transfer Frame packet
  * @param buffer_in Data buffer with a TF packet to decode
- * @param buffer_length Data lenght if TFPH is not truncated
+ * @param buffer_length Data buffer length (TF packet length if TFPH is truncated)
  * @param tfph Pointer to TFPH structure to save data
  * @param tfdf Pointer to TFDF structure to save data
  * @return HAL status
  */
 HAL_StatusTypeDef tf_packet_Decode(uint8_t *buffer_in, uint32_t buffer_length,  tfph_packet_t *tfph, tfdf_packet_t *tfdf)
 {
+	uint32_t header_length, trailer_length;
+	uint32_t length = tf_packet_ValidLength(buffer_in, buffer_length, TF_PACKET_MAX_SIZE, TF_PACKET_ECF_SIZE, &header_length, &trailer_length);
+
+	// Nothing is copied until the TF packet is known to be correct
+	if(length == 0 || !tf_packet_CheckECF(buffer_in, length))	return HAL_ERROR;
+
 	tfph->tfvn = (buffer_in[0] & 0b11110000)>>4;
 	tfph->scid = ((buffer_in[0] & 0b00001111)<<12) | (buffer_in[1] << 4) | ((buffer_in[2] & 0b11110000)>>4);
 	tfph->source_dest_id = (buffer_in[2] & 0b00001000)>>3;
 	tfph->vcid = ((buffer_in[2] & 0b00000111)<<3) | ((buffer_in[3] & 0b11100000) >>5);
 	tfph->mapid = (buffer_in[3] & 0b00011110) >>1;
 	tfph->end_flag = buffer_in[3] & 0b00000001;
+	tfph->ocf = 0;						// Not kept from the last TF packet decoded
 
 	if(!tfph->end_flag)
 	{
-		tfph->length = (buffer_in[4]<<8) | buffer_in[5];
+		tfph->length = length;
 		tfph->bypass_flag = (buffer_in[6] & 0b10000000) >>7;
 		tfph->command_flag = (buffer_in[6] & 0b01000000) >>6;
 //		tfph->spare = (buffer_in[6] & 0b00110000) >>4;
 		tfph->ocf_flag = (buffer_in[6] & 0b00001000) >>3;
 		tfph->vc_length = buffer_in[6] & 0b00000111;
-		memcpy(tfph->vc_frame, &buffer_in[7], tfph->vc_length);
+		memcpy(tfph->vc_frame, &buffer_in[TF_PACKET_PRIMARY_BASE_HEADER_SIZE], tfph->vc_length);
 
-		tfdf->constr_rule = (buffer_in[7+tfph->vc_length] & 0b11100000) >>5;
-		tfdf->protocol_id = buffer_in[7+tfph->vc_length] & 0b00011111;
+		if(tfph->ocf_flag)
+		{
+			const uint8_t *ocf = &buffer_in[length - trailer_length];
+			tfph->ocf = ((uint32_t)ocf[0]<<24) | (ocf[1]<<16) | (ocf[2]<<8) | ocf[3];
+		}
+	}
 
+	tfdf->constr_rule = (buffer_in[header_length] & 0b11100000) >>5;
+	tfdf->protocol_id = buffer_in[header_length] & 0b00011111;
+	memcpy(tfdf->data, &buffer_in[header_length + TF_PACKET_DATA_HEADER_SIZE], length - header_length - TF_PACKET_DATA_HEADER_SIZE - trailer_length);
 
-		if(tfph->length - TF_PACKET_PRIMARY_BASE_HEADER_SIZE - tfph->vc_length - TF_PACKET_DATA_HEADER_SIZE - TF_PACKET_ECF_SIZE < 0)	return HAL_ERROR;
-		memcpy(tfdf->data, &buffer_in[8+tfph->vc_length], tfph->length - TF_PACKET_PRIMARY_BASE_HEADER_SIZE - tfph->vc_length - TF_PACKET_DATA_HEADER_SIZE - TF_PACKET_ECF_SIZE);
+	return HAL_OK;
+}
 
-#ifdef STM32_MCU
-		uint16_t calculated_crc = HAL_CRC_Calculate(&hcrc, (uint32_t *)buffer_in, tfph->length - TF_PACKET_ECF_SIZE) & 0xFFFF;
-#else
-		uint16_t calculated_crc = bus_packet_CRC16CCSDSCalculate(0, buffer_in, tfph->length - TF_PACKET_ECF_SIZE) & 0xFFFF;
-#endif
 
-		uint16_t ecf = (buffer_in[tfph->length-TF_PACKET_ECF_SIZE]<<8) | buffer_in[tfph->length-TF_PACKET_ECF_SIZE+1];
+/**
+ * Decode data buffer that contain a Transfer Frame packet and, if its ECF
+ * is wrong, correct a single bit error in place. Errors of an even number
+ * of bits are never miscorrected, but three or more bits may be (or an
+ * error in the length field).
+ * @param buffer_in Data buffer with a TF packet to decode
+ * @param buffer_length Data buffer length (TF packet length if TFPH is truncated)
+ * @param tfph Pointer to TFPH structure to save data
+ * @param tfdf Pointer to TFDF structure to save data
+ * @param corrected Pointer where 1 is saved if a bit was corrected, or NULL
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_DecodeCorrect(uint8_t *buffer_in, uint32_t buffer_length, tfph_packet_t *tfph, tfdf_packet_t *tfdf, uint8_t *corrected)
+{
+	uint32_t header_length, trailer_length;
+	uint32_t length = tf_packet_ValidLength(buffer_in, buffer_length, TF_PACKET_MAX_SIZE, TF_PACKET_ECF_SIZE, &header_length, &trailer_length);
+
+	if(corrected != NULL)	*corrected = 0;
+	if(length == 0)		return HAL_ERROR;
+	if(tf_packet_Decode(buffer_in, buffer_length, tfph, tfdf) == HAL_OK)	return HAL_OK;
+
+	uint8_t original[TF_PACKET_MAX_SIZE];
+	memcpy(original, buffer_in, length);
+
+	uint16_t ecf = (buffer_in[length-TF_PACKET_ECF_SIZE]<<8) | buffer_in[length-TF_PACKET_ECF_SIZE+1];
+	uint16_t syndrome = crc16_ccsds_Calculate(0, buffer_in, length - TF_PACKET_ECF_SIZE) ^ ecf;
 
-		if(calculated_crc != ecf)	return HAL_ERROR;
+	// The corrected bit may be in the TFPH, so the TF packet is decoded again
+	if(crc16_ccsds_CorrectBit(buffer_in, length, syndrome) != HAL_OK ||
+	   tf_packet_Decode(buffer_in, buffer_length, tfph, tfdf) != HAL_OK)
+	{
+		memcpy(buffer_in, original, length);
+		return HAL_ERROR;
 	}
 
-	else
+	if(corrected != NULL)	*corrected = 1;
+	return HAL_OK;
+}
+
+
+static inline void tf_packet_SetView(const uint8_t *buffer_in, uint32_t length, uint32_t header_length, uint32_t trailer_length, uint32_t ecf_size, tf_packet_view_t *view)
+{
+	view->id = ((uint32_t)buffer_in[0]<<24) | (buffer_in[1]<<16) | (buffer_in[2]<<8) | buffer_in[3];
+	view->flags = (buffer_in[3] & 0b00000001) ? 0 : buffer_in[6];
+	view->vc_frame = (view->flags & 0b00000111) ? &buffer_in[TF_PACKET_PRIMARY_BASE_HEADER_SIZE] : NULL;
+	view->length = length;
+	view->tfdf_header = buffer_in[header_length];
+	view->data = &buffer_in[header_length + TF_PACKET_DATA_HEADER_SIZE];
+	view->data_length = length - header_length - TF_PACKET_DATA_HEADER_SIZE - trailer_length;
+	view->ocf = (trailer_length > ecf_size) ? &buffer_in[length - trailer_length] : NULL;
+}
+
+
+/**
+ * Decode data buffer that contain a Transfer Frame packet without copying
+ * the VC frame and the data. TF packets up to TF_PACKET_USLP_MAX_SIZE are
+ * accepted, as nothing is copied into TF_PACKET_MAX_SIZE structures.
+ * @param buffer_in Data buffer with a TF packet to decode
+ * @param buffer_length Data buffer length
+ * @param view Pointer to compact TF packet to save the headers and pointers
+ * to the VC frame and the data into buffer_in
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_DecodeView(const uint8_t *buffer_in, uint32_t buffer_length, tf_packet_view_t *view)
+{
+	uint32_t header_length, trailer_length;
+	uint32_t length = tf_packet_ValidLength(buffer_in, buffer_length, TF_PACKET_USLP_MAX_SIZE, TF_PACKET_ECF_SIZE, &header_length, &trailer_length);
+
+	if(length == 0 || !tf_packet_CheckECF(buffer_in, length))	return HAL_ERROR;
+
+	tf_packet_SetView(buffer_in, length, header_length, trailer_length, TF_PACKET_ECF_SIZE, view);
+
+	return HAL_OK;
+}
+
+
+static inline uint32_t tf_packet_Load32(const uint8_t *buffer)
+{
+	uint32_t word;
+	memcpy(&word, buffer, sizeof(word));
+	return word;
+}
+
+
+static void tf_packet_DecodeHeaderScalar(const uint8_t *buffer_in, tf_packet_header_batch_t *batch, uint32_t i)
+{
+	uint8_t end_flag = buffer_in[3] & 0b00000001;
+
+	batch->scid[i] = ((buffer_in[0] & 0b00001111)<<12) | (buffer_in[1] << 4) | ((buffer_in[2] & 0b11110000)>>4);
+	batch->vcid[i] = ((buffer_in[2] & 0b00000111)<<3) | ((buffer_in[3] & 0b11100000) >>5);
+	batch->mapid[i] = (buffer_in[3] & 0b00011110) >>1;
+	batch->end_flag[i] = end_flag;
+	batch->length[i] = end_flag ? 0 : (buffer_in[4]<<8) | buffer_in[5];
+	batch->flags[i] = end_flag ? 0 : buffer_in[6];
+}
+
+
+#ifdef TF_PACKET_HAS_SSSE3
+/*
+ * Four TFPH per step: the first 8 bytes of each TF packet are gathered in
+ * two registers (bytes 0..3 and 4..7 of every packet in a 32 bits lane),
+ * byte swapped and the fields are extracted with shifts and masks in all
+ * lanes at once. Then every field is packed into its column with a shuffle.
+ */
+__attribute__((target("ssse3")))
+static uint32_t tf_packet_DecodeHeaderSSSE3(const uint8_t *buffer, const uint32_t *offsets, uint32_t n, tf_packet_header_batch_t *batch)
+{
+	const __m128i bswap32 = _mm_set_epi8(12,13,14,15, 8,9,10,11, 4,5,6,7, 0,1,2,3);
+	const __m128i pack16 = _mm_set_epi8(-1,-1,-1,-1,-1,-1,-1,-1, 13,12,9,8,5,4,1,0);
+	const __m128i pack8 = _mm_set_epi8(-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, 12,8,4,0);
+	const __m128i one = _mm_set1_epi32(1);
+	uint32_t i = 0;
+
+	for(; i+4 <= n; i+=4)
 	{
-		tfdf->constr_rule = (buffer_in[4] & 0b11100000) >>5;
-		tfdf->protocol_id = buffer_in[4] & 0b00011111;
-		if(buffer_length - TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE - TF_PACKET_DATA_HEADER_SIZE - TF_PACKET_ECF_SIZE < 0)	return HAL_ERROR;
-		memcpy(tfdf->data, &buffer_in[5], buffer_length - TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE - TF_PACKET_DATA_HEADER_SIZE - TF_PACKET_ECF_SIZE);
+		const uint8_t *f0 = &buffer[offsets[i]], *f1 = &buffer[offsets[i+1]];
+		const uint8_t *f2 = &buffer[offsets[i+2]], *f3 = &buffer[offsets[i+3]];
+
+		__m128i id = _mm_set_epi32((int)tf_packet_Load32(f3), (int)tf_packet_Load32(f2), (int)tf_packet_Load32(f1), (int)tf_packet_Load32(f0));
+		__m128i ext = _mm_set_epi32((int)tf_packet_Load32(f3+4), (int)tf_packet_Load32(f2+4), (int)tf_packet_Load32(f1+4), (int)tf_packet_Load32(f0+4));
+		id = _mm_shuffle_epi8(id, bswap32);
+		ext = _mm_shuffle_epi8(ext, bswap32);
+
+		__m128i end_flag = _mm_and_si128(id, one);
+		__m128i not_truncated = _mm_cmpeq_epi32(end_flag, _mm_setzero_si128());
+		ext = _mm_and_si128(ext, not_truncated);
+
+		__m128i scid = _mm_and_si128(_mm_srli_epi32(id, 12), _mm_set1_epi32(0xFFFF));
+		__m128i vcid = _mm_and_si128(_mm_srli_epi32(id, 5), _mm_set1_epi32(0b00111111));
+		__m128i mapid = _mm_and_si128(_mm_srli_epi32(id, 1), _mm_set1_epi32(0b00001111));
+		__m128i length = _mm_srli_epi32(ext, 16);
+		__m128i flags = _mm_and_si128(_mm_srli_epi32(ext, 8), _mm_set1_epi32(0xFF));
+
+		_mm_storel_epi64((__m128i *)&batch->scid[i], _mm_shuffle_epi8(scid, pack16));
+		_mm_storel_epi64((__m128i *)&batch->length[i], _mm_shuffle_epi8(length, pack16));
+
+		uint32_t column;
+		column = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi8(vcid, pack8));		memcpy(&batch->vcid[i], &column, 4);
+		column = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi8(mapid, pack8));		memcpy(&batch->mapid[i], &column, 4);
+		column = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi8(end_flag, pack8));	memcpy(&batch->end_flag[i], &column, 4);
+		column = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi8(flags, pack8));		memcpy(&batch->flags[i], &column, 4);
+	}
 
-#ifdef STM32_MCU
-		uint16_t calculated_crc = HAL_CRC_Calculate(&hcrc, (uint32_t *)buffer_in, buffer_length - TF_PACKET_ECF_SIZE) & 0xFFFF;
-#else
-		uint16_t calculated_crc = bus_packet_CRC16CCSDSCalculate(0, buffer_in, buffer_length - TF_PACKET_ECF_SIZE) & 0xFFFF;
-#endif
+	return i;
+}
 
-		uint16_t ecf = buffer_in[buffer_length-TF_PACKET_ECF_SIZE]<<8 | buffer_in[buffer_length-TF_PACKET_ECF_SIZE+1];
 
-		if(calculated_crc == ecf)	return HAL_ERROR;
+static uint8_t tf_packet_HasSSSE3(void)
+{
+	static int8_t supported = -1;
+	if(supported < 0)
+	{
+		__builtin_cpu_init();
+		supported = __builtin_cpu_supports("ssse3") ? 1 : 0;
 	}
+	return supported;
+}
+#endif
 
 
-	return HAL_OK;
+/**
+ * Decode the TFPH of many TF packets into a struct of arrays, without
+ * checking the ECF. It is used to index or filter TF packets quickly.
+ * @param buffer Data buffer with the TF packets. At least 8 bytes must be
+ * readable from every offset.
+ * @param offsets Offset of every TF packet into buffer
+ * @param n Number of TF packets
+ * @param batch Pointer to the struct of arrays, filled from position 0
+ * @return Number of TFPH decoded
+ */
+uint32_t tf_packet_DecodeHeaderBatch(const uint8_t *buffer, const uint32_t *offsets, uint32_t n, tf_packet_header_batch_t *batch)
+{
+	uint32_t i = 0;
+
+	if(n > batch->capacity)		n = batch->capacity;
+
+#ifdef TF_PACKET_HAS_SSSE3
+	if(tf_packet_HasSSSE3())
+		i = tf_packet_DecodeHeaderSSSE3(buffer, offsets, n, batch);
+#endif
+
+	for(; i<n; i++)
+		tf_packet_DecodeHeaderScalar(&buffer[offsets[i]], batch, i);
+
+	batch->count = n;
+	return n;
 }
 
 
@@ -123,7 +363,7 @@ HAL_StatusTypeDef tf_packet_Decode(uint8_t *buffer_in, uint32_t buffer_length,
  * @param buffer_out Pointer to a data buffer for to be transmitted
  * @return HAL status
  */
-HAL_StatusTypeDef tf_packet_Packetize(uint8_t data_length, tfph_packet_t *tfph, tfdf_packet_t *tfdf, uint8_t *buffer_out)
+HAL_StatusTypeDef tf_packet_Packetize(uint16_t data_length, tfph_packet_t *tfph, tfdf_packet_t *tfdf, uint8_t *buffer_out)
 {
 	buffer_out[0] = (tfph->tfvn<<4) | ((tfph->scid & 0xF000)>>12);
 	buffer_out[1] = (tfph->scid & 0x0FF0)>>4;
@@ -133,7 +373,11 @@ HAL_StatusTypeDef tf_packet_Packetize(uint8_t data_length, tfph_packet_t *tfph,
 
 	if(!tfph->end_flag)
 	{
-		if(tfph->length > TF_PACKET_MAX_SIZE)	return HAL_ERROR;
+		uint32_t ocf_size = tfph->ocf_flag ? TF_PACKET_OCF_SIZE : 0;
+
+		if(tfph->length > TF_PACKET_MAX_SIZE || tfph->vc_length > 0b00000111 || tfph->ocf_flag > TF_PACKET_OCF_EXIST ||
+		   tfph->length < TF_PACKET_PRIMARY_BASE_HEADER_SIZE + tfph->vc_length + TF_PACKET_DATA_HEADER_SIZE + ocf_size + TF_PACKET_ECF_SIZE)
+			return HAL_ERROR;
 
 		buffer_out[4] = (tfph->length & 0xFF00)>>8;
 		buffer_out[5] = tfph->length & 0x00FF;
@@ -142,13 +386,18 @@ HAL_StatusTypeDef tf_packet_Packetize(uint8_t data_length, tfph_packet_t *tfph,
 
 		buffer_out[7+tfph->vc_length] = (tfdf->constr_rule<<5) | tfdf->protocol_id;
 
-		memcpy(&buffer_out[8+tfph->vc_length], tfdf->data, tfph->length - TF_PACKET_PRIMARY_BASE_HEADER_SIZE - tfph->vc_length - TF_PACKET_DATA_HEADER_SIZE - TF_PACKET_ECF_SIZE);
+		memcpy(&buffer_out[8+tfph->vc_length], tfdf->data, tfph->length - TF_PACKET_PRIMARY_BASE_HEADER_SIZE - tfph->vc_length - TF_PACKET_DATA_HEADER_SIZE - ocf_size - TF_PACKET_ECF_SIZE);
 
-#ifdef STM32_MCU
-		uint16_t calculated_crc = HAL_CRC_Calculate(&hcrc, (uint32_t *)buffer_out, tfph->length - TF_PACKET_ECF_SIZE) & 0xFFFF;
-#else
-		uint16_t calculated_crc = bus_packet_CRC16CCSDSCalculate(0, buffer_out, tfph->length - TF_PACKET_ECF_SIZE) & 0xFFFF;
-#endif
+		if(ocf_size)
+		{
+			uint8_t *ocf = &buffer_out[tfph->length - TF_PACKET_ECF_SIZE - TF_PACKET_OCF_SIZE];
+			ocf[0] = tfph->ocf>>24;
+			ocf[1] = (tfph->ocf & 0x00FF0000)>>16;
+			ocf[2] = (tfph->ocf & 0x0000FF00)>>8;
+			ocf[3] = tfph->ocf & 0x000000FF;
+		}
+
+		uint16_t calculated_crc = crc16_ccsds_Calculate(0, buffer_out, tfph->length - TF_PACKET_ECF_SIZE);
 
 		buffer_out[tfph->length-TF_PACKET_ECF_SIZE] = (calculated_crc & 0xFF00)>>8;
 		buffer_out[tfph->length-TF_PACKET_ECF_SIZE+1] = calculated_crc & 0x00FF;
@@ -159,17 +408,13 @@ HAL_StatusTypeDef tf_packet_Packetize(uint8_t data_length, tfph_packet_t *tfph,
 	{
 		if(data_length > TF_PACKET_DATA_MAX_SIZE)		return HAL_ERROR;
 
-		buffer_out[7] = (tfdf->constr_rule<<5) | tfdf->protocol_id;
-		memcpy(&buffer_out[8], tfdf->data, data_length);
+		buffer_out[TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE] = (tfdf->constr_rule<<5) | tfdf->protocol_id;
+		memcpy(&buffer_out[TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE], tfdf->data, data_length);
 
-#ifdef STM32_MCU
-		uint16_t calculated_crc = HAL_CRC_Calculate(&hcrc, (uint32_t *)buffer_out, data_length + TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE) & 0xFFFF;
-#else
-		uint16_t calculated_crc = bus_packet_CRC16CCSDSCalculate(0, buffer_out, data_length + TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE) & 0xFFFF;
-#endif
+		uint16_t calculated_crc = crc16_ccsds_Calculate(0, buffer_out, data_length + TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE);
 
-		buffer_out[data_length + TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE] = calculated_crc & 0x00FF;
-		buffer_out[data_length + TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE+1] = (calculated_crc & 0xFF00)>>8;
+		buffer_out[data_length + TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE] = (calculated_crc & 0xFF00)>>8;
+		buffer_out[data_length + TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE+1] = calculated_crc & 0x00FF;
 	}
 
 	 return HAL_OK;
@@ -177,7 +422,8 @@ HAL_StatusTypeDef tf_packet_Packetize(uint8_t data_length, tfph_packet_t *tfph,
 
 
 /**
- * Set TFPH and TFDF structures to be correctly encoded and packetized
+ * Set TFPH and TFDF structures to be correctly encoded and packetized. Set
+ * tfph->ocf_flag before, the OCF is included in the length.
  * @param data Pointer to data that will be encoded
  * @param data_length Data length
  * @param VCdata Pointer to a VC data that will be encoded
@@ -186,18 +432,21 @@ HAL_StatusTypeDef tf_packet_Packetize(uint8_t data_length, tfph_packet_t *tfph,
  * @param tfdf Pointer to a TFDF structure to be set
  * @return
  */
-HAL_StatusTypeDef tf_packet_SetData(uint8_t *data, uint8_t data_length, uint8_t *VCdata, uint8_t VCdata_length, tfph_packet_t *tfph, tfdf_packet_t *tfdf)
+HAL_StatusTypeDef tf_packet_SetData(uint8_t *data, uint16_t data_length, uint8_t *VCdata, uint16_t VCdata_length, tfph_packet_t *tfph, tfdf_packet_t *tfdf)
 {
 	if(data_length > TF_PACKET_DATA_MAX_SIZE) 	return HAL_ERROR;
 	if(VCdata_length > TF_PACKET_VCDATA_MAX_SIZE)	return HAL_ERROR;
 
 	if(!tfph->end_flag)
 	{
-		tfph->vc_length = VCdata_length;
-		tfph->length = data_length + VCdata_length + TF_PACKET_PRIMARY_BASE_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE + TF_PACKET_ECF_SIZE;
+		uint32_t length = data_length + VCdata_length + TF_PACKET_PRIMARY_BASE_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE + TF_PACKET_ECF_SIZE;
 
-		if(tfph->length > (TF_PACKET_DATA_MAX_SIZE - (TF_PACKET_PRIMARY_BASE_HEADER_SIZE - TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE)) )
-			return HAL_ERROR;
+		if(tfph->ocf_flag)	length += TF_PACKET_OCF_SIZE;
+
+		if(length > TF_PACKET_MAX_SIZE)		return HAL_ERROR;
+
+		tfph->vc_length = VCdata_length;
+		tfph->length = length;
 
 		memcpy(tfph->vc_frame, VCdata, VCdata_length);
 
@@ -210,6 +459,348 @@ HAL_StatusTypeDef tf_packet_SetData(uint8_t *data, uint8_t data_length, uint8_t
 
 
 
+/*
+ * Bytes of a TF packet of a channel other than the data
+ */
+static inline uint32_t tf_packet_ChannelOverhead(uint32_t vc_count_length, uint32_t ocf_flag, uint32_t ecf_size)
+{
+	return TF_PACKET_PRIMARY_BASE_HEADER_SIZE + vc_count_length + TF_PACKET_DATA_HEADER_SIZE + (ocf_flag ? TF_PACKET_OCF_SIZE : 0) + ecf_size;
+}
+
+
+/**
+ * Initialize the configuration of a virtual channel with the default TFPH
+ * and TFDF header values
+ * @param channel Pointer to the channel configuration
+ * @param scid Spacecraft ID
+ * @param vcid Virtual channel ID (6 bits)
+ * @param max_size Longest TF packet of the channel (size of its buffers),
+ * up to TF_PACKET_USLP_MAX_SIZE
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_ChannelInit(tf_packet_channel_t *channel, uint16_t scid, uint8_t vcid, uint32_t max_size)
+{
+	if(vcid > 0b00111111 || max_size > TF_PACKET_USLP_MAX_SIZE ||
+	   max_size < TF_PACKET_PRIMARY_BASE_HEADER_SIZE + TF_PACKET_DATA_HEADER_SIZE + TF_PACKET_ECF_SIZE)
+		return HAL_ERROR;
+
+	memset(channel, 0, sizeof(*channel));
+	channel->tfvn = TF_PACKET_TFVN;
+	channel->scid = scid;
+	channel->source_dest_id = TF_PACKET_SOURCE;
+	channel->vcid = vcid;
+	channel->mapid = TF_PACKET_DEFAULT_MAPID;
+	channel->bypass_flag = TF_PACKET_SEQUENCE_CONTROLLED;
+	channel->command_flag = TF_PACKET_USER_DATA;
+	channel->constr_rule = TF_PACKET_DEFAULT_CONSTR_RULE;
+	channel->protocol_id = TF_PACKET_DEFAULT_PROTOCOL_ID;
+	channel->max_size = max_size;
+	channel->ecf_size = TF_PACKET_ECF_SIZE;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Select the ECF of a virtual channel. The TFPH does not tell the ECF
+ * length, so the receiver must select the same ECF.
+ * @param channel Pointer to the channel configuration
+ * @param ecf_size
+ * 		@arg TF_PACKET_ECF_SIZE for CRC16 (default)
+ * 		@arg TF_PACKET_ECF32_SIZE for CRC32 (crc32_ccsds.h)
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_ChannelSetEcf(tf_packet_channel_t *channel, uint8_t ecf_size)
+{
+	if((ecf_size != TF_PACKET_ECF_SIZE && ecf_size != TF_PACKET_ECF32_SIZE) ||
+	   channel->max_size < tf_packet_ChannelOverhead(channel->vc_count_length, channel->ocf_flag, ecf_size))
+		return HAL_ERROR;
+
+	channel->ecf_size = ecf_size;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Add the VC frame count to the TF packets of a virtual channel. Every
+ * tf_packet_PacketizeChannel() writes it and increments it (modulo
+ * 2^(8*vc_count_length)).
+ * @param channel Pointer to the channel configuration
+ * @param vc_count_length Bytes of the VC frame count, up to
+ * TF_PACKET_VC_COUNT_MAX_SIZE, 0 to remove it
+ * @param vc_count VC frame count of the next TF packet
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_ChannelSetVcCount(tf_packet_channel_t *channel, uint8_t vc_count_length, uint64_t vc_count)
+{
+	if(vc_count_length > TF_PACKET_VC_COUNT_MAX_SIZE ||
+	   channel->max_size < tf_packet_ChannelOverhead(vc_count_length, channel->ocf_flag, channel->ecf_size))
+		return HAL_ERROR;
+
+	channel->vc_count_length = vc_count_length;
+	channel->vc_count = vc_count_length ? vc_count & ((1ULL<<(8*vc_count_length)) - 1) : 0;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Add the OCF to the TF packets of a virtual channel or change it. Every
+ * tf_packet_PacketizeChannel() sends the last value, so the CLCW is updated
+ * here when the uplink state changes.
+ * @param channel Pointer to the channel configuration
+ * @param ocf_flag
+ * 		@arg TF_PACKET_OCF_EXIST to send the OCF
+ * 		@arg TF_PACKET_OCF_NOT_EXIST to remove it
+ * @param ocf Operational Control Field, see tf_packet_EncodeClcw()
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_ChannelSetOcf(tf_packet_channel_t *channel, uint8_t ocf_flag, uint32_t ocf)
+{
+	if(ocf_flag > TF_PACKET_OCF_EXIST ||
+	   channel->max_size < tf_packet_ChannelOverhead(channel->vc_count_length, ocf_flag, channel->ecf_size))
+		return HAL_ERROR;
+
+	channel->ocf_flag = ocf_flag;
+	channel->ocf = ocf_flag ? ocf : 0;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Encode and packetize data of a virtual channel into a buffer for to be
+ * transmitted, with non-truncated TFPH, the VC frame count of the channel,
+ * which is incremented, and its OCF. The data is copied straight into the
+ * buffer, so TF packets longer than TF_PACKET_MAX_SIZE can be sent.
+ * @param channel Pointer to the channel configuration
+ * @param data Pointer to data that will be encoded
+ * @param data_length Data length, up to tf_packet_ChannelDataSize()
+ * @param buffer_out Pointer to a data buffer of channel->max_size bytes
+ * @param length Pointer where the TF packet length is saved
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_PacketizeChannel(tf_packet_channel_t *channel, const uint8_t *data, uint32_t data_length, uint8_t *buffer_out, uint16_t *length)
+{
+	uint32_t header_length = TF_PACKET_PRIMARY_BASE_HEADER_SIZE + channel->vc_count_length + TF_PACKET_DATA_HEADER_SIZE;
+
+	if(data_length > tf_packet_ChannelDataSize(channel))	return HAL_ERROR;
+
+	uint32_t frame_length = header_length + data_length + (channel->ocf_flag ? TF_PACKET_OCF_SIZE : 0) + channel->ecf_size;
+
+	buffer_out[0] = (channel->tfvn<<4) | ((channel->scid & 0xF000)>>12);
+	buffer_out[1] = (channel->scid & 0x0FF0)>>4;
+	buffer_out[2] = ((channel->scid & 0x000F)<<4) | (channel->source_dest_id<<3) | ((channel->vcid & 0b111000)>>3);
+	buffer_out[3] = ((channel->vcid & 0b000111)<<5) | (channel->mapid<<1) | TF_PACKET_NOT_TRUNCATED;
+	buffer_out[4] = (frame_length & 0xFF00)>>8;
+	buffer_out[5] = frame_length & 0x00FF;
+	buffer_out[6] = (channel->bypass_flag<<7) | (channel->command_flag<<6) | (channel->ocf_flag<<3) | channel->vc_count_length;
+	tf_packet_EncodeVcCount(&buffer_out[TF_PACKET_PRIMARY_BASE_HEADER_SIZE], channel->vc_count, channel->vc_count_length);
+	buffer_out[header_length-TF_PACKET_DATA_HEADER_SIZE] = (channel->constr_rule<<5) | channel->protocol_id;
+	memcpy(&buffer_out[header_length], data, data_length);
+
+	if(channel->ocf_flag)
+	{
+		uint8_t *ocf = &buffer_out[header_length + data_length];
+		ocf[0] = channel->ocf>>24;
+		ocf[1] = (channel->ocf & 0x00FF0000)>>16;
+		ocf[2] = (channel->ocf & 0x0000FF00)>>8;
+		ocf[3] = channel->ocf & 0x000000FF;
+	}
+
+	if(channel->ecf_size == TF_PACKET_ECF32_SIZE)
+	{
+		uint32_t calculated_crc = crc32_ccsds_Calculate(0, buffer_out, frame_length - TF_PACKET_ECF32_SIZE);
+
+		buffer_out[frame_length-4] = calculated_crc>>24;
+		buffer_out[frame_length-3] = (calculated_crc & 0x00FF0000)>>16;
+		buffer_out[frame_length-2] = (calculated_crc & 0x0000FF00)>>8;
+		buffer_out[frame_length-1] = calculated_crc & 0x000000FF;
+	}
+	else
+	{
+		uint16_t calculated_crc = crc16_ccsds_Calculate(0, buffer_out, frame_length - TF_PACKET_ECF_SIZE);
+
+		buffer_out[frame_length-TF_PACKET_ECF_SIZE] = (calculated_crc & 0xFF00)>>8;
+		buffer_out[frame_length-TF_PACKET_ECF_SIZE+1] = calculated_crc & 0x00FF;
+	}
+
+	if(channel->vc_count_length)
+		channel->vc_count = (channel->vc_count + 1) & ((1ULL<<(8*channel->vc_count_length)) - 1);
+
+	*length = frame_length;
+	return HAL_OK;
+}
+
+
+/**
+ * Decode data buffer that contain a TF packet of a virtual channel without
+ * copying the VC frame and the data, with the ECF and the maximum length of
+ * the channel
+ * @param channel Pointer to the channel configuration
+ * @param buffer_in Data buffer with a TF packet to decode
+ * @param buffer_length Data buffer length
+ * @param view Pointer to compact TF packet to save the headers and pointers
+ * to the VC frame and the data into buffer_in
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_DecodeViewChannel(const tf_packet_channel_t *channel, const uint8_t *buffer_in, uint32_t buffer_length, tf_packet_view_t *view)
+{
+	uint32_t header_length, trailer_length;
+	uint32_t length = tf_packet_ValidLength(buffer_in, buffer_length, channel->max_size, channel->ecf_size, &header_length, &trailer_length);
+
+	if(length == 0)		return HAL_ERROR;
+	if(channel->ecf_size == TF_PACKET_ECF32_SIZE ? !tf_packet_CheckECF32(buffer_in, length) : !tf_packet_CheckECF(buffer_in, length))
+		return HAL_ERROR;
+
+	tf_packet_SetView(buffer_in, length, header_length, trailer_length, channel->ecf_size, view);
+
+	return HAL_OK;
+}
+
+
+
+/**
+ * Write a VC frame count MSB first
+ * @param vc_frame Pointer to vc_length bytes (tfph_packet_t::vc_frame or the
+ * VC data given to tf_packet_SetData())
+ * @param vc_count VC frame count, the upper bytes are dropped
+ * @param vc_length Bytes of the VC frame count, up to TF_PACKET_VC_COUNT_MAX_SIZE
+ */
+void tf_packet_EncodeVcCount(uint8_t *vc_frame, uint64_t vc_count, uint8_t vc_length)
+{
+	for(int32_t i=vc_length-1; i>=0; i--)
+	{
+		vc_frame[i] = vc_count & 0xFF;
+		vc_count >>= 8;
+	}
+}
+
+
+/**
+ * Read a VC frame count MSB first
+ * @param vc_frame Pointer to vc_length bytes (tfph_packet_t::vc_frame or
+ * tf_packet_view_t::vc_frame)
+ * @param vc_length Bytes of the VC frame count, up to TF_PACKET_VC_COUNT_MAX_SIZE
+ * @return VC frame count, 0 if vc_length is 0
+ */
+uint64_t tf_packet_DecodeVcCount(const uint8_t *vc_frame, uint8_t vc_length)
+{
+	uint64_t vc_count = 0;
+
+	for(uint32_t i=0; i<vc_length; i++)
+		vc_count = (vc_count<<8) | vc_frame[i];
+
+	return vc_count;
+}
+
+
+
+/**
+ * Change some bytes of an encoded TF packet (header fields as the VCID, the
+ * flags or the VC frame count) and update its ECF with the CRC of the
+ * changed bytes only, so retransmitting or cloning a large TF packet to
+ * other VCs does not compute the CRC again. The ECF must be a correct
+ * CRC16 (TF_PACKET_ECF_SIZE).
+ * The bytes that set the TF packet length cannot change: end_flag, the
+ * length field, ocf_flag and vc_length.
+ * @param buffer_in Data buffer with a TF packet
+ * @param buffer_length Data buffer length (TF packet length if TFPH is truncated)
+ * @param offset Position of the first byte to change
+ * @param header New bytes
+ * @param header_length Number of bytes to change, all before the ECF
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_PatchHeader(uint8_t *buffer_in, uint32_t buffer_length, uint32_t offset, const uint8_t *header, uint32_t header_length)
+{
+	// Bits of bytes 3..6 that set the length of the TF packet and its TFPH
+	static const uint8_t fixed[4] = {0b00000001, 0xFF, 0xFF, 0b00001111};
+	uint32_t header_size, trailer_size;
+	uint32_t length = tf_packet_ValidLength(buffer_in, buffer_length, TF_PACKET_USLP_MAX_SIZE, TF_PACKET_ECF_SIZE, &header_size, &trailer_size);
+
+	if(length == 0 || offset > length - TF_PACKET_ECF_SIZE || header_length > length - TF_PACKET_ECF_SIZE - offset)
+		return HAL_ERROR;
+
+	uint32_t fixed_end = (header_size == TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE) ? 4 : TF_PACKET_PRIMARY_BASE_HEADER_SIZE;
+	for(uint32_t i = (offset > 3) ? offset : 3; i < offset + header_length && i < fixed_end; i++)
+		if((buffer_in[i] ^ header[i - offset]) & fixed[i-3])	return HAL_ERROR;
+
+	uint16_t ecf = (buffer_in[length-TF_PACKET_ECF_SIZE]<<8) | buffer_in[length-TF_PACKET_ECF_SIZE+1];
+	ecf = crc16_ccsds_Patch(ecf, length - TF_PACKET_ECF_SIZE, offset, &buffer_in[offset], header, header_length);
+
+	memmove(&buffer_in[offset], header, header_length);
+	buffer_in[length-TF_PACKET_ECF_SIZE] = (ecf & 0xFF00)>>8;
+	buffer_in[length-TF_PACKET_ECF_SIZE+1] = ecf & 0x00FF;
+
+	return HAL_OK;
+}
+
+
+/**
+ * Change the VCID of an encoded TF packet and update its ECF
+ * @param buffer_in Data buffer with a TF packet
+ * @param buffer_length Data buffer length (TF packet length if TFPH is truncated)
+ * @param vcid New VCID
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_PatchVcid(uint8_t *buffer_in, uint32_t buffer_length, uint8_t vcid)
+{
+	uint8_t header[2];
+
+	if(buffer_length < TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE || vcid > 0b00111111)	return HAL_ERROR;
+
+	header[0] = (buffer_in[2] & 0b11111000) | ((vcid & 0b111000)>>3);
+	header[1] = ((vcid & 0b000111)<<5) | (buffer_in[3] & 0b00011111);
+
+	return tf_packet_PatchHeader(buffer_in, buffer_length, 2, header, sizeof(header));
+}
+
+
+/**
+ * Change the bypass and command flags of an encoded TF packet (not
+ * truncated TFPH) and update its ECF
+ * @param buffer_in Data buffer with a TF packet
+ * @param buffer_length Data buffer length
+ * @param bypass_flag
+ * 		@arg TF_PACKET_SEQUENCE_CONTROLLED
+ * 		@arg TF_PACKET_EXPEDITED
+ * @param command_flag
+ * 		@arg TF_PACKET_USER_DATA
+ * 		@arg TF_PACKET_INFO
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_PatchFlags(uint8_t *buffer_in, uint32_t buffer_length, uint8_t bypass_flag, uint8_t command_flag)
+{
+	if(buffer_length < TF_PACKET_PRIMARY_BASE_HEADER_SIZE || (buffer_in[3] & 0b00000001) ||
+	   bypass_flag > 1 || command_flag > 1)
+		return HAL_ERROR;
+
+	uint8_t flags = (bypass_flag<<7) | (command_flag<<6) | (buffer_in[6] & 0b00111111);
+
+	return tf_packet_PatchHeader(buffer_in, buffer_length, 6, &flags, 1);
+}
+
+
+/**
+ * Change the OCF of an encoded TF packet (the CLCW sent again with a new
+ * report value) and update its ECF
+ * @param buffer_in Data buffer with a TF packet with OCF and CRC16 ECF
+ * @param buffer_length Data buffer length
+ * @param ocf New Operational Control Field
+ * @return HAL status
+ */
+HAL_StatusTypeDef tf_packet_PatchOcf(uint8_t *buffer_in, uint32_t buffer_length, uint32_t ocf)
+{
+	uint32_t header_length, trailer_length;
+	uint32_t length = tf_packet_ValidLength(buffer_in, buffer_length, TF_PACKET_USLP_MAX_SIZE, TF_PACKET_ECF_SIZE, &header_length, &trailer_length);
+	uint8_t field[TF_PACKET_OCF_SIZE] = {ocf>>24, (ocf & 0x00FF0000)>>16, (ocf & 0x0000FF00)>>8, ocf & 0x000000FF};
+
+	if(length == 0 || trailer_length == TF_PACKET_ECF_SIZE)		return HAL_ERROR;
+
+	return tf_packet_PatchHeader(buffer_in, buffer_length, length - trailer_length, field, TF_PACKET_OCF_SIZE);
+}
+
 
 #ifdef STM32_MCU
 /**
@@ -223,31 +814,17 @@ HAL_StatusTypeDef tf_packet_CRC16CCSDSConfig()
 	else if(HAL_CRCEx_Output_Data_Reverse(&hcrc, CRC_OUTPUTDATA_INVERSION_DISABLE) != HAL_OK)	return HAL_ERROR;
 	else																						return HAL_OK;
 }
+#endif
 
 
-#else
+/**
+ * Compute CRC16 CCSDS with the selected CRC backend
+ * @param seed Initial value of the CRC
+ * @param buf Pointer to data
+ * @param len Data length
+ * @return CRC16
+ */
 uint16_t tf_packet_CRC16CCSDSCalculate(int16_t seed, uint8_t *buf, uint32_t len)
 {
-    unsigned short crc;
-    unsigned short ch, xor_flag;
-    int i, count;
-    crc = seed;
-    count = 0;
-    while (len--) {
-        ch = buf[count++];
-        ch<<=8;
-        for(i=0; i<8; i++)
-        {
-            if ((crc ^ ch) & 0x8000)    xor_flag = 1;
-            else                        xor_flag = 0;
-
-            crc = crc << 1;
-            if (xor_flag)               crc = crc ^ 0x1021;
-
-            ch = ch << 1;
-        }
-    }
-    return (unsigned short)crc;
+	return crc16_ccsds_Calculate((uint16_t)seed, buf, len);
 }
-
-#endif
@@ -29,6 +29,40 @@
   *	    }
   *		// Approximated time for max buffer: 8830 clock cycles
   *
+  *		Large frames (up to TF_PACKET_USLP_MAX_SIZE, the 16 bits length
+  *		field) are sent with a channel, whose buffers are sized by the
+  *		application for that channel only. tfph_packet_t and tfdf_packet_t
+  *		keep the TF_PACKET_MAX_SIZE limit (default 256 bytes):
+  *		tf_packet_channel_t channel;
+  *		uint8_t xband_buffer[8192];
+  *		uint16_t length;
+  *		tf_packet_ChannelInit(&channel, TF_PACKET_DEFAULT_SCID, 1, sizeof(xband_buffer));
+  *		tf_packet_PacketizeChannel(&channel, image, image_length, xband_buffer, &length);
+  *		tf_packet_DecodeView(xband_buffer, length, &view);
+  *
+  *		The ECF of a channel is CRC16 by default. For large TF packets the
+  *		32 bits FECF of USLP (crc32_ccsds.h) detects more errors; both ends
+  *		must select it, as the TFPH does not tell the ECF length:
+  *		tf_packet_ChannelSetEcf(&channel, TF_PACKET_ECF32_SIZE);
+  *		tf_packet_DecodeViewChannel(&channel, xband_buffer, length, &view);
+  *
+  *		The VC frame count (vc_frame, vc_length bytes MSB first) numbers the
+  *		TF packets of every VC, so the receiver finds the lost ones
+  *		(tf_packet_vcc.h). A channel writes and increments it:
+  *		tf_packet_ChannelSetVcCount(&channel, 2, 0);
+  *		and a tfph_packet_t takes it as VC data:
+  *		tf_packet_EncodeVcCount(vc_count, frame_count, 2);
+  *		tf_packet_SetData(data, 10, vc_count, 2, &tfph, &tfdf);
+  *
+  *		With ocf_flag = TF_PACKET_OCF_EXIST the 4 bytes OCF (a CLCW,
+  *		tf_packet_clcw.h) is sent before the ECF, so the acknowledgements of
+  *		the uplink ride on the downlink TF packets:
+  *		tf_packet_ChannelSetOcf(&channel, TF_PACKET_OCF_EXIST, tf_packet_EncodeClcw(&clcw));
+  *
+  *		Header fields of an encoded TF packet are changed without computing
+  *		the CRC of the whole TF packet again (the CRC16 ECF is patched):
+  *		tf_packet_PatchVcid(xband_buffer, length, 2);
+  *
   *
   *	 Warning:
   *		With STM32, define your own CRC handle and make sure that is correctly
@@ -51,7 +85,7 @@
 extern "C" {
 #endif
 
-#define	STM32_MCU	// Comment this define if crc16 is not computed in STM32 MCU
+// Define STM32_MCU in the build (-DSTM32_MCU) if crc16 is computed in STM32 MCU
 
 
 
@@ -60,15 +94,13 @@ extern "C" {
 #include "main.h"
 #endif
 
+#include "crc16_ccsds.h"
+#include "crc32_ccsds.h"
+
 #include <stdint.h>
 #include <string.h>
 
 
-#ifdef STM32_MCU
-extern CRC_HandleTypeDef hcrc;  // In STM32, define your own CRC handle
-#endif
-
-
 #ifndef STM32_MCU
 #define HAL_OK      0x00
 #define HAL_ERROR   0x01
@@ -78,12 +110,21 @@ extern CRC_HandleTypeDef hcrc;  // In STM32, define your own CRC handle
 #endif
 
 
-#define TF_PACKET_MAX_SIZE						256
-#define TF_PACKET_ECF_SIZE						2
+#define TF_PACKET_USLP_MAX_SIZE					65535		// 16 bits length field
+#ifndef TF_PACKET_MAX_SIZE
+#define TF_PACKET_MAX_SIZE						256			// tfph_packet_t and tfdf_packet_t
+#endif
+#if TF_PACKET_MAX_SIZE > TF_PACKET_USLP_MAX_SIZE
+#error "TF_PACKET_MAX_SIZE must not be greater than TF_PACKET_USLP_MAX_SIZE"
+#endif
+#define TF_PACKET_ECF_SIZE						2			// CRC16 FECF
+#define TF_PACKET_ECF32_SIZE					4			// CRC32 FECF, only with channels
 #define TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE	4
 #define TF_PACKET_PRIMARY_BASE_HEADER_SIZE		7
 #define TF_PACKET_DATA_HEADER_SIZE				1
 #define TF_PACKET_VCDATA_MAX_SIZE				56
+#define TF_PACKET_VC_COUNT_MAX_SIZE				7			// vc_length field, 3 bits
+#define TF_PACKET_OCF_SIZE						4			// Before the ECF if ocf_flag is set
 #define TF_PACKET_DATA_MAX_SIZE					(TF_PACKET_MAX_SIZE-TF_PACKET_PRIMARY_TRUNCATED_HEADER_SIZE-TF_PACKET_DATA_HEADER_SIZE-TF_PACKET_ECF_SIZE)
 
 
@@ -104,8 +145,8 @@ extern CRC_HandleTypeDef hcrc;  // In STM32, define your own CRC handle
 #define TF_PACKET_USER_DATA		0
 #define TF_PACKET_INFO			1
 
-#define TF_PACKET_OCF_EXIST			0
-#define TF_PACKET_OCF_NOT_EXIST		1
+#define TF_PACKET_OCF_NOT_EXIST		0
+#define TF_PACKET_OCF_EXIST			1
 
 #define TF_PACKET_DEFAULT_PROTOCOL_ID	0b00000000
 #define TF_PACKET_DEFAULT_CONSTR_RULE	0b00000111
@@ -125,6 +166,7 @@ typedef struct
 	uint8_t ocf_flag;
 	uint8_t vc_length;
 	uint8_t vc_frame[TF_PACKET_VCDATA_MAX_SIZE];
+	uint32_t ocf;				// Operational Control Field (CLCW), 0 without TF_PACKET_OCF_EXIST
 }tfph_packet_t;
 
 
@@ -136,20 +178,117 @@ typedef struct
 }tfdf_packet_t;
 
 
+/*
+ * Compact decoded TF packet. The TFPH fields are kept packed as in the wire
+ * header and the VC frame, data and OCF are not copied:
+ *	id bits		31..28: tfvn, 27..12: scid, 11: source_dest_id,
+ *				10..5: vcid, 4..1: mapid, 0: end_flag
+ *	flags bits	7: bypass_flag, 6: command_flag, 3: ocf_flag, 2..0: vc_length
+ *	tfdf_header	7..5: constr_rule, 4..0: protocol_id
+ */
+typedef struct
+{
+	uint32_t id;
+	uint16_t length;
+	uint8_t flags;
+	uint8_t tfdf_header;
+	const uint8_t *vc_frame;	// Points into the decoded buffer, NULL if vc_length is 0
+	const uint8_t *data;		// Points into the decoded buffer
+	uint32_t data_length;
+	const uint8_t *ocf;			// Points into the decoded buffer, NULL if ocf_flag is 0
+}tf_packet_view_t;
+
+
+/*
+ * Configuration of a virtual channel. Every channel has its own maximum TF
+ * packet length, so the buffers of a high rate channel are sized for it and
+ * not for all the channels.
+ */
+typedef struct
+{
+	uint8_t tfvn;
+	uint16_t scid;
+	uint8_t source_dest_id;
+	uint8_t vcid;
+	uint8_t mapid;
+	uint8_t bypass_flag;
+	uint8_t command_flag;
+	uint8_t constr_rule;
+	uint8_t protocol_id;
+	uint16_t max_size;			// Longest TF packet of the channel, up to TF_PACKET_USLP_MAX_SIZE
+	uint8_t ecf_size;			// TF_PACKET_ECF_SIZE (CRC16) or TF_PACKET_ECF32_SIZE (CRC32)
+	uint8_t vc_count_length;	// Bytes of the VC frame count, 0 without it
+	uint8_t ocf_flag;			// TF_PACKET_OCF_EXIST to send ocf in every TF packet
+	uint32_t ocf;				// Operational Control Field (CLCW)
+	uint64_t vc_count;			// VC frame count of the next TF packet
+}tf_packet_channel_t;
+
+
+/*
+ * Struct of arrays with the TFPH of many TF packets. Arrays are owned by the
+ * caller and must have capacity elements. length and flags are 0 for
+ * truncated TFPH.
+ */
+typedef struct
+{
+	uint32_t capacity;
+	uint32_t count;
+	uint16_t *scid;
+	uint8_t *vcid;
+	uint8_t *mapid;
+	uint8_t *end_flag;
+	uint16_t *length;
+	uint8_t *flags;				// bypass_flag(7), command_flag(6), ocf_flag(3), vc_length(2..0)
+}tf_packet_header_batch_t;
+
+
 
 
 
 
 
-#ifndef STM32_MCU
 uint16_t tf_packet_CRC16CCSDSCalculate(int16_t seed, uint8_t *buf, uint32_t len);
-#else
+#ifdef STM32_MCU
 HAL_StatusTypeDef tf_packet_CRC16CCSDSConfig();
 #endif
 
+HAL_StatusTypeDef tf_packet_Validate(const uint8_t *buffer_in, uint32_t buffer_length);
 HAL_StatusTypeDef tf_packet_Decode(uint8_t *buffer_in, uint32_t buffer_length,  tfph_packet_t *tfph, tfdf_packet_t *tfdf);
-HAL_StatusTypeDef tf_packet_Packetize(uint8_t data_length, tfph_packet_t *tfph, tfdf_packet_t *tfdf, uint8_t *buffer_out);
-HAL_StatusTypeDef tf_packet_SetData(uint8_t *data, uint8_t data_length, uint8_t *VCdata, uint8_t VCdata_length, tfph_packet_t *tfph, tfdf_packet_t *tfdf);
+HAL_StatusTypeDef tf_packet_DecodeCorrect(uint8_t *buffer_in, uint32_t buffer_length, tfph_packet_t *tfph, tfdf_packet_t *tfdf, uint8_t *corrected);
+HAL_StatusTypeDef tf_packet_Packetize(uint16_t data_length, tfph_packet_t *tfph, tfdf_packet_t *tfdf, uint8_t *buffer_out);
+HAL_StatusTypeDef tf_packet_DecodeView(const uint8_t *buffer_in, uint32_t buffer_length, tf_packet_view_t *view);
+uint32_t tf_packet_DecodeHeaderBatch(const uint8_t *buffer, const uint32_t *offsets, uint32_t n, tf_packet_header_batch_t *batch);
+HAL_StatusTypeDef tf_packet_SetData(uint8_t *data, uint16_t data_length, uint8_t *VCdata, uint16_t VCdata_length, tfph_packet_t *tfph, tfdf_packet_t *tfdf);
+
+HAL_StatusTypeDef tf_packet_ChannelInit(tf_packet_channel_t *channel, uint16_t scid, uint8_t vcid, uint32_t max_size);
+HAL_StatusTypeDef tf_packet_ChannelSetEcf(tf_packet_channel_t *channel, uint8_t ecf_size);
+HAL_StatusTypeDef tf_packet_ChannelSetVcCount(tf_packet_channel_t *channel, uint8_t vc_count_length, uint64_t vc_count);
+HAL_StatusTypeDef tf_packet_ChannelSetOcf(tf_packet_channel_t *channel, uint8_t ocf_flag, uint32_t ocf);
+HAL_StatusTypeDef tf_packet_PacketizeChannel(tf_packet_channel_t *channel, const uint8_t *data, uint32_t data_length, uint8_t *buffer_out, uint16_t *length);
+HAL_StatusTypeDef tf_packet_DecodeViewChannel(const tf_packet_channel_t *channel, const uint8_t *buffer_in, uint32_t buffer_length, tf_packet_view_t *view);
+
+void tf_packet_EncodeVcCount(uint8_t *vc_frame, uint64_t vc_count, uint8_t vc_length);
+uint64_t tf_packet_DecodeVcCount(const uint8_t *vc_frame, uint8_t vc_length);
+
+HAL_StatusTypeDef tf_packet_PatchHeader(uint8_t *buffer_in, uint32_t buffer_length, uint32_t offset, const uint8_t *header, uint32_t header_length);
+HAL_StatusTypeDef tf_packet_PatchVcid(uint8_t *buffer_in, uint32_t buffer_length, uint8_t vcid);
+HAL_StatusTypeDef tf_packet_PatchFlags(uint8_t *buffer_in, uint32_t buffer_length, uint8_t bypass_flag, uint8_t command_flag);
+HAL_StatusTypeDef tf_packet_PatchOcf(uint8_t *buffer_in, uint32_t buffer_length, uint32_t ocf);
+
+static inline uint32_t tf_packet_ChannelDataSize(const tf_packet_channel_t *channel) {return channel->max_size - TF_PACKET_PRIMARY_BASE_HEADER_SIZE - TF_PACKET_DATA_HEADER_SIZE - channel->vc_count_length - (channel->ocf_flag ? TF_PACKET_OCF_SIZE : 0) - channel->ecf_size;}
+
+static inline uint8_t tf_packet_ViewTfvn(const tf_packet_view_t *view) {return view->id>>28;}
+static inline uint16_t tf_packet_ViewScid(const tf_packet_view_t *view) {return (view->id>>12) & 0xFFFF;}
+static inline uint8_t tf_packet_ViewSourceDestId(const tf_packet_view_t *view) {return (view->id>>11) & 0x01;}
+static inline uint8_t tf_packet_ViewVcid(const tf_packet_view_t *view) {return (view->id>>5) & 0b00111111;}
+static inline uint8_t tf_packet_ViewMapid(const tf_packet_view_t *view) {return (view->id>>1) & 0b00001111;}
+static inline uint8_t tf_packet_ViewEndFlag(const tf_packet_view_t *view) {return view->id & 0x01;}
+static inline uint8_t tf_packet_ViewBypassFlag(const tf_packet_view_t *view) {return view->flags>>7;}
+static inline uint8_t tf_packet_ViewCommandFlag(const tf_packet_view_t *view) {return (view->flags>>6) & 0x01;}
+static inline uint8_t tf_packet_ViewOcfFlag(const tf_packet_view_t *view) {return (view->flags>>3) & 0x01;}
+static inline uint8_t tf_packet_ViewVcLength(const tf_packet_view_t *view) {return view->flags & 0b00000111;}
+static inline uint32_t tf_packet_ViewOcf(const tf_packet_view_t *view) {return view->ocf ? ((uint32_t)view->ocf[0]<<24) | (view->ocf[1]<<16) | (view->ocf[2]<<8) | view->ocf[3] : 0;}
+static inline uint64_t tf_packet_ViewVcCount(const tf_packet_view_t *view) {return tf_packet_DecodeVcCount(view->vc_frame, tf_packet_ViewVcLength(view));}
 
 
 #ifdef __cplusplus
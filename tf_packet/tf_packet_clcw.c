@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file           : tf_packet_clcw.c
+  * @brief          : CLCW of the OCF for TF (USLP) FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Encoder and decoder of the COP-1 CLCW sent in the OCF.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "tf_packet_clcw.h"
+
+
+/**
+ * Encode a CLCW to be sent in the OCF. The fields are masked to their
+ * lengths and the spare bits are zero.
+ * @param clcw Pointer to the CLCW
+ * @return OCF
+ */
+uint32_t tf_packet_EncodeClcw(const tf_packet_clcw_t *clcw)
+{
+	return ((uint32_t)TF_PACKET_CLCW_TYPE<<31) |
+		   ((uint32_t)TF_PACKET_CLCW_VERSION<<29) |
+		   ((uint32_t)(clcw->status & 0b111)<<26) |
+		   ((uint32_t)(clcw->cop_in_effect & 0b11)<<24) |
+		   ((uint32_t)(clcw->vcid & 0b00111111)<<18) |
+		   ((uint32_t)(clcw->no_rf_available & 0b1)<<15) |
+		   ((uint32_t)(clcw->no_bit_lock & 0b1)<<14) |
+		   ((uint32_t)(clcw->lockout & 0b1)<<13) |
+		   ((uint32_t)(clcw->wait & 0b1)<<12) |
+		   ((uint32_t)(clcw->retransmit & 0b1)<<11) |
+		   ((uint32_t)(clcw->farm_b_counter & 0b11)<<9) |
+		   clcw->report_value;
+}
+
+
+/**
+ * Decode the CLCW of an OCF
+ * @param ocf Operational Control Field received
+ * @param clcw Pointer to the CLCW
+ * @return HAL status, error if the OCF is not a CLCW of version 0
+ */
+HAL_StatusTypeDef tf_packet_DecodeClcw(uint32_t ocf, tf_packet_clcw_t *clcw)
+{
+	if((ocf>>31) != TF_PACKET_CLCW_TYPE || ((ocf>>29) & 0b11) != TF_PACKET_CLCW_VERSION)
+		return HAL_ERROR;
+
+	clcw->status = (ocf>>26) & 0b111;
+	clcw->cop_in_effect = (ocf>>24) & 0b11;
+	clcw->vcid = (ocf>>18) & 0b00111111;
+	clcw->no_rf_available = (ocf>>15) & 0b1;
+	clcw->no_bit_lock = (ocf>>14) & 0b1;
+	clcw->lockout = (ocf>>13) & 0b1;
+	clcw->wait = (ocf>>12) & 0b1;
+	clcw->retransmit = (ocf>>11) & 0b1;
+	clcw->farm_b_counter = (ocf>>9) & 0b11;
+	clcw->report_value = ocf & 0xFF;
+
+	return HAL_OK;
+}
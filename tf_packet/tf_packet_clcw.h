@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file           : tf_packet_clcw.h
+  * @brief          : CLCW of the OCF for TF (USLP) FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		The Communications Link Control Word (CCSDS 232.0-B, COP-1) is the
+  *		report of the FARM of the receiver of the uplink. It is sent in the
+  *		OCF of the downlink TF packets, so the sender of the uplink knows
+  *		the next expected frame sequence number (report value) and if it has
+  *		to retransmit.
+  *
+  *		 Bits (MSB first):
+  *			type (1, = 0) | version (2, = 0) | status (3) | COP in effect (2)
+  *			| VCID (6) | spare (2) | no RF available (1) | no bit lock (1)
+  *			| lockout (1) | wait (1) | retransmit (1) | FARM-B counter (2)
+  *			| spare (1) | report value (8)
+  *
+  *	 Example:
+  *		tf_packet_clcw_t clcw = {.cop_in_effect = TF_PACKET_CLCW_COP1, .vcid = 0, .report_value = farm_vr};
+  *		tf_packet_ChannelSetOcf(&channel, TF_PACKET_OCF_EXIST, tf_packet_EncodeClcw(&clcw));
+  *
+  *		if(tf_packet_DecodeView(buffer, length, &view) == HAL_OK && view.ocf != NULL &&
+  *		   tf_packet_DecodeClcw(tf_packet_ViewOcf(&view), &clcw) == HAL_OK && clcw.retransmit)
+  *			Fop_Retransmit(clcw.report_value);
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_TF_PACKET_CLCW_H_
+#define INC_TF_PACKET_CLCW_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "tf_packet.h"
+
+
+#define TF_PACKET_CLCW_TYPE				0		// Control word type of the CLCW
+#define TF_PACKET_CLCW_VERSION			0
+#define TF_PACKET_CLCW_COP1				1		// COP in effect
+
+
+typedef struct
+{
+	uint8_t status;				// 3 bits, mission specific
+	uint8_t cop_in_effect;		// 2 bits, TF_PACKET_CLCW_COP1
+	uint8_t vcid;				// 6 bits
+	uint8_t no_rf_available;	// 1 bit
+	uint8_t no_bit_lock;		// 1 bit
+	uint8_t lockout;			// 1 bit
+	uint8_t wait;				// 1 bit
+	uint8_t retransmit;			// 1 bit
+	uint8_t farm_b_counter;		// 2 bits
+	uint8_t report_value;		// Next expected frame sequence number, V(R)
+}tf_packet_clcw_t;
+
+
+uint32_t tf_packet_EncodeClcw(const tf_packet_clcw_t *clcw);
+HAL_StatusTypeDef tf_packet_DecodeClcw(uint32_t ocf, tf_packet_clcw_t *clcw);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TF_PACKET_CLCW_H_ */
@@ -0,0 +1,154 @@
+/**
+  ******************************************************************************
+  * @file           : tf_packet_vcc.c
+  * @brief          : VC frame count loss tracker for TF (USLP) FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Receiver tracker of the VC frame count with gaps, duplicates, late
+  *		TF packets and resyncs per VCID.
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "tf_packet_vcc.h"
+
+
+/**
+ * Initialize the tracker without TF packets received
+ * @param vcc Pointer to the tracker
+ * @param flywheel Longest gap counted as lost (TF_PACKET_VCC_DEFAULT_FLYWHEEL).
+ * With short VC frame counts it is limited to the counts out of the window.
+ */
+void tf_packet_VccInit(tf_packet_vcc_t *vcc, uint32_t flywheel)
+{
+	memset(vcc, 0, sizeof(*vcc));
+	vcc->flywheel = flywheel;
+}
+
+
+/**
+ * Forget the state and statistics of a VC, so its next TF packet is the
+ * first one
+ * @param vcc Pointer to the tracker
+ * @param vcid Virtual channel ID
+ */
+void tf_packet_VccReset(tf_packet_vcc_t *vcc, uint8_t vcid)
+{
+	memset(&vcc->vc[vcid & 0b00111111], 0, sizeof(vcc->vc[0]));
+}
+
+
+/**
+ * Track a received VC frame count
+ * @param vcc Pointer to the tracker
+ * @param vcid Virtual channel ID
+ * @param vc_count Received VC frame count
+ * @param vc_length Bytes of the VC frame count, 1 to TF_PACKET_VC_COUNT_MAX_SIZE
+ * @return What the VC frame count means for the VC. With
+ * TF_PACKET_VCC_DUPLICATE the TF packet should be dropped. With
+ * TF_PACKET_VCC_GAP, gap_start and gap_length of the VC are the missing
+ * VC frame counts.
+ */
+tf_packet_vcc_event_t tf_packet_VccTrack(tf_packet_vcc_t *vcc, uint8_t vcid, uint64_t vc_count, uint8_t vc_length)
+{
+	if(vc_length == 0 || vc_length > TF_PACKET_VC_COUNT_MAX_SIZE)	return TF_PACKET_VCC_NO_COUNT;
+
+	tf_packet_vcc_state_t *state = &vcc->vc[vcid & 0b00111111];
+	uint64_t mask = (1ULL<<(8*vc_length)) - 1;
+
+	vc_count &= mask;
+	uint64_t ahead = (vc_count - state->expected) & mask;		// 0 if in order
+	uint64_t behind = (state->expected - 1 - vc_count) & mask;	// 0 if the last one again
+
+	// Behind is checked first: with short counts both distances are small
+	if(state->vc_length == vc_length && behind < TF_PACKET_VCC_WINDOW)
+	{
+		uint32_t bit = 1UL << behind;
+		if(state->window & bit)
+		{
+			state->stats.duplicates++;
+			return TF_PACKET_VCC_DUPLICATE;
+		}
+
+		state->window |= bit;
+		state->stats.received++;
+		state->stats.late++;
+		if(state->stats.lost)	state->stats.lost--;
+		return TF_PACKET_VCC_LATE;
+	}
+
+	if(state->vc_length != vc_length || ahead > vcc->flywheel)
+	{
+		tf_packet_vcc_event_t event = state->vc_length ? TF_PACKET_VCC_RESYNC : TF_PACKET_VCC_FIRST;
+
+		state->stats.resyncs += (event == TF_PACKET_VCC_RESYNC);
+		state->vc_length = vc_length;
+		state->expected = (vc_count + 1) & mask;
+		state->window = ~0U;		// Older counts were never lost: duplicates, or a resync out of the window
+		state->stats.received++;
+		return event;
+	}
+
+	// The window moves to the new count: ahead lost TF packets and this one
+	state->window = (ahead + 1 >= TF_PACKET_VCC_WINDOW) ? 1 : (state->window << (ahead + 1)) | 1;
+	state->expected = (vc_count + 1) & mask;
+	state->stats.received++;
+	if(ahead == 0)	return TF_PACKET_VCC_IN_ORDER;
+
+	state->gap_start = (vc_count - ahead) & mask;
+	state->gap_length = ahead;
+	state->stats.lost += ahead;
+	state->stats.gaps++;
+	if(ahead > state->stats.max_gap)	state->stats.max_gap = ahead;
+	return TF_PACKET_VCC_GAP;
+}
+
+
+/**
+ * Track the VC frame count of a decoded TF packet
+ * @param vcc Pointer to the tracker
+ * @param view TF packet decoded with tf_packet_DecodeView()
+ * @return What the VC frame count means for the VC, or
+ * TF_PACKET_VCC_NO_COUNT if the TF packet has no VC frame count
+ */
+tf_packet_vcc_event_t tf_packet_VccTrackView(tf_packet_vcc_t *vcc, const tf_packet_view_t *view)
+{
+	uint8_t vc_length = tf_packet_ViewVcLength(view);
+
+	if(vc_length == 0)	return TF_PACKET_VCC_NO_COUNT;
+
+	return tf_packet_VccTrack(vcc, tf_packet_ViewVcid(view), tf_packet_ViewVcCount(view), vc_length);
+}
+
+
+/**
+ * Add the statistics of all the VCs
+ * @param vcc Pointer to the tracker
+ * @param totals Pointer to save the sum (max_gap is the longest of all)
+ */
+void tf_packet_VccTotals(const tf_packet_vcc_t *vcc, tf_packet_vcc_stats_t *totals)
+{
+	memset(totals, 0, sizeof(*totals));
+
+	for(uint32_t vcid=0; vcid<TF_PACKET_VCC_VCIDS; vcid++)
+	{
+		const tf_packet_vcc_stats_t *stats = &vcc->vc[vcid].stats;
+
+		totals->received += stats->received;
+		totals->lost += stats->lost;
+		totals->gaps += stats->gaps;
+		if(stats->max_gap > totals->max_gap)	totals->max_gap = stats->max_gap;
+		totals->duplicates += stats->duplicates;
+		totals->late += stats->late;
+		totals->resyncs += stats->resyncs;
+	}
+}
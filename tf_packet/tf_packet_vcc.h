@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file           : tf_packet_vcc.h
+  * @brief          : VC frame count loss tracker for TF (USLP) FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		The receiver keeps O(1) state per VCID (next expected VC frame count
+  *		and a window with the last TF_PACKET_VCC_WINDOW counts received) and
+  *		reports gaps, duplicates (retransmissions), late TF packets and
+  *		resyncs. The VC frame count is modulo 2^(8*vc_length), with the
+  *		vc_length of every TF packet.
+  *
+  *		The tracker flywheels over gaps up to the flywheel length: the
+  *		missing TF packets are counted as lost and the last gap is kept for
+  *		the retransmission logic. A longer jump forward, a jump backward out
+  *		of the window or a new vc_length (the sender restarted, or a wrong
+  *		count) is a resync and nothing is counted as lost.
+  *
+  *	 Example:
+  *		tf_packet_vcc_t vcc;
+  *		tf_packet_VccInit(&vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+  *		if(tf_packet_DecodeView(buffer, length, &view) == HAL_OK &&
+  *		   tf_packet_VccTrackView(&vcc, &view) == TF_PACKET_VCC_GAP)
+  *			Request_Retransmission(vcid, vcc.vc[vcid].gap_start, vcc.vc[vcid].gap_length);
+  *		lost = vcc.vc[vcid].stats.lost;
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_TF_PACKET_VCC_H_
+#define INC_TF_PACKET_VCC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "tf_packet.h"
+
+
+#define TF_PACKET_VCC_VCIDS					64
+#define TF_PACKET_VCC_WINDOW				32		// Bits of tf_packet_vcc_state_t::window
+#define TF_PACKET_VCC_DEFAULT_FLYWHEEL		1024	// Longest gap counted as lost
+
+
+typedef enum
+{
+	TF_PACKET_VCC_IN_ORDER		= 0,
+	TF_PACKET_VCC_FIRST,					// First TF packet of the VC
+	TF_PACKET_VCC_GAP,						// TF packets were lost before this one
+	TF_PACKET_VCC_DUPLICATE,				// Already received, drop it
+	TF_PACKET_VCC_LATE,						// Counted as lost before, received now
+	TF_PACKET_VCC_RESYNC,					// Jump out of the flywheel or the window
+	TF_PACKET_VCC_NO_COUNT,					// TF packet without VC frame count
+}tf_packet_vcc_event_t;
+
+
+typedef struct
+{
+	uint32_t received;			// TF packets received (duplicates are not included)
+	uint32_t lost;				// TF packets missing in the gaps and not received later
+	uint32_t gaps;
+	uint32_t max_gap;			// Longest gap flywheeled over
+	uint32_t duplicates;
+	uint32_t late;
+	uint32_t resyncs;
+}tf_packet_vcc_stats_t;
+
+
+typedef struct
+{
+	uint64_t expected;			// Next expected VC frame count
+	uint64_t gap_start;			// First VC frame count missing in the last gap
+	uint32_t gap_length;		// TF packets missing in the last gap
+	uint32_t window;			// Bit i: VC frame count expected-1-i received
+	uint8_t vc_length;			// VC frame count bytes, 0 before the first TF packet
+	tf_packet_vcc_stats_t stats;
+}tf_packet_vcc_state_t;
+
+
+typedef struct
+{
+	uint32_t flywheel;			// Longest gap counted as lost, longer jumps resync
+	tf_packet_vcc_state_t vc[TF_PACKET_VCC_VCIDS];
+}tf_packet_vcc_t;
+
+
+
+
+void tf_packet_VccInit(tf_packet_vcc_t *vcc, uint32_t flywheel);
+void tf_packet_VccReset(tf_packet_vcc_t *vcc, uint8_t vcid);
+tf_packet_vcc_event_t tf_packet_VccTrack(tf_packet_vcc_t *vcc, uint8_t vcid, uint64_t vc_count, uint8_t vc_length);
+tf_packet_vcc_event_t tf_packet_VccTrackView(tf_packet_vcc_t *vcc, const tf_packet_view_t *view);
+void tf_packet_VccTotals(const tf_packet_vcc_t *vcc, tf_packet_vcc_stats_t *totals);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* INC_TF_PACKET_VCC_H_ */
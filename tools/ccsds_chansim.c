@@ -0,0 +1,802 @@
+/**
+  ******************************************************************************
+  * @file           : ccsds_chansim.c
+  * @brief          : Channel simulator and load generator FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Ground station tool (Linux) that generates a stream of bus packets
+  *		(bus_packet_EncodePacketize) or TF packets (tf_packet_PacketizeChannel),
+  *		every one after the sync marker 1A CF FC 1D, and damages it as a
+  *		noisy channel would do:
+  *			- bit flips with a bit error rate
+  *			- bursts of random bytes
+  *			- dropped and inserted bytes
+  *			- bit slips (one bit added or lost, the rest of the packet is
+  *			  shifted until the UART aligns again after the idle line)
+  *		Every impairment is a Poisson process drawn from a seeded PRNG, so
+  *		the same seed always gives the same stream.
+  *
+  *		The damaged stream is decoded in memory (bus_packet_RxFeed or a TF
+  *		sync search, then the zero-copy decoders) and the tool reports
+  *		throughput, CRC rejections and their cost, undetected errors and how
+  *		long the receiver takes to recover the sync after every impairment.
+  *		The stream can also be written to a file or a pipe, paced at a
+  *		packet rate, and the clean packets saved as a capture file.
+  *
+  *		The first 4 data bytes of every packet are its number (big endian),
+  *		the rest are pseudo-random, so the receiver can check them.
+  *
+  *		TF packets are sent through a channel sized for -M, so large frames
+  *		(up to TF_PACKET_USLP_MAX_SIZE) are measured too:
+  *			ccsds_chansim -t tf -m 65525 -M 65525 -n 20000 -q
+  *		and with the 32 bits FECF (-f 32), whose CRC uses the fastest backend.
+  *
+  *	 Build:
+  *		gcc -O2 -Icrc -Ibus_packet -Itf_packet -Icapture tools/ccsds_chansim.c \
+  *			crc/crc16_ccsds.c crc/crc32_ccsds.c bus_packet/bus_packet.c bus_packet/bus_packet_rx.c \
+  *			tf_packet/tf_packet.c tf_packet/tf_packet_vcc.c capture/capture.c -o ccsds_chansim -lm
+  *
+  *	 Usage:
+  *		ccsds_chansim [-t bus|tf] [-n packets] [-S seed] [-m min] [-M max] [-f 16|32] [-V bytes]
+  *					  [-e ber] [-B rate:length] [-d rate] [-i rate] [-k rate]
+  *					  [-c chunk] [-r packets/s] [-o stream] [-w capture] [-q]
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "bus_packet_rx.h"
+#include "capture.h"
+#include "tf_packet_vcc.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+
+#define CHANSIM_LINK_BUS			0
+#define CHANSIM_LINK_TF				1
+
+#define CHANSIM_SEQUENCE_SIZE		4		// Packet number at the start of the data
+#define CHANSIM_DATA_MAX_SIZE		TF_PACKET_USLP_MAX_SIZE
+#define CHANSIM_NEVER				UINT64_MAX
+
+
+typedef struct
+{
+	uint8_t link;
+	uint64_t packets;
+	uint64_t seed;
+	uint32_t min_length;			// Data length range
+	uint32_t max_length;
+	double ber;						// Bit error rate
+	double burst_rate;				// Impairment events per byte
+	uint32_t burst_length;
+	double drop_rate;
+	double insert_rate;
+	double slip_rate;
+	uint32_t chunk;					// Bytes given to the receiver at once
+	double rate;					// Packets per second (pacing and timestamps)
+	uint8_t tf_ecf_size;			// TF_PACKET_ECF_SIZE or TF_PACKET_ECF32_SIZE
+	uint8_t tf_vc_count_length;		// VC frame count bytes, 0 without it
+	tf_packet_channel_t tf_channel;	// Sized for max_length
+}chansim_config_t;
+
+
+typedef struct
+{
+	uint8_t *data;
+	uint64_t size;
+	uint64_t capacity;
+	uint64_t acc;					// Bits not yet written, MSB first
+	uint32_t bits;
+}chansim_stream_t;
+
+
+typedef struct
+{
+	uint64_t *packet_start;			// Offset of every sync marker in the damaged stream
+	uint64_t *event;				// Offset of every impairment in the damaged stream
+	uint64_t events;
+	uint64_t event_capacity;
+	uint64_t flips, bursts, drops, inserts, slips;
+	uint64_t clean_bytes;
+}chansim_channel_t;
+
+
+typedef struct
+{
+	const chansim_config_t *config;
+	uint8_t *received;				// 1 for every packet received correctly
+	uint64_t ok;
+	uint64_t rejected;				// Frames found but rejected by the decoder
+	uint64_t undetected;			// Frames accepted with wrong data
+	uint64_t duplicated;
+	tf_packet_vcc_t vcc;			// VC frame count tracker (-V)
+	chansim_stream_t ok_frames;		// Copies to measure the decoding cost
+	chansim_stream_t rejected_frames;
+}chansim_receiver_t;
+
+
+
+
+static inline uint64_t chansim_Random(uint64_t *state)
+{
+	// splitmix64
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+
+static inline double chansim_Uniform(uint64_t *state)
+{
+	return ((chansim_Random(state) >> 11) + 0.5) * 0x1.0p-53;
+}
+
+
+/**
+ * Distance to the next event of a Poisson process
+ * @param state PRNG state
+ * @param rate Events per unit
+ * @return Units until the next event
+ */
+static uint64_t chansim_Gap(uint64_t *state, double rate)
+{
+	if(rate <= 0)	return CHANSIM_NEVER;
+	if(rate >= 1)	return 0;
+	return (uint64_t)floor(log(chansim_Uniform(state)) / log1p(-rate));
+}
+
+
+static uint64_t chansim_After(uint64_t position, uint64_t gap)
+{
+	return (gap == CHANSIM_NEVER) ? CHANSIM_NEVER : position + gap;
+}
+
+
+static void chansim_Reserve(chansim_stream_t *stream, uint64_t length)
+{
+	if(stream->size + length <= stream->capacity)	return;
+
+	uint64_t capacity = stream->capacity ? stream->capacity : 65536;
+	while(capacity < stream->size + length)		capacity *= 2;
+	stream->data = realloc(stream->data, capacity);
+	if(stream->data == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	stream->capacity = capacity;
+}
+
+
+static void chansim_Append(chansim_stream_t *stream, const uint8_t *data, uint64_t length)
+{
+	chansim_Reserve(stream, length);
+	memcpy(&stream->data[stream->size], data, length);
+	stream->size += length;
+}
+
+
+static inline void chansim_PutBits(chansim_stream_t *stream, uint32_t value, uint32_t n)
+{
+	stream->acc = (stream->acc << n) | (value & ((1U << n) - 1));
+	stream->bits += n;
+
+	// Keep at least 8 bits, so a bit can always be removed
+	while(stream->bits >= 16)
+	{
+		chansim_Reserve(stream, 1);
+		stream->bits -= 8;
+		stream->data[stream->size++] = stream->acc >> stream->bits;
+	}
+}
+
+
+static inline void chansim_DropBit(chansim_stream_t *stream)
+{
+	if(stream->bits)
+	{
+		stream->acc >>= 1;
+		stream->bits--;
+	}
+}
+
+
+static inline uint64_t chansim_Position(const chansim_stream_t *stream)
+{
+	return stream->size + stream->bits / 8;
+}
+
+
+static void chansim_Flush(chansim_stream_t *stream)
+{
+	while(stream->bits >= 8)
+	{
+		chansim_Reserve(stream, 1);
+		stream->bits -= 8;
+		stream->data[stream->size++] = stream->acc >> stream->bits;
+	}
+	if(stream->bits)
+	{
+		chansim_Reserve(stream, 1);
+		stream->data[stream->size++] = stream->acc << (8 - stream->bits);
+		stream->bits = 0;
+	}
+}
+
+
+static void chansim_Event(chansim_channel_t *channel, uint64_t position)
+{
+	if(channel->events == channel->event_capacity)
+	{
+		channel->event_capacity = channel->event_capacity ? channel->event_capacity * 2 : 4096;
+		channel->event = realloc(channel->event, channel->event_capacity * sizeof(uint64_t));
+		if(channel->event == NULL)
+		{
+			fprintf(stderr, "out of memory\n");
+			exit(1);
+		}
+	}
+	channel->event[channel->events++] = position;
+}
+
+
+/**
+ * Data of a packet: its number and pseudo-random bytes from the seed
+ * @return Data length
+ */
+static uint32_t chansim_PacketData(const chansim_config_t *config, uint64_t number, uint8_t *data)
+{
+	uint64_t state = config->seed ^ (number * 0xD1342543DE82EF95ULL);
+	uint32_t length = config->min_length + chansim_Random(&state) % (config->max_length - config->min_length + 1);
+
+	data[0] = number >> 24;
+	data[1] = number >> 16;
+	data[2] = number >> 8;
+	data[3] = number;
+	for(uint32_t i = CHANSIM_SEQUENCE_SIZE; i < length; i++)
+		data[i] = chansim_Random(&state);
+
+	return length;
+}
+
+
+/**
+ * Encode a packet without sync marker
+ * @return Frame length
+ */
+static uint32_t chansim_PacketFrame(const chansim_config_t *config, uint64_t number, uint8_t *frame)
+{
+	uint8_t data[CHANSIM_DATA_MAX_SIZE];
+	uint32_t length = chansim_PacketData(config, number, data);
+
+	if(config->link == CHANSIM_LINK_BUS)
+	{
+		bus_packet_EncodePacketize(BUS_PACKET_TYPE_TM, number % 128, BUS_PACKET_ECF_EXIST, data, length, frame);
+		return bus_packet_GetLength(frame);
+	}
+
+	tf_packet_channel_t channel = config->tf_channel;
+	uint16_t frame_length;
+
+	channel.vcid = number % 64;
+	if(channel.vc_count_length)		channel.vc_count = (number / 64) & ((1ULL<<(8*channel.vc_count_length)) - 1);
+	tf_packet_PacketizeChannel(&channel, data, length, frame, &frame_length);
+	return frame_length;
+}
+
+
+/**
+ * Generate the packets and send them through the channel
+ */
+static void chansim_Generate(const chansim_config_t *config, chansim_stream_t *stream, chansim_channel_t *channel, capture_writer_t *writer)
+{
+	uint64_t state = config->seed;
+	uint64_t position = 0, bit_position = 0;
+	uint64_t next_flip = chansim_Gap(&state, config->ber);
+	uint64_t next_burst = chansim_Gap(&state, config->burst_rate);
+	uint64_t next_drop = chansim_Gap(&state, config->drop_rate);
+	uint64_t next_insert = chansim_Gap(&state, config->insert_rate);
+	uint64_t next_slip = chansim_Gap(&state, config->slip_rate);
+	uint64_t burst_end = 0;
+	int32_t slip = 0;				// Bits added (> 0) or lost (< 0) in this packet
+	uint8_t frame[BUS_PACKET_FRAME_SYNC_SIZE + CHANSIM_DATA_MAX_SIZE];
+
+	for(uint64_t n = 0; n < config->packets; n++)
+	{
+		uint32_t length = BUS_PACKET_FRAME_SYNC_SIZE + chansim_PacketFrame(config, n, &frame[BUS_PACKET_FRAME_SYNC_SIZE]);
+		memcpy(frame, BUS_PACKET_FRAME_SYNC, BUS_PACKET_FRAME_SYNC_SIZE);
+
+		if(writer != NULL)
+		{
+			uint64_t timestamp_ns = (config->rate > 0) ? (uint64_t)(n * 1e9 / config->rate) : n;
+			if(config->link == CHANSIM_LINK_BUS)
+				capture_WriterAppendBusPacket(writer, &frame[BUS_PACKET_FRAME_SYNC_SIZE], timestamp_ns);
+			else
+				capture_WriterAppendTfPacket(writer, &frame[BUS_PACKET_FRAME_SYNC_SIZE], length - BUS_PACKET_FRAME_SYNC_SIZE, timestamp_ns);
+		}
+
+		channel->packet_start[n] = chansim_Position(stream);
+
+		for(uint32_t i = 0; i < length; i++, position++, bit_position += 8)
+		{
+			uint8_t byte = frame[i];
+
+			if(position == next_drop)
+			{
+				chansim_Event(channel, chansim_Position(stream));
+				channel->drops++;
+				next_drop = chansim_After(position, 1 + chansim_Gap(&state, config->drop_rate));
+
+				// The bit errors of the dropped byte are lost with it
+				while(next_flip < bit_position + 8)
+					next_flip = chansim_After(next_flip, 1 + chansim_Gap(&state, config->ber));
+				continue;
+			}
+
+			if(position >= next_burst)
+			{
+				chansim_Event(channel, chansim_Position(stream));
+				channel->bursts++;
+				burst_end = position + config->burst_length;
+				next_burst = chansim_After(position, 1 + chansim_Gap(&state, config->burst_rate));
+			}
+			if(position < burst_end)	byte ^= chansim_Random(&state);
+
+			while(next_flip < bit_position + 8)
+			{
+				if(!(position < burst_end))		chansim_Event(channel, chansim_Position(stream));
+				byte ^= 0x80 >> (next_flip - bit_position);
+				channel->flips++;
+				next_flip = chansim_After(next_flip, 1 + chansim_Gap(&state, config->ber));
+			}
+
+			chansim_PutBits(stream, byte, 8);
+
+			if(position >= next_insert)
+			{
+				chansim_Event(channel, chansim_Position(stream));
+				chansim_PutBits(stream, chansim_Random(&state), 8);
+				channel->inserts++;
+				next_insert = chansim_After(position, 1 + chansim_Gap(&state, config->insert_rate));
+			}
+
+			if(position >= next_slip)
+			{
+				chansim_Event(channel, chansim_Position(stream));
+				if(chansim_Random(&state) & 1)
+				{
+					chansim_PutBits(stream, chansim_Random(&state), 1);
+					slip++;
+				}
+				else
+				{
+					chansim_DropBit(stream);
+					slip--;
+				}
+				channel->slips++;
+				next_slip = chansim_After(position, 1 + chansim_Gap(&state, config->slip_rate));
+			}
+		}
+
+		// The UART takes the byte alignment again with the start bit after the idle line
+		for(; slip > 0; slip--)		chansim_DropBit(stream);
+		for(; slip < 0; slip++)		chansim_PutBits(stream, 0, 1);
+	}
+
+	chansim_Flush(stream);
+	channel->clean_bytes = position;
+}
+
+
+
+
+static void chansim_Check(chansim_receiver_t *receiver, const uint8_t *data, uint32_t data_length)
+{
+	uint8_t expected[CHANSIM_DATA_MAX_SIZE];
+	uint64_t number;
+
+	if(data_length < CHANSIM_SEQUENCE_SIZE)
+	{
+		receiver->undetected++;
+		return;
+	}
+
+	number = ((uint64_t)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+	if(number >= receiver->config->packets ||
+	   chansim_PacketData(receiver->config, number, expected) != data_length ||
+	   memcmp(expected, data, data_length) != 0)
+	{
+		receiver->undetected++;
+		return;
+	}
+
+	if(receiver->received[number])	receiver->duplicated++;
+	receiver->received[number] = 1;
+	receiver->ok++;
+}
+
+
+static void chansim_BusPacketReceived(void *context, uint8_t *buffer, uint32_t length)
+{
+	chansim_receiver_t *receiver = (chansim_receiver_t *)context;
+	bus_packet_view_t view;
+	uint8_t frame_length = length;
+
+	if(bus_packet_DecodeView(buffer, length, &view) != HAL_OK)
+	{
+		receiver->rejected++;
+		chansim_Append(&receiver->rejected_frames, &frame_length, 1);
+		chansim_Append(&receiver->rejected_frames, buffer, length);
+		return;
+	}
+
+	chansim_Append(&receiver->ok_frames, &frame_length, 1);
+	chansim_Append(&receiver->ok_frames, buffer, length);
+	chansim_Check(receiver, view.data, bus_packet_ViewDataLength(&view));
+}
+
+
+static void chansim_ReceiveBus(chansim_receiver_t *receiver, const chansim_stream_t *stream)
+{
+	uint8_t dma_buffer[256];
+	bus_packet_rx_t rx;
+
+	bus_packet_RxInit(&rx, dma_buffer, sizeof(dma_buffer), chansim_BusPacketReceived, receiver);
+	for(uint64_t pos = 0; pos < stream->size; pos += receiver->config->chunk)
+	{
+		uint64_t n = stream->size - pos;
+		bus_packet_RxFeed(&rx, &stream->data[pos], (n < receiver->config->chunk) ? n : receiver->config->chunk);
+	}
+}
+
+
+static void chansim_ReceiveTf(chansim_receiver_t *receiver, const chansim_stream_t *stream)
+{
+	const uint8_t *data = stream->data;
+	uint64_t size = stream->size;
+	uint64_t pos = 0;
+	uint32_t max_size = receiver->config->tf_channel.max_size;
+
+	while(pos + BUS_PACKET_FRAME_SYNC_SIZE + TF_PACKET_PRIMARY_BASE_HEADER_SIZE <= size)
+	{
+		const uint8_t *sync = memchr(&data[pos], BUS_PACKET_FRAME_SYNC[0], size - pos);
+		if(sync == NULL)	break;
+		pos = sync - data;
+		if(pos + BUS_PACKET_FRAME_SYNC_SIZE + TF_PACKET_PRIMARY_BASE_HEADER_SIZE > size)	break;
+		if(memcmp(sync, BUS_PACKET_FRAME_SYNC, BUS_PACKET_FRAME_SYNC_SIZE) != 0)
+		{
+			pos++;
+			continue;
+		}
+
+		const uint8_t *frame = sync + BUS_PACKET_FRAME_SYNC_SIZE;
+		uint32_t length = (frame[4] << 8) | frame[5];
+		tf_packet_view_t view;
+
+		if(length > max_size || pos + BUS_PACKET_FRAME_SYNC_SIZE + length > size ||
+		   tf_packet_DecodeViewChannel(&receiver->config->tf_channel, frame, length, &view) != HAL_OK)
+		{
+			if(length <= max_size && pos + BUS_PACKET_FRAME_SYNC_SIZE + length <= size)
+			{
+				uint16_t frame_length = length;
+				chansim_Append(&receiver->rejected_frames, (uint8_t *)&frame_length, sizeof(frame_length));
+				chansim_Append(&receiver->rejected_frames, frame, length);
+			}
+			receiver->rejected++;
+			pos++;
+			continue;
+		}
+
+		uint16_t frame_length = length;
+		chansim_Append(&receiver->ok_frames, (uint8_t *)&frame_length, sizeof(frame_length));
+		chansim_Append(&receiver->ok_frames, frame, length);
+		chansim_Check(receiver, view.data, view.data_length);
+		tf_packet_VccTrackView(&receiver->vcc, &view);
+		pos += BUS_PACKET_FRAME_SYNC_SIZE + length;
+	}
+}
+
+
+/**
+ * Decode again the frames saved by the receiver
+ * @param megabytes Decoded MB/s, without the receiver and the check of the data
+ * @return Nanoseconds per frame
+ */
+static double chansim_DecodeCost(const chansim_config_t *config, const chansim_stream_t *frames, double *megabytes)
+{
+	uint64_t count = 0, bytes = 0, start, end;
+	uint32_t loops = 0;
+	struct timespec ts;
+
+	*megabytes = 0;
+	if(frames->size == 0)	return 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	start = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	do
+	{
+		for(uint64_t pos = 0; pos < frames->size; count++)
+		{
+			if(config->link == CHANSIM_LINK_BUS)
+			{
+				bus_packet_view_t view;
+				uint32_t length = frames->data[pos];
+				bus_packet_DecodeView(&frames->data[pos + 1], length, &view);
+				pos += 1 + length;
+				bytes += length;
+			}
+			else
+			{
+				tf_packet_view_t view;
+				uint16_t length;
+				memcpy(&length, &frames->data[pos], sizeof(length));
+				tf_packet_DecodeViewChannel(&config->tf_channel, &frames->data[pos + sizeof(length)], length, &view);
+				pos += sizeof(length) + length;
+				bytes += length;
+			}
+		}
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		end = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	}
+	while(++loops < 1000 && end - start < 200000000ULL);
+
+	*megabytes = bytes * 1e3 / (end - start);
+	return (double)(end - start) / count;
+}
+
+
+/**
+ * Bytes and packets until the receiver gets a packet again after every
+ * impairment
+ */
+static void chansim_Recovery(const chansim_config_t *config, const chansim_channel_t *channel, const uint8_t *received,
+							 double *mean_bytes, uint64_t *max_bytes, double *mean_lost)
+{
+	uint64_t n = 0, measured = 0, bytes = 0, lost = 0;
+
+	*max_bytes = 0;
+	for(uint64_t e = 0; e < channel->events; e++)
+	{
+		uint64_t p = channel->event[e];
+
+		while(n < config->packets && channel->packet_start[n] < p)		n++;
+
+		// Packets that start after the impairment and are still lost
+		uint64_t k = n;
+		while(k < config->packets && !received[k])	k++;
+		if(k == config->packets)	break;
+
+		uint64_t recovery = channel->packet_start[k] - p;
+		bytes += recovery;
+		lost += k - n;
+		if(recovery > *max_bytes)	*max_bytes = recovery;
+		measured++;
+	}
+
+	*mean_bytes = measured ? (double)bytes / measured : 0;
+	*mean_lost = measured ? (double)lost / measured : 0;
+}
+
+
+static void chansim_WriteStream(const chansim_config_t *config, const chansim_stream_t *stream, const chansim_channel_t *channel, const char *path)
+{
+	FILE *file = (strcmp(path, "-") == 0) ? stdout : fopen(path, "wb");
+	struct timespec start, ts;
+
+	if(file == NULL)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		exit(1);
+	}
+
+	if(config->rate <= 0)
+		fwrite(stream->data, 1, stream->size, file);
+	else
+	{
+		// Write every packet at its time
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for(uint64_t n = 0; n < config->packets; n++)
+		{
+			uint64_t begin = channel->packet_start[n];
+			uint64_t end = (n + 1 < config->packets) ? channel->packet_start[n + 1] : stream->size;
+			uint64_t target = (uint64_t)start.tv_sec * 1000000000ULL + start.tv_nsec + (uint64_t)(n * 1e9 / config->rate);
+
+			ts.tv_sec = target / 1000000000ULL;
+			ts.tv_nsec = target % 1000000000ULL;
+			while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+
+			if(end > begin && fwrite(&stream->data[begin], 1, end - begin, file) != end - begin)	break;
+			fflush(file);
+		}
+	}
+
+	if(file != stdout)	fclose(file);
+}
+
+
+static void chansim_Usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [options]\n"
+			"  -t  bus|tf        packets to generate (default bus)\n"
+			"  -n  packets       number of packets (default 100000)\n"
+			"  -S  seed          PRNG seed (default 1)\n"
+			"  -m/-M length      minimum/maximum data length (TF: up to 65525, 65523 with -f 32)\n"
+			"  -f  16|32         CRC of the TF packets ECF (default 16)\n"
+			"  -V  bytes         VC frame count of the TF packets, tracked by the receiver\n"
+			"  -e  ber           bit error rate\n"
+			"  -B  rate:length   bursts per byte and burst length in bytes\n"
+			"  -d  rate          dropped bytes per byte\n"
+			"  -i  rate          inserted bytes per byte\n"
+			"  -k  rate          bit slips per byte\n"
+			"  -c  chunk         bytes given to the receiver at once (default 64)\n"
+			"  -r  packets/s     pace -o and set the -w timestamps\n"
+			"  -o  stream        write the damaged stream (- for stdout) instead of decoding it\n"
+			"  -w  capture       save the clean packets as a capture file\n"
+			"  -q  print only the summary line\n", name);
+}
+
+
+int main(int argc, char **argv)
+{
+	chansim_config_t config = {0};
+	chansim_stream_t stream = {0};
+	chansim_channel_t channel = {0};
+	chansim_receiver_t receiver = {0};
+	capture_writer_t writer;
+	const char *output = NULL, *capture = NULL;
+	uint8_t quiet = 0;
+	int opt;
+
+	config.link = CHANSIM_LINK_BUS;
+	config.packets = 100000;
+	config.seed = 1;
+	config.min_length = 0;
+	config.max_length = 0;
+	config.chunk = 64;
+	config.tf_ecf_size = TF_PACKET_ECF_SIZE;
+
+	while((opt = getopt(argc, argv, "t:n:S:m:M:f:V:e:B:d:i:k:c:r:o:w:qh")) != -1)
+	{
+		switch(opt)
+		{
+		case 't':	config.link = (strcmp(optarg, "tf") == 0) ? CHANSIM_LINK_TF : CHANSIM_LINK_BUS;	break;
+		case 'n':	config.packets = strtoull(optarg, NULL, 0);				break;
+		case 'S':	config.seed = strtoull(optarg, NULL, 0);				break;
+		case 'm':	config.min_length = strtoul(optarg, NULL, 0);			break;
+		case 'M':	config.max_length = strtoul(optarg, NULL, 0);			break;
+		case 'V':	config.tf_vc_count_length = strtoul(optarg, NULL, 0);	break;
+		case 'f':	config.tf_ecf_size = (strtoul(optarg, NULL, 0) == 32) ? TF_PACKET_ECF32_SIZE : TF_PACKET_ECF_SIZE;	break;
+		case 'e':	config.ber = strtod(optarg, NULL);						break;
+		case 'B':
+		{
+			char *end;
+			config.burst_rate = strtod(optarg, &end);
+			config.burst_length = (*end == ':') ? strtoul(end + 1, NULL, 0) : 8;
+			break;
+		}
+		case 'd':	config.drop_rate = strtod(optarg, NULL);				break;
+		case 'i':	config.insert_rate = strtod(optarg, NULL);				break;
+		case 'k':	config.slip_rate = strtod(optarg, NULL);				break;
+		case 'c':	config.chunk = strtoul(optarg, NULL, 0);				break;
+		case 'r':	config.rate = strtod(optarg, NULL);						break;
+		case 'o':	output = optarg;										break;
+		case 'w':	capture = optarg;										break;
+		case 'q':	quiet = 1;												break;
+		default:	chansim_Usage(argv[0]);									return 2;
+		}
+	}
+
+	// The TF channel is sized for the longest data (-M), up to TF_PACKET_USLP_MAX_SIZE
+	uint32_t max_data = (config.link == CHANSIM_LINK_BUS) ? BUS_PACKET_DATA_SIZE :
+			TF_PACKET_USLP_MAX_SIZE - TF_PACKET_PRIMARY_BASE_HEADER_SIZE - config.tf_vc_count_length - TF_PACKET_DATA_HEADER_SIZE - config.tf_ecf_size;
+	if(config.max_length == 0)
+		config.max_length = (config.link == CHANSIM_LINK_BUS) ? max_data :
+				(uint32_t)(TF_PACKET_MAX_SIZE - TF_PACKET_PRIMARY_BASE_HEADER_SIZE - config.tf_vc_count_length - TF_PACKET_DATA_HEADER_SIZE - config.tf_ecf_size);
+	if(config.min_length < CHANSIM_SEQUENCE_SIZE)	config.min_length = CHANSIM_SEQUENCE_SIZE;
+	if(optind != argc || config.packets == 0 || config.packets > UINT32_MAX || config.chunk == 0 ||
+	   config.max_length > max_data || config.min_length > config.max_length || config.tf_vc_count_length > TF_PACKET_VC_COUNT_MAX_SIZE)
+	{
+		chansim_Usage(argv[0]);
+		return 2;
+	}
+
+	if(config.link == CHANSIM_LINK_TF)
+	{
+		tf_packet_ChannelInit(&config.tf_channel, TF_PACKET_DEFAULT_SCID, 0,
+				TF_PACKET_PRIMARY_BASE_HEADER_SIZE + config.tf_vc_count_length + TF_PACKET_DATA_HEADER_SIZE + config.max_length + config.tf_ecf_size);
+		tf_packet_ChannelSetEcf(&config.tf_channel, config.tf_ecf_size);
+		tf_packet_ChannelSetVcCount(&config.tf_channel, config.tf_vc_count_length, 0);
+	}
+	crc16_ccsds_SetBackend(crc16_ccsds_GetFastest());
+	crc32_ccsds_SetBackend(crc32_ccsds_GetFastest());
+
+	channel.packet_start = malloc(config.packets * sizeof(uint64_t));
+	receiver.received = calloc(config.packets, 1);
+	if(channel.packet_start == NULL || receiver.received == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	if(capture != NULL &&
+	   (capture_WriterOpen(&writer, capture, config.link == CHANSIM_LINK_BUS ? CAPTURE_LINK_BUS_PACKET : CAPTURE_LINK_TF_PACKET) != HAL_OK ||
+	    capture_WriterSetTfEcf(&writer, config.tf_ecf_size) != HAL_OK))
+	{
+		fprintf(stderr, "%s: cannot create capture\n", capture);
+		return 1;
+	}
+	chansim_Generate(&config, &stream, &channel, capture != NULL ? &writer : NULL);
+	if(capture != NULL)		capture_WriterClose(&writer);
+
+	if(output != NULL)
+	{
+		chansim_WriteStream(&config, &stream, &channel, output);
+		return 0;
+	}
+
+	struct timespec t0, t1;
+	receiver.config = &config;
+	tf_packet_VccInit(&receiver.vcc, TF_PACKET_VCC_DEFAULT_FLYWHEEL);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	if(config.link == CHANSIM_LINK_BUS)		chansim_ReceiveBus(&receiver, &stream);
+	else									chansim_ReceiveTf(&receiver, &stream);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	double seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+	double recovery_bytes, recovery_lost;
+	uint64_t recovery_max;
+	chansim_Recovery(&config, &channel, receiver.received, &recovery_bytes, &recovery_max, &recovery_lost);
+
+	if(!quiet)
+	{
+		printf("stream:      %s, %lu packets, %lu bytes (seed %lu)\n", config.link == CHANSIM_LINK_BUS ? "bus packets" :
+			   config.tf_ecf_size == TF_PACKET_ECF32_SIZE ? "TF packets (CRC32 ECF)" : "TF packets",
+			   (unsigned long)config.packets, (unsigned long)stream.size, (unsigned long)config.seed);
+		printf("channel:     %lu bit flips, %lu bursts, %lu drops, %lu inserts, %lu slips\n",
+			   (unsigned long)channel.flips, (unsigned long)channel.bursts, (unsigned long)channel.drops,
+			   (unsigned long)channel.inserts, (unsigned long)channel.slips);
+		printf("receiver:    %lu ok, %lu lost, %lu CRC rejected, %lu undetected, %lu duplicated\n",
+			   (unsigned long)receiver.ok, (unsigned long)(config.packets - (receiver.ok - receiver.duplicated)),
+			   (unsigned long)receiver.rejected, (unsigned long)receiver.undetected, (unsigned long)receiver.duplicated);
+		printf("recovery:    %.1f bytes mean, %lu bytes max, %.3f extra packets lost per impairment\n",
+			   recovery_bytes, (unsigned long)recovery_max, recovery_lost);
+		if(config.link == CHANSIM_LINK_TF && config.tf_vc_count_length)
+		{
+			tf_packet_vcc_stats_t vcc;
+			tf_packet_VccTotals(&receiver.vcc, &vcc);
+			printf("vc count:    %u lost in %u gaps (max %u), %u duplicates, %u late, %u resyncs\n",
+				   vcc.lost, vcc.gaps, vcc.max_gap, vcc.duplicates, vcc.late, vcc.resyncs);
+		}
+		double ok_megabytes, rejected_megabytes;
+		double ok_cost = chansim_DecodeCost(&config, &receiver.ok_frames, &ok_megabytes);
+		double rejected_cost = chansim_DecodeCost(&config, &receiver.rejected_frames, &rejected_megabytes);
+		printf("decode cost: %.1f ns accepted (%.0f frames/s, %.1f MB/s), %.1f ns rejected frame\n",
+			   ok_cost, ok_cost > 0 ? 1e9 / ok_cost : 0, ok_megabytes, rejected_cost);
+	}
+	printf("%.3f s, %.0f packets/s, %.2f MB/s, %.4f%% delivered, %lu rejected, %lu undetected\n",
+		   seconds, config.packets / seconds, stream.size / seconds / 1e6, 100.0 * receiver.ok / config.packets,
+		   (unsigned long)receiver.rejected, (unsigned long)receiver.undetected);
+
+	free(stream.data);
+	free(channel.packet_start);
+	free(channel.event);
+	free(receiver.received);
+	free(receiver.ok_frames.data);
+	free(receiver.rejected_frames.data);
+	return 0;
+}
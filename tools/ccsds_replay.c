@@ -0,0 +1,339 @@
+/**
+  ******************************************************************************
+  * @file           : ccsds_replay.c
+  * @brief          : Replay of capture files through the decoders FyCUS 2023
+  *
+  * @author         Rubén Torres Bermúdez <rubentorresbermudez@gmail.com>
+  ******************************************************************************
+  * @attention
+  *
+  *  Created on:     16.10.2026
+  *
+  *  Description:
+  *		Ground station tool (Linux) that maps a capture file and decodes
+  *		its frames again with the same functions used on reception, to
+  *		reproduce anomalies of a pass or to measure the decoders.
+  *
+  *		The frames are split in blocks of REPLAY_BLOCK records that the
+  *		threads take in order. With -s the replay follows the receive time
+  *		of the records (scaled by the speed), otherwise it runs flat-out.
+  *		In full mode, frames longer than the tfph_packet_t/bus_packet_t
+  *		structures (large TF packets, jumbo bus packets) and TF packets with
+  *		the CRC32 ECF of the capture are decoded with the zero-copy decoders
+  *		and counted apart.
+  *
+  *	 Build:
+  *		gcc -O2 -pthread -Icrc -Ibus_packet -Itf_packet -Icapture tools/ccsds_replay.c \
+  *			crc/crc16_ccsds.c crc/crc32_ccsds.c bus_packet/bus_packet.c tf_packet/tf_packet.c \
+  *			capture/capture.c capture/capture_query.c -o ccsds_replay
+  *
+  *	 Usage:
+  *		ccsds_replay [-j threads] [-s speed] [-l loops] [-m full|view]
+  *					 [-a apid] [-c vcid] [-q] capture
+  *
+  *
+  *  Copyright (C) 2023 Rubén Torres Bermúdez
+  *
+  ******************************************************************************
+  */
+
+#include "capture_query.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+
+
+#define REPLAY_BLOCK			1024
+#define REPLAY_MAX_THREADS		64
+
+#define REPLAY_MODE_FULL		0		// tf_packet_Decode / bus_packet_Decode
+#define REPLAY_MODE_VIEW		1		// tf_packet_DecodeView / bus_packet_DecodeView
+
+
+typedef struct
+{
+	const capture_reader_t *reader;
+	const uint64_t *records;		// Record numbers to replay, NULL for all of them
+	uint64_t count;
+	uint32_t loops;
+	uint8_t mode;
+	double speed;					// 0 for flat-out
+	tf_packet_channel_t tf_channel;	// Decoder of the CRC32 TF packets and the ones longer than TF_PACKET_MAX_SIZE
+	uint64_t start_ns;				// Monotonic start of the replay
+	uint64_t first_ns;				// Receive time of the first record
+	atomic_uint_fast64_t next;		// Next block
+}replay_t;
+
+
+typedef struct
+{
+	replay_t *replay;
+	pthread_t thread;
+	uint64_t frames;
+	uint64_t bytes;
+	uint64_t errors;				// Frames rejected by the decoder
+	uint64_t mismatches;			// Decoder result different from the recorded CRC status
+	uint64_t late;					// Throttled frames decoded after their time
+	uint64_t large;					// Full mode frames decoded with the zero-copy decoders (long, jumbo or CRC32)
+}replay_worker_t;
+
+
+
+
+static uint64_t replay_MonotonicNs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static void replay_Wait(replay_worker_t *worker, uint64_t timestamp_ns)
+{
+	replay_t *replay = worker->replay;
+	uint64_t elapsed = (timestamp_ns > replay->first_ns) ? timestamp_ns - replay->first_ns : 0;
+	uint64_t target = replay->start_ns + (uint64_t)(elapsed / replay->speed);
+	uint64_t now = replay_MonotonicNs();
+
+	if(now >= target)
+	{
+		if(now - target > 1000000)	worker->late++;		// More than 1 ms behind
+		return;
+	}
+
+	struct timespec ts = {(time_t)(target / 1000000000ULL), (long)(target % 1000000000ULL)};
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+
+static HAL_StatusTypeDef replay_Decode(replay_worker_t *worker, uint8_t link_type, const capture_record_t *record)
+{
+	const replay_t *replay = worker->replay;
+	const uint8_t *frame = capture_GetFrame(record);
+
+	if(link_type == CAPTURE_LINK_TF_PACKET)
+	{
+		// tf_packet_Decode and tf_packet_DecodeView only check the CRC16 ECF
+		if(replay->mode == REPLAY_MODE_VIEW || record->length > TF_PACKET_MAX_SIZE || replay->tf_channel.ecf_size != TF_PACKET_ECF_SIZE)
+		{
+			tf_packet_view_t view;
+			if(replay->mode == REPLAY_MODE_VIEW && replay->tf_channel.ecf_size == TF_PACKET_ECF_SIZE)
+				return tf_packet_DecodeView(frame, record->length, &view);
+
+			if(replay->mode != REPLAY_MODE_VIEW)	worker->large++;
+			return tf_packet_DecodeViewChannel(&replay->tf_channel, frame, record->length, &view);
+		}
+
+		tfph_packet_t tfph;
+		tfdf_packet_t tfdf;
+		uint8_t buffer[TF_PACKET_MAX_SIZE];
+		memcpy(buffer, frame, record->length);
+		return tf_packet_Decode(buffer, record->length, &tfph, &tfdf);
+	}
+
+	if(record->length < BUS_PACKET_JUMBO_HEADER_SIZE || bus_packet_GetLength(frame) != record->length)	return HAL_ERROR;
+
+	if(replay->mode == REPLAY_MODE_VIEW || record->length > BUS_PACKET_BUS_SIZE || bus_packet_IsJumbo(frame))
+	{
+		bus_packet_view_t view;
+		if(replay->mode != REPLAY_MODE_VIEW)	worker->large++;
+		return bus_packet_DecodeViewJumbo(frame, record->length, &view);
+	}
+
+	bus_packet_t packet;
+	uint8_t buffer[BUS_PACKET_BUS_SIZE];
+	memcpy(buffer, frame, record->length);
+	return bus_packet_Decode(buffer, &packet);
+}
+
+
+static void *replay_Worker(void *arg)
+{
+	replay_worker_t *worker = (replay_worker_t *)arg;
+	replay_t *replay = worker->replay;
+	uint8_t link_type = replay->reader->header->link_type;
+	uint64_t total = replay->count * replay->loops;
+	uint64_t block;
+
+	while((block = atomic_fetch_add(&replay->next, 1)) * REPLAY_BLOCK < total)
+	{
+		uint64_t end = (block + 1) * REPLAY_BLOCK;
+		if(end > total)		end = total;
+
+		for(uint64_t i = block * REPLAY_BLOCK; i < end; i++)
+		{
+			uint64_t n = i % replay->count;
+			const capture_record_t *record = capture_GetRecord(replay->reader, replay->records ? replay->records[n] : n);
+
+			if(replay->speed > 0 && i < replay->count)	replay_Wait(worker, record->timestamp_ns);
+
+			HAL_StatusTypeDef status = replay_Decode(worker, link_type, record);
+			if(status != HAL_OK)	worker->errors++;
+			if(record->crc_status != CAPTURE_CRC_UNCHECKED &&
+			   (status == HAL_OK) != (record->crc_status == CAPTURE_CRC_OK))	worker->mismatches++;
+
+			worker->frames++;
+			worker->bytes += record->length;
+		}
+	}
+
+	return NULL;
+}
+
+
+static uint64_t *replay_Select(const capture_reader_t *reader, const char *path, uint32_t list, uint64_t *count)
+{
+	capture_query_index_t index;
+	capture_query_t query;
+	uint64_t *records;
+
+	if(capture_QueryOpen(&index, path, reader) != HAL_OK)	return NULL;
+
+	*count = 0;
+	records = malloc((capture_QueryCount(&index, list) + 1) * sizeof(uint64_t));
+	if(records != NULL && capture_QueryStart(&query, &index, reader, list, CAPTURE_QUERY_TIME_ALL) == HAL_OK)
+		while(capture_QueryNext(&query) != NULL)
+			records[(*count)++] = query.record;
+
+	capture_QueryClose(&index);
+	return records;
+}
+
+
+static void replay_Usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-j threads] [-s speed] [-l loops] [-m full|view] [-a apid] [-c vcid] [-q] capture\n"
+			"  -j  decoding threads (default 1)\n"
+			"  -s  follow the receive time, scaled by speed (1 = real time); flat-out if not given\n"
+			"  -l  replay the capture several times (only the first one is throttled)\n"
+			"  -m  full: tf_packet_Decode/bus_packet_Decode (default), view: zero-copy decoders\n"
+			"  -a  replay only one APID, -c only one VCID (uses the <capture>.apx index)\n"
+			"  -q  print only the summary line\n", name);
+}
+
+
+int main(int argc, char **argv)
+{
+	replay_t replay = {0};
+	replay_worker_t workers[REPLAY_MAX_THREADS] = {0};
+	capture_reader_t reader;
+	uint32_t threads = 1;
+	int32_t list = -1;
+	uint8_t quiet = 0;
+	uint64_t *records = NULL;
+	int opt;
+
+	replay.loops = 1;
+	replay.mode = REPLAY_MODE_FULL;
+	tf_packet_ChannelInit(&replay.tf_channel, TF_PACKET_DEFAULT_SCID, 0, TF_PACKET_USLP_MAX_SIZE);
+
+	while((opt = getopt(argc, argv, "j:s:l:m:a:c:qh")) != -1)
+	{
+		switch(opt)
+		{
+		case 'j':	threads = strtoul(optarg, NULL, 0);					break;
+		case 's':	replay.speed = strtod(optarg, NULL);				break;
+		case 'l':	replay.loops = strtoul(optarg, NULL, 0);			break;
+		case 'm':	replay.mode = (strcmp(optarg, "view") == 0) ? REPLAY_MODE_VIEW : REPLAY_MODE_FULL;	break;
+		case 'a':	list = CAPTURE_QUERY_APID(strtoul(optarg, NULL, 0));	break;
+		case 'c':	list = CAPTURE_QUERY_VCID(strtoul(optarg, NULL, 0));	break;
+		case 'q':	quiet = 1;											break;
+		default:	replay_Usage(argv[0]);								return 2;
+		}
+	}
+	if(optind != argc - 1 || threads == 0 || threads > REPLAY_MAX_THREADS || replay.loops == 0)
+	{
+		replay_Usage(argv[0]);
+		return 2;
+	}
+
+	if(capture_ReaderOpen(&reader, argv[optind]) != HAL_OK)
+	{
+		fprintf(stderr, "%s: cannot open capture\n", argv[optind]);
+		return 1;
+	}
+
+	replay.reader = &reader;
+	tf_packet_ChannelSetEcf(&replay.tf_channel, capture_GetTfEcfSize(&reader));
+	replay.count = reader.count;
+	if(list >= 0)
+	{
+		records = replay_Select(&reader, argv[optind], list, &replay.count);
+		if(records == NULL)
+		{
+			fprintf(stderr, "%s: cannot open APID/VCID index\n", argv[optind]);
+			capture_ReaderClose(&reader);
+			return 1;
+		}
+		replay.records = records;
+	}
+	if(replay.count == 0)
+	{
+		fprintf(stderr, "%s: no frames to replay\n", argv[optind]);
+		free(records);
+		capture_ReaderClose(&reader);
+		return 1;
+	}
+
+	madvise((void *)reader.map, reader.map_size, MADV_SEQUENTIAL);
+	replay.first_ns = capture_GetRecord(&reader, records ? records[0] : 0)->timestamp_ns;
+	atomic_init(&replay.next, 0);
+	replay.start_ns = replay_MonotonicNs();
+
+	// The records are shared through replay.next, so the started threads replay all of them
+	uint32_t started = 0;
+	for(uint32_t i = 0; i < threads; i++)
+	{
+		workers[i].replay = &replay;
+		if(pthread_create(&workers[i].thread, NULL, replay_Worker, &workers[i]) != 0)
+		{
+			fprintf(stderr, "could not start thread %u, using %u threads\n", i, started);
+			break;
+		}
+		started++;
+	}
+	if(started == 0)
+	{
+		free(records);
+		capture_ReaderClose(&reader);
+		return 1;
+	}
+	threads = started;
+
+	replay_worker_t total = {0};
+	for(uint32_t i = 0; i < threads; i++)
+	{
+		pthread_join(workers[i].thread, NULL);
+		total.frames += workers[i].frames;
+		total.bytes += workers[i].bytes;
+		total.errors += workers[i].errors;
+		total.mismatches += workers[i].mismatches;
+		total.late += workers[i].late;
+		total.large += workers[i].large;
+	}
+	double seconds = (replay_MonotonicNs() - replay.start_ns) / 1e9;
+
+	if(!quiet)
+	{
+		printf("capture:     %s (%s, %lu records)\n", argv[optind],
+			   reader.header->link_type == CAPTURE_LINK_TF_PACKET ? "TF packets" : "bus packets", (unsigned long)reader.count);
+		printf("decoder:     %s, %u threads, %s\n", replay.mode == REPLAY_MODE_VIEW ? "view" : "full", threads,
+			   replay.speed > 0 ? "throttled" : "flat-out");
+		for(uint32_t i = 0; i < threads && threads > 1; i++)
+			printf("  thread %-3u %lu frames, %lu errors\n", i, (unsigned long)workers[i].frames, (unsigned long)workers[i].errors);
+		if(total.large)
+			printf("large:       %lu frames too long, jumbo or with CRC32 for the full decoders, decoded with the view decoders\n", (unsigned long)total.large);
+	}
+	printf("%lu frames, %.3f s, %.0f frames/s, %.2f MB/s, %lu errors, %lu mismatches, %lu late\n",
+		   (unsigned long)total.frames, seconds, total.frames / seconds, total.bytes / seconds / 1e6,
+		   (unsigned long)total.errors, (unsigned long)total.mismatches, (unsigned long)total.late);
+
+	free(records);
+	capture_ReaderClose(&reader);
+	return total.mismatches ? 3 : 0;
+}